@@ -47,6 +47,14 @@ public:
    */
   const Block& 
   wireEncode() const;
+
+  /**
+   * @brief Prepend the wire encoding to the encoder, or estimate its size
+   * @return number of bytes prepended
+   */
+  template<bool T>
+  size_t
+  wireEncode(EncodingImpl<T> &block) const;
   
   /**
    * @brief Decode the input using a particular wire format and update this Data. 
@@ -142,6 +150,10 @@ private:
   Signature signature_;
 
   mutable Block wire_;
+
+  struct SignatureInfoCodec;
+  struct SignatureValueCodec;
+  class Schema;
 };
 
 inline
@@ -11,50 +11,132 @@
 #define NDN_BLOCK_HELPERS_HPP
 
 #include "block.hpp"
+#include "encoding-buffer.hpp"
 
 namespace ndn {
 
+/**
+ * @brief Prepend TLV element holding nonNegativeInteger value
+ * @return number of bytes prepended
+ */
+template<bool P>
+inline size_t
+prependNonNegativeIntegerBlock(EncodingImpl<P> &encoder, uint32_t type, uint64_t value)
+{
+  size_t valueLength = encoder.prependNonNegativeInteger(value);
+  size_t totalLength = valueLength;
+  totalLength += encoder.prependVarNumber(valueLength);
+  totalLength += encoder.prependVarNumber(type);
+
+  return totalLength;
+}
+
+/**
+ * @brief Prepend TLV element with empty value
+ * @return number of bytes prepended
+ */
+template<bool P>
+inline size_t
+prependBooleanBlock(EncodingImpl<P> &encoder, uint32_t type)
+{
+  size_t totalLength = encoder.prependVarNumber(0);
+  totalLength += encoder.prependVarNumber(type);
+
+  return totalLength;
+}
+
+/**
+ * @brief Prepend TLV element with the value copied from the array
+ * @return number of bytes prepended
+ */
+template<bool P>
+inline size_t
+prependByteArrayBlock(EncodingImpl<P> &encoder, uint32_t type, const uint8_t *array, size_t arraySize)
+{
+  size_t totalLength = encoder.prependByteArray(array, arraySize);
+  totalLength += encoder.prependVarNumber(arraySize);
+  totalLength += encoder.prependVarNumber(type);
+
+  return totalLength;
+}
+
+/**
+ * @brief Prepend wire encoding of the block
+ *
+ * The block may have full wire, only value, or only (not yet encoded) sub-elements.  In the
+ * last two cases type and length are generated in place, without encoding the block first.
+ *
+ * @return number of bytes prepended
+ */
+template<bool P>
+inline size_t
+prependBlock(EncodingImpl<P> &encoder, const Block &block)
+{
+  if (block.hasWire())
+    return encoder.prependByteArray(block.wire(), block.size());
+
+  if (block.hasValue())
+    return prependByteArrayBlock(encoder, block.type(), block.value(), block.value_size());
+
+  size_t totalLength = 0;
+  for (Block::element_container::const_reverse_iterator i = block.getAll().rbegin();
+       i != block.getAll().rend();
+       ++i)
+    {
+      totalLength += prependBlock(encoder, *i);
+    }
+  totalLength += encoder.prependVarNumber(totalLength);
+  totalLength += encoder.prependVarNumber(block.type());
+
+  return totalLength;
+}
+
+/**
+ * @brief Create TLV element holding nonNegativeInteger value
+ *
+ * The value is encoded on the stack and the element is written into a single buffer
+ */
 inline Block
 nonNegativeIntegerBlock(uint32_t type, uint64_t value)
 {
-  OBufferStream os;
-  Tlv::writeVarNumber(os, type);
-  Tlv::writeVarNumber(os, Tlv::sizeOfNonNegativeInteger(value));
-  Tlv::writeNonNegativeInteger(os, value);
-  return Block(os.buf());
+  uint8_t buffer[8];
+  EncodingEstimator estimator;
+  size_t valueLength = estimator.prependNonNegativeInteger(value);
+  for (size_t i = 0; i < valueLength; ++i)
+    buffer[valueLength - 1 - i] = static_cast<uint8_t>(value >> (8 * i));
+
+  return Block(type, buffer, valueLength);
 }
 
 inline uint64_t
 readNonNegativeInteger(const Block &block)
 {
-  Buffer::const_iterator begin = block.value_begin();
-  return Tlv::readNonNegativeInteger(block.value_size(), begin, block.value_end());
+  const uint8_t *begin = block.value();
+  return Tlv::readNonNegativeInteger(block.value_size(), begin, begin + block.value_size());
 }
 
+/**
+ * @brief Create TLV element with empty value
+ */
 inline Block
 booleanBlock(uint32_t type)
 {
-  OBufferStream os;
-  Tlv::writeVarNumber(os, type);
-  Tlv::writeVarNumber(os, 0);
-  return Block(os.buf());
+  return Block(type, 0, 0);
 }
 
+/**
+ * @brief Create TLV element with the value copied from the array
+ */
 inline Block
-dataBlock(uint32_t type, const char *data, size_t dataSize)
+dataBlock(uint32_t type, const unsigned char *data, size_t dataSize)
 {
-  OBufferStream os;
-  Tlv::writeVarNumber(os, type);
-  Tlv::writeVarNumber(os, dataSize);
-  os.write(data, dataSize);
-
-  return Block(os.buf());
+  return Block(type, data, dataSize);
 }
 
 inline Block
-dataBlock(uint32_t type, const unsigned char *data, size_t dataSize)
+dataBlock(uint32_t type, const char *data, size_t dataSize)
 {
-  return dataBlock(type, reinterpret_cast<const char*>(data), dataSize);
+  return dataBlock(type, reinterpret_cast<const unsigned char*>(data), dataSize);
 }
 
 } // namespace ndn
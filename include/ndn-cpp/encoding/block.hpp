@@ -12,10 +12,12 @@
 
 #include <ndn-cpp/common.hpp>
 
-#include <list>
+#include <vector>
+#include <algorithm>
 #include <exception>
 
 #include "buffer.hpp"
+#include "buffer-pool.hpp"
 #include "tlv.hpp"
 
 #include <boost/lexical_cast.hpp>
@@ -28,8 +30,17 @@ namespace ndn {
 class Block
 {
 public:
-  typedef std::list<Block>::iterator element_iterator;
-  typedef std::list<Block>::const_iterator element_const_iterator;
+  typedef std::vector<Block> element_container;
+  typedef element_container::iterator element_iterator;
+  typedef element_container::const_iterator element_const_iterator;
+
+  /**
+   * @brief Sub-elements with TLV type below this value have their position indexed,
+   *        so get() and find() for them are constant-time
+   *
+   * This covers all NDN-TLV types of Interest, Data, MetaInfo, SignatureInfo and KeyLocator
+   */
+  static const uint32_t INDEXED_TYPE_LIMIT = 32;
 
   /// @brief Error that can be thrown from the block
   struct Error : public std::runtime_error { Error(const std::string &what) : std::runtime_error(what) {} };
@@ -76,6 +87,13 @@ public:
    */
   Block(uint32_t type, const ConstBufferPtr &value);
 
+  /**
+   * @brief Create Block of a specific type with the full wire encoding of the value copied from the array
+   *
+   * Type, length and value are written into a single buffer of the exact size
+   */
+  Block(uint32_t type, const uint8_t *value, size_t valueSize);
+
   /**
    * @brief Create nested Block of a specific type with the specified value
    *
@@ -109,6 +127,17 @@ public:
 
   void
   encode();
+
+  /**
+   * @brief Get the element that starts at wire, which must point inside the wire of this Block
+   *
+   * The element is not copied: it shares the buffer of this Block
+   * @param wire first byte of the element (its type)
+   * @param size number of bytes available from wire, at least the size of the element
+   * @throws Tlv::Error if the element type or length cannot be read, or value exceeds size
+   */
+  Block
+  slice(const uint8_t *wire, size_t size) const;
   
   inline uint32_t
   type() const;
@@ -143,18 +172,46 @@ public:
   /**
    * @brief Get all subelements
    */
-  inline const std::list<Block>&
+  inline const element_container&
   getAll () const;
 
-  inline std::list<Block>&
+  /**
+   * @brief Get all subelements (mutable version)
+   *
+   * Direct modifications of the returned container are allowed, so the type index
+   * is discarded and rebuilt on the next non-const find()
+   */
+  inline element_container&
   getAll ();
   
   /**
    * @brief Get all elements of the requested type
    */
-  std::list<Block>
+  element_container
   getAll(uint32_t type) const;
 
+  /**
+   * @brief Get begin iterator of the subelements
+   *
+   * Unlike getAll(), does not discard the type index
+   */
+  inline element_const_iterator
+  elements_begin() const;
+
+  /**
+   * @brief Get end iterator of the subelements (e.g., to check result of find())
+   *
+   * Unlike getAll(), does not discard the type index
+   */
+  inline element_const_iterator
+  elements_end() const;
+
+  /**
+   * @brief Get number of subelements
+   */
+  inline size_t
+  elements_size() const;
+
   inline Buffer::const_iterator
   begin() const;
 
@@ -170,6 +227,12 @@ public:
   inline Buffer::const_iterator
   value_end() const;
 
+  /**
+   * @brief Get the buffer that begin() and the other iterators point into, which is shared with this Block
+   */
+  inline const ConstBufferPtr&
+  sharedBuffer() const;
+
   inline const uint8_t*
   wire() const;
   
@@ -183,15 +246,56 @@ protected:
   ConstBufferPtr m_buffer;
 
   uint32_t m_type;
-  
-  Buffer::const_iterator m_begin;
-  Buffer::const_iterator m_end;
+
+  // offsets from the beginning of m_buffer
+  size_t m_begin;
+  size_t m_end;
   uint32_t m_size;
   
-  Buffer::const_iterator m_value_begin;
-  Buffer::const_iterator m_value_end;
+  size_t m_value_begin;
+  size_t m_value_end;
 
-  std::list<Block> m_subBlocks;
+  element_container m_subBlocks;
+
+private:
+  /**
+   * @brief Record position of the sub-element (if its type is indexed and the slot is not yet taken)
+   */
+  inline void
+  indexElement(size_t position);
+
+  void
+  rebuildIndex();
+
+  inline void
+  clearIndex();
+
+  /**
+   * @brief Get pointer to the first byte of m_buffer, which the offsets refer to
+   */
+  inline const uint8_t*
+  storage() const;
+
+  /**
+   * @brief Create Block for the element at [wire, end) inside the wire of this Block
+   */
+  Block
+  makeSubBlock(uint32_t type, const uint8_t *wire, const uint8_t *valueBegin, const uint8_t *end) const;
+
+  /// @brief Positions below this value can be stored in the index
+  static const size_t MAX_INDEXED_POSITION = 255;
+
+  /**
+   * @brief Position + 1 of the first sub-element of each indexed type, 0 if there is none
+   *
+   * Only valid if m_isIndexValid is true
+   */
+  uint8_t m_index[INDEXED_TYPE_LIMIT];
+  bool m_isIndexValid;
+
+#if NDN_CPP_WITH_INSTRUMENTATION
+  InstrumentedCopy<Instrumentation::BLOCK_COPIES> m_instrumentedCopy;
+#endif
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -201,7 +305,7 @@ protected:
 inline bool
 Block::hasWire() const
 {
-  return m_buffer && (m_begin != m_end);
+  return hasValue() && (m_begin != m_end);
 }
 
 inline bool
@@ -215,9 +319,16 @@ Block::reset()
 {
   m_buffer.reset(); // reset of the shared_ptr
   m_subBlocks.clear(); // remove all parsed subelements
+  clearIndex();
 
   m_type = std::numeric_limits<uint32_t>::max();
-  m_begin = m_end = m_value_begin = m_value_end = Buffer::const_iterator(); // not really necessary, but for safety
+  m_begin = m_end = m_value_begin = m_value_end = 0; // not really necessary, but for safety
+}
+
+inline const uint8_t*
+Block::storage() const
+{
+  return m_buffer->empty() ? 0 : &m_buffer->front();
 }
 
 inline uint32_t
@@ -226,18 +337,27 @@ Block::type() const
   return m_type;
 }
 
+inline void
+Block::clearIndex()
+{
+  std::fill(m_index, m_index + INDEXED_TYPE_LIMIT, 0);
+  m_isIndexValid = true;
+}
+
+inline void
+Block::indexElement(size_t position)
+{
+  uint32_t type = m_subBlocks[position].type();
+  if (type < INDEXED_TYPE_LIMIT && position < MAX_INDEXED_POSITION && m_index[type] == 0)
+    m_index[type] = static_cast<uint8_t>(position + 1);
+}
+
 inline const Block &
 Block::get(uint32_t type) const
 {
-  for (element_const_iterator i = m_subBlocks.begin ();
-       i != m_subBlocks.end();
-       i++)
-    {
-      if (i->type () == type)
-        {
-          return *i;
-        }
-    }
+  element_const_iterator i = find(type);
+  if (i != m_subBlocks.end())
+    return *i;
 
   throw Error("(Block::get) Requested a non-existed type [" + boost::lexical_cast<std::string>(type) + "] from Block");
 }
@@ -245,15 +365,9 @@ Block::get(uint32_t type) const
 inline Block &
 Block::get(uint32_t type)
 {
-  for (element_iterator i = m_subBlocks.begin ();
-       i != m_subBlocks.end();
-       i++)
-    {
-      if (i->type () == type)
-        {
-          return *i;
-        }
-    }
+  element_iterator i = find(type);
+  if (i != m_subBlocks.end())
+    return *i;
 
   throw Error("(Block::get) Requested a non-existed type [" + boost::lexical_cast<std::string>(type) + "] from Block");
 }
@@ -261,9 +375,20 @@ Block::get(uint32_t type)
 inline Block::element_const_iterator
 Block::find(uint32_t type) const
 {
-  for (element_const_iterator i = m_subBlocks.begin ();
-       i != m_subBlocks.end();
-       i++)
+  element_const_iterator i = m_subBlocks.begin();
+  if (type < INDEXED_TYPE_LIMIT && m_isIndexValid)
+    {
+      if (m_index[type] != 0)
+        return m_subBlocks.begin() + (m_index[type] - 1);
+
+      if (m_subBlocks.size() <= MAX_INDEXED_POSITION)
+        return m_subBlocks.end();
+
+      // only elements beyond the indexed positions need to be checked
+      i += MAX_INDEXED_POSITION;
+    }
+
+  for (; i != m_subBlocks.end(); i++)
     {
       if (i->type () == type)
         {
@@ -276,16 +401,11 @@ Block::find(uint32_t type) const
 inline Block::element_iterator
 Block::find(uint32_t type)
 {
-  for (element_iterator i = m_subBlocks.begin ();
-       i != m_subBlocks.end();
-       i++)
-    {
-      if (i->type () == type)
-        {
-          return i;
-        }
-    }
-  return m_subBlocks.end();
+  if (!m_isIndexValid)
+    rebuildIndex();
+
+  element_const_iterator i = static_cast<const Block&>(*this).find(type);
+  return m_subBlocks.begin() + (i - m_subBlocks.begin());
 }
 
 struct block_type
@@ -307,19 +427,27 @@ private:
 inline void
 Block::remove(uint32_t type)
 {
-  m_subBlocks.remove_if(block_type(type));
+  m_subBlocks.erase(std::remove_if(m_subBlocks.begin(), m_subBlocks.end(), block_type(type)),
+                    m_subBlocks.end());
+  rebuildIndex();
 }
 
 inline Block::element_iterator
 Block::erase(Block::element_iterator position)
 {
-  return m_subBlocks.erase(position);
+  element_iterator next = m_subBlocks.erase(position);
+  size_t offset = next - m_subBlocks.begin();
+  rebuildIndex();
+  return m_subBlocks.begin() + offset;
 }
 
 inline Block::element_iterator
 Block::erase(Block::element_iterator first, Block::element_iterator last)
 {
-  return m_subBlocks.erase(first, last);
+  element_iterator next = m_subBlocks.erase(first, last);
+  size_t offset = next - m_subBlocks.begin();
+  rebuildIndex();
+  return m_subBlocks.begin() + offset;
 }
 
 
@@ -327,21 +455,42 @@ inline void
 Block::push_back(const Block &element)
 {
   m_subBlocks.push_back(element);
+  if (m_isIndexValid)
+    indexElement(m_subBlocks.size() - 1);
 }
 
 
-inline const std::list<Block>&
+inline const Block::element_container&
 Block::getAll () const
 {
   return m_subBlocks;
 }
 
-inline std::list<Block>&
+inline Block::element_container&
 Block::getAll ()
 {
+  m_isIndexValid = false;
   return m_subBlocks;
 }
 
+inline Block::element_const_iterator
+Block::elements_begin() const
+{
+  return m_subBlocks.begin();
+}
+
+inline Block::element_const_iterator
+Block::elements_end() const
+{
+  return m_subBlocks.end();
+}
+
+inline size_t
+Block::elements_size() const
+{
+  return m_subBlocks.size();
+}
+
 
 inline Buffer::const_iterator
 Block::begin() const
@@ -349,7 +498,7 @@ Block::begin() const
   if (!hasWire())
       throw Error("Underlying wire buffer is empty");
 
-  return m_begin;
+  return m_buffer->begin() + m_begin;
 }
 
 inline Buffer::const_iterator
@@ -358,7 +507,7 @@ Block::end() const
   if (!hasWire())
       throw Error("Underlying wire buffer is empty");
 
-  return m_end;
+  return m_buffer->begin() + m_end;
 }
 
 inline size_t
@@ -377,7 +526,7 @@ Block::value_begin() const
   if (!hasValue())
       throw Error("(Block::value_begin) Underlying value buffer is empty");
 
-  return m_value_begin;
+  return m_buffer->begin() + m_value_begin;
 }
 
 inline Buffer::const_iterator
@@ -386,7 +535,13 @@ Block::value_end() const
   if (!hasValue())
       throw Error("(Block::value_end) Underlying value buffer is empty");
 
-  return m_value_end;
+  return m_buffer->begin() + m_value_end;
+}
+
+inline const ConstBufferPtr&
+Block::sharedBuffer() const
+{
+  return m_buffer;
 }
 
 inline const uint8_t*
@@ -395,7 +550,7 @@ Block::wire() const
   if (!hasWire())
       throw Error("(Block::wire) Underlying wire buffer is empty");
 
-  return &*m_begin;
+  return storage() + m_begin;
 }
 
 inline const uint8_t*
@@ -404,7 +559,7 @@ Block::value() const
   if (!hasValue())
       throw Error("(Block::value) Underlying value buffer is empty");
   
-  return &*m_value_begin;
+  return storage() + m_value_begin;
 }
 
 inline size_t
@@ -418,6 +573,6 @@ Block::value_size() const
 
 } // ndn
 
-#include "block-helpers.hpp"
+#include "encoding-buffer.hpp"
 
 #endif // NDN_BLOCK_HPP
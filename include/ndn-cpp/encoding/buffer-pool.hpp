@@ -0,0 +1,172 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef NDN_BUFFER_POOL_HPP
+#define NDN_BUFFER_POOL_HPP
+
+#include <ndn-cpp/common.hpp>
+
+#include <string.h>
+#include <vector>
+
+#include "buffer.hpp"
+
+namespace ndn {
+
+/**
+ * @brief Per-thread pool of Buffer objects that are reused together with their memory
+ *
+ * Released buffers are kept in free lists of power-of-two size classes (by capacity), and the
+ * shared_ptr control blocks are kept in a free list of their own.  When the pool is warm, a
+ * buffer of a pooled size is obtained without any heap allocation.
+ *
+ * A pool is used by the library once it is installed in a thread with BufferPool::install():
+ * all wire buffers of Block, EncodingBuffer and TlvFramer and values of Name::Component created
+ * in that thread are then taken from it via allocateBuffer().  A buffer goes to the pool that
+ * is installed in the thread which releases it (or is simply freed if there is none), so
+ * buffers can be passed between threads.  The pool itself is not thread-safe.
+ *
+ * <code>
+ *     BufferPool pool;
+ *     BufferPool::install(&pool);
+ *     ...
+ *     BufferPool::install(0);
+ * </code>
+ */
+class BufferPool
+{
+public:
+  /// @brief Smallest size class, smaller buffers are given this capacity
+  static const size_t MIN_POOLED_SIZE = 64;
+
+  /// @brief Largest size class, larger buffers are allocated and freed as usual
+  static const size_t MAX_POOLED_SIZE = 65536;
+
+  /**
+   * @param maxCachedPerClass maximum number of released buffers kept in each size class
+   */
+  explicit
+  BufferPool(size_t maxCachedPerClass = 256);
+
+  ~BufferPool();
+
+  /**
+   * @brief Get a buffer of the specified size (filled with zeros)
+   */
+  BufferPtr
+  allocate(size_t size);
+
+  /**
+   * @brief Get number of buffers requested from the pool
+   */
+  uint64_t
+  getNAllocations() const;
+
+  /**
+   * @brief Get number of requests that were satisfied with a released buffer
+   */
+  uint64_t
+  getNHits() const;
+
+  /**
+   * @brief Get fraction of requests that were satisfied with a released buffer
+   */
+  double
+  getHitRate() const;
+
+  /**
+   * @brief Get number of released buffers currently kept by the pool
+   */
+  size_t
+  getNCached() const;
+
+  void
+  resetStatistics();
+
+  /**
+   * @brief Make allocateBuffer() in the calling thread take buffers from the pool
+   *
+   * @param pool the pool, which must stay alive while it is installed; 0 to uninstall
+   */
+  static void
+  install(BufferPool *pool);
+
+  /**
+   * @brief Get the pool installed in the calling thread, 0 if none
+   */
+  static BufferPool*
+  getInstalled();
+
+private:
+  BufferPool(const BufferPool&);
+
+  BufferPool&
+  operator=(const BufferPool&);
+
+  /**
+   * @brief Keep the released buffer in the pool (or delete it if there is no room)
+   */
+  void
+  release(Buffer *buffer);
+
+  void*
+  allocateControlBlock(size_t size);
+
+  void
+  releaseControlBlock(void *block, size_t size);
+
+  static size_t
+  getSizeClass(size_t size);
+
+  class Deleter;
+  template<class T> class ControlBlockAllocator;
+
+private:
+  static const size_t N_SIZE_CLASSES = 11;
+
+  size_t m_maxCachedPerClass;
+  std::vector<Buffer*> m_buffers[N_SIZE_CLASSES];
+  std::vector<void*> m_controlBlocks;
+
+  uint64_t m_nAllocations;
+  uint64_t m_nHits;
+};
+
+/**
+ * @brief Create a buffer of the specified size, taking it from the BufferPool installed in
+ *        the calling thread if there is one
+ */
+inline BufferPtr
+allocateBuffer(size_t size)
+{
+  BufferPool *pool = BufferPool::getInstalled();
+  if (pool != 0)
+    return pool->allocate(size);
+
+  return ptr_lib::make_shared<Buffer>(size);
+}
+
+/**
+ * @brief Create a buffer holding a copy of the array, taking it from the BufferPool installed in
+ *        the calling thread if there is one
+ */
+inline BufferPtr
+allocateBuffer(const uint8_t *array, size_t size)
+{
+  BufferPool *pool = BufferPool::getInstalled();
+  if (pool == 0)
+    return ptr_lib::make_shared<Buffer>(array, size);
+
+  BufferPtr buffer = pool->allocate(size);
+  if (size > 0)
+    memcpy(buffer->buf(), array, size);
+  return buffer;
+}
+
+} // namespace ndn
+
+#endif // NDN_BUFFER_POOL_HPP
@@ -11,6 +11,7 @@
 #define NDN_BUFFER_HPP
 
 #include <ndn-cpp/common.hpp>
+#include <ndn-cpp/util/instrumentation.hpp>
 
 #include <boost/iostreams/detail/ios.hpp>
 #include <boost/iostreams/categories.hpp>
@@ -39,6 +40,18 @@ public:
    */
   Buffer ()
   {
+    NDN_INSTRUMENT(BUFFER_ALLOCATIONS);
+  }
+
+  /**
+   * @brief Creates a buffer with pre-allocated size
+   * @param size size of the buffer to be allocated
+   */
+  explicit
+  Buffer (size_t size)
+    : std::vector<uint8_t> (size, 0)
+  {
+    NDN_INSTRUMENT(BUFFER_ALLOCATIONS);
   }
 
   /**
@@ -49,6 +62,7 @@ public:
   Buffer (const void *buf, size_t length)
     : std::vector<uint8_t> (reinterpret_cast<const uint8_t*> (buf), reinterpret_cast<const uint8_t*> (buf) + length)
   {
+    NDN_INSTRUMENT(BUFFER_ALLOCATIONS);
   }
 
   /**
@@ -63,6 +77,7 @@ public:
   Buffer (InputIterator first, InputIterator last)
     : std::vector<uint8_t> (first, last)
   {
+    NDN_INSTRUMENT(BUFFER_ALLOCATIONS);
   }
   
   /**
@@ -122,6 +137,11 @@ public:
   {
     return reinterpret_cast<const T *>(&front ());
   }  
+
+#if NDN_CPP_WITH_INSTRUMENTATION
+private:
+  InstrumentedCopy<Instrumentation::BUFFER_COPIES> m_instrumentedCopy;
+#endif
 };
 
 /// @cond include_hidden
@@ -141,7 +161,10 @@ public:
   std::streamsize
   write(const char_type* s, std::streamsize n)
   {
+    size_t capacity = m_container.capacity ();
     std::copy (s, s+n, std::back_inserter(m_container));
+    if (m_container.capacity () != capacity)
+      NDN_INSTRUMENT(OBUFFERSTREAM_ALLOCATIONS);
     return n;
   }
   
@@ -175,6 +198,7 @@ struct OBufferStream : public boost::iostreams::stream<iostreams::buffer_append_
     : m_buffer (ptr_lib::make_shared<Buffer> ())
     , m_device (*m_buffer)
   {
+    NDN_INSTRUMENT(OBUFFERSTREAM_ALLOCATIONS);
     open (m_device);
   }
 
@@ -0,0 +1,326 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef NDN_ENCODING_BUFFER_HPP
+#define NDN_ENCODING_BUFFER_HPP
+
+#include <ndn-cpp/common.hpp>
+
+#include <string.h>
+
+#include "buffer.hpp"
+#include "tlv.hpp"
+#include "block.hpp"
+
+namespace ndn {
+
+/**
+ * @brief Class representing wire element encoder or wire size estimator
+ *
+ * Both versions have the same interface, so the same wireEncode(EncodingImpl<T>&) method of a
+ * packet class can be used first to estimate the exact size of the wire encoding and then to
+ * write the encoding into a buffer allocated just once.
+ *
+ * TLV elements are written back to front: nested elements are prepended before the type and
+ * length of their parent, so the parent length is known by the time it needs to be written.
+ */
+template<bool isRealEncoderNotEstimator>
+class EncodingImpl;
+
+typedef EncodingImpl<true> EncodingBuffer;
+typedef EncodingImpl<false> EncodingEstimator;
+
+/**
+ * @brief Encoder that prepends TLV elements into a pre-allocated buffer
+ */
+template<>
+class EncodingImpl<true>
+{
+public:
+  /**
+   * @brief Create an encoder with the specified capacity
+   *
+   * @param totalReserve    number of bytes to allocate for the encoding
+   * @param reserveFromBack number of bytes to leave after the encoding for append operations
+   *
+   * If the capacity turns out to be insufficient, the buffer is grown (with a copy)
+   */
+  explicit
+  EncodingImpl(size_t totalReserve = 8800, size_t reserveFromBack = 400)
+    : m_buffer(allocateBuffer(totalReserve))
+  {
+    m_begin = m_end = std::min(totalReserve, totalReserve - reserveFromBack);
+  }
+
+  /**
+   * @brief Get size of the encoded data
+   */
+  inline size_t
+  size() const;
+
+  /**
+   * @brief Get size of the underlying buffer
+   */
+  inline size_t
+  capacity() const;
+
+  /**
+   * @brief Get pointer to the first byte of the encoded data
+   */
+  inline uint8_t*
+  buf();
+
+  inline const uint8_t*
+  buf() const;
+
+  /**
+   * @brief Create Block that references the encoded data (no copy)
+   *
+   * The encoded data must be a single TLV element
+   */
+  inline Block
+  block() const;
+
+  inline size_t
+  prependByte(uint8_t value);
+
+  inline size_t
+  prependByteArray(const uint8_t *array, size_t length);
+
+  /**
+   * @brief Prepend nonNegativeInteger (1, 2, 4, or 8 bytes, same as Tlv::writeNonNegativeInteger)
+   */
+  inline size_t
+  prependNonNegativeInteger(uint64_t varNumber);
+
+  /**
+   * @brief Prepend VAR-NUMBER in NDN-TLV encoding
+   */
+  inline size_t
+  prependVarNumber(uint64_t varNumber);
+
+private:
+  /**
+   * @brief Make sure that at least length bytes can be prepended
+   */
+  inline void
+  reserveFront(size_t length);
+
+  inline void
+  growFront(size_t length);
+
+private:
+  BufferPtr m_buffer;
+
+  // offsets, so they stay valid when the buffer is reallocated
+  size_t m_begin;
+  size_t m_end;
+};
+
+
+/**
+ * @brief Estimator of the wire size, having the same interface as EncodingBuffer
+ *
+ * Nothing is written; every call only returns number of bytes it would have prepended
+ */
+template<>
+class EncodingImpl<false>
+{
+public:
+  EncodingImpl(size_t totalReserve = 8800, size_t reserveFromBack = 400)
+  {
+  }
+
+  inline size_t
+  prependByte(uint8_t value);
+
+  inline size_t
+  prependByteArray(const uint8_t *array, size_t length);
+
+  inline size_t
+  prependNonNegativeInteger(uint64_t varNumber);
+
+  inline size_t
+  prependVarNumber(uint64_t varNumber);
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+inline size_t
+EncodingImpl<true>::size() const
+{
+  return m_end - m_begin;
+}
+
+inline size_t
+EncodingImpl<true>::capacity() const
+{
+  return m_buffer->size();
+}
+
+inline uint8_t*
+EncodingImpl<true>::buf()
+{
+  return m_buffer->buf() + m_begin;
+}
+
+inline const uint8_t*
+EncodingImpl<true>::buf() const
+{
+  return m_buffer->buf() + m_begin;
+}
+
+inline Block
+EncodingImpl<true>::block() const
+{
+  ConstBufferPtr wire = m_buffer;
+
+  Buffer::const_iterator begin = wire->begin() + m_begin;
+  Buffer::const_iterator end = wire->begin() + m_end;
+
+  Buffer::const_iterator valueBegin = begin;
+  uint32_t type = Tlv::readType(valueBegin, end);
+  uint64_t length = Tlv::readVarNumber(valueBegin, end);
+  if (length != static_cast<uint64_t>(end - valueBegin))
+    throw Tlv::Error("TLV length doesn't match buffer length");
+
+  return Block(wire, type, begin, end, valueBegin, end);
+}
+
+inline void
+EncodingImpl<true>::reserveFront(size_t length)
+{
+  if (m_begin < length)
+    growFront(length);
+}
+
+inline void
+EncodingImpl<true>::growFront(size_t length)
+{
+  size_t extra = std::max(length, m_buffer->size());
+
+  BufferPtr buffer = allocateBuffer(m_buffer->size() + extra);
+  std::copy(m_buffer->begin(), m_buffer->end(), buffer->begin() + extra);
+
+  m_buffer = buffer;
+  m_begin += extra;
+  m_end += extra;
+}
+
+inline size_t
+EncodingImpl<true>::prependByte(uint8_t value)
+{
+  reserveFront(1);
+  --m_begin;
+  (*m_buffer)[m_begin] = value;
+  return 1;
+}
+
+inline size_t
+EncodingImpl<true>::prependByteArray(const uint8_t *array, size_t length)
+{
+  if (length == 0)
+    return 0;
+
+  reserveFront(length);
+  m_begin -= length;
+  memcpy(m_buffer->buf() + m_begin, array, length);
+  return length;
+}
+
+inline size_t
+EncodingImpl<true>::prependNonNegativeInteger(uint64_t varNumber)
+{
+  if (varNumber < 253) {
+    return prependByte(static_cast<uint8_t>(varNumber));
+  }
+  else if (varNumber <= std::numeric_limits<uint16_t>::max()) {
+    uint16_t value = htobe16(static_cast<uint16_t>(varNumber));
+    return prependByteArray(reinterpret_cast<const uint8_t*>(&value), 2);
+  }
+  else if (varNumber <= std::numeric_limits<uint32_t>::max()) {
+    uint32_t value = htobe32(static_cast<uint32_t>(varNumber));
+    return prependByteArray(reinterpret_cast<const uint8_t*>(&value), 4);
+  }
+  else {
+    uint64_t value = htobe64(varNumber);
+    return prependByteArray(reinterpret_cast<const uint8_t*>(&value), 8);
+  }
+}
+
+inline size_t
+EncodingImpl<true>::prependVarNumber(uint64_t varNumber)
+{
+  if (varNumber < 253) {
+    prependByte(static_cast<uint8_t>(varNumber));
+    return 1;
+  }
+  else if (varNumber <= std::numeric_limits<uint16_t>::max()) {
+    uint16_t value = htobe16(static_cast<uint16_t>(varNumber));
+    prependByteArray(reinterpret_cast<const uint8_t*>(&value), 2);
+    prependByte(253);
+    return 3;
+  }
+  else if (varNumber <= std::numeric_limits<uint32_t>::max()) {
+    uint32_t value = htobe32(static_cast<uint32_t>(varNumber));
+    prependByteArray(reinterpret_cast<const uint8_t*>(&value), 4);
+    prependByte(254);
+    return 5;
+  }
+  else {
+    uint64_t value = htobe64(varNumber);
+    prependByteArray(reinterpret_cast<const uint8_t*>(&value), 8);
+    prependByte(255);
+    return 9;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+inline size_t
+EncodingImpl<false>::prependByte(uint8_t value)
+{
+  return 1;
+}
+
+inline size_t
+EncodingImpl<false>::prependByteArray(const uint8_t *array, size_t length)
+{
+  return length;
+}
+
+inline size_t
+EncodingImpl<false>::prependNonNegativeInteger(uint64_t varNumber)
+{
+  if (varNumber < 253) {
+    return 1;
+  }
+  else if (varNumber <= std::numeric_limits<uint16_t>::max()) {
+    return 2;
+  }
+  else if (varNumber <= std::numeric_limits<uint32_t>::max()) {
+    return 4;
+  }
+  else {
+    return 8;
+  }
+}
+
+inline size_t
+EncodingImpl<false>::prependVarNumber(uint64_t varNumber)
+{
+  return Tlv::sizeOfVarNumber(varNumber);
+}
+
+} // namespace ndn
+
+#include "block-helpers.hpp"
+
+#endif // NDN_ENCODING_BUFFER_HPP
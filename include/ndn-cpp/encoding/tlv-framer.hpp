@@ -0,0 +1,271 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef NDN_TLV_FRAMER_HPP
+#define NDN_TLV_FRAMER_HPP
+
+#include <ndn-cpp/common.hpp>
+
+#include "buffer.hpp"
+#include "tlv.hpp"
+#include "block.hpp"
+
+namespace ndn {
+
+/**
+ * @brief Incremental framer of NDN-TLV elements received from a byte stream
+ *
+ * The framer owns the receive buffer.  A stream transport reads into receiveBuffer(), reports
+ * the number of bytes read with received(), and then calls next() until it returns false.  Each
+ * complete element is returned as a Block that shares the receive buffer (no copy).
+ *
+ * An incomplete trailing element is never an error: next() simply returns false and needed()
+ * tells how many more bytes are required.  Elements larger than the buffer size get a buffer of
+ * their own, up to the maximum element size.
+ */
+class TlvFramer
+{
+public:
+  /// @brief Error that is thrown when the stream cannot contain valid NDN-TLV elements
+  struct Error : public Tlv::Error { Error(const std::string &what) : Tlv::Error(what) {} };
+
+  static const size_t DEFAULT_BUFFER_SIZE = 8800;
+  static const size_t DEFAULT_MAX_ELEMENT_SIZE = 1024 * 1024;
+
+  /**
+   * @param bufferSize     size of the receive buffers
+   * @param maxElementSize elements that declare larger size are rejected with Error
+   */
+  explicit
+  TlvFramer(size_t bufferSize = DEFAULT_BUFFER_SIZE, size_t maxElementSize = DEFAULT_MAX_ELEMENT_SIZE);
+
+  /**
+   * @brief Frame the element at the beginning of [begin, end), without throwing
+   *
+   * @param elementSize set to total size of the element (type, length, and value) if its type
+   *                    and length are complete, to 0 otherwise
+   * @return number of bytes still needed to complete the element (0 if the element is complete).
+   *         If even type and length are incomplete, at least one more byte is needed.
+   */
+  static inline uint64_t
+  frame(const uint8_t *begin, const uint8_t *end, uint64_t &elementSize);
+
+  /**
+   * @brief Get the memory where the next read should put the data
+   */
+  inline uint8_t*
+  receiveBuffer();
+
+  /**
+   * @brief Get the number of bytes that can be put into receiveBuffer()
+   */
+  inline size_t
+  receiveBufferSize() const;
+
+  /**
+   * @brief Notify the framer that nBytes were put into receiveBuffer()
+   */
+  inline void
+  received(size_t nBytes);
+
+  /**
+   * @brief Get the next complete element
+   *
+   * When no complete element is left, element is reset, the incomplete trailing element is moved
+   * to the front of the receive buffer and false is returned.  If delivered elements still reference
+   * the current receive buffer, the incomplete element is moved to a new buffer instead.  Therefore,
+   * next() should be called until it returns false before the next read.
+   *
+   * @throws Error if the next element has invalid type or is larger than the maximum element size
+   */
+  inline bool
+  next(Block &element);
+
+  /**
+   * @brief Get the number of bytes that are needed before next() can return another element
+   */
+  inline size_t
+  needed() const;
+
+  /**
+   * @brief Discard all buffered data (e.g., after reconnect)
+   */
+  inline void
+  reset();
+
+private:
+  inline void
+  compact(uint64_t pendingSize);
+
+private:
+  size_t m_bufferSize;
+  size_t m_maxElementSize;
+
+  BufferPtr m_buffer;
+  size_t m_begin;
+  size_t m_end;
+  size_t m_needed;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+inline
+TlvFramer::TlvFramer(size_t bufferSize/* = DEFAULT_BUFFER_SIZE*/, size_t maxElementSize/* = DEFAULT_MAX_ELEMENT_SIZE*/)
+  : m_bufferSize(bufferSize)
+  , m_maxElementSize(maxElementSize)
+  , m_buffer(allocateBuffer(bufferSize))
+  , m_begin(0)
+  , m_end(0)
+  , m_needed(1)
+{
+  NDN_INSTRUMENT(TRANSPORT_RECEIVE_ALLOCATIONS);
+}
+
+inline uint64_t
+TlvFramer::frame(const uint8_t *begin, const uint8_t *end, uint64_t &elementSize)
+{
+  const uint8_t *valueBegin = begin;
+  uint64_t type;
+  uint64_t length;
+  if (!Tlv::readVarNumber(valueBegin, end, type) || !Tlv::readVarNumber(valueBegin, end, length))
+    {
+      elementSize = 0;
+      return 1;
+    }
+
+  uint64_t headerSize = valueBegin - begin;
+  if (length > std::numeric_limits<uint64_t>::max() - headerSize)
+    {
+      // cannot be a valid element, report size larger than any limit
+      elementSize = std::numeric_limits<uint64_t>::max();
+      return elementSize;
+    }
+
+  elementSize = headerSize + length;
+
+  uint64_t available = end - begin;
+  return (elementSize > available) ? elementSize - available : 0;
+}
+
+inline uint8_t*
+TlvFramer::receiveBuffer()
+{
+  return m_buffer->buf() + m_end;
+}
+
+inline size_t
+TlvFramer::receiveBufferSize() const
+{
+  return m_buffer->size() - m_end;
+}
+
+inline void
+TlvFramer::received(size_t nBytes)
+{
+  m_end += nBytes;
+  m_needed = (nBytes >= m_needed) ? 0 : m_needed - nBytes;
+}
+
+inline size_t
+TlvFramer::needed() const
+{
+  return m_needed;
+}
+
+inline bool
+TlvFramer::next(Block &element)
+{
+  if (m_needed == 0 && m_begin < m_end)
+    {
+      const uint8_t *begin = m_buffer->buf() + m_begin;
+      const uint8_t *end = m_buffer->buf() + m_end;
+
+      uint64_t elementSize;
+      uint64_t needed = frame(begin, end, elementSize);
+      if (elementSize > m_maxElementSize)
+        throw Error("Incoming TLV element is larger than the maximum allowed size");
+
+      if (needed == 0)
+        {
+          ConstBufferPtr buffer = m_buffer;
+          Buffer::const_iterator elementBegin = buffer->begin() + m_begin;
+          Buffer::const_iterator elementEnd = elementBegin + elementSize;
+
+          Buffer::const_iterator valueBegin = elementBegin;
+          uint32_t type;
+          uint64_t length;
+          if (!Tlv::readType(valueBegin, elementEnd, type))
+            throw Error("TLV type code exceeds allowed maximum");
+          Tlv::readVarNumber(valueBegin, elementEnd, length);
+
+          element = Block(buffer, type, elementBegin, elementEnd, valueBegin, elementEnd);
+          m_begin += elementSize;
+          return true;
+        }
+
+      m_needed = needed;
+      element = Block();
+      compact(elementSize);
+      return false;
+    }
+
+  element = Block();
+  if (m_begin == m_end)
+    {
+      // everything has been delivered
+      m_needed = 1;
+      compact(0);
+    }
+  // otherwise, still waiting for the same incomplete element, which is already at the front
+  return false;
+}
+
+inline void
+TlvFramer::compact(uint64_t pendingSize)
+{
+  size_t partialSize = m_end - m_begin;
+  size_t requiredSize = std::max(m_bufferSize, static_cast<size_t>(pendingSize));
+
+  if (m_buffer.unique() && m_buffer->size() >= requiredSize)
+    {
+      if (m_begin > 0)
+        {
+          std::copy(m_buffer->begin() + m_begin, m_buffer->begin() + m_end, m_buffer->begin());
+          NDN_INSTRUMENT_ADD(TRANSPORT_RECEIVE_COPIED_BYTES, partialSize);
+        }
+    }
+  else
+    {
+      NDN_INSTRUMENT(TRANSPORT_RECEIVE_ALLOCATIONS);
+      NDN_INSTRUMENT_ADD(TRANSPORT_RECEIVE_COPIED_BYTES, partialSize);
+      BufferPtr buffer = allocateBuffer(requiredSize);
+      std::copy(m_buffer->begin() + m_begin, m_buffer->begin() + m_end, buffer->begin());
+      m_buffer = buffer;
+    }
+
+  m_begin = 0;
+  m_end = partialSize;
+}
+
+inline void
+TlvFramer::reset()
+{
+  if (!m_buffer.unique() || m_buffer->size() != m_bufferSize)
+    {
+      NDN_INSTRUMENT(TRANSPORT_RECEIVE_ALLOCATIONS);
+      m_buffer = allocateBuffer(m_bufferSize);
+    }
+
+  m_begin = m_end = 0;
+  m_needed = 1;
+}
+
+} // namespace ndn
+
+#endif // NDN_TLV_FRAMER_HPP
@@ -0,0 +1,263 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef NDN_TLV_READER_HPP
+#define NDN_TLV_READER_HPP
+
+#include <ndn-cpp/common.hpp>
+
+#include "tlv.hpp"
+#include "block.hpp"
+
+namespace ndn {
+
+/**
+ * @brief Forward cursor over a sequence of NDN-TLV elements
+ *
+ * The reader only keeps pointers into the byte range: it never allocates and does not hold
+ * a reference to the underlying buffer, which must outlive the reader.
+ *
+ * <code>
+ *     TlvReader reader(block);   // elements inside the value of block
+ *     while (reader.next()) {
+ *       if (reader.type() == Tlv::Name)
+ *         ... reader.value(), reader.value_size() ...
+ *     }
+ * </code>
+ *
+ * next() moves past the current element as a whole, so nested elements that are not
+ * interesting are skipped without being looked at.  children() gives a reader over the
+ * elements nested in the current one.
+ */
+class TlvReader
+{
+public:
+  /// @brief Error that is thrown when an element is truncated or has invalid type
+  struct Error : public Tlv::Error { Error(const std::string &what) : Tlv::Error(what) {} };
+
+  /**
+   * @brief Create a reader over an empty range
+   */
+  inline
+  TlvReader();
+
+  /**
+   * @brief Create a reader over the elements in [begin, end)
+   */
+  inline
+  TlvReader(const uint8_t *begin, const uint8_t *end);
+
+  /**
+   * @brief Create a reader over the elements nested in the value of block
+   */
+  inline explicit
+  TlvReader(const Block &block);
+
+  /**
+   * @brief Move to the next element (the first one on the first call)
+   *
+   * @return false if there are no more elements
+   * @throws Error if the element type or length cannot be read, or value exceeds the range
+   */
+  inline bool
+  next();
+
+  /**
+   * @brief Move to the next element of the specified type, skipping all others
+   *
+   * @return false if there are no more elements of that type
+   */
+  inline bool
+  find(uint32_t type);
+
+  /**
+   * @brief Get a reader over the elements nested in the current element
+   */
+  inline TlvReader
+  children() const;
+
+  /**
+   * @brief Get number of elements left, including the current one
+   */
+  inline size_t
+  count() const;
+
+  inline uint32_t
+  type() const;
+
+  /**
+   * @brief Get the first byte of the current element (its type)
+   */
+  inline const uint8_t*
+  wire() const;
+
+  /**
+   * @brief Get size of the current element, including type and length
+   */
+  inline size_t
+  size() const;
+
+  inline const uint8_t*
+  value() const;
+
+  inline const uint8_t*
+  value_end() const;
+
+  inline size_t
+  value_size() const;
+
+  /**
+   * @brief Interpret the value of the current element as nonNegativeInteger
+   */
+  inline uint64_t
+  readNonNegativeInteger() const;
+
+private:
+  const uint8_t *m_next;
+  const uint8_t *m_end;
+
+  uint32_t m_type;
+  const uint8_t *m_begin;
+  const uint8_t *m_value_begin;
+  const uint8_t *m_value_end;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+inline
+TlvReader::TlvReader()
+  : m_next(0)
+  , m_end(0)
+  , m_type(std::numeric_limits<uint32_t>::max())
+  , m_begin(0)
+  , m_value_begin(0)
+  , m_value_end(0)
+{
+}
+
+inline
+TlvReader::TlvReader(const uint8_t *begin, const uint8_t *end)
+  : m_next(begin)
+  , m_end(end)
+  , m_type(std::numeric_limits<uint32_t>::max())
+  , m_begin(begin)
+  , m_value_begin(begin)
+  , m_value_end(begin)
+{
+}
+
+inline
+TlvReader::TlvReader(const Block &block)
+  : m_type(std::numeric_limits<uint32_t>::max())
+{
+  m_next = m_end = m_begin = m_value_begin = m_value_end = 0;
+  if (block.hasValue() && block.value_size() > 0)
+    {
+      m_next = m_begin = m_value_begin = m_value_end = block.value();
+      m_end = m_next + block.value_size();
+    }
+}
+
+inline bool
+TlvReader::next()
+{
+  if (m_next == m_end)
+    return false;
+
+  const uint8_t *begin = m_next;
+  uint32_t type;
+  uint64_t length;
+  if (!Tlv::readType(begin, m_end, type))
+    throw Error("Cannot read TLV type");
+  if (!Tlv::readVarNumber(begin, m_end, length))
+    throw Error("Cannot read TLV length");
+  if (length > static_cast<uint64_t>(m_end - begin))
+    throw Error("TLV length exceeds buffer length");
+
+  m_type = type;
+  m_begin = m_next;
+  m_value_begin = begin;
+  m_value_end = begin + length;
+  m_next = m_value_end;
+  return true;
+}
+
+inline bool
+TlvReader::find(uint32_t type)
+{
+  while (next())
+    {
+      if (m_type == type)
+        return true;
+    }
+  return false;
+}
+
+inline TlvReader
+TlvReader::children() const
+{
+  return TlvReader(m_value_begin, m_value_end);
+}
+
+inline size_t
+TlvReader::count() const
+{
+  TlvReader i(m_begin, m_end);
+  size_t n = 0;
+  while (i.next())
+    ++n;
+  return n;
+}
+
+inline uint32_t
+TlvReader::type() const
+{
+  return m_type;
+}
+
+inline const uint8_t*
+TlvReader::wire() const
+{
+  return m_begin;
+}
+
+inline size_t
+TlvReader::size() const
+{
+  return m_value_end - m_begin;
+}
+
+inline const uint8_t*
+TlvReader::value() const
+{
+  return m_value_begin;
+}
+
+inline const uint8_t*
+TlvReader::value_end() const
+{
+  return m_value_end;
+}
+
+inline size_t
+TlvReader::value_size() const
+{
+  return m_value_end - m_value_begin;
+}
+
+inline uint64_t
+TlvReader::readNonNegativeInteger() const
+{
+  const uint8_t *begin = m_value_begin;
+  return Tlv::readNonNegativeInteger(value_size(), begin, m_value_end);
+}
+
+} // namespace ndn
+
+#endif // NDN_TLV_READER_HPP
@@ -0,0 +1,443 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef NDN_TLV_SCHEMA_HPP
+#define NDN_TLV_SCHEMA_HPP
+
+#include <ndn-cpp/common.hpp>
+
+#include <boost/lexical_cast.hpp>
+
+#include "tlv-reader.hpp"
+
+namespace ndn {
+
+/**
+ * @brief Occurrence of a field in TlvSchema
+ */
+enum TlvOccurrence {
+  TLV_OPTIONAL = 0,
+  TLV_REQUIRED = 1
+};
+
+/**
+ * @brief Description of one field of TlvSchema: TLV type, occurrence and the codec of the field
+ *
+ * A codec is a class with static methods that move the field between the packet and the wire:
+ *
+ * <code>
+ *     // element is the field in the wire of parent, slices of parent can be taken with Block::slice
+ *     static void decode(Packet &packet, const Block &parent, const TlvReader &element);
+ *
+ *     // the field is absent in the decoded wire (called only for TLV_OPTIONAL fields)
+ *     static void reset(Packet &packet);
+ *
+ *     // whether the field should be encoded (called only for TLV_OPTIONAL fields)
+ *     static bool isPresent(const Packet &packet);
+ *
+ *     // prepend the whole element (type, length and value), return number of bytes prepended
+ *     template<bool T>
+ *     static size_t encode(EncodingImpl<T> &block, uint32_t type, const Packet &packet);
+ * </code>
+ */
+template<uint32_t TYPE, TlvOccurrence OCCURRENCE, class Codec>
+struct TlvField
+{
+  static const uint32_t type = TYPE;
+  static const TlvOccurrence occurrence = OCCURRENCE;
+  typedef Codec codec;
+};
+
+template<uint32_t TYPE, TlvOccurrence OCCURRENCE, class Codec>
+const uint32_t TlvField<TYPE, OCCURRENCE, Codec>::type;
+
+template<uint32_t TYPE, TlvOccurrence OCCURRENCE, class Codec>
+const TlvOccurrence TlvField<TYPE, OCCURRENCE, Codec>::occurrence;
+
+/**
+ * @brief Placeholder for unused fields of TlvSchema
+ */
+struct TlvSchemaEnd
+{
+};
+
+/**
+ * @brief Layout of the elements nested in a TLV element, in the order they appear on the wire
+ *
+ * <code>
+ *     class MetaInfo::Schema : public TlvSchema<MetaInfo,
+ *       TlvField<Tlv::ContentType,     TLV_OPTIONAL, TlvNonNegativeInteger<MetaInfo, uint32_t, &MetaInfo::type_, TYPE_DEFAULT> >,
+ *       TlvField<Tlv::FreshnessPeriod, TLV_OPTIONAL, TlvNonNegativeInteger<MetaInfo, Milliseconds, &MetaInfo::freshnessPeriod_> >
+ *       >
+ *     {
+ *     };
+ * </code>
+ *
+ * The decoder and the encoder are generated from this description at compile time:
+ *
+ * - decode() walks the elements once with TlvReader and hands each one to the codec of its field.
+ *   Elements of types that are not in the schema are skipped.  An element of a known type that is
+ *   out of order or repeated, or a missing TLV_REQUIRED field, is an error.
+ *
+ * - encode() prepends the fields in reverse order, so it works with both EncodingEstimator (to
+ *   compute the size of the value in advance) and EncodingBuffer.
+ *
+ * Up to 8 fields can be described, unused slots are TlvSchemaEnd.
+ */
+template<class Packet,
+         class F1 = TlvSchemaEnd, class F2 = TlvSchemaEnd, class F3 = TlvSchemaEnd, class F4 = TlvSchemaEnd,
+         class F5 = TlvSchemaEnd, class F6 = TlvSchemaEnd, class F7 = TlvSchemaEnd, class F8 = TlvSchemaEnd>
+class TlvSchema
+{
+public:
+  typedef TlvSchema<Packet, F2, F3, F4, F5, F6, F7, F8> Rest;
+
+  /**
+   * @brief Decode the elements nested in the value of wire into packet
+   *
+   * @throws Tlv::Error if the elements do not follow the schema or cannot be read
+   */
+  static void
+  decode(Packet &packet, const Block &wire)
+  {
+    TlvReader reader(wire);
+    decode(packet, wire, reader);
+  }
+
+  /**
+   * @brief Decode the elements of the reader (which walks inside the wire of parent) into packet
+   */
+  static void
+  decode(Packet &packet, const Block &parent, TlvReader &reader)
+  {
+    bool hasElement = reader.next();
+    decodeFields<TlvSchema>(packet, parent, reader, hasElement);
+  }
+
+  /**
+   * @brief Prepend the fields of packet, or estimate their size
+   *
+   * @return number of bytes prepended (the length of the enclosing element)
+   */
+  template<bool T>
+  static size_t
+  encode(EncodingImpl<T> &block, const Packet &packet)
+  {
+    size_t totalLength = Rest::encode(block, packet);
+    totalLength += encodeField(block, packet, static_cast<Occurrence<F1::occurrence>*>(0));
+    return totalLength;
+  }
+
+  /**
+   * @brief Reset all fields of packet as if they were absent in the wire
+   */
+  static void
+  reset(Packet &packet)
+  {
+    F1::codec::reset(packet);
+    Rest::reset(packet);
+  }
+
+  /**
+   * @brief Check if the type is the TLV type of one of the fields
+   */
+  static bool
+  contains(uint32_t type)
+  {
+    return type == F1::type || Rest::contains(type);
+  }
+
+  /**
+   * @brief Decode the fields starting with F1 (used by decode())
+   *
+   * @param hasElement whether the reader is at an element that is not decoded yet
+   */
+  template<class Schema>
+  static void
+  decodeFields(Packet &packet, const Block &parent, TlvReader &reader, bool &hasElement)
+  {
+    while (hasElement && !Schema::contains(reader.type()))
+      hasElement = reader.next();
+
+    if (hasElement && reader.type() == F1::type)
+      {
+        F1::codec::decode(packet, parent, reader);
+        hasElement = reader.next();
+      }
+    else if (F1::occurrence == TLV_REQUIRED)
+      {
+        throw Tlv::Error("Required TLV element [" + boost::lexical_cast<std::string>(F1::type) + "] is missing");
+      }
+    else
+      {
+        resetField(packet, static_cast<Occurrence<F1::occurrence>*>(0));
+      }
+
+    Rest::template decodeFields<Schema>(packet, parent, reader, hasElement);
+  }
+
+private:
+  template<TlvOccurrence OCCURRENCE>
+  struct Occurrence
+  {
+  };
+
+  template<bool T>
+  static size_t
+  encodeField(EncodingImpl<T> &block, const Packet &packet, Occurrence<TLV_REQUIRED>*)
+  {
+    return F1::codec::encode(block, F1::type, packet);
+  }
+
+  template<bool T>
+  static size_t
+  encodeField(EncodingImpl<T> &block, const Packet &packet, Occurrence<TLV_OPTIONAL>*)
+  {
+    if (!F1::codec::isPresent(packet))
+      return 0;
+
+    return F1::codec::encode(block, F1::type, packet);
+  }
+
+  static void
+  resetField(Packet &packet, Occurrence<TLV_REQUIRED>*)
+  {
+  }
+
+  static void
+  resetField(Packet &packet, Occurrence<TLV_OPTIONAL>*)
+  {
+    F1::codec::reset(packet);
+  }
+};
+
+/**
+ * @brief End of the fields of TlvSchema
+ */
+template<class Packet>
+class TlvSchema<Packet,
+                TlvSchemaEnd, TlvSchemaEnd, TlvSchemaEnd, TlvSchemaEnd,
+                TlvSchemaEnd, TlvSchemaEnd, TlvSchemaEnd, TlvSchemaEnd>
+{
+public:
+  template<bool T>
+  static size_t
+  encode(EncodingImpl<T> &block, const Packet &packet)
+  {
+    return 0;
+  }
+
+  static void
+  reset(Packet &packet)
+  {
+  }
+
+  static bool
+  contains(uint32_t type)
+  {
+    return false;
+  }
+
+  template<class Schema>
+  static void
+  decodeFields(Packet &packet, const Block &parent, TlvReader &reader, bool &hasElement)
+  {
+    while (hasElement && !Schema::contains(reader.type()))
+      hasElement = reader.next();
+
+    if (hasElement)
+      throw Tlv::Error("TLV element [" + boost::lexical_cast<std::string>(reader.type()) +
+                       "] is out of order or repeated");
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Codecs of the common field types
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Codec of a nonNegativeInteger field stored in the member of packet
+ *
+ * The field is encoded only if the value is not negative and differs from DEFAULT, and it gets
+ * DEFAULT when it is absent in the wire.
+ */
+template<class Packet, class Value, Value Packet::*member, int64_t DEFAULT = -1>
+struct TlvNonNegativeInteger
+{
+  static void
+  decode(Packet &packet, const Block &parent, const TlvReader &element)
+  {
+    packet.*member = static_cast<Value>(element.readNonNegativeInteger());
+  }
+
+  static void
+  reset(Packet &packet)
+  {
+    packet.*member = static_cast<Value>(DEFAULT);
+  }
+
+  static bool
+  isPresent(const Packet &packet)
+  {
+    return static_cast<int64_t>(packet.*member) >= 0 &&
+           static_cast<int64_t>(packet.*member) != DEFAULT;
+  }
+
+  template<bool T>
+  static size_t
+  encode(EncodingImpl<T> &block, uint32_t type, const Packet &packet)
+  {
+    return prependNonNegativeIntegerBlock(block, type, packet.*member);
+  }
+};
+
+/**
+ * @brief Codec of a field without value that is stored as bool in the member of packet
+ */
+template<class Packet, bool Packet::*member>
+struct TlvBoolean
+{
+  static void
+  decode(Packet &packet, const Block &parent, const TlvReader &element)
+  {
+    packet.*member = true;
+  }
+
+  static void
+  reset(Packet &packet)
+  {
+    packet.*member = false;
+  }
+
+  static bool
+  isPresent(const Packet &packet)
+  {
+    return packet.*member;
+  }
+
+  template<bool T>
+  static size_t
+  encode(EncodingImpl<T> &block, uint32_t type, const Packet &packet)
+  {
+    return prependBooleanBlock(block, type);
+  }
+};
+
+/**
+ * @brief Codec of a field that is stored as Block in the member of packet (e.g., Content)
+ *
+ * The Block is a slice of the wire of packet, and is encoded as is
+ */
+template<class Packet, Block Packet::*member>
+struct TlvBlock
+{
+  static void
+  decode(Packet &packet, const Block &parent, const TlvReader &element)
+  {
+    packet.*member = parent.slice(element.wire(), element.size());
+  }
+
+  static void
+  reset(Packet &packet)
+  {
+    packet.*member = Block();
+  }
+
+  static bool
+  isPresent(const Packet &packet)
+  {
+    return (packet.*member).hasWire() || (packet.*member).hasValue();
+  }
+
+  template<bool T>
+  static size_t
+  encode(EncodingImpl<T> &block, uint32_t type, const Packet &packet)
+  {
+    return prependBlock(block, packet.*member);
+  }
+};
+
+/**
+ * @brief Codec of a field that is stored in the member of packet as an object with its own
+ *        wireDecode(const Block&) and wireEncode(EncodingImpl<T>&) (e.g., Name, MetaInfo)
+ *
+ * The field is encoded if it is not empty()
+ */
+template<class Packet, class Value, Value Packet::*member>
+struct TlvNested
+{
+  static void
+  decode(Packet &packet, const Block &parent, const TlvReader &element)
+  {
+    (packet.*member).wireDecode(parent.slice(element.wire(), element.size()));
+  }
+
+  static void
+  reset(Packet &packet)
+  {
+    packet.*member = Value();
+  }
+
+  static bool
+  isPresent(const Packet &packet)
+  {
+    return !(packet.*member).empty();
+  }
+
+  template<bool T>
+  static size_t
+  encode(EncodingImpl<T> &block, uint32_t type, const Packet &packet)
+  {
+    return (packet.*member).wireEncode(block);
+  }
+};
+
+/**
+ * @brief Codec of a field whose value is a group of fields of packet itself (e.g., Selectors),
+ *        described by another TlvSchema
+ *
+ * The field is omitted when none of the nested fields is encoded
+ */
+template<class Packet, class Schema>
+struct TlvGroup
+{
+  static void
+  decode(Packet &packet, const Block &parent, const TlvReader &element)
+  {
+    TlvReader reader = element.children();
+    Schema::decode(packet, parent, reader);
+  }
+
+  static void
+  reset(Packet &packet)
+  {
+    Schema::reset(packet);
+  }
+
+  static bool
+  isPresent(const Packet &packet)
+  {
+    return true;
+  }
+
+  template<bool T>
+  static size_t
+  encode(EncodingImpl<T> &block, uint32_t type, const Packet &packet)
+  {
+    size_t totalLength = Schema::encode(block, packet);
+    if (totalLength == 0)
+      return 0;
+
+    totalLength += block.prependVarNumber(totalLength);
+    totalLength += block.prependVarNumber(type);
+    return totalLength;
+  }
+};
+
+} // namespace ndn
+
+#endif // NDN_TLV_SCHEMA_HPP
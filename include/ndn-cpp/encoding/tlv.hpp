@@ -11,6 +11,7 @@
 #define NDN_TLV_HPP
 
 #include <stdexcept>
+#include <string.h>
 #include "buffer.hpp"
 #include "endian.h"
 
@@ -75,6 +76,18 @@ template<class InputIterator>
 inline uint64_t
 readVarNumber(InputIterator &begin, const InputIterator &end);
 
+/**
+ * @brief Read VAR-NUMBER in NDN-TLV encoding without throwing
+ *
+ * @return true if number was read; false if [begin, end) does not contain a complete VAR-NUMBER,
+ *         in which case begin is not changed
+ *
+ * Note that after call finished successfully, begin will point to the first byte after the read VAR-NUMBER
+ */
+template<class InputIterator>
+inline bool
+readVarNumber(InputIterator &begin, const InputIterator &end, uint64_t &number);
+
 /**
  * @brief Read TLV Type
  *
@@ -85,6 +98,16 @@ template<class InputIterator>
 inline uint32_t
 readType(InputIterator &begin, const InputIterator &end);
 
+/**
+ * @brief Read TLV Type without throwing
+ *
+ * @return false if [begin, end) does not contain a complete VAR-NUMBER or its value is larger
+ *         than 2^32-1, in which case begin is not changed
+ */
+template<class InputIterator>
+inline bool
+readType(InputIterator &begin, const InputIterator &end, uint32_t &type);
+
 /**
  * @brief Get number of bytes necessary to hold value of VAR-NUMBER
  */
@@ -97,6 +120,12 @@ sizeOfVarNumber(uint64_t varNumber);
 inline size_t
 writeVarNumber(std::ostream &os, uint64_t varNumber);
 
+/**
+ * @brief Write VAR-NUMBER to the specified memory, which must have room for sizeOfVarNumber(varNumber) bytes
+ */
+inline size_t
+writeVarNumber(uint8_t *buffer, uint64_t varNumber);
+
 /**
  * @brief Read nonNegativeInteger in NDN-TLV encoding
  *
@@ -176,6 +205,49 @@ readVarNumber(InputIterator &begin, const InputIterator &end)
     }
 }
 
+template<class InputIterator>
+inline bool
+readVarNumber(InputIterator &begin, const InputIterator &end, uint64_t &number)
+{
+  if (begin == end)
+    return false;
+
+  uint8_t firstOctet = *begin;
+  if (firstOctet < 253)
+    {
+      number = firstOctet;
+      ++begin;
+      return true;
+    }
+
+  size_t size = (firstOctet == 253) ? 2 : ((firstOctet == 254) ? 4 : 8);
+  if (end - begin < static_cast<ptrdiff_t>(size + 1))
+    return false;
+
+  InputIterator i = begin;
+  ++i;
+  number = 0;
+  for (size_t k = 0; k < size; ++k, ++i)
+    number = (number << 8) | static_cast<uint8_t>(*i);
+
+  begin = i;
+  return true;
+}
+
+template<class InputIterator>
+inline bool
+readType(InputIterator &begin, const InputIterator &end, uint32_t &type)
+{
+  InputIterator i = begin;
+  uint64_t number;
+  if (!readVarNumber(i, end, number) || number > std::numeric_limits<uint32_t>::max())
+    return false;
+
+  type = static_cast<uint32_t>(number);
+  begin = i;
+  return true;
+}
+
 template<class InputIterator>
 inline uint32_t
 readType(InputIterator &begin, const InputIterator &end)
@@ -233,6 +305,33 @@ writeVarNumber(std::ostream &os, uint64_t varNumber)
   }
 }
 
+inline size_t
+writeVarNumber(uint8_t *buffer, uint64_t varNumber)
+{
+  if (varNumber < 253) {
+    buffer[0] = static_cast<uint8_t> (varNumber);
+    return 1;
+  }
+  else if (varNumber <= std::numeric_limits<uint16_t>::max()) {
+    buffer[0] = 253;
+    uint16_t value = htobe16(static_cast<uint16_t> (varNumber));
+    memcpy(buffer + 1, &value, 2);
+    return 3;
+  }
+  else if (varNumber <= std::numeric_limits<uint32_t>::max()) {
+    buffer[0] = 254;
+    uint32_t value = htobe32(static_cast<uint32_t> (varNumber));
+    memcpy(buffer + 1, &value, 4);
+    return 5;
+  }
+  else {
+    buffer[0] = 255;
+    uint64_t value = htobe64(varNumber);
+    memcpy(buffer + 1, &value, 8);
+    return 9;
+  }
+}
+
 template<class InputIterator>
 inline uint64_t
 readNonNegativeInteger(size_t size, InputIterator &begin, const InputIterator &end)
@@ -13,25 +13,40 @@
 
 #include "name.hpp"
 
-#include <map>
+#include <iterator>
+#include <vector>
 
 namespace ndn {
 
 /**
  * @brief Class to represent Exclude component in NDN interests
+ *
+ * The terms are kept in a vector sorted in the NDN canonical order of their components.  A term
+ * holds the first 16 bytes of its component value, which is the whole value for most components,
+ * and the longer values are packed one after another in a single buffer, so that the filter takes
+ * at most two allocations however many terms it has.  isExcluded() is a binary search over the
+ * vector which compares the first bytes as two numbers.  A term with an empty component and the
+ * ANY flag stands for a leading ANY.
+ *
+ * A filter decoded by wireDecode() with at most MAX_TERMS_IN_WIRE terms in the canonical order,
+ * as most filters of Interests are, only keeps the wire encoding: the const methods read the
+ * encoded terms in place, without allocating, and the terms are decoded into the vector only when
+ * the filter is changed.  The const methods thus never change the filter.  Reading in place takes
+ * time linear in the number of terms, so larger filters are decoded by wireDecode() itself.
  */
 class Exclude
 {
 public:
   struct Error : public std::runtime_error { Error(const std::string &what) : std::runtime_error(what) {} };
 
-  
-  typedef std::map< Name::Component, bool /*any*/, std::greater<Name::Component> > exclude_type;
+  template<bool IS_ASCENDING>
+  class Iterator;
 
-  typedef exclude_type::iterator iterator;
-  typedef exclude_type::const_iterator const_iterator;
-  typedef exclude_type::reverse_iterator reverse_iterator;
-  typedef exclude_type::const_reverse_iterator const_reverse_iterator;
+  /// @brief Iterates over the terms from the last one in the canonical order to the first one
+  typedef Iterator<false> const_iterator;
+  typedef Iterator<true> const_reverse_iterator;
+  typedef const_iterator iterator;
+  typedef const_reverse_iterator reverse_iterator;
 
   /**
    * @brief Default constructor an empty exclude
@@ -45,6 +60,14 @@ public:
   bool
   isExcluded (const Name::Component &comp) const;
 
+  /**
+   * @brief Check if name component with the value is excluded, without creating a Name::Component
+   * @param value pointer to the value of the component
+   * @param valueSize size of the value
+   */
+  bool
+  isExcluded (const uint8_t *value, size_t valueSize) const;
+
   /**
    * @brief Exclude specific name component
    * @param comp component to exclude
@@ -53,6 +76,13 @@ public:
   Exclude &
   excludeOne (const Name::Component &comp);
 
+  /**
+   * @brief Exclude the name component with the value, without creating a Name::Component
+   * @returns *this to allow chaining
+   */
+  Exclude &
+  excludeOne (const uint8_t *value, size_t valueSize);
+
   /**
    * @brief Exclude components from range [from, to]
    * @param from first element of the range
@@ -62,12 +92,20 @@ public:
   Exclude &
   excludeRange (const Name::Component &from, const Name::Component &to);
 
+  /**
+   * @brief Exclude the components from range [from, to] given by their values
+   * @returns *this to allow chaining
+   */
+  Exclude &
+  excludeRange (const uint8_t *fromValue, size_t fromValueSize,
+                const uint8_t *toValue, size_t toValueSize);
+
   /**
    * @brief Exclude all components from range [/, to]
    * @param to last element of the range
    * @returns *this to allow chaining
    */
-  inline Exclude &
+  Exclude &
   excludeBefore (const Name::Component &to);
 
   /**
@@ -87,9 +125,25 @@ public:
    *
    * If there is an error with ranges (e.g., order of components is wrong) an exception is thrown
    */
-  inline void
+  void
   appendExclude (const Name::Component &name, bool any);
 
+  /**
+   * @brief Append the exclude element with the component value, see appendExclude(const Name::Component&, bool)
+   *
+   * Appending components in the canonical order takes constant time.  An empty value with any set
+   * is a leading ANY.
+   */
+  void
+  appendExclude (const uint8_t *value, size_t valueSize, bool any);
+
+  /**
+   * @brief Reserve room for nTerms terms and nValueBytes bytes of component values, so that
+   *        building the filter does not allocate for each term
+   */
+  void
+  reserve (size_t nTerms, size_t nValueBytes);
+
   /**
    * @brief Check if exclude filter is empty
    */
@@ -99,7 +153,7 @@ public:
   /**
    * @brief Clear the exclude filter
    */
-  inline void
+  void
   clear();
   
   /**
@@ -108,6 +162,26 @@ public:
   inline size_t
   size () const;
 
+  /**
+   * @brief Get the value of the component of term i, counting in the canonical order (the wire order)
+   *
+   * The value is valid until the filter is changed.
+   */
+  inline const uint8_t*
+  getComponentValue (size_t i) const;
+
+  /**
+   * @brief Get the size of the value of the component of term i, 0 for a leading ANY
+   */
+  inline size_t
+  getComponentValueSize (size_t i) const;
+
+  /**
+   * @brief Check if the components after the component of term i, up to the next term, are excluded
+   */
+  inline bool
+  hasAnyAfter (size_t i) const;
+
   /**
    * @brief Get begin iterator of the exclude terms
    */
@@ -144,80 +218,291 @@ public:
    */
   const Block&
   wireEncode() const;
+
+  /**
+   * @brief Prepend the wire encoding to the encoder, or estimate its size
+   *
+   * The cached wire encoding, if any, is copied as is
+   * @return number of bytes prepended
+   */
+  template<bool T>
+  size_t
+  wireEncode(EncodingImpl<T> &block) const;
   
   /**
    * Decode the input using a particular wire format and update this Interest.
    * @param input The input byte array to be decoded.
+   *
+   * Only the format and the order of the terms are checked here if there are at most
+   * MAX_TERMS_IN_WIRE terms in the canonical order, as any encoder writes them: they are then read
+   * in place until the filter is changed.
    */
   void 
   wireDecode(const Block &wire);
   
 private:
-  Exclude &
-  excludeRange (iterator fromLowerBound, iterator toLowerBound);
+  static const size_t PREFIX_SIZE = 16;
+  /// @brief The most terms of a decoded filter which are read in place rather than decoded
+  static const size_t MAX_TERMS_IN_WIRE = 8;
+
+  struct Term
+  {
+    /// @brief the value if it fits, else its first bytes; padded with zeros
+    uint8_t prefix[PREFIX_SIZE];
+    size_t offset; ///< @brief offset of the value in m_values if it does not fit in prefix
+    size_t size;
+    bool any;
+  };
+
+  /**
+   * @brief The first PREFIX_SIZE bytes of a value, padded with zeros, as a big-endian number,
+   *        which decides most comparisons with values of the same size without reading the bytes
+   */
+  struct PrefixKey
+  {
+    uint64_t high;
+    uint64_t low;
+  };
+
+  static PrefixKey
+  getPrefixKey (const uint8_t *value, size_t valueSize);
+
+  /**
+   * @brief Compare the component of term i with the value in the NDN canonical order
+   * @param prefixKey getPrefixKey() of the value
+   */
+  int
+  compareTerm (size_t i, const uint8_t *value, size_t valueSize, const PrefixKey &prefixKey) const;
+
+  /**
+   * @brief Get the number of terms whose component is not greater than the value
+   * @param isEqual Set to whether the last of those terms has the value.
+   */
+  size_t
+  findUpperBound (const uint8_t *value, size_t valueSize, bool &isEqual) const;
+
+  void
+  insertTerm (size_t i, const uint8_t *value, size_t valueSize, bool any);
+
+  void
+  eraseTerms (size_t iBegin, size_t iEnd);
+
+  /**
+   * @brief Make sure that a term with the ANY flag starts at or before the value, adding one if needed
+   * @return the index of that term
+   */
+  size_t
+  setRangeStart (const uint8_t *value, size_t valueSize);
+
+  /**
+   * @brief Make the terms from wire_, which must be a filter checked by wireDecode()
+   */
+  void
+  decodeTerms ();
+
+  /**
+   * @brief isExcluded() on the terms in wire_, which are in the canonical order
+   */
+  bool
+  isExcludedInWire (const uint8_t *value, size_t valueSize) const;
+
+  /**
+   * @brief Get the number of terms in wire_
+   */
+  size_t
+  countTermsInWire () const;
+
+  /**
+   * @brief Read term i of wire_; the value of a leading ANY is 0 with size 0
+   */
+  void
+  readTermInWire (size_t i, const uint8_t *&value, size_t &valueSize, bool &any) const;
 
 private:
-  exclude_type m_exclude;
+  std::vector<Term> m_terms;
+  std::vector<uint8_t> m_values; ///< @brief the values which do not fit in Term::prefix
+  size_t m_nUnusedBytes; ///< @brief bytes in m_values no longer used by a term
+  /// @brief false if the terms are only in wire_, see decodeTerms()
+  bool m_hasTerms;
 
   mutable Block wire_;
 };
 
+/**
+ * @brief Iterator over the terms of an Exclude, which makes a Name::Component for each term it visits
+ *
+ * Use Exclude::getComponentValue() and the related methods to go through the terms without
+ * allocating.
+ */
+template<bool IS_ASCENDING>
+class Exclude::Iterator
+{
+public:
+  typedef std::bidirectional_iterator_tag iterator_category;
+  typedef std::pair<Name::Component, bool /*any*/> value_type;
+  typedef ptrdiff_t difference_type;
+  typedef const value_type* pointer;
+  typedef const value_type& reference;
+
+  Iterator ()
+    : m_exclude (0)
+    , m_position (0)
+  {
+  }
+
+  Iterator (const Exclude *exclude, size_t position)
+    : m_exclude (exclude)
+    , m_position (position)
+  {
+  }
+
+  const value_type&
+  operator* () const
+  {
+    size_t i = IS_ASCENDING ? m_position : m_exclude->size () - 1 - m_position;
+    m_value.first = Name::Component (m_exclude->getComponentValue (i), m_exclude->getComponentValueSize (i));
+    m_value.second = m_exclude->hasAnyAfter (i);
+    return m_value;
+  }
+
+  const value_type*
+  operator-> () const
+  {
+    return &**this;
+  }
+
+  Iterator&
+  operator++ ()
+  {
+    ++m_position;
+    return *this;
+  }
+
+  Iterator
+  operator++ (int)
+  {
+    Iterator result (*this);
+    ++m_position;
+    return result;
+  }
+
+  Iterator&
+  operator-- ()
+  {
+    --m_position;
+    return *this;
+  }
+
+  Iterator
+  operator-- (int)
+  {
+    Iterator result (*this);
+    --m_position;
+    return result;
+  }
+
+  bool
+  operator== (const Iterator &other) const
+  {
+    return m_position == other.m_position;
+  }
+
+  bool
+  operator!= (const Iterator &other) const
+  {
+    return m_position != other.m_position;
+  }
+
+private:
+  const Exclude *m_exclude;
+  size_t m_position;
+  mutable value_type m_value;
+};
+
 std::ostream&
 operator << (std::ostream &os, const Exclude &name);
 
-inline Exclude &
-Exclude::excludeBefore (const Name::Component &to)
+inline bool
+Exclude::empty () const
 {
-  return excludeRange (Name::Component (), to);
+  if (!m_hasTerms)
+    return wire_.value_size () == 0;
+  return m_terms.empty ();
 }
 
-inline void
-Exclude::appendExclude (const Name::Component &name, bool any)
+inline size_t
+Exclude::size () const
 {
-  m_exclude[name] = any;
+  if (!m_hasTerms)
+    return countTermsInWire ();
+  return m_terms.size ();
 }
 
-inline bool
-Exclude::empty () const
+inline const uint8_t*
+Exclude::getComponentValue (size_t i) const
 {
-  return m_exclude.empty ();
+  if (!m_hasTerms)
+    {
+      const uint8_t *value;
+      size_t valueSize;
+      bool any;
+      readTermInWire (i, value, valueSize, any);
+      return value;
+    }
+  const Term &term = m_terms[i];
+  return term.size <= PREFIX_SIZE ? term.prefix : &m_values[term.offset];
 }
 
-inline void
-Exclude::clear ()
+inline size_t
+Exclude::getComponentValueSize (size_t i) const
 {
-  m_exclude.clear ();
+  if (!m_hasTerms)
+    {
+      const uint8_t *value;
+      size_t valueSize;
+      bool any;
+      readTermInWire (i, value, valueSize, any);
+      return valueSize;
+    }
+  return m_terms[i].size;
 }
 
-
-inline size_t
-Exclude::size () const
+inline bool
+Exclude::hasAnyAfter (size_t i) const
 {
-  return m_exclude.size ();
+  if (!m_hasTerms)
+    {
+      const uint8_t *value;
+      size_t valueSize;
+      bool any;
+      readTermInWire (i, value, valueSize, any);
+      return any;
+    }
+  return m_terms[i].any;
 }
 
 inline Exclude::const_iterator
 Exclude::begin () const
 {
-  return m_exclude.begin ();
+  return const_iterator (this, 0);
 }
 
 inline Exclude::const_iterator
 Exclude::end () const
 {
-  return m_exclude.end ();
+  return const_iterator (this, size ());
 }
 
 inline Exclude::const_reverse_iterator
 Exclude::rbegin () const
 {
-  return m_exclude.rbegin ();
+  return const_reverse_iterator (this, 0);
 }
 
 inline Exclude::const_reverse_iterator
 Exclude::rend () const
 {
-  return m_exclude.rend ();
+  return const_reverse_iterator (this, size ());
 }
 
 inline std::string
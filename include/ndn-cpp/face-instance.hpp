@@ -105,6 +105,14 @@ public:
   // Wire
   inline const Block&
   wireEncode() const;
+
+  /**
+   * @brief Prepend the wire encoding to the encoder, or estimate its size
+   * @return number of bytes prepended
+   */
+  template<bool T>
+  inline size_t
+  wireEncode(EncodingImpl<T> &block) const;
   
   inline void 
   wireDecode(const Block &wire);
@@ -122,11 +130,11 @@ private:
   mutable Block wire_;
 };
 
-inline const Block&
-FaceInstance::wireEncode() const
+template<bool T>
+inline size_t
+FaceInstance::wireEncode(EncodingImpl<T> &block) const
 {
-  if (wire_.hasWire())
-    return wire_;
+  size_t totalLength = 0;
 
   // FaceInstance ::= FACE-INSTANCE-TYPE TLV-LENGTH
   //                  Action?
@@ -137,69 +145,83 @@ FaceInstance::wireEncode() const
   //                  MulticastInterface?
   //                  MulticastTTL?
   //                  FreshnessPeriod?
-  
-  wire_ = Block(Tlv::FaceManagement::FaceInstance);
+  //
+  // (reverse encoding)
 
-  // Action
-  if (!action_.empty())
+  // FreshnessPeriod
+  if (freshnessPeriod_ >= 0)
     {
-      wire_.push_back
-        (dataBlock(Tlv::FaceManagement::Action, action_.c_str(), action_.size()));
+      totalLength += prependNonNegativeIntegerBlock(block, Tlv::FreshnessPeriod, freshnessPeriod_);
     }
 
-  // FaceID
-  if (faceId_ >= 0)
+  // MulticastTTL
+  if (multicastTtl_ >= 0)
     {
-      wire_.push_back
-        (nonNegativeIntegerBlock(Tlv::FaceManagement::FaceID, faceId_));
+      totalLength += prependNonNegativeIntegerBlock(block, Tlv::FaceManagement::MulticastTTL, multicastTtl_);
     }
 
-  // IPProto
-  if (ipProto_ >= 0)
-    {
-      wire_.push_back
-        (nonNegativeIntegerBlock(Tlv::FaceManagement::IPProto, ipProto_));
-    }
-  
-  // Host
-  if (!host_.empty())
+  // MulticastInterface
+  if (!multicastInterface_.empty())
     {
-      wire_.push_back
-        (dataBlock(Tlv::FaceManagement::Host, host_.c_str(), host_.size()));
+      totalLength += prependByteArrayBlock(block, Tlv::FaceManagement::MulticastInterface,
+                                           reinterpret_cast<const uint8_t*>(multicastInterface_.c_str()),
+                                           multicastInterface_.size());
     }
 
   // Port
   if (!port_.empty())
     {
-      wire_.push_back
-        (dataBlock(Tlv::FaceManagement::Port, port_.c_str(), port_.size()));
+      totalLength += prependByteArrayBlock(block, Tlv::FaceManagement::Port,
+                                           reinterpret_cast<const uint8_t*>(port_.c_str()), port_.size());
     }
 
-  // MulticastInterface
-  if (!multicastInterface_.empty())
+  // Host
+  if (!host_.empty())
     {
-      wire_.push_back
-        (dataBlock(Tlv::FaceManagement::MulticastInterface, multicastInterface_.c_str(), multicastInterface_.size()));
+      totalLength += prependByteArrayBlock(block, Tlv::FaceManagement::Host,
+                                           reinterpret_cast<const uint8_t*>(host_.c_str()), host_.size());
     }
 
-  // MulticastTTL
-  if (multicastTtl_ >= 0)
+  // IPProto
+  if (ipProto_ >= 0)
     {
-      wire_.push_back
-        (nonNegativeIntegerBlock(Tlv::FaceManagement::MulticastTTL, multicastTtl_));
+      totalLength += prependNonNegativeIntegerBlock(block, Tlv::FaceManagement::IPProto, ipProto_);
     }
 
-  // FreshnessPeriod
-  if (freshnessPeriod_ >= 0)
+  // FaceID
+  if (faceId_ >= 0)
     {
-      wire_.push_back
-        (nonNegativeIntegerBlock(Tlv::FreshnessPeriod, freshnessPeriod_));
+      totalLength += prependNonNegativeIntegerBlock(block, Tlv::FaceManagement::FaceID, faceId_);
     }
-  
-  wire_.encode();
-  return wire_;    
+
+  // Action
+  if (!action_.empty())
+    {
+      totalLength += prependByteArrayBlock(block, Tlv::FaceManagement::Action,
+                                           reinterpret_cast<const uint8_t*>(action_.c_str()), action_.size());
+    }
+
+  totalLength += block.prependVarNumber(totalLength);
+  totalLength += block.prependVarNumber(Tlv::FaceManagement::FaceInstance);
+  return totalLength;
 }
-  
+
+inline const Block&
+FaceInstance::wireEncode() const
+{
+  if (wire_.hasWire())
+    return wire_;
+
+  EncodingEstimator estimator;
+  size_t estimatedSize = wireEncode(estimator);
+
+  EncodingBuffer buffer(estimatedSize, 0);
+  wireEncode(buffer);
+
+  wire_ = buffer.block();
+  return wire_;
+}
+
 inline void 
 FaceInstance::wireDecode(const Block &wire)
 {
@@ -227,56 +249,56 @@ FaceInstance::wireDecode(const Block &wire)
 
   // Action
   Block::element_iterator val = wire_.find(Tlv::FaceManagement::Action);
-  if (val != wire_.getAll().end())
+  if (val != wire_.elements_end())
     {
       action_ = std::string(reinterpret_cast<const char*>(val->value()), val->value_size());
     }
 
   // FaceID
   val = wire_.find(Tlv::FaceManagement::FaceID);
-  if (val != wire_.getAll().end())
+  if (val != wire_.elements_end())
     {
       faceId_ = readNonNegativeInteger(*val);
     }
 
   // IPProto
   val = wire_.find(Tlv::FaceManagement::IPProto);
-  if (val != wire_.getAll().end())
+  if (val != wire_.elements_end())
     {
       ipProto_ = readNonNegativeInteger(*val);
     }
 
   // Host
   val = wire_.find(Tlv::FaceManagement::Host);
-  if (val != wire_.getAll().end())
+  if (val != wire_.elements_end())
     {
       host_ = std::string(reinterpret_cast<const char*>(val->value()), val->value_size());
     }
 
   // Port
   val = wire_.find(Tlv::FaceManagement::Port);
-  if (val != wire_.getAll().end())
+  if (val != wire_.elements_end())
     {
       port_ = std::string(reinterpret_cast<const char*>(val->value()), val->value_size());
     }
 
   // MulticastInterface
   val = wire_.find(Tlv::FaceManagement::MulticastInterface);
-  if (val != wire_.getAll().end())
+  if (val != wire_.elements_end())
     {
       multicastInterface_ = std::string(reinterpret_cast<const char*>(val->value()), val->value_size());
     }
 
   // MulticastTTL
   val = wire_.find(Tlv::FaceManagement::MulticastTTL);
-  if (val != wire_.getAll().end())
+  if (val != wire_.elements_end())
     {
       multicastTtl_ = readNonNegativeInteger(*val);
     }
 
   // FreshnessPeriod
   val = wire_.find(Tlv::FreshnessPeriod);
-  if (val != wire_.getAll().end())
+  if (val != wire_.elements_end())
     {
       freshnessPeriod_ = readNonNegativeInteger(*val);
     }
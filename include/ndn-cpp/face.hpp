@@ -184,6 +184,19 @@ public:
   void 
   shutdown();
   
+  /**
+   * @brief Let any thread call expressInterest, removePendingInterest, setInterestFilter,
+   *        unsetInterestFilter and put, which are then carried out by the thread running
+   *        processEvents
+   *
+   * @see Node::enableThreadSafety
+   */
+  void
+  enableThreadSafety()
+  {
+    node_.enableThreadSafety();
+  }
+  
 private:
   Node node_;
 };
@@ -71,6 +71,14 @@ public:
 
   inline const Block&
   wireEncode() const;
+
+  /**
+   * @brief Prepend the wire encoding to the encoder, or estimate its size
+   * @return number of bytes prepended
+   */
+  template<bool T>
+  inline size_t
+  wireEncode(EncodingImpl<T> &block) const;
   
   inline void 
   wireDecode(const Block &wire);
@@ -85,11 +93,11 @@ private:
   mutable Block wire_;
 };
 
-inline const Block&
-ForwardingEntry::wireEncode() const
+template<bool T>
+inline size_t
+ForwardingEntry::wireEncode(EncodingImpl<T> &block) const
 {
-  if (wire_.hasWire())
-    return wire_;
+  size_t totalLength = 0;
 
   // ForwardingEntry ::= FORWARDING-ENTRY TLV-LENGTH
   //                       Action?
@@ -97,42 +105,55 @@ ForwardingEntry::wireEncode() const
   //                       FaceID?
   //                       ForwardingFlags?
   //                       FreshnessPeriod?
-  
-  wire_ = Block(Tlv::FaceManagement::ForwardingEntry);
+  //
+  // (reverse encoding)
 
-  // Action
-  if (!action_.empty())
+  // FreshnessPeriod
+  if (freshnessPeriod_ >= 0)
     {
-      wire_.push_back
-        (dataBlock(Tlv::FaceManagement::Action, action_.c_str(), action_.size()));
+      totalLength += prependNonNegativeIntegerBlock(block, Tlv::FreshnessPeriod, freshnessPeriod_);
     }
 
-  // Name
-  wire_.push_back
-    (prefix_.wireEncode());
+  // ForwardingFlags
+  totalLength += forwardingFlags_.wireEncode(block);
 
   // FaceID
   if (faceId_ >= 0)
     {
-      wire_.push_back
-        (nonNegativeIntegerBlock(Tlv::FaceManagement::FaceID, faceId_));
+      totalLength += prependNonNegativeIntegerBlock(block, Tlv::FaceManagement::FaceID, faceId_);
     }
 
-  // ForwardingFlags
-  wire_.push_back
-    (forwardingFlags_.wireEncode());
+  // Name
+  totalLength += prefix_.wireEncode(block);
 
-  // FreshnessPeriod
-  if (freshnessPeriod_ >= 0)
+  // Action
+  if (!action_.empty())
     {
-      wire_.push_back
-        (nonNegativeIntegerBlock(Tlv::FreshnessPeriod, freshnessPeriod_));
+      totalLength += prependByteArrayBlock(block, Tlv::FaceManagement::Action,
+                                           reinterpret_cast<const uint8_t*>(action_.c_str()), action_.size());
     }
-  
-  wire_.encode();
-  return wire_;    
+
+  totalLength += block.prependVarNumber(totalLength);
+  totalLength += block.prependVarNumber(Tlv::FaceManagement::ForwardingEntry);
+  return totalLength;
 }
-  
+
+inline const Block&
+ForwardingEntry::wireEncode() const
+{
+  if (wire_.hasWire())
+    return wire_;
+
+  EncodingEstimator estimator;
+  size_t estimatedSize = wireEncode(estimator);
+
+  EncodingBuffer buffer(estimatedSize, 0);
+  wireEncode(buffer);
+
+  wire_ = buffer.block();
+  return wire_;
+}
+
 inline void 
 ForwardingEntry::wireDecode(const Block &wire)
 {
@@ -154,35 +175,35 @@ ForwardingEntry::wireDecode(const Block &wire)
 
   // Action
   Block::element_iterator val = wire_.find(Tlv::FaceManagement::Action);
-  if (val != wire_.getAll().end())
+  if (val != wire_.elements_end())
     {
       action_ = std::string(reinterpret_cast<const char*>(val->value()), val->value_size());
     }
 
   // Name
   val = wire_.find(Tlv::Name);
-  if (val != wire_.getAll().end())
+  if (val != wire_.elements_end())
     {
       prefix_.wireDecode(*val);
     }
 
   // FaceID
   val = wire_.find(Tlv::FaceManagement::FaceID);
-  if (val != wire_.getAll().end())
+  if (val != wire_.elements_end())
     {
       faceId_ = readNonNegativeInteger(*val);
     }
 
   // ForwardingFlags
   val = wire_.find(Tlv::FaceManagement::ForwardingFlags);
-  if (val != wire_.getAll().end())
+  if (val != wire_.elements_end())
     {
       forwardingFlags_.wireDecode(*val);
     }
 
   // FreshnessPeriod
   val = wire_.find(Tlv::FreshnessPeriod);
-  if (val != wire_.getAll().end())
+  if (val != wire_.elements_end())
     {
       freshnessPeriod_ = readNonNegativeInteger(*val);
     }
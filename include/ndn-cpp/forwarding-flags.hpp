@@ -134,6 +134,14 @@ public:
   inline const Block&
   wireEncode() const;
 
+  /**
+   * @brief Prepend the wire encoding to the encoder, or estimate its size
+   * @return number of bytes prepended
+   */
+  template<bool T>
+  inline size_t
+  wireEncode(EncodingImpl<T> &block) const;
+
   inline void
   wireDecode(const Block &block);
   
@@ -150,12 +158,10 @@ private:
   mutable Block wire_;
 };
 
-inline const Block&
-ForwardingFlags::wireEncode() const
+template<bool T>
+inline size_t
+ForwardingFlags::wireEncode(EncodingImpl<T> &block) const
 {
-  if (wire_.hasWire())
-    return wire_;
-
   uint32_t result = 0;
   if (active_)
     result |= Tlv::FaceManagement::FORW_ACTIVE;
@@ -174,8 +180,22 @@ ForwardingFlags::wireEncode() const
   if (captureOk_)
     result |= Tlv::FaceManagement::FORW_CAPTURE_OK;
   
-  wire_ = nonNegativeIntegerBlock(Tlv::FaceManagement::ForwardingFlags, result);
+  return prependNonNegativeIntegerBlock(block, Tlv::FaceManagement::ForwardingFlags, result);
+}
+
+inline const Block&
+ForwardingFlags::wireEncode() const
+{
+  if (wire_.hasWire())
+    return wire_;
+
+  EncodingEstimator estimator;
+  size_t estimatedSize = wireEncode(estimator);
+
+  EncodingBuffer buffer(estimatedSize, 0);
+  wireEncode(buffer);
 
+  wire_ = buffer.block();
   return wire_;
 }
 
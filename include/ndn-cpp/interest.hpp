@@ -11,6 +11,7 @@
 #include "name.hpp"
 #include "exclude.hpp"
 #include "encoding/block.hpp"
+#include "util/atomic.hpp"
 
 namespace ndn {
   
@@ -79,6 +80,26 @@ public:
   {
     construct();
   }
+
+  /**
+   * Copy the fields of the interest, with the nonce as it is now.
+   */
+  Interest(const Interest& interest)
+  : name_(interest.name_)
+  , minSuffixComponents_(interest.minSuffixComponents_)
+  , maxSuffixComponents_(interest.maxSuffixComponents_)
+  , exclude_(interest.exclude_)
+  , childSelector_(interest.childSelector_)
+  , mustBeFresh_(interest.mustBeFresh_)
+  , scope_(interest.scope_)
+  , interestLifetime_(interest.interestLifetime_)
+  , nonce_(interest.nonce_.load())
+  , wire_(interest.wire_)
+  {
+  }
+
+  Interest&
+  operator=(const Interest& interest);
   
   /**
    * Encode this Interest for a particular wire format.
@@ -86,6 +107,14 @@ public:
    */
   const Block&
   wireEncode() const;
+
+  /**
+   * @brief Prepend the wire encoding to the encoder, or estimate its size
+   * @return number of bytes prepended
+   */
+  template<bool T>
+  size_t
+  wireEncode(EncodingImpl<T> &block) const;
   
   /**
    * Decode the input using a particular wire format and update this Interest.
@@ -135,11 +164,11 @@ public:
   /**
    * @brief Get Interest's nonce
    *
-   * If nonce was not set before this call, it will be automatically assigned to a random value
-   *
-   * Const reference needed for C decoding
+   * If nonce was not set before this call, it will be automatically assigned to a random value.
+   * Different threads may call this at once, on the same Interest or on different ones: they all
+   * get the value assigned first.
    */
-  const uint32_t&
+  uint32_t
   getNonce() const;
     
   void
@@ -164,7 +193,7 @@ public:
   setInterestLifetime(Milliseconds interestLifetime) { interestLifetime_ = interestLifetime; }
 
   void 
-  setNonce(uint32_t nonce) { nonce_ = nonce; }
+  setNonce(uint32_t nonce) { nonce_.store(nonce); }
 
   inline bool
   hasSelectors() const;
@@ -192,7 +221,7 @@ private:
     mustBeFresh_ = false; // default
     scope_ = -1;
     interestLifetime_ = -1.0;
-    nonce_ = 0;
+    nonce_.store(0);
   }
   
   Name name_;
@@ -203,9 +232,14 @@ private:
   bool mustBeFresh_;
   int scope_;
   Milliseconds interestLifetime_;
-  mutable uint32_t nonce_;
+  /// @brief 0 until the nonce is set or assigned by getNonce
+  mutable Atomic<uint32_t> nonce_;
 
   mutable Block wire_;
+
+  struct NonceCodec;
+  class SelectorsSchema;
+  class Schema;
 };
 
 std::ostream &
@@ -235,7 +269,7 @@ Interest::hasGuiders() const
 {
   return scope_ >= 0 ||
     interestLifetime_ >= 0 ||
-    nonce_ > 0;
+    nonce_.load() > 0;
 }
 
 }
@@ -9,6 +9,7 @@
 #define NDN_KEY_LOCATOR_HPP
 
 #include "encoding/block.hpp"
+#include "encoding/tlv-schema.hpp"
 #include "name.hpp"
 
 namespace ndn {
@@ -36,6 +37,16 @@ public:
   inline const Block& 
   wireEncode() const;
 
+  /**
+   * @brief Prepend the wire encoding to the encoder, or estimate its size
+   *
+   * The cached wire encoding, if any, is copied as is
+   * @return number of bytes prepended
+   */
+  template<bool T>
+  inline size_t
+  wireEncode(EncodingImpl<T> &block) const;
+
   inline void 
   wireDecode(const Block &value);
   
@@ -64,6 +75,42 @@ private:
   Name name_;
   
   mutable Block wire_;
+
+  struct NameCodec;
+  class Schema;
+};
+
+/**
+ * @brief Codec of the Name of KeyLocator, which also sets the KeyLocator type
+ */
+struct KeyLocator::NameCodec : public TlvNested<KeyLocator, Name, &KeyLocator::name_>
+{
+  static void
+  decode(KeyLocator &keyLocator, const Block &parent, const TlvReader &element)
+  {
+    keyLocator.type_ = KeyLocator_Name;
+    TlvNested<KeyLocator, Name, &KeyLocator::name_>::decode(keyLocator, parent, element);
+  }
+
+  static void
+  reset(KeyLocator &keyLocator)
+  {
+    keyLocator.type_ = KeyLocator_Unknown;
+  }
+
+  static bool
+  isPresent(const KeyLocator &keyLocator)
+  {
+    return keyLocator.type_ == KeyLocator_Name;
+  }
+};
+
+// KeyLocator ::= KEY-LOCATOR-TYPE TLV-LENGTH
+//                  Name
+class KeyLocator::Schema : public TlvSchema<KeyLocator,
+  TlvField<Tlv::Name, TLV_OPTIONAL, KeyLocator::NameCodec>
+  >
+{
 };
 
 inline
@@ -72,27 +119,38 @@ KeyLocator::KeyLocator(const Name &name)
   setName(name);
 }
 
+template<bool T>
+inline size_t
+KeyLocator::wireEncode(EncodingImpl<T> &block) const
+{
+  if (wire_.hasWire())
+    return block.prependByteArray(wire_.wire(), wire_.size());
+
+  // KeyLocator
+
+  if (type_ != static_cast<uint32_t>(KeyLocator_None) && type_ != KeyLocator_Name)
+    throw Error("Unsupported KeyLocator type");
+
+  size_t totalLength = Schema::encode(block, *this);
+
+  totalLength += block.prependVarNumber(totalLength);
+  totalLength += block.prependVarNumber(Tlv::KeyLocator);
+  return totalLength;
+}
+
 inline const Block& 
 KeyLocator::wireEncode() const
 {
   if (wire_.hasWire())
     return wire_;
 
-  // KeyLocator
+  EncodingEstimator estimator;
+  size_t estimatedSize = wireEncode(estimator);
 
-  switch (type_) {
-  case KeyLocator_None:
-    wire_ = dataBlock(Tlv::KeyLocator, reinterpret_cast<const uint8_t*>(0), 0);
-    break;
-  case KeyLocator_Name:
-    wire_ = Block(Tlv::KeyLocator);
-    wire_.push_back(name_.wireEncode());
-    wire_.encode();
-    break;
-  default:
-    throw Error("Unsupported KeyLocator type");
-  }
-  
+  EncodingBuffer buffer(estimatedSize, 0);
+  wireEncode(buffer);
+
+  wire_ = buffer.block();
   return wire_;
 }
 
@@ -100,17 +158,8 @@ inline void
 KeyLocator::wireDecode(const Block &value)
 {
   wire_ = value;
-  wire_.parse();
-  
-  if (!wire_.getAll().empty() && wire_.getAll().front().type() == Tlv::Name)
-    {
-      type_ = KeyLocator_Name;
-      name_.wireDecode(wire_.getAll().front());
-    }
-  else
-    {
-      type_ = KeyLocator_Unknown;
-    }
+
+  Schema::decode(*this, wire_);
 }
 
 inline const Name&
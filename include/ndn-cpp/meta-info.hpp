@@ -8,6 +8,8 @@
 #ifndef NDN_META_INFO_HPP
 #define NDN_META_INFO_HPP
 
+#include "encoding/tlv-schema.hpp"
+
 namespace ndn {
 
 /**
@@ -45,6 +47,16 @@ public:
 
   inline const Block& 
   wireEncode() const;
+
+  /**
+   * @brief Prepend the wire encoding to the encoder, or estimate its size
+   *
+   * The cached wire encoding, if any, is copied as is
+   * @return number of bytes prepended
+   */
+  template<bool T>
+  inline size_t
+  wireEncode(EncodingImpl<T> &block) const;
   
   inline void
   wireDecode(const Block &wire);  
@@ -54,33 +66,47 @@ private:
   Milliseconds freshnessPeriod_;
 
   mutable Block wire_;
+
+  class Schema;
+};
+
+// MetaInfo ::= META-INFO-TYPE TLV-LENGTH
+//                ContentType?
+//                FreshnessPeriod?
+class MetaInfo::Schema : public TlvSchema<MetaInfo,
+  TlvField<Tlv::ContentType,     TLV_OPTIONAL, TlvNonNegativeInteger<MetaInfo, uint32_t, &MetaInfo::type_, TYPE_DEFAULT> >,
+  TlvField<Tlv::FreshnessPeriod, TLV_OPTIONAL, TlvNonNegativeInteger<MetaInfo, Milliseconds, &MetaInfo::freshnessPeriod_> >
+  >
+{
 };
 
+template<bool T>
+inline size_t
+MetaInfo::wireEncode(EncodingImpl<T> &block) const
+{
+  if (wire_.hasWire())
+    return block.prependByteArray(wire_.wire(), wire_.size());
+
+  size_t totalLength = Schema::encode(block, *this);
+
+  totalLength += block.prependVarNumber(totalLength);
+  totalLength += block.prependVarNumber(Tlv::MetaInfo);
+  return totalLength;
+}
+
 inline const Block& 
 MetaInfo::wireEncode() const
 {
   if (wire_.hasWire())
     return wire_;
 
-  // MetaInfo ::= META-INFO-TYPE TLV-LENGTH
-  //                ContentType?
-  //                FreshnessPeriod?
-  
-  wire_ = Block(Tlv::MetaInfo);
+  EncodingEstimator estimator;
+  size_t estimatedSize = wireEncode(estimator);
 
-  // ContentType
-  if (type_ != TYPE_DEFAULT) {
-    wire_.push_back
-      (nonNegativeIntegerBlock(Tlv::ContentType, type_));
-  }
+  EncodingBuffer buffer(estimatedSize, 0);
+  wireEncode(buffer);
 
-  // FreshnessPeriod
-  if (freshnessPeriod_ >= 0) {
-    wire_.push_back
-      (nonNegativeIntegerBlock(Tlv::FreshnessPeriod, freshnessPeriod_));
-  }
-  
-  wire_.encode();
+  wire_ = buffer.block();
   return wire_;  
 }
   
@@ -88,25 +114,8 @@ inline void
 MetaInfo::wireDecode(const Block &wire)
 {
   wire_ = wire;
-  wire_.parse();
 
-  // MetaInfo ::= META-INFO-TYPE TLV-LENGTH
-  //                ContentType?
-  //                FreshnessPeriod?
-  
-  // ContentType
-  Block::element_iterator val = wire_.find(Tlv::ContentType);
-  if (val != wire_.getAll().end())
-    {
-      type_ = readNonNegativeInteger(*val);
-    }
-
-  // FreshnessPeriod
-  val = wire_.find(Tlv::FreshnessPeriod);
-  if (val != wire_.getAll().end())
-    {
-      freshnessPeriod_ = readNonNegativeInteger(*val);
-    }
+  Schema::decode(*this, wire_);
 }
 
 inline std::ostream&
@@ -14,17 +14,34 @@
 #include <string>
 #include <sstream>
 #include <string.h>
+#include <iterator>
 #include "encoding/block.hpp"
 
 namespace ndn {
     
 /**
  * A Name holds an array of Name::Component and represents an NDN name.
+ *
+ * The components are stored back to back as NameComponent TLV elements in shared buffers (for a
+ * decoded name, the buffer of the packet), with a table of their offsets.  Copies, prefixes and
+ * sub-names share the buffers, and the wire encoding is made from them with at most one copy.
+ * A name derived from another one, as in Name(base).appendSegment(i), keeps sharing the components
+ * of the base and stores only the appended components, so the cost of deriving it depends on the
+ * suffix and not on the base (as long as the base lives, its buffer is only read).  get() and the
+ * iterators return each Component by value, copied from the buffer when it is asked for;
+ * getComponentValue() and getComponentValueSize() read the buffer without creating one.
  */
 class Name {
 public:
+  /// @brief Number of components meaning "up to the end of the name"
+  static const size_t npos = static_cast<size_t>(-1);
+
   /**
    * A Name::Component holds a read-only name component value.
+   *
+   * A component made by fromNumber() or fromNumberWithMarker() keeps its number, so that
+   * toNumber() or toNumberWithMarker() with the same marker returns it without decoding the value.
+   * Other components decode the number on each call, and a component is never changed once made.
    */
   class Component
   {
@@ -33,6 +50,8 @@ public:
      * Create a new Name::Component with a null value.
      */
     Component() 
+      : number_ (0)
+      , numberMarker_ (NO_NUMBER)
     {    
     }
 
@@ -44,6 +63,8 @@ public:
      */
     Component(const ConstBufferPtr &buffer)
     : value_ (buffer)
+    , number_ (0)
+    , numberMarker_ (NO_NUMBER)
     {
     }
   
@@ -53,7 +74,10 @@ public:
      */
     Component(const Buffer& value) 
       : value_ (new Buffer(value))
+      , number_ (0)
+      , numberMarker_ (NO_NUMBER)
     {
+      NDN_INSTRUMENT(COMPONENT_ALLOCATIONS);
     }
 
     /**
@@ -62,19 +86,28 @@ public:
      * @param valueLen Length of value.
      */
     Component(const uint8_t *value, size_t valueLen) 
-      : value_ (new Buffer(value, valueLen))
+      : value_ (allocateBuffer(value, valueLen))
+      , number_ (0)
+      , numberMarker_ (NO_NUMBER)
     {
+      NDN_INSTRUMENT(COMPONENT_ALLOCATIONS);
     }
 
     template<class InputIterator>
     Component(InputIterator begin, InputIterator end)
       : value_ (new Buffer(begin, end))
+      , number_ (0)
+      , numberMarker_ (NO_NUMBER)
     {
+      NDN_INSTRUMENT(COMPONENT_ALLOCATIONS);
     }
     
     Component(const char *string)
       : value_ (new Buffer(string, ::strlen(string)))
+      , number_ (0)
+      , numberMarker_ (NO_NUMBER)
     {
+      NDN_INSTRUMENT(COMPONENT_ALLOCATIONS);
     }
 
     const Buffer& 
@@ -250,14 +283,42 @@ public:
      */
     bool
     operator > (const Component& other) const { return compare(other) > 0; }
+
+  private:
+    /**
+     * @brief Create a component with the value, whose number with the marker is already known
+     */
+    Component(const uint8_t *value, size_t valueLen, uint64_t number, int marker)
+      : value_ (allocateBuffer(value, valueLen))
+      , number_ (number)
+      , numberMarker_ (marker)
+    {
+      NDN_INSTRUMENT(COMPONENT_ALLOCATIONS);
+    }
+
+    /// @brief Values of numberMarker_ when the number is not known, and when it has no marker
+    enum {
+      NO_NUMBER = -2,
+      NO_MARKER = -1
+    };
+
   private:
     ConstBufferPtr value_;
+    uint64_t number_; ///< @brief the number the component was made from, if any
+    /// @brief marker of number_, NO_MARKER if made by fromNumber(), NO_NUMBER if not made from a number
+    int numberMarker_;
+
+#if NDN_CPP_WITH_INSTRUMENTATION
+    InstrumentedCopy<Instrumentation::COMPONENT_COPIES> instrumentedCopy_;
+#endif
   };
 
   /**
    * Create a new Name with no components.
    */
-  Name() {
+  Name()
+    : nPrefix_(0)
+  {
   }
   
   /**
@@ -265,17 +326,28 @@ public:
    * @param components A vector of Component
    */
   Name(const std::vector<Component>& components)
-  : components_(components)
+    : nPrefix_(0)
   {
+    for (size_t i = 0; i < components.size(); ++i)
+      append(components[i]);
   }
 
+  /**
+   * Create a new Name from its wire encoding (or from the parsed elements of a Block without wire).
+   */
   Name(const Block &name)
+    : nPrefix_(0)
   {
-    for (Block::element_const_iterator i = name.getAll().begin();
-         i != name.getAll().end();
-         ++i)
+    if (name.hasWire())
+      wireDecode(name);
+    else
       {
-        append(Component(i->value_begin(), i->value_end()));
+        for (Block::element_const_iterator i = name.elements_begin();
+             i != name.elements_end();
+             ++i)
+          {
+            append(i->value(), i->value_size());
+          }
       }
   }
   
@@ -284,6 +356,7 @@ public:
    * @param uri The URI string.
    */
   Name(const char* uri)
+    : nPrefix_(0)
   {
     set(uri);
   }
@@ -293,6 +366,7 @@ public:
    * @param uri The URI string.
    */
   Name(const std::string& uri)
+    : nPrefix_(0)
   {
     set(uri.c_str());
   }
@@ -300,6 +374,16 @@ public:
   const Block &
   wireEncode() const;
 
+  /**
+   * @brief Prepend the wire encoding to the encoder, or estimate its size
+   *
+   * The cached wire encoding, if any, is copied as is
+   * @return number of bytes prepended
+   */
+  template<bool T>
+  size_t
+  wireEncode(EncodingImpl<T> &block) const;
+
   void
   wireDecode(const Block &wire);
   
@@ -324,7 +408,10 @@ public:
   Name& 
   append(const uint8_t *value, size_t valueLength) 
   {
-    components_.push_back(Component(value, valueLength));
+    if (valueLength > 0)
+      memcpy(appendUninitialized(valueLength), value, valueLength);
+    else
+      appendUninitialized(0);
     return *this;
   }
 
@@ -335,22 +422,22 @@ public:
   Name& 
   append(const Buffer& value) 
   {
-    components_.push_back(value);
-    return *this;
+    return append(value.empty() ? 0 : value.buf(), value.size());
   }
   
   Name& 
   append(const ConstBufferPtr &value)
   {
-    components_.push_back(value);
-    return *this;
+    return append(*value);
   }
   
   Name& 
   append(const Component &value)
   {
-    components_.push_back(value);
-    return *this;
+    if (value.empty())
+      return append(0, 0);
+    else
+      return append(value.getValue());
   }
 
   /**
@@ -363,15 +450,16 @@ public:
   Name& 
   append(const char *value)
   {
-    components_.push_back(Component(value));
-    return *this;
+    return append(reinterpret_cast<const uint8_t*>(value), ::strlen(value));
   }
   
+  /**
+   * @brief Append a component whose value is the wire encoding of the Block
+   */
   Name&
   append(const Block &value)
   {
-    components_.push_back(Component(value.begin(), value.end()));
-    return *this;
+    return append(value.wire(), value.size());
   }
   
   /**
@@ -440,9 +528,7 @@ public:
    * Clear all the components.
    */
   void 
-  clear() {
-    components_.clear();
-  }
+  clear();
   
   /**
    * @deprecated use size().
@@ -453,7 +539,7 @@ public:
   /**
    * @deprecated Use get(i).
    */
-  const Component& 
+  Component
   getComponent(size_t i) const { return get(i); }
   
   /**
@@ -483,7 +569,7 @@ public:
   getPrefix(int nComponents) const
   {
     if (nComponents < 0)
-      return getSubName(0, components_.size() + nComponents);
+      return getSubName(0, size() + nComponents);
     else
       return getSubName(0, nComponents);
   }
@@ -494,7 +580,35 @@ public:
    */
   std::string 
   toUri() const;
+
+  /**
+   * @brief Encode this name as a URI into the buffer, like snprintf
+   *
+   * At most bufferSize bytes are written, including a terminating zero (the URI is truncated if
+   * it does not fit).  Nothing is allocated.
+   * @return The size of the whole URI, not counting the terminating zero.  If it is not less than
+   *         bufferSize, the URI was truncated.
+   */
+  size_t
+  toUri(char *buffer, size_t bufferSize) const;
   
+  /**
+   * @brief Append a component whose value is the network-ordered encoding of the number, like
+   *        append(Component::fromNumber(number)), writing the bytes directly into the name
+   * @return This name so that you can chain calls to append.
+   */
+  Name&
+  appendNumber(uint64_t number);
+
+  /**
+   * @brief Append a component whose value is the marker followed by the network-ordered encoding
+   *        of the number, like append(Component::fromNumberWithMarker(number, marker)), writing
+   *        the bytes directly into the name
+   * @return This name so that you can chain calls to append.
+   */
+  Name&
+  appendNumberWithMarker(uint64_t number, uint8_t marker);
+
   /**
    * Append a component with the encoded segment number.
    * @param segment The segment number.
@@ -503,8 +617,7 @@ public:
   Name& 
   appendSegment(uint64_t segment)
   {
-    components_.push_back(Component::fromNumberWithMarker(segment, 0x00));
-    return *this;
+    return appendNumberWithMarker(segment, 0x00);
   }
 
   /**
@@ -516,8 +629,7 @@ public:
   Name& 
   appendVersion(uint64_t version)
   {
-    components_.push_back(Component::fromNumberWithMarker(version, 0xFD));
-    return *this;
+    return appendNumberWithMarker(version, 0xFD);
   }
 
   /**
@@ -592,6 +704,15 @@ public:
   static void 
   toEscapedString(const uint8_t *value, size_t valueSize, std::ostream& result);
 
+  /**
+   * @brief Write the value escaped according to the NDN URI Scheme into the buffer, like snprintf
+   *
+   * See toUri(char*, size_t) for how the buffer is filled.
+   * @return The size of the whole escaped value, not counting the terminating zero.
+   */
+  static size_t
+  toEscapedString(const uint8_t *value, size_t valueSize, char *buffer, size_t bufferSize);
+
   inline static void 
   toEscapedString(const std::vector<uint8_t>& value, std::ostream& result)
   {
@@ -626,31 +747,100 @@ public:
    * @brief Check if name is emtpy
    */
   bool
-  empty() const { return components_.empty(); }
+  empty() const { return size() == 0; }
   
   /**
    * Get the number of components.
    * @return The number of components.
    */
   size_t 
-  size() const { return components_.size(); }
+  size() const { return nPrefix_ + (storage_ ? storage_->offsets.size() : 0); }
 
   /**
    * Get the component at the given index.
-   * @param i The index of the component, starting from 0.
-   * @return The name component at the index.
+   * @param i The index of the component, starting from 0, or counting from the end if negative.
+   * @return A copy of the name component at the index.
    */
-  const Component& 
+  Component
   get(ssize_t i) const
   {
-    if (i >= 0)
-      return components_[i];
+    size_t index = i >= 0 ? static_cast<size_t>(i) : size() + i;
+    return Component(getComponentValue(index), getComponentValueSize(index));
+  }
+
+  /**
+   * @brief Get pointer to the value of the component at the index, without creating a Component
+   * @param i The index of the component, starting from 0 (must be less than size())
+   */
+  const uint8_t*
+  getComponentValue(size_t i) const
+  {
+    if (i < nPrefix_)
+      return prefix_->buffer->buf() + prefix_->offsets[i].value;
     else
-      return components_[size() + i];
+      return storage_->buffer->buf() + storage_->offsets[i - nPrefix_].value;
   }
+
+  /**
+   * @brief Get size of the value of the component at the index, without creating a Component
+   * @param i The index of the component, starting from 0 (must be less than size())
+   */
+  size_t
+  getComponentValueSize(size_t i) const
+  {
+    const ComponentOffset &offset = i < nPrefix_ ? prefix_->offsets[i] : storage_->offsets[i - nPrefix_];
+    return getComponentEnd(i) - offset.value;
+  }
+
+  /**
+   * @brief Interpret the component at the index as a network-ordered number, like
+   *        get(i).toNumber(), without creating a Component
+   */
+  uint64_t
+  getComponentNumber(size_t i) const;
+
+  /**
+   * @brief Interpret the component at the index as a network-ordered number with a marker, like
+   *        get(i).toNumberWithMarker(marker), without creating a Component
+   * @throw runtime_error If the first byte of the component does not equal the marker.
+   */
+  uint64_t
+  getComponentNumberWithMarker(size_t i, uint8_t marker) const;
+
+  /**
+   * @brief Get the hash of the name, the same as getPrefixHash(size())
+   */
+  size_t
+  getHash() const
+  {
+    return getPrefixHash(size());
+  }
+
+  /**
+   * @brief Get the hash of the prefix with the first nComponents components of the name
+   *
+   * getPrefixHash(n) is equal to getPrefix(n).getHash().  The hash is computed on each call and
+   * nothing is cached in the name, so several threads may call it at once on a shared Name.  To
+   * get the hashes of all prefixes of a name in one pass, use getPrefixHashes.
+   *
+   * The hash is SipHash keyed with a random key chosen once per process, so names that collide
+   * cannot be crafted by remote parties.  Hashes are therefore not stable across processes.
+   * @param nComponents The number of components of the prefix.  If larger than size(), size() is used.
+   */
+  size_t
+  getPrefixHash(size_t nComponents) const;
+
+  /**
+   * @brief Get the hashes of the prefixes with 0 to nComponents components in one pass
+   * @param nComponents The number of components of the longest prefix.  If larger than size(),
+   *        size() is used.
+   * @param hashes Set to the hashes, where hashes[n] equals getPrefixHash(n).
+   */
+  void
+  getPrefixHashes(size_t nComponents, std::vector<size_t> &hashes) const;
   
 
-  const Component&
+  Component
   operator [] (int i) const
   {
     return get(i);
@@ -682,6 +872,46 @@ public:
   bool
   operator != (const Name &name) const { return !equals(name); }
 
+  /**
+   * @brief Compare this name with other in the NDN canonical order
+   *
+   * The components are compared in turn with Name::Component::compare (a shorter value comes
+   * first, values of the same size are compared byte by byte).  If one name is a prefix of the
+   * other, the shorter name comes first.
+   *
+   * The encoded components of both names are compared with a memcmp-like scan to find the first
+   * component that differs, so names that share a long prefix cost about one scan of the prefix.
+   * @return 0 if the names are equal, a negative value if this name comes first, otherwise a
+   *         positive value.
+   */
+  int
+  compare(const Name &other) const
+  {
+    return compare(0, npos, other, 0, npos);
+  }
+
+  /**
+   * @brief Compare getSubName(iStartComponent, nComponents) with
+   *        other.getSubName(iOtherStartComponent, nOtherComponents) without creating the sub-names
+   *
+   * The start indexes and counts are clamped to the sizes of the names, like in getSubName().
+   */
+  int
+  compare(size_t iStartComponent, size_t nComponents, const Name &other,
+          size_t iOtherStartComponent = 0, size_t nOtherComponents = npos) const;
+
+  bool
+  operator < (const Name &name) const { return compare(name) < 0; }
+
+  bool
+  operator <= (const Name &name) const { return compare(name) <= 0; }
+
+  bool
+  operator > (const Name &name) const { return compare(name) > 0; }
+
+  bool
+  operator >= (const Name &name) const { return compare(name) >= 0; }
+
   /**
    * Compare two names for "less than" using breadth first.  If the first components of each name are not equal, 
    * this returns true if the first comes before the second using the NDN canonical ordering for name components.
@@ -689,8 +919,8 @@ public:
    * the size of the shorter name, this returns true if the first name is shorter than the second.  For example, if you
    * use breadthFirstLess in std::sort, it gives: /a/b/d	/a/b/cc /c /c/a /bb .  This is intuitive because all names
    * with the prefix /a are next to each other.  But it may be also be counter-intuitive because /c comes before /bb 
-   * according to NDN canonical ordering since it is shorter.  Note: We don't define this directly as the Name
-   * less than operation because there are other valid ways to sort names.
+   * according to NDN canonical ordering since it is shorter.  This is the same order as compare() and
+   * operator <.
    * @param name1 The first name to compare.
    * @param name2 The second name to compare.
    * @return True if the first name is less than the second using breadth first comparison.
@@ -705,72 +935,285 @@ public:
   struct BreadthFirstLess {
     bool operator() (const Name& name1, const Name& name2) const { return breadthFirstLess(name1, name2); }
   };
+
+  /**
+   * Name::Hash is a function object which calls getHash, for use as the hash function of unordered containers.
+   * For example: unordered_map<Name, int, Name::Hash>.  See also NameHashMap and NameHashSet.
+   */
+  struct Hash {
+    size_t operator() (const Name& name) const { return name.getHash(); }
+  };
   
   //
-  // Iterator interface to name components.
+  // Iterator interface to name components (read-only, the components cannot be modified in place).
   //
-  typedef std::vector<Component>::iterator iterator;
-  typedef std::vector<Component>::const_iterator const_iterator;
-  typedef std::vector<Component>::reverse_iterator reverse_iterator;
-  typedef std::vector<Component>::const_reverse_iterator const_reverse_iterator;
-  typedef std::vector<Component>::reference reference;
-  typedef std::vector<Component>::const_reference const_reference;
-
-  typedef std::vector<Component>::difference_type difference_type;
-  typedef std::vector<Component>::size_type size_type;
-  
-  typedef std::vector<Component>::value_type value_type;
 
   /**
-   * Begin iterator (const).
+   * @brief Random access iterator over the components, which returns a copy of the component
+   *        it points to, like get()
    */
-  const_iterator
-  begin() const { return components_.begin(); }
+  class const_iterator
+  {
+  public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef Component value_type;
+    typedef ptrdiff_t difference_type;
+    typedef Component reference;
+
+    /**
+     * @brief Holder of the component for operator->
+     */
+    class pointer
+    {
+    public:
+      explicit
+      pointer(const Component &component)
+        : component_(component)
+      {
+      }
+
+      const Component*
+      operator-> () const { return &component_; }
+
+    private:
+      Component component_;
+    };
+
+    const_iterator()
+      : name_(0)
+      , i_(0)
+    {
+    }
+
+    const_iterator(const Name *name, size_t i)
+      : name_(name)
+      , i_(i)
+    {
+    }
+
+    reference
+    operator * () const { return name_->get(i_); }
+
+    pointer
+    operator -> () const { return pointer(name_->get(i_)); }
+
+    reference
+    operator [] (difference_type n) const { return name_->get(i_ + n); }
+
+    const_iterator&
+    operator ++ () { ++i_; return *this; }
+
+    const_iterator
+    operator ++ (int) { const_iterator i = *this; ++i_; return i; }
+
+    const_iterator&
+    operator -- () { --i_; return *this; }
+
+    const_iterator
+    operator -- (int) { const_iterator i = *this; --i_; return i; }
+
+    const_iterator&
+    operator += (difference_type n) { i_ += n; return *this; }
+
+    const_iterator&
+    operator -= (difference_type n) { i_ -= n; return *this; }
+
+    const_iterator
+    operator + (difference_type n) const { return const_iterator(name_, i_ + n); }
+
+    const_iterator
+    operator - (difference_type n) const { return const_iterator(name_, i_ - n); }
+
+    difference_type
+    operator - (const const_iterator &other) const
+    {
+      return static_cast<difference_type>(i_) - static_cast<difference_type>(other.i_);
+    }
+
+    bool
+    operator == (const const_iterator &other) const { return i_ == other.i_ && name_ == other.name_; }
+
+    bool
+    operator != (const const_iterator &other) const { return !(*this == other); }
+
+    bool
+    operator < (const const_iterator &other) const { return i_ < other.i_; }
+
+    bool
+    operator > (const const_iterator &other) const { return i_ > other.i_; }
+
+    bool
+    operator <= (const const_iterator &other) const { return i_ <= other.i_; }
+
+    bool
+    operator >= (const const_iterator &other) const { return i_ >= other.i_; }
+
+  private:
+    const Name *name_;
+    size_t i_;
+  };
+
+  typedef const_iterator iterator;
+  typedef std::reverse_iterator<const_iterator> reverse_iterator;
+  typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+  typedef Component reference;
+  typedef Component const_reference;
+
+  typedef ptrdiff_t difference_type;
+  typedef size_t size_type;
+  
+  typedef Component value_type;
 
   /**
    * Begin iterator.
    */
-  iterator
-  begin() { return components_.begin(); }
+  const_iterator
+  begin() const { return const_iterator(this, 0); }
 
   /**
-   * End iterator (const).
+   * End iterator.
    */
   const_iterator
-  end() const { return components_.end(); }
+  end() const { return const_iterator(this, size()); }
 
   /**
-   * End iterator.
+   * Reverse begin iterator.
    */
-  iterator
-  end() { return components_.end(); }
+  const_reverse_iterator
+  rbegin() const { return const_reverse_iterator(end()); }
 
   /**
-   * Reverse begin iterator (const).
+   * Reverse end iterator.
    */
   const_reverse_iterator
-  rbegin() const { return components_.rbegin(); }
+  rend() const { return const_reverse_iterator(begin()); }
 
+private:
   /**
-   * Reverse begin iterator.
+   * @brief Add a component with value of the specified size at the end of the buffer
+   *
+   * The buffer is copied first if it is shared or the name does not end where it does
+   * @return pointer to the value, which is to be filled by the caller
    */
-  reverse_iterator
-  rbegin() { return components_.rbegin(); }
+  uint8_t*
+  appendUninitialized(size_t valueSize);
 
   /**
-   * Reverse end iterator (const).
+   * @brief Append the component escaped according to the NDN URI Scheme between begin and end
+   *
+   * Like set(), this skips the component if it is empty or illegal
    */
-  const_reverse_iterator
-  rend() const { return components_.rend(); }
+  void
+  appendEscaped(const char *begin, const char *end);
 
   /**
-   * Reverse end iterator.
+   * @brief Make the value of the last component valueSize bytes long, which must not be longer than it is
+   */
+  void
+  resizeLastComponent(size_t valueSize);
+
+  void
+  removeLastComponent();
+
+  /**
+   * @brief Get offset of the end of the component at the index in the buffer holding it
+   */
+  size_t
+  getComponentEnd(size_t i) const
+  {
+    if (i < nPrefix_)
+      return i + 1 < nPrefix_ ? prefix_->offsets[i + 1].begin : getPrefixEnd();
+
+    else
+      return storage_->getComponentEnd(i - nPrefix_);
+  }
+
+  /**
+   * @brief Get offset of the end of the last component of the prefix in its buffer
    */
-  reverse_iterator
-  rend() { return components_.rend(); }
+  size_t
+  getPrefixEnd() const
+  {
+    return nPrefix_ < prefix_->offsets.size() ? prefix_->offsets[nPrefix_].begin : prefix_->end;
+  }
+
+  /**
+   * @brief Check if storage_ and its buffer can be changed without being seen by other objects
+   */
+  bool
+  isStorageUnique() const
+  {
+    return storage_ && storage_.unique() && storage_->buffer.unique();
+  }
+
+  /// @brief Room left before the first component for the TLV type and length of the Name
+  static const size_t HEADER_RESERVE = 6;
+
+  /**
+   * @brief Offsets of a component in the buffer of its Storage
+   */
+  struct ComponentOffset
+  {
+    uint32_t begin; ///< @brief first byte of the NameComponent element
+    uint32_t value; ///< @brief first byte of its value
+  };
+
+  /**
+   * @brief Encoded components in a buffer, which may be shared by several names
+   *
+   * A name changes its storage_ only if it holds the only reference to it and to its buffer.
+   */
+  struct Storage
+  {
+    Storage()
+      : end(0)
+    {
+    }
+
+    /**
+     * @brief Create a storage sharing the buffer of the other one, with the components from iBegin to iEnd
+     * @param end The end of the last of these components in the buffer.
+     */
+    Storage(const Storage &other, size_t iBegin, size_t iEnd, size_t end);
+
+    /**
+     * @brief Get offset of the end of the component at the index in buffer
+     */
+    size_t
+    getComponentEnd(size_t i) const
+    {
+      return i + 1 < offsets.size() ? offsets[i + 1].begin : end;
+    }
+
+    ConstBufferPtr buffer;
+    std::vector<ComponentOffset> offsets;
+    size_t end; ///< @brief end of the last component in buffer
+  };
+
+  /**
+   * @brief Get the storage holding the component at index i (less than iEnd), with the indexes in
+   *        it of that component and of the end of the components before iEnd which it holds
+   */
+  const Storage&
+  getRun(size_t i, size_t iEnd, size_t &iRun, size_t &iRunEnd) const
+  {
+    if (i < nPrefix_)
+      {
+        iRun = i;
+        iRunEnd = std::min(iEnd, nPrefix_);
+        return *prefix_;
+      }
+    iRun = i - nPrefix_;
+    iRunEnd = iEnd - nPrefix_;
+    return *storage_;
+  }
 
 private:
-  std::vector<Component> components_;
+  /// @brief Storage of the name this one was derived from, of which it has the first nPrefix_ components
+  ptr_lib::shared_ptr<const Storage> prefix_;
+  size_t nPrefix_;
+  /// @brief Storage of the components after the prefix
+  ptr_lib::shared_ptr<Storage> storage_;
 
   mutable Block wire_;
 };
@@ -785,14 +1228,6 @@ operator << (std::ostream &os, const Name::Component &component)
   return os;
 }
 
-inline std::string 
-Name::toUri() const
-{
-  std::ostringstream os;
-  os << *this;
-  return os.str();
-}
-
 }
 
 #endif
@@ -13,6 +13,12 @@
 #include "data.hpp"
 #include "forwarding-flags.hpp"
 #include "transport/transport.hpp"
+#include "util/interest-matcher.hpp"
+#include "util/name-trie.hpp"
+#include "util/atomic.hpp"
+#include "util/mpsc-queue.hpp"
+
+#include <map>
 
 
 namespace ndn {
@@ -145,6 +151,22 @@ public:
   void 
   shutdown();
 
+  /**
+   * @brief Let any thread call expressInterest, removePendingInterest, registerPrefix,
+   *        removeRegisteredPrefix and put
+   *
+   * From then on, these methods return at once (with the ID of the new entry) and leave the work
+   * to the thread running processEvents, through a lock-free queue.  The tables and the transport
+   * are only used by that thread, and all the callbacks are called in it.  Calls made by one thread
+   * are carried out in the order it made them.
+   *
+   * Call this before sharing the node with other threads.  processEvents should be called with
+   * keepThread, so that it waits for the calls of the other threads.  The other methods, such as
+   * shutdown, must still be called in the thread running processEvents.
+   */
+  void
+  enableThreadSafety();
+
 private:
   void 
   onReceiveElement(const Block &wire);
@@ -173,7 +195,7 @@ private:
     static uint64_t 
     getNextPendingInterestId()
     {
-      return ++lastPendingInterestId_;
+      return lastPendingInterestId_.fetchAdd(1) + 1;
     }
     
     /**
@@ -199,6 +221,9 @@ private:
       return timeoutTimeMilliseconds_ >= 0.0 && nowMilliseconds >= timeoutTimeMilliseconds_;
     }
 
+    MillisecondsSince1970
+    getTimeoutTimeMilliseconds() { return timeoutTimeMilliseconds_; }
+
     /**
      * Call onTimeout_ (if defined).  This ignores exceptions from the onTimeout_.
      */
@@ -206,7 +231,7 @@ private:
     callTimeout();
     
   private:
-    static uint64_t lastPendingInterestId_; /**< A class variable used to get the next unique ID. */
+    static Atomic<uint64_t> lastPendingInterestId_; /**< A class variable used to get the next unique ID. */
 
     uint64_t pendingInterestId_;            /**< A unique identifier for this entry so it can be deleted */
     ptr_lib::shared_ptr<const Interest> interest_;
@@ -237,7 +262,7 @@ private:
     static uint64_t 
     getNextRegisteredPrefixId()
     {
-      return ++lastRegisteredPrefixId_;
+      return lastRegisteredPrefixId_.fetchAdd(1) + 1;
     }
     
     /**
@@ -262,32 +287,109 @@ private:
     }
     
   private:
-    static uint64_t lastRegisteredPrefixId_; /**< A class variable used to get the next unique ID. */
+    static Atomic<uint64_t> lastRegisteredPrefixId_; /**< A class variable used to get the next unique ID. */
 
     uint64_t registeredPrefixId_;            /**< A unique identifier for this entry so it can be deleted */
     ptr_lib::shared_ptr<const Name> prefix_;
     const OnInterest onInterest_;
   };
   
-  typedef std::vector<ptr_lib::shared_ptr<PendingInterest> > PendingInterestTable;
-  typedef std::vector<ptr_lib::shared_ptr<RegisteredPrefix> > RegisteredPrefixTable;
-  
   /**
-   * Find the entry from the pit_ where the name conforms to the entry's interest selectors, and
-   * the entry interest name is the longest that matches name.
-   * @param name The name to find the interest for (from the incoming data packet).
-   * @return The index in pit_ of the pit entry, or -1 if not found.
+   * The pending interests indexed by their names and by their pendingInterestId, so that the
+   * entries satisfied by a data packet are found in time depending on the length of its name,
+   * not on the number of entries.
    */
-  PendingInterestTable::iterator 
-  getEntryIndexForExpressedInterest(const Name& name);
+  typedef InterestMatcher<ptr_lib::shared_ptr<PendingInterest> > PendingInterestTable;
+  typedef std::vector<ptr_lib::shared_ptr<RegisteredPrefix> > RegisteredPrefixList;
+
+  /**
+   * The registered prefixes in a tree of names, with those registered for the same prefix in the
+   * order of registration, so that the entries for an interest are found by a longest prefix match
+   * in time depending on the length of its name, not on the number of entries.  Only the thread
+   * running processEvents uses it, so it is changed in place rather than copied on each change,
+   * except for the nodes held by the Snapshot taken while the OnInterest callbacks run.
+   */
+  typedef NameTrie<RegisteredPrefixList> RegisteredPrefixTable;
+  typedef std::map<uint64_t, ptr_lib::shared_ptr<RegisteredPrefix> > RegisteredPrefixIdIndex;
+
+  /**
+   * @brief An entry of the pending interest timeout queue
+   *
+   * The entry of a pending interest which is satisfied or removed is not taken out of the queue,
+   * which would take a search, but left to be skipped when it comes first or dropped by
+   * removeStalePendingInterestTimeouts.
+   */
+  struct PendingInterestTimeout
+  {
+    PendingInterestTimeout(const ptr_lib::shared_ptr<PendingInterest> &pendingInterest)
+      : timeoutTimeMilliseconds(pendingInterest->getTimeoutTimeMilliseconds())
+      , pendingInterest(pendingInterest)
+    {
+    }
+
+    /**
+     * @brief Order the entries so that the one to time out first is on top of the heap
+     */
+    bool
+    operator<(const PendingInterestTimeout &other) const
+    {
+      if (timeoutTimeMilliseconds != other.timeoutTimeMilliseconds)
+        return timeoutTimeMilliseconds > other.timeoutTimeMilliseconds;
+      return pendingInterest->getPendingInterestId() > other.pendingInterest->getPendingInterestId();
+    }
+
+    MillisecondsSince1970 timeoutTimeMilliseconds;
+    ptr_lib::shared_ptr<PendingInterest> pendingInterest;
+  };
+
+  /**
+   * @brief A heap (see std::push_heap) of the timeouts of the pending interests
+   */
+  typedef std::vector<PendingInterestTimeout> PendingInterestTimeoutQueue;
   
+  typedef func_lib::function<void()> Command;
+
   /**
-   * Find the first entry from the registeredPrefixTable_ where the entry prefix is the longest that matches name.
-   * @param name The name to find the PrefixEntry for (from the incoming interest packet).
-   * @return A pointer to the entry, or 0 if not found.
+   * @brief Queue the command for processCommands, and have it scheduled if it is not yet
+   *
+   * This can be called from any thread.
    */
-  RegisteredPrefixTable::iterator
-  getEntryForRegisteredPrefix(const Name& name);
+  void
+  callInIoThread(const Command &command);
+
+  /**
+   * @brief Run the queued commands until the queue is empty
+   */
+  void
+  processCommands();
+
+  /**
+   * @brief Do the work of expressInterest in the thread running processEvents
+   */
+  void
+  expressInterestHelper(uint64_t pendingInterestId, const ptr_lib::shared_ptr<const Interest>& interest,
+                        const OnData& onData, const OnTimeout& onTimeout);
+
+  void
+  removePendingInterestHelper(uint64_t pendingInterestId);
+
+  /**
+   * @brief Do the work of registerPrefix in the thread running processEvents: fetch the ndndId_
+   *        if it is not known yet, then call registerPrefixHelper
+   */
+  void
+  fetchNdndIdAndRegisterPrefix
+    (uint64_t registeredPrefixId, const ptr_lib::shared_ptr<const Name>& prefix, const OnInterest& onInterest,
+     const OnRegisterFailed& onRegisterFailed, const ForwardingFlags& flags);
+
+  void
+  removeRegisteredPrefixHelper(uint64_t registeredPrefixId);
+
+  /**
+   * @brief Send the encoding of a data packet given to put
+   */
+  void
+  putHelper(const Block &wire);
 
   /**
    * Do the work of registerPrefix once we know we are connected with an ndndId_.
@@ -315,24 +417,67 @@ private:
                       const OnRegisterFailed& onRegisterFailed,
                       const ptr_lib::shared_ptr<const Interest>&, const ptr_lib::shared_ptr<Data>&);
   
+  /**
+   * @brief Set pitTimeoutCheckTimer_ to call checkPitExpire at timeoutTimeMilliseconds
+   *
+   * This cancels the call for which the timer was set before.
+   */
   void
-  checkPitExpire();
+  schedulePitTimeoutCheck(MillisecondsSince1970 timeoutTimeMilliseconds);
+
+  /**
+   * @brief Call the timeout callbacks of the pending interests which have timed out, and set the
+   *        timer for the next one
+   */
+  void
+  checkPitExpire(const boost::system::error_code &error);
+
+  /**
+   * @brief Drop the entries of pendingInterestTimeouts_ for pending interests no longer in the
+   *        table, once they outnumber the others
+   *
+   * Call this after removing pending interests from the table.  If the table is then empty, this
+   * posts checkPitEmpty.
+   */
+  void
+  removeStalePendingInterestTimeouts();
+
+  /**
+   * @brief Call onPitEmpty if the table is still empty
+   */
+  void
+  checkPitEmpty();
+
+  /**
+   * @brief Stop pitTimeoutCheckTimer_, and close the transport if no registered prefix needs it
+   *        either, so that processEvents can return
+   */
+  void
+  onPitEmpty();
   
 private:
   ptr_lib::shared_ptr<boost::asio::io_service> ioService_;
   ptr_lib::shared_ptr<boost::asio::io_service::work> ioServiceWork_; // needed if thread needs to be preserved
   ptr_lib::shared_ptr<boost::asio::deadline_timer> pitTimeoutCheckTimer_;
   bool pitTimeoutCheckTimerActive_;
+  MillisecondsSince1970 pitTimeoutCheckTimeMilliseconds_; /**< The time pitTimeoutCheckTimer_ is set for, if active */
+  bool pitEmptyCheckPosted_;
   ptr_lib::shared_ptr<boost::asio::deadline_timer> processEventsTimeoutTimer_;
   
   ptr_lib::shared_ptr<Transport> transport_;
 
   PendingInterestTable pendingInterestTable_;
+  PendingInterestTimeoutQueue pendingInterestTimeouts_;
   RegisteredPrefixTable registeredPrefixTable_;
+  RegisteredPrefixIdIndex registeredPrefixIds_;
   Interest ndndIdFetcherInterest_;
 
   int64_t faceId_; // internal face ID (needed for prefix de-registration)
   Buffer ndndId_;
+
+  bool isThreadSafe_;
+  MpscQueue<Command> commands_; /**< The calls of other threads, if isThreadSafe_ */
+  Atomic<bool> isProcessingCommands_; /**< true while processCommands is posted to ioService_ or running */
 };
 
 } // namespace ndn
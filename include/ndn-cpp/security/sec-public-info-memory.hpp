@@ -9,8 +9,8 @@
 #define NDN_SEC_PUBLIC_INFO_MEMORY_HPP
 
 #include <vector>
-#include <map>
 #include "sec-public-info.hpp"
+#include "../util/name-hash-map.hpp"
 
 namespace ndn {
 
@@ -200,13 +200,13 @@ private:
     PublicKey key_;
   };
   
-  std::vector<std::string> identityStore_; /**< A list of name URI. */
+  NameHashSet identityStore_;              /**< The identity names. */
   std::string defaultIdentity_;            /**< The default identity in identityStore_, or "" if not defined. */
   Name defaultKeyName_;
   Name defaultCert_;
 
-  typedef std::map< std::string, ptr_lib::shared_ptr<KeyRecord> > KeyStore; /**< The map key is the keyName.toUri() */
-  typedef std::map< std::string, ptr_lib::shared_ptr<IdentityCertificate> > CertificateStore; /**< The map key is the certificateName.toUri() */
+  typedef NameHashMap< ptr_lib::shared_ptr<KeyRecord> > KeyStore; /**< The map key is the keyName */
+  typedef NameHashMap< ptr_lib::shared_ptr<IdentityCertificate> > CertificateStore; /**< The map key is the certificateName */
   
   KeyStore keyStore_; 
   CertificateStore certificateStore_;                    
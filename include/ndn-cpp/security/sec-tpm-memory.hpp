@@ -8,8 +8,8 @@
 #ifndef NDN_SEC_TPM_MEMORY_HPP
 #define NDN_SEC_TPM_MEMORY_HPP
 
-#include <map>
 #include "sec-tpm.hpp"
+#include "../util/name-hash-map.hpp"
 
 struct rsa_st;
 
@@ -115,11 +115,11 @@ public:
 private:
   class RsaPrivateKey;
 
-  typedef std::map<std::string, ptr_lib::shared_ptr<PublicKey> >     PublicKeyStore;
-  typedef std::map<std::string, ptr_lib::shared_ptr<RsaPrivateKey> > PrivateKeyStore;
+  typedef NameHashMap< ptr_lib::shared_ptr<PublicKey> >     PublicKeyStore;
+  typedef NameHashMap< ptr_lib::shared_ptr<RsaPrivateKey> > PrivateKeyStore;
   
-  PublicKeyStore  publicKeyStore_;  /**< The map key is the keyName.toUri() */
-  PrivateKeyStore privateKeyStore_; /**< The map key is the keyName.toUri() */
+  PublicKeyStore  publicKeyStore_;  /**< The map key is the keyName */
+  PrivateKeyStore privateKeyStore_; /**< The map key is the keyName */
 };
 
 }
@@ -34,7 +34,7 @@ public:
 
     info_.parse();
     Block::element_iterator i = info_.find(Tlv::KeyLocator);
-    if (i != info_.getAll().end())
+    if (i != info_.elements_end())
       {
         keyLocator_.wireDecode(*i);
       }
@@ -0,0 +1,206 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2013 Regents of the University of California.
+ * See COPYING for copyright and distribution information.
+ */
+
+#ifndef NDN_SHARDED_NODE_HPP
+#define NDN_SHARDED_NODE_HPP
+
+#include "node.hpp"
+
+#include <vector>
+
+namespace ndn {
+
+/**
+ * @brief A set of Nodes, each with its own transport connection and io_service, which several
+ *        threads run at once so that the decoding, the table lookups and the callbacks of one
+ *        application use several cores
+ *
+ * Each shard is a thread-safe Node (see Node::enableThreadSafety) over one of the transports given
+ * to the constructor.  An Interest is expressed by the shard chosen by the hash of its name, and
+ * its Data comes back over the connection of that shard, so each pending interest table only holds
+ * a part of the Interests and the shards share no state.  A prefix is registered by the shard
+ * chosen by its hash, and the Interests under it are received by that shard only.  The Data which
+ * answers them is put through that shard too, chosen by the registered prefix ID given to
+ * onInterest, so that it goes back over the connection the Interest came from.
+ *
+ * The application starts one thread for each shard, which calls processEvents(shard).  The other
+ * methods may be called from any thread, including the callbacks of any shard.  The callbacks of an
+ * Interest or a prefix are called in the thread of its shard.
+ *
+ * <code>
+ *     std::vector<ptr_lib::shared_ptr<Transport> > transports;
+ *     for (size_t i = 0; i < nThreads; ++i)
+ *       transports.push_back(ptr_lib::make_shared<UnixTransport>());
+ *     ShardedNode node(transports);
+ *
+ *     // In thread i:
+ *     node.processEvents(i, 0, true);
+ * </code>
+ */
+class ShardedNode {
+public:
+  struct Error : public std::runtime_error { Error(const std::string &what) : std::runtime_error(what) {} };
+
+  /**
+   * @brief The counts of the work done by one shard since the ShardedNode was created
+   */
+  struct ShardStatistics
+  {
+    uint64_t nExpressedInterests;  ///< Interests given to expressInterest
+    uint64_t nSatisfiedInterests;  ///< onData callbacks called (or skipped when empty)
+    uint64_t nTimedOutInterests;   ///< onTimeout callbacks called (or skipped when empty)
+    uint64_t nReceivedInterests;   ///< onInterest callbacks called
+    uint64_t nPutData;             ///< Data given to put
+  };
+
+  /**
+   * @brief Create one shard for each transport
+   * @param transports The transports, each connected to the NDN hub on its own.
+   * @throws Error if transports is empty
+   */
+  ShardedNode(const std::vector<ptr_lib::shared_ptr<Transport> > &transports);
+
+  size_t
+  getShardCount() const
+  {
+    return shards_.size();
+  }
+
+  /**
+   * @brief Get the shard which expresses the Interests with the name and registers it as a prefix
+   *
+   * This does not change the name, so several threads may call it at once with a shared name.
+   */
+  size_t
+  getShardForName(const Name &name) const
+  {
+    return name.getHash() % shards_.size();
+  }
+
+  /**
+   * @brief Express the Interest through the shard of its name
+   * @see Node::expressInterest
+   * @return The ID for removePendingInterest of this ShardedNode.
+   */
+  uint64_t
+  expressInterest(const Interest& interest, const OnData& onData, const OnTimeout& onTimeout);
+
+  /**
+   * @brief Remove the pending interest from its shard
+   * @see Node::removePendingInterest
+   */
+  void
+  removePendingInterest(uint64_t pendingInterestId);
+
+  /**
+   * @brief Register the prefix through the shard of its name
+   * @see Node::registerPrefix
+   * @return The ID for removeRegisteredPrefix of this ShardedNode.
+   */
+  uint64_t
+  registerPrefix
+    (const Name& prefix, const OnInterest& onInterest, const OnRegisterFailed& onRegisterFailed,
+     const ForwardingFlags& flags);
+
+  /**
+   * @brief Remove the registered prefix from its shard
+   * @see Node::removeRegisteredPrefix
+   */
+  void
+  removeRegisteredPrefix(uint64_t registeredPrefixId);
+
+  /**
+   * @brief Publish the Data through the shard of the registered prefix, which is the shard that
+   *        received the Interests under the prefix
+   * @param data The Data, usually answering an Interest given to the OnInterest of the prefix.
+   * @param registeredPrefixId The ID returned by registerPrefix, which is also passed to OnInterest.
+   * @see Node::put
+   */
+  void
+  put(const Data &data, uint64_t registeredPrefixId);
+
+  /**
+   * @brief Process the events of one shard, in the thread which serves it
+   *
+   * Each shard must be processed by one thread at a time.
+   * @see Node::processEvents
+   * @throws Error if there is no such shard
+   */
+  void
+  processEvents(size_t shard, Milliseconds timeout = 0, bool keepThread = false);
+
+  /**
+   * @brief Shut down the Node of each shard and make its processEvents return
+   *
+   * This may be called from any thread.  Each shard shuts down in its own thread.
+   */
+  void
+  shutdown();
+
+  /**
+   * @brief Get the counts of the work done by the shard so far
+   *
+   * This may be called from any thread while the shards run.
+   * @throws Error if there is no such shard
+   */
+  ShardStatistics
+  getShardStatistics(size_t shard) const;
+
+private:
+  struct Shard
+  {
+    Shard(const ptr_lib::shared_ptr<Transport> &transport);
+
+    ptr_lib::shared_ptr<boost::asio::io_service> ioService;
+    Node node;
+
+    Atomic<uint64_t> nExpressedInterests;
+    Atomic<uint64_t> nSatisfiedInterests;
+    Atomic<uint64_t> nTimedOutInterests;
+    Atomic<uint64_t> nReceivedInterests;
+    Atomic<uint64_t> nPutData;
+  };
+
+  /**
+   * @brief Get the shard of an ID returned by this ShardedNode, and the ID of its Node
+   */
+  Shard&
+  getShardForId(uint64_t id, uint64_t &nodeId);
+
+  /**
+   * @brief Make the ID returned by this ShardedNode from the ID of the Node of a shard
+   */
+  uint64_t
+  makeId(uint64_t nodeId, size_t shard) const
+  {
+    return nodeId * shards_.size() + shard;
+  }
+
+  void
+  onShardData(size_t shard, const OnData &onData,
+              const ptr_lib::shared_ptr<const Interest> &interest, const ptr_lib::shared_ptr<Data> &data);
+
+  void
+  onShardTimeout(size_t shard, const OnTimeout &onTimeout, const ptr_lib::shared_ptr<const Interest> &interest);
+
+  /**
+   * @brief Count the Interest and pass it to onInterest with the ID of this ShardedNode
+   */
+  void
+  onShardInterest(size_t shard, const OnInterest &onInterest,
+                  const ptr_lib::shared_ptr<const Name> &prefix, const ptr_lib::shared_ptr<const Interest> &interest,
+                  Transport &transport, uint64_t registeredPrefixId);
+
+  static void
+  shutdownShard(Shard *shard);
+
+private:
+  std::vector<ptr_lib::shared_ptr<Shard> > shards_;
+};
+
+} // namespace ndn
+
+#endif
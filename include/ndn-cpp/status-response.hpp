@@ -40,6 +40,14 @@ public:
   inline const Block&
   wireEncode() const;
 
+  /**
+   * @brief Prepend the wire encoding to the encoder, or estimate its size
+   * @return number of bytes prepended
+   */
+  template<bool T>
+  inline size_t
+  wireEncode(EncodingImpl<T> &block) const;
+
   inline void
   wireDecode(const Block &block);
   
@@ -77,23 +85,40 @@ StatusResponse::setInfo(const std::string &info)
 }
 
 
+template<bool T>
+inline size_t
+StatusResponse::wireEncode(EncodingImpl<T> &block) const
+{
+  size_t totalLength = 0;
+
+  // (reverse encoding)
+
+  if (!info_.empty())
+    {
+      totalLength += prependByteArrayBlock(block, Tlv::FaceManagement::StatusText,
+                                           reinterpret_cast<const uint8_t*>(info_.c_str()), info_.size());
+    }
+
+  totalLength += prependNonNegativeIntegerBlock(block, Tlv::FaceManagement::StatusCode, code_);
+
+  totalLength += block.prependVarNumber(totalLength);
+  totalLength += block.prependVarNumber(Tlv::FaceManagement::StatusResponse);
+  return totalLength;
+}
+
 inline const Block&
 StatusResponse::wireEncode() const
 {
   if (wire_.hasWire())
     return wire_;
 
-  wire_ = Block(Tlv::FaceManagement::StatusResponse);
-  wire_.push_back
-    (nonNegativeIntegerBlock(Tlv::FaceManagement::StatusCode, code_));
+  EncodingEstimator estimator;
+  size_t estimatedSize = wireEncode(estimator);
 
-  if (!info_.empty())
-    {
-      wire_.push_back
-        (dataBlock(Tlv::FaceManagement::StatusText, info_.c_str(), info_.size()));
-    }
-  
-  wire_.encode();  
+  EncodingBuffer buffer(estimatedSize, 0);
+  wireEncode(buffer);
+
+  wire_ = buffer.block();
   return wire_;
 }
 
@@ -106,7 +131,7 @@ StatusResponse::wireDecode(const Block &wire)
   code_ = readNonNegativeInteger(wire_.get(Tlv::FaceManagement::StatusCode));
 
   Block::element_iterator val = wire_.find(Tlv::FaceManagement::StatusText);
-  if (val != wire_.getAll().end())
+  if (val != wire_.elements_end())
     {
       info_.assign(reinterpret_cast<const char*>(val->value()), val->value_size());
     }
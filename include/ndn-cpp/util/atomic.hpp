@@ -0,0 +1,114 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef NDN_ATOMIC_HPP
+#define NDN_ATOMIC_HPP
+
+#include "../common.hpp"
+
+#if NDN_CPP_HAVE_CXX11
+#include <atomic>
+#endif
+
+namespace ndn {
+
+/**
+ * @brief A value of an integer, bool or pointer type which many threads can read and change at once
+ *
+ * This is std::atomic when the library is built in C++11 mode, and the __atomic builtins of GCC
+ * and Clang otherwise.  All the operations are sequentially consistent.
+ */
+template<class T>
+class Atomic
+{
+public:
+  explicit
+  Atomic(T value = T())
+    : m_value(value)
+  {
+  }
+
+  T
+  load() const
+  {
+#if NDN_CPP_HAVE_CXX11
+    return m_value.load();
+#else
+    return __atomic_load_n(&m_value, __ATOMIC_SEQ_CST);
+#endif
+  }
+
+  void
+  store(T value)
+  {
+#if NDN_CPP_HAVE_CXX11
+    m_value.store(value);
+#else
+    __atomic_store_n(&m_value, value, __ATOMIC_SEQ_CST);
+#endif
+  }
+
+  /**
+   * @brief Set the value and return the one it replaced
+   */
+  T
+  exchange(T value)
+  {
+#if NDN_CPP_HAVE_CXX11
+    return m_value.exchange(value);
+#else
+    return __atomic_exchange_n(&m_value, value, __ATOMIC_SEQ_CST);
+#endif
+  }
+
+  /**
+   * @brief Set the value to desired if it is expected
+   *
+   * @return true if the value was set, otherwise false with the value read in expected
+   */
+  bool
+  compareExchange(T &expected, T desired)
+  {
+#if NDN_CPP_HAVE_CXX11
+    return m_value.compare_exchange_strong(expected, desired);
+#else
+    return __atomic_compare_exchange_n(&m_value, &expected, desired, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+  }
+
+  /**
+   * @brief Add to the value (of an integer type) and return the value before
+   */
+  T
+  fetchAdd(T value)
+  {
+#if NDN_CPP_HAVE_CXX11
+    return m_value.fetch_add(value);
+#else
+    return __atomic_fetch_add(&m_value, value, __ATOMIC_SEQ_CST);
+#endif
+  }
+
+private:
+  // not copyable
+  Atomic(const Atomic&);
+
+  Atomic&
+  operator=(const Atomic&);
+
+private:
+#if NDN_CPP_HAVE_CXX11
+  std::atomic<T> m_value;
+#else
+  T m_value;
+#endif
+};
+
+} // namespace ndn
+
+#endif // NDN_ATOMIC_HPP
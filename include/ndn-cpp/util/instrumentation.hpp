@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef NDN_INSTRUMENTATION_HPP
+#define NDN_INSTRUMENTATION_HPP
+
+#include <ndn-cpp/common.hpp>
+
+namespace ndn {
+
+/**
+ * @brief Per-thread counters of allocations and copies made by the library
+ *
+ * The library updates the counters only if it is configured with --enable-instrumentation
+ * (which defines NDN_CPP_WITH_INSTRUMENTATION).  Otherwise the instrumentation points compile
+ * to nothing, the counters stay zero and isEnabled() returns false.
+ *
+ * Each thread has its own counters, so the cost of an operation can be measured without
+ * interference from other threads:
+ *
+ * <code>
+ *     Instrumentation::Snapshot snapshot;
+ *     interest.wireDecode(wire);
+ *     if (snapshot.get(Instrumentation::BUFFER_ALLOCATIONS) > 2)
+ *       ...
+ * </code>
+ *
+ * Copies of Block and Name::Component are counted because each one is a shared_ptr reference
+ * count operation on the wire or value buffer (and another one when the copy is destroyed).
+ */
+class Instrumentation
+{
+public:
+  enum Counter {
+    /// @brief Buffer objects created other than by copy (a pooled buffer that is reused is not counted)
+    BUFFER_ALLOCATIONS,
+    /// @brief Buffer objects copied, including their contents
+    BUFFER_COPIES,
+    /// @brief Block objects copied
+    BLOCK_COPIES,
+    /// @brief Name::Component objects created with a new value buffer
+    COMPONENT_ALLOCATIONS,
+    /// @brief Name::Component objects copied
+    COMPONENT_COPIES,
+    /// @brief OBufferStream buffers created or grown
+    OBUFFERSTREAM_ALLOCATIONS,
+    /// @brief Receive buffers allocated by TlvFramer for the transports
+    TRANSPORT_RECEIVE_ALLOCATIONS,
+    /// @brief Bytes of partially received elements moved by TlvFramer
+    TRANSPORT_RECEIVE_COPIED_BYTES,
+
+    N_COUNTERS
+  };
+
+  /**
+   * @brief Values of all counters of the calling thread at the time of construction
+   *
+   * get() returns how much a counter has grown since then.
+   */
+  class Snapshot
+  {
+  public:
+    Snapshot();
+
+    uint64_t
+    get(Counter counter) const;
+
+    /**
+     * @brief Take the snapshot again
+     */
+    void
+    reset();
+
+  private:
+    uint64_t m_values[N_COUNTERS];
+  };
+
+  /**
+   * @brief Check if the library is built to update the counters
+   */
+  static bool
+  isEnabled();
+
+  /**
+   * @brief Get the value of the counter of the calling thread
+   */
+  static uint64_t
+  get(Counter counter);
+
+  /**
+   * @brief Add n to the counter of the calling thread
+   */
+  static void
+  add(Counter counter, uint64_t n = 1);
+
+  /**
+   * @brief Set all counters of the calling thread to zero
+   */
+  static void
+  reset();
+
+  /**
+   * @brief Get the name of the counter, e.g. "buffer-allocations"
+   */
+  static const char*
+  getName(Counter counter);
+};
+
+#if NDN_CPP_WITH_INSTRUMENTATION
+
+/**
+ * @brief Member of an instrumented class that counts copies of the objects of that class
+ *
+ * Being a member, it is copied by the implicit copy constructor and assignment of the class,
+ * so these do not have to be written out.  Moves are not counted.
+ */
+template<Instrumentation::Counter COUNTER>
+class InstrumentedCopy
+{
+public:
+  InstrumentedCopy()
+  {
+  }
+
+  InstrumentedCopy(const InstrumentedCopy&)
+  {
+    Instrumentation::add(COUNTER);
+  }
+
+  InstrumentedCopy&
+  operator=(const InstrumentedCopy&)
+  {
+    Instrumentation::add(COUNTER);
+    return *this;
+  }
+
+#if NDN_CPP_HAVE_CXX11
+  InstrumentedCopy(InstrumentedCopy&&)
+  {
+  }
+
+  InstrumentedCopy&
+  operator=(InstrumentedCopy&&)
+  {
+    return *this;
+  }
+#endif
+};
+
+#define NDN_INSTRUMENT(COUNTER) \
+  ::ndn::Instrumentation::add(::ndn::Instrumentation::COUNTER)
+
+#define NDN_INSTRUMENT_ADD(COUNTER, N) \
+  ::ndn::Instrumentation::add(::ndn::Instrumentation::COUNTER, N)
+
+#else // NDN_CPP_WITH_INSTRUMENTATION
+
+#define NDN_INSTRUMENT(COUNTER) ((void)0)
+#define NDN_INSTRUMENT_ADD(COUNTER, N) ((void)0)
+
+#endif // NDN_CPP_WITH_INSTRUMENTATION
+
+} // namespace ndn
+
+#endif // NDN_INSTRUMENTATION_HPP
@@ -0,0 +1,332 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef NDN_INTEREST_MATCHER_HPP
+#define NDN_INTEREST_MATCHER_HPP
+
+#include "../interest.hpp"
+#include "name-hash-map.hpp"
+
+#include <limits>
+#include <vector>
+
+#if !(NDN_CPP_HAVE_CXX11 || NDN_CPP_USE_SYSTEM_BOOST)
+#include <map>
+#endif
+
+namespace ndn {
+
+/**
+ * @brief Table of outstanding Interests, each with a value, which finds all the Interests that a
+ *        Data name satisfies in one call
+ *
+ * The Interests are kept in a hash table keyed by the hashes of their names.  findMatches()
+ * hashes the prefixes of the Data name in one pass (see Name::getPrefixHashes), looks up the hash of each prefix length
+ * that some Interest has, and compares the names found with the prefix in place, without creating
+ * the prefix as a Name.  Its cost thus grows with the length of the name and the number of
+ * Interests under its prefixes rather than with the size of the table.
+ *
+ * The selectors of an Interest are turned into a range of Data name sizes when it is inserted, and
+ * its Exclude, if any, is shared with the entry.  An entry thus matches a name under its prefix
+ * exactly when Interest::matchesName() is true.
+ *
+ * Each Interest is identified by an ID chosen by the caller, such as a pending interest ID, with
+ * which erase() removes it in constant time.
+ */
+template<class T>
+class InterestMatcher
+{
+public:
+  InterestMatcher()
+    : m_size(0)
+  {
+  }
+
+  /**
+   * @brief Add the Interest with the value
+   * @param id An ID which no other Interest of the table has.
+   * @return false (and the table is not changed) if some Interest already has the ID
+   */
+  bool
+  insert(uint64_t id, const Interest &interest, const T &value);
+
+  /**
+   * @brief Remove the Interest with the ID
+   * @return false if no Interest has the ID
+   */
+  bool
+  erase(uint64_t id);
+
+  /**
+   * @brief Append the values of the Interests which the Data name satisfies to values
+   *
+   * The Interests with shorter names come first, and those with the same name in the order they
+   * were inserted.
+   * @return the number of values appended
+   */
+  size_t
+  findMatches(const Name &name, std::vector<T> &values) const;
+
+  /**
+   * @brief Append the values of all the Interests to values, in no particular order
+   */
+  void
+  getValues(std::vector<T> &values) const;
+
+  /**
+   * @brief Check if some Interest has the ID
+   */
+  bool
+  contains(uint64_t id) const
+  {
+    return m_ids.find(id) != m_ids.end();
+  }
+
+  size_t
+  size() const
+  {
+    return m_size;
+  }
+
+  bool
+  empty() const
+  {
+    return m_size == 0;
+  }
+
+  void
+  clear()
+  {
+    m_table.clear();
+    m_ids.clear();
+    m_nNamesOfSize.clear();
+    m_size = 0;
+  }
+
+private:
+  /**
+   * @brief An Interest with its selectors turned into a test of the Data name
+   */
+  struct Entry
+  {
+    /**
+     * @brief Check if the Data name, of which the name of the Interest is a prefix of nComponents
+     *        components, satisfies the selectors
+     */
+    bool
+    matches(const Name &name, size_t nComponents) const
+    {
+      // Add 1 for the implicit digest.
+      size_t nSuffixComponents = name.size() + 1 - nComponents;
+      if (nSuffixComponents < minSuffixComponents || nSuffixComponents > maxSuffixComponents)
+        return false;
+
+      return !(exclude && name.size() > nComponents &&
+               exclude->isExcluded(name.getComponentValue(nComponents),
+                                   name.getComponentValueSize(nComponents)));
+    }
+
+    uint64_t id;
+    size_t minSuffixComponents; ///< @brief 0 if the Interest has no MinSuffixComponents
+    size_t maxSuffixComponents; ///< @brief the largest size_t if the Interest has no MaxSuffixComponents
+    ptr_lib::shared_ptr<const Exclude> exclude; ///< @brief null if the Interest has no Exclude
+    T value;
+  };
+
+  typedef std::vector<Entry> EntryList;
+
+  /**
+   * @brief The Interests with the same name
+   */
+  struct Bucket
+  {
+    explicit
+    Bucket(const Name &name)
+      : name(name)
+    {
+    }
+
+    Name name;
+    EntryList entries;
+  };
+
+  /// @brief The buckets keyed by the hash of their name (see Name::getHash)
+#if NDN_CPP_HAVE_CXX11 || NDN_CPP_USE_SYSTEM_BOOST
+  typedef unordered_lib::unordered_multimap<size_t, Bucket> Table;
+#else
+  typedef std::multimap<size_t, Bucket> Table;
+#endif
+  /// @brief Elements of Table do not move when other ones are inserted or erased
+  typedef typename Table::value_type TableEntry;
+
+#if NDN_CPP_HAVE_CXX11 || NDN_CPP_USE_SYSTEM_BOOST
+  typedef unordered_lib::unordered_map<uint64_t, TableEntry*> IdIndex;
+#else
+  typedef std::map<uint64_t, TableEntry*> IdIndex;
+#endif
+
+  /**
+   * @brief Find the bucket of the prefix of name with nComponents components
+   * @param hash The hash of the prefix, name.getPrefixHash(nComponents).
+   * @return m_table.end() if there is none
+   */
+  typename Table::const_iterator
+  findBucket(const Name &name, size_t nComponents, size_t hash) const;
+
+private:
+  Table m_table;
+  IdIndex m_ids;
+  /// @brief m_nNamesOfSize[n] is the number of Interest names of n components in m_table
+  std::vector<size_t> m_nNamesOfSize;
+  size_t m_size;
+};
+
+template<class T>
+bool
+InterestMatcher<T>::insert(uint64_t id, const Interest &interest, const T &value)
+{
+  if (m_ids.find(id) != m_ids.end())
+    return false;
+
+  const Name &name = interest.getName();
+  size_t hash = name.getHash();
+  typename Table::iterator bucket = m_table.end();
+  std::pair<typename Table::iterator, typename Table::iterator> range = m_table.equal_range(hash);
+  for (typename Table::iterator i = range.first; i != range.second; ++i)
+    {
+      if (i->second.name == name)
+        {
+          bucket = i;
+          break;
+        }
+    }
+  if (bucket == m_table.end())
+    {
+      bucket = m_table.insert(std::make_pair(hash, Bucket(name)));
+      if (m_nNamesOfSize.size() <= name.size())
+        m_nNamesOfSize.resize(name.size() + 1, 0);
+      ++m_nNamesOfSize[name.size()];
+    }
+  m_ids[id] = &*bucket;
+
+  Entry entry;
+  entry.id = id;
+  entry.minSuffixComponents =
+    interest.getMinSuffixComponents() >= 0 ? interest.getMinSuffixComponents() : 0;
+  entry.maxSuffixComponents =
+    interest.getMaxSuffixComponents() >= 0 ? interest.getMaxSuffixComponents()
+                                           : std::numeric_limits<size_t>::max();
+  if (!interest.getExclude().empty())
+    entry.exclude = ptr_lib::make_shared<Exclude>(interest.getExclude());
+  entry.value = value;
+  bucket->second.entries.push_back(entry);
+
+  ++m_size;
+  return true;
+}
+
+template<class T>
+bool
+InterestMatcher<T>::erase(uint64_t id)
+{
+  typename IdIndex::iterator idEntry = m_ids.find(id);
+  if (idEntry == m_ids.end())
+    return false;
+
+  TableEntry &tableEntry = *idEntry->second;
+  m_ids.erase(idEntry);
+
+  EntryList &entries = tableEntry.second.entries;
+  for (typename EntryList::iterator i = entries.begin(); i != entries.end(); ++i)
+    {
+      if (i->id == id)
+        {
+          entries.erase(i);
+          break;
+        }
+    }
+
+  if (entries.empty())
+    {
+      --m_nNamesOfSize[tableEntry.second.name.size()];
+      std::pair<typename Table::iterator, typename Table::iterator> range =
+        m_table.equal_range(tableEntry.first);
+      for (typename Table::iterator i = range.first; i != range.second; ++i)
+        {
+          if (&*i == &tableEntry)
+            {
+              m_table.erase(i);
+              break;
+            }
+        }
+    }
+  --m_size;
+  return true;
+}
+
+template<class T>
+size_t
+InterestMatcher<T>::findMatches(const Name &name, std::vector<T> &values) const
+{
+  if (m_size == 0)
+    return 0;
+
+  size_t nValues = values.size();
+  size_t maxSize = std::min(name.size(), m_nNamesOfSize.size() - 1);
+  // hash the prefixes in one pass, so that no prefix is hashed from its first component again
+  std::vector<size_t> hashes;
+  name.getPrefixHashes(maxSize, hashes);
+  for (size_t nComponents = 0; nComponents <= maxSize; ++nComponents)
+    {
+      if (m_nNamesOfSize[nComponents] == 0)
+        continue;
+
+      typename Table::const_iterator bucket = findBucket(name, nComponents, hashes[nComponents]);
+      if (bucket == m_table.end())
+        continue;
+
+      const EntryList &entries = bucket->second.entries;
+      for (typename EntryList::const_iterator i = entries.begin(); i != entries.end(); ++i)
+        {
+          if (i->matches(name, nComponents))
+            values.push_back(i->value);
+        }
+    }
+  return values.size() - nValues;
+}
+
+template<class T>
+typename InterestMatcher<T>::Table::const_iterator
+InterestMatcher<T>::findBucket(const Name &name, size_t nComponents, size_t hash) const
+{
+  std::pair<typename Table::const_iterator, typename Table::const_iterator> range =
+    m_table.equal_range(hash);
+  for (typename Table::const_iterator i = range.first; i != range.second; ++i)
+    {
+      const Name &bucketName = i->second.name;
+      if (bucketName.size() == nComponents && name.compare(0, nComponents, bucketName) == 0)
+        return i;
+    }
+  return m_table.end();
+}
+
+template<class T>
+void
+InterestMatcher<T>::getValues(std::vector<T> &values) const
+{
+  values.reserve(values.size() + m_size);
+  for (typename Table::const_iterator bucket = m_table.begin(); bucket != m_table.end(); ++bucket)
+    {
+      const EntryList &entries = bucket->second.entries;
+      for (typename EntryList::const_iterator i = entries.begin(); i != entries.end(); ++i)
+        values.push_back(i->value);
+    }
+}
+
+} // namespace ndn
+
+#endif // NDN_INTEREST_MATCHER_HPP
@@ -0,0 +1,143 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef NDN_MPSC_QUEUE_HPP
+#define NDN_MPSC_QUEUE_HPP
+
+#include "atomic.hpp"
+
+#include <sched.h>
+
+namespace ndn {
+
+/**
+ * @brief Unbounded FIFO queue which many threads can push to without a lock while one thread pops
+ *
+ * This is the node-based MPSC queue of Dmitry Vyukov.  The entries are linked from the oldest to
+ * the newest.  push() swaps its entry in as the head with one atomic exchange, so producers never
+ * wait for each other or for the consumer, and then links the entry it replaced to the new one.
+ * pop() only reads the links from the tail, which the consumer alone changes.
+ *
+ * The values pushed by one thread are popped in the order it pushed them.  push() may be called
+ * from any thread, and pop() and empty() only from one thread at a time.
+ */
+template<class T>
+class MpscQueue
+{
+public:
+  MpscQueue();
+
+  ~MpscQueue();
+
+  /**
+   * @brief Add a copy of the value at the head of the queue
+   */
+  void
+  push(const T &value);
+
+  /**
+   * @brief Take the value at the tail of the queue
+   *
+   * If a push() has swapped its entry in but not linked it yet, this waits until it has.
+   * @return false if the queue is empty
+   */
+  bool
+  pop(T &value);
+
+  bool
+  empty() const
+  {
+    return m_head.load() == m_tail;
+  }
+
+private:
+  // not copyable
+  MpscQueue(const MpscQueue&);
+
+  MpscQueue&
+  operator=(const MpscQueue&);
+
+  struct Entry
+  {
+    Entry()
+      : next(0)
+    {
+    }
+
+    explicit
+    Entry(const T &value)
+      : next(0)
+      , value(value)
+    {
+    }
+
+    Atomic<Entry*> next;
+    T value;
+  };
+
+private:
+  /// @brief Newest entry, changed by the producers
+  Atomic<Entry*> m_head;
+  /// @brief Keeps m_head and m_tail in different cache lines
+  char m_padding[64];
+  /// @brief Entry of the value popped last (or an empty one), changed by the consumer only
+  Entry *m_tail;
+};
+
+template<class T>
+MpscQueue<T>::MpscQueue()
+  : m_tail(new Entry())
+{
+  m_head.store(m_tail);
+}
+
+template<class T>
+MpscQueue<T>::~MpscQueue()
+{
+  while (m_tail != 0)
+    {
+      Entry *next = m_tail->next.load();
+      delete m_tail;
+      m_tail = next;
+    }
+}
+
+template<class T>
+void
+MpscQueue<T>::push(const T &value)
+{
+  Entry *entry = new Entry(value);
+  Entry *previous = m_head.exchange(entry);
+  previous->next.store(entry);
+}
+
+template<class T>
+bool
+MpscQueue<T>::pop(T &value)
+{
+  Entry *next = m_tail->next.load();
+  if (next == 0)
+    {
+      if (m_head.load() == m_tail)
+        return false;
+
+      // A producer is between the exchange and the link.
+      while ((next = m_tail->next.load()) == 0)
+        sched_yield();
+    }
+
+  value = next->value;
+  // The entry is kept as the new tail, so do not keep the value alive with it.
+  next->value = T();
+  delete m_tail;
+  m_tail = next;
+  return true;
+}
+
+} // namespace ndn
+
+#endif // NDN_MPSC_QUEUE_HPP
@@ -0,0 +1,67 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef NDN_NAME_HASH_MAP_HPP
+#define NDN_NAME_HASH_MAP_HPP
+
+#include "../name.hpp"
+
+#if NDN_CPP_HAVE_CXX11
+#include <unordered_map>
+#include <unordered_set>
+#elif NDN_CPP_USE_SYSTEM_BOOST
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+#else
+#include <map>
+#include <set>
+#endif
+
+namespace ndn {
+
+#if NDN_CPP_HAVE_CXX11
+namespace unordered_lib = std;
+#elif NDN_CPP_USE_SYSTEM_BOOST
+namespace unordered_lib = boost;
+#endif
+
+/**
+ * @brief Hash table keyed by Name, using Name::Hash
+ *
+ * Each lookup hashes its key, so looking up all prefixes of a name with
+ * map.find(name.getPrefix(i)) hashes the first components once per prefix.  Name::getPrefixHashes
+ * hashes all prefixes of a name in a single pass.
+ *
+ * The boost headers included in this distribution have no usable unordered containers, so when
+ * the library is compiled without C++11 and without the system boost, this is a std::map ordered
+ * by Name::BreadthFirstLess instead.
+ */
+template<class T>
+class NameHashMap
+#if NDN_CPP_HAVE_CXX11 || NDN_CPP_USE_SYSTEM_BOOST
+  : public unordered_lib::unordered_map<Name, T, Name::Hash>
+#else
+  : public std::map<Name, T, Name::BreadthFirstLess>
+#endif
+{
+};
+
+/**
+ * @brief Hash set of Name, using Name::Hash (see NameHashMap)
+ */
+class NameHashSet
+#if NDN_CPP_HAVE_CXX11 || NDN_CPP_USE_SYSTEM_BOOST
+  : public unordered_lib::unordered_set<Name, Name::Hash>
+#else
+  : public std::set<Name, Name::BreadthFirstLess>
+#endif
+{
+};
+
+} // namespace ndn
+
+#endif // NDN_NAME_HASH_MAP_HPP
@@ -0,0 +1,507 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef NDN_NAME_TRIE_HPP
+#define NDN_NAME_TRIE_HPP
+
+#include "../name.hpp"
+
+#include <vector>
+#include <utility>
+
+namespace ndn {
+
+/**
+ * @brief Tree of names keyed by Name::Component, with a value at some of the names, which many
+ *        threads can read while one thread changes it
+ *
+ * The nodes are never changed once readers can see them.  insert() and erase() copy the nodes on
+ * the path from the root to the changed name and then publish the new root with an atomic store,
+ * so readers never take a lock on the tree and never wait for the writer.  As with RCU, the nodes
+ * of a replaced version are freed when the last reader still holding that version releases it.
+ *
+ * getSnapshot() takes the current version with one atomic load of the root.  The lookups of
+ * NameTrie take a snapshot per call, so a thread doing many lookups at once should take one
+ * Snapshot and look up with it.  The lookups only use Name::getComponentValue() and never create
+ * Component objects, so the same Name can be looked up from several threads.
+ *
+ * insert(), erase() and clear() must not be called from several threads at once.  Each of them
+ * copies the children of every node on the path, so the tree suits tables that are read much more
+ * often than they are changed, such as a FIB.  Inserting N names under one prefix thus costs
+ * O(N^2) in all.  A tree constructed with isReadByOtherThreads false, which only one thread uses,
+ * instead changes in place the nodes which no Snapshot holds, and copies only the nodes a Snapshot
+ * still holds, so that a Snapshot taken by that thread still does not change.
+ *
+ * The children of a node are kept in the NDN canonical order, and T must be default-constructible.
+ */
+template<class T>
+class NameTrie
+{
+  struct Node;
+  typedef ptr_lib::shared_ptr<const Node> NodePtr;
+
+public:
+  typedef std::vector<std::pair<Name, T> > EntryList;
+
+  /**
+   * @param isReadByOtherThreads If false, all calls are made by one thread, and insert() and
+   *        erase() change in place the nodes which no Snapshot holds.
+   */
+  explicit
+  NameTrie(bool isReadByOtherThreads = true)
+    : isReadByOtherThreads_(isReadByOtherThreads)
+  {
+  }
+
+  /**
+   * @brief One version of the tree, which does not change while it is held
+   */
+  class Snapshot
+  {
+  public:
+    Snapshot()
+    {
+    }
+
+    /**
+     * @brief Get the value of the name, 0 if it has none
+     *
+     * The value lives as long as the snapshot.
+     */
+    const T*
+    findExactMatch(const Name &name) const;
+
+    /**
+     * @brief Get the value of the longest prefix of the name (possibly the name itself) that has one
+     * @param nComponents If not 0, set to the number of components of that prefix.
+     * @return the value, or 0 if no prefix has one
+     */
+    const T*
+    findLongestPrefixMatch(const Name &name, size_t *nComponents = 0) const;
+
+    /**
+     * @brief Append the names starting with the prefix (including the prefix itself) and their
+     *        values to entries, in the NDN canonical order
+     */
+    void
+    findAllUnder(const Name &prefix, EntryList &entries) const;
+
+    /**
+     * @brief Get the number of names with a value
+     */
+    size_t
+    size() const
+    {
+      return root_ ? root_->nEntries : 0;
+    }
+
+    bool
+    empty() const
+    {
+      return !root_;
+    }
+
+  private:
+    explicit
+    Snapshot(const NodePtr &root)
+      : root_(root)
+    {
+    }
+
+    friend class NameTrie;
+
+    NodePtr root_;
+  };
+
+  /**
+   * @brief Get the current version of the tree
+   */
+  Snapshot
+  getSnapshot() const
+  {
+    return Snapshot(ptr_lib::atomic_load(&root_));
+  }
+
+  /**
+   * @brief Copy the value of the name to value
+   * @return false if the name has no value
+   */
+  bool
+  findExactMatch(const Name &name, T &value) const;
+
+  /**
+   * @brief Copy the value of the longest prefix of the name that has one to value
+   * @param nComponents If not 0, set to the number of components of that prefix.
+   * @return false if no prefix has a value
+   */
+  bool
+  findLongestPrefixMatch(const Name &name, T &value, size_t *nComponents = 0) const;
+
+  /**
+   * @see Snapshot::findAllUnder
+   */
+  void
+  findAllUnder(const Name &prefix, EntryList &entries) const
+  {
+    getSnapshot().findAllUnder(prefix, entries);
+  }
+
+  size_t
+  size() const
+  {
+    return getSnapshot().size();
+  }
+
+  bool
+  empty() const
+  {
+    return getSnapshot().empty();
+  }
+
+  /**
+   * @brief Set the value of the name, replacing the value it has
+   * @return true if the name had no value
+   */
+  bool
+  insert(const Name &name, const T &value);
+
+  /**
+   * @brief Remove the value of the name
+   * @return false if the name had no value
+   */
+  bool
+  erase(const Name &name);
+
+  void
+  clear()
+  {
+    ptr_lib::atomic_store(&root_, NodePtr());
+  }
+
+private:
+  struct Node
+  {
+    typedef std::vector<std::pair<Name::Component, NodePtr> > ChildList;
+
+    Node()
+      : hasValue(false)
+      , value()
+      , nEntries(0)
+    {
+    }
+
+    ChildList children; ///< @brief sorted by component
+    bool hasValue;
+    T value;
+    size_t nEntries; ///< @brief number of names with a value in the subtree, never 0 in a tree
+  };
+
+  /**
+   * @brief Get the index of the first child whose component is not less than the component i of name
+   */
+  static size_t
+  findChildIndex(const Node &node, const Name &name, size_t i);
+
+  /**
+   * @brief Get the child for the component i of name, 0 if none
+   */
+  static const Node*
+  findChild(const Node &node, const Name &name, size_t i);
+
+  /**
+   * @brief Compare the component i of name with the component in the NDN canonical order
+   */
+  static int
+  compareComponent(const Name &name, size_t i, const Name::Component &component);
+
+  /**
+   * @brief Get a node to change instead of node: node itself if canChangeInPlace and nothing else
+   *        holds it, otherwise a copy of it (or a new node if node is null)
+   * @param canChangeInPlace true if the tree is used by one thread and every node on the path to
+   *        node was changed in place, so that no Snapshot can reach node through another node.
+   */
+  static ptr_lib::shared_ptr<Node>
+  makeWritable(const NodePtr &node, bool canChangeInPlace);
+
+  /**
+   * @brief Copy the node (or create it if null) and set the value of the suffix of name from i under it
+   */
+  static NodePtr
+  insert(const NodePtr &node, const Name &name, size_t i, const T &value, bool canChangeInPlace,
+         bool &isNew);
+
+  /**
+   * @brief Copy the node without the value of the suffix of name from i
+   * @return the node itself if the suffix has no value, a null pointer if nothing is left
+   */
+  static NodePtr
+  erase(const NodePtr &node, const Name &name, size_t i, bool canChangeInPlace, bool &isErased);
+
+  static void
+  appendEntries(const Node &node, const Name &name, EntryList &entries);
+
+private:
+  /// @brief Read and written only with atomic_load and atomic_store, a null pointer when empty
+  NodePtr root_;
+  bool isReadByOtherThreads_;
+};
+
+template<class T>
+inline int
+NameTrie<T>::compareComponent(const Name &name, size_t i, const Name::Component &component)
+{
+  size_t size = name.getComponentValueSize(i);
+  const Buffer &value = component.getValue();
+  if (size != value.size())
+    return size < value.size() ? -1 : 1;
+  return size == 0 ? 0 : memcmp(name.getComponentValue(i), value.buf(), size);
+}
+
+template<class T>
+inline size_t
+NameTrie<T>::findChildIndex(const Node &node, const Name &name, size_t i)
+{
+  size_t low = 0;
+  size_t high = node.children.size();
+  while (low < high)
+    {
+      size_t middle = low + (high - low) / 2;
+      if (compareComponent(name, i, node.children[middle].first) > 0)
+        low = middle + 1;
+      else
+        high = middle;
+    }
+  return low;
+}
+
+template<class T>
+inline const typename NameTrie<T>::Node*
+NameTrie<T>::findChild(const Node &node, const Name &name, size_t i)
+{
+  size_t j = findChildIndex(node, name, i);
+  if (j < node.children.size() && compareComponent(name, i, node.children[j].first) == 0)
+    return node.children[j].second.get();
+  else
+    return 0;
+}
+
+template<class T>
+const T*
+NameTrie<T>::Snapshot::findExactMatch(const Name &name) const
+{
+  const Node *node = root_.get();
+  for (size_t i = 0; node != 0 && i < name.size(); ++i)
+    node = findChild(*node, name, i);
+
+  return node != 0 && node->hasValue ? &node->value : 0;
+}
+
+template<class T>
+const T*
+NameTrie<T>::Snapshot::findLongestPrefixMatch(const Name &name, size_t *nComponents/* = 0*/) const
+{
+  const T *match = 0;
+  size_t nMatched = 0;
+  const Node *node = root_.get();
+  for (size_t i = 0; node != 0; ++i)
+    {
+      if (node->hasValue)
+        {
+          match = &node->value;
+          nMatched = i;
+        }
+      if (i == name.size())
+        break;
+      node = findChild(*node, name, i);
+    }
+
+  if (nComponents != 0)
+    *nComponents = nMatched;
+  return match;
+}
+
+template<class T>
+void
+NameTrie<T>::Snapshot::findAllUnder(const Name &prefix, EntryList &entries) const
+{
+  const Node *node = root_.get();
+  for (size_t i = 0; node != 0 && i < prefix.size(); ++i)
+    node = findChild(*node, prefix, i);
+
+  if (node != 0)
+    {
+      entries.reserve(entries.size() + node->nEntries);
+      appendEntries(*node, prefix, entries);
+    }
+}
+
+template<class T>
+void
+NameTrie<T>::appendEntries(const Node &node, const Name &name, EntryList &entries)
+{
+  if (node.hasValue)
+    entries.push_back(std::make_pair(name, node.value));
+
+  for (size_t i = 0; i < node.children.size(); ++i)
+    {
+      // The child name shares the components of name and stores only the new one.
+      Name childName(name);
+      childName.append(node.children[i].first);
+      appendEntries(*node.children[i].second, childName, entries);
+    }
+}
+
+template<class T>
+bool
+NameTrie<T>::findExactMatch(const Name &name, T &value) const
+{
+  Snapshot snapshot = getSnapshot();
+  const T *match = snapshot.findExactMatch(name);
+  if (match == 0)
+    return false;
+
+  value = *match;
+  return true;
+}
+
+template<class T>
+bool
+NameTrie<T>::findLongestPrefixMatch(const Name &name, T &value, size_t *nComponents/* = 0*/) const
+{
+  Snapshot snapshot = getSnapshot();
+  const T *match = snapshot.findLongestPrefixMatch(name, nComponents);
+  if (match == 0)
+    return false;
+
+  value = *match;
+  return true;
+}
+
+template<class T>
+bool
+NameTrie<T>::insert(const Name &name, const T &value)
+{
+  bool isNew = false;
+  NodePtr root;
+  if (isReadByOtherThreads_)
+    root = insert(ptr_lib::atomic_load(&root_), name, 0, value, false, isNew);
+  else
+    // without taking a reference to the root, so that it can be changed in place
+    root = insert(root_, name, 0, value, true, isNew);
+  ptr_lib::atomic_store(&root_, root);
+  return isNew;
+}
+
+template<class T>
+bool
+NameTrie<T>::erase(const Name &name)
+{
+  bool isErased = false;
+  NodePtr root;
+  if (isReadByOtherThreads_)
+    root = erase(ptr_lib::atomic_load(&root_), name, 0, false, isErased);
+  else
+    root = erase(root_, name, 0, true, isErased);
+  if (isErased)
+    ptr_lib::atomic_store(&root_, root);
+  return isErased;
+}
+
+template<class T>
+ptr_lib::shared_ptr<typename NameTrie<T>::Node>
+NameTrie<T>::makeWritable(const NodePtr &node, bool canChangeInPlace)
+{
+  if (!node)
+    return ptr_lib::make_shared<Node>();
+  // Only the parent of the node (or root_) holds it, so no Snapshot can see it.
+  if (canChangeInPlace && node.unique())
+    return ptr_lib::const_pointer_cast<Node>(node);
+  return ptr_lib::make_shared<Node>(*node);
+}
+
+template<class T>
+typename NameTrie<T>::NodePtr
+NameTrie<T>::insert(const NodePtr &node, const Name &name, size_t i, const T &value,
+                    bool canChangeInPlace, bool &isNew)
+{
+  ptr_lib::shared_ptr<Node> copy = makeWritable(node, canChangeInPlace);
+  // The children of a copy are held by node too, so they are copied as well.
+  canChangeInPlace = copy == node;
+
+  if (i == name.size())
+    {
+      isNew = !copy->hasValue;
+      copy->hasValue = true;
+      copy->value = value;
+    }
+  else
+    {
+      typename Node::ChildList &children = copy->children;
+      size_t j = findChildIndex(*copy, name, i);
+      if (j < children.size() && compareComponent(name, i, children[j].first) == 0)
+        children[j].second = insert(children[j].second, name, i + 1, value, canChangeInPlace, isNew);
+      else
+        {
+          Name::Component component(name.getComponentValue(i), name.getComponentValueSize(i));
+          children.insert(children.begin() + j,
+                          std::make_pair(component,
+                                         insert(NodePtr(), name, i + 1, value, false, isNew)));
+        }
+    }
+
+  if (isNew)
+    ++copy->nEntries;
+  return copy;
+}
+
+template<class T>
+typename NameTrie<T>::NodePtr
+NameTrie<T>::erase(const NodePtr &node, const Name &name, size_t i, bool canChangeInPlace,
+                   bool &isErased)
+{
+  if (!node)
+    return node;
+
+  canChangeInPlace = canChangeInPlace && node.unique();
+
+  ptr_lib::shared_ptr<Node> copy;
+  if (i == name.size())
+    {
+      if (!node->hasValue)
+        return node;
+
+      copy = makeWritable(node, canChangeInPlace);
+      copy->hasValue = false;
+      copy->value = T();
+    }
+  else
+    {
+      size_t j = findChildIndex(*node, name, i);
+      if (j == node->children.size() || compareComponent(name, i, node->children[j].first) != 0)
+        return node;
+
+      NodePtr child = erase(node->children[j].second, name, i + 1, canChangeInPlace, isErased);
+      if (!isErased)
+        return node;
+
+      copy = makeWritable(node, canChangeInPlace);
+      if (child)
+        copy->children[j].second = child;
+      else
+        copy->children.erase(copy->children.begin() + j);
+    }
+
+  isErased = true;
+  if (--copy->nEntries == 0)
+    // no value is left under the node
+    return NodePtr();
+  return copy;
+}
+
+} // namespace ndn
+
+#endif // NDN_NAME_TRIE_HPP
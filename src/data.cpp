@@ -7,49 +7,99 @@
 
 #include <ndn-cpp/common.hpp>
 #include <ndn-cpp/data.hpp>
+#include <ndn-cpp/encoding/tlv-schema.hpp>
 
 using namespace std;
 
 namespace ndn {
 
-const Block& 
-Data::wireEncode() const
+/**
+ * @brief Codec of the SignatureInfo, which is kept in the Signature
+ */
+struct Data::SignatureInfoCodec
 {
-  if (wire_.hasWire())
-    return wire_;
-
-  // Data ::= DATA-TLV TLV-LENGTH
-  //            Name
-  //            MetaInfo
-  //            Content
-  //            Signature
-  
-  wire_ = Block(Tlv::Data);
+  static void
+  decode(Data &data, const Block &parent, const TlvReader &element)
+  {
+    data.signature_.setInfo(parent.slice(element.wire(), element.size()));
+  }
 
-  // Name
-  wire_.push_back(getName().wireEncode());
+  template<bool T>
+  static size_t
+  encode(EncodingImpl<T> &block, uint32_t type, const Data &data)
+  {
+    return prependBlock(block, data.signature_.getInfo());
+  }
+};
 
-  // MetaInfo
-  wire_.push_back(getMetaInfo().wireEncode());
+/**
+ * @brief Codec of the SignatureValue, which is kept in the Signature
+ */
+struct Data::SignatureValueCodec
+{
+  static void
+  decode(Data &data, const Block &parent, const TlvReader &element)
+  {
+    data.signature_.setValue(parent.slice(element.wire(), element.size()));
+  }
 
-  // Content
-  wire_.push_back(getContent());
+  template<bool T>
+  static size_t
+  encode(EncodingImpl<T> &block, uint32_t type, const Data &data)
+  {
+    return prependBlock(block, data.signature_.getValue());
+  }
+};
+
+// Data ::= DATA-TLV TLV-LENGTH
+//            Name
+//            MetaInfo
+//            Content
+//            Signature
+class Data::Schema : public TlvSchema<Data,
+  TlvField<Tlv::Name,           TLV_REQUIRED, TlvNested<Data, Name, &Data::name_> >,
+  TlvField<Tlv::MetaInfo,       TLV_REQUIRED, TlvNested<Data, MetaInfo, &Data::metaInfo_> >,
+  TlvField<Tlv::Content,        TLV_REQUIRED, TlvBlock<Data, &Data::content_> >,
+  TlvField<Tlv::SignatureInfo,  TLV_REQUIRED, Data::SignatureInfoCodec>,
+  TlvField<Tlv::SignatureValue, TLV_REQUIRED, Data::SignatureValueCodec>
+  >
+{
+};
 
+template<bool T>
+size_t
+Data::wireEncode(EncodingImpl<T> &block) const
+{
   if (!signature_) {
     throw Error("Requested wire format, but data packet has not been signed yet");
   }
 
-  ///////////////
-  // Signature //
-  ///////////////
-  
-  // SignatureInfo
-  wire_.push_back(signature_.getInfo());
-  
-  // SignatureValue
-  wire_.push_back(signature_.getValue());
-  
-  wire_.encode();
+  size_t totalLength = Schema::encode(block, *this);
+
+  totalLength += block.prependVarNumber(totalLength);
+  totalLength += block.prependVarNumber(Tlv::Data);
+  return totalLength;
+}
+
+template size_t
+Data::wireEncode<true>(EncodingImpl<true> &block) const;
+
+template size_t
+Data::wireEncode<false>(EncodingImpl<false> &block) const;
+
+const Block& 
+Data::wireEncode() const
+{
+  if (wire_.hasWire())
+    return wire_;
+
+  EncodingEstimator estimator;
+  size_t estimatedSize = wireEncode(estimator);
+
+  EncodingBuffer buffer(estimatedSize, 0);
+  wireEncode(buffer);
+
+  wire_ = buffer.block();
   return wire_;  
 }
   
@@ -61,32 +111,8 @@ void
 Data::wireDecode(const Block &wire)
 {
   wire_ = wire;
-  wire_.parse();
-
-  // Data ::= DATA-TLV TLV-LENGTH
-  //            Name
-  //            MetaInfo
-  //            Content
-  //            Signature
-    
-  // Name
-  name_.wireDecode(wire_.get(Tlv::Name));
-
-  // MetaInfo
-  metaInfo_.wireDecode(wire_.get(Tlv::MetaInfo));
-
-  // Content
-  content_ = wire_.get(Tlv::Content);
-
-  ///////////////
-  // Signature //
-  ///////////////
-  
-  // SignatureInfo
-  signature_.setInfo(wire_.get(Tlv::SignatureInfo));
-  
-  // SignatureValue
-  signature_.setValue(wire_.get(Tlv::SignatureValue));
+
+  Schema::decode(*this, wire_);
 }
 
 std::ostream&
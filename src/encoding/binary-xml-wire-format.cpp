@@ -32,16 +32,16 @@ public:
       throw runtime_error("excludeStruct.maxEntries must be >= this exclude getEntryCount()");
 
     int entries = 0;
-    for (Exclude::const_reverse_iterator i = rbegin (); i != rend (); i++)
+    for (size_t i = 0; i < size(); i++)
       {
-        if (!i->first.empty())
+        if (getComponentValueSize(i) > 0)
           {
             excludeStruct.entries[entries].type = ndn_Exclude_COMPONENT;
-            excludeStruct.entries[entries].component.value.value = const_cast<uint8_t*>(i->first.getValue().buf());
-            excludeStruct.entries[entries].component.value.length = i->first.getValue().size();
+            excludeStruct.entries[entries].component.value.value = const_cast<uint8_t*>(getComponentValue(i));
+            excludeStruct.entries[entries].component.value.length = getComponentValueSize(i);
             ++entries;
           }
-        if (i->second)
+        if (hasAnyAfter(i))
           {
             excludeStruct.entries[entries].type = ndn_Exclude_ANY;
             ++entries;
@@ -61,7 +61,7 @@ public:
 
     int i = 0;
     if (excludeStruct.entries[i].type == ndn_Exclude_ANY) {
-      appendExclude("/", true);
+      appendExclude(0, 0, true);
       i++;
     }
 
@@ -71,20 +71,21 @@ public:
       if (entry->type != ndn_Exclude_COMPONENT)
         throw runtime_error("unrecognized ndn_ExcludeType");
 
-      Name::Component excludedComponent (entry->component.value.value, entry->component.value.length);
+      const uint8_t *value = entry->component.value.value;
+      size_t valueSize = entry->component.value.length;
       ++i;
       entry = &excludeStruct.entries[i];
 
       if (i < excludeStruct.nEntries) {
         if (entry->type == ndn_Exclude_ANY) {
-          appendExclude(excludedComponent, true);
+          appendExclude(value, valueSize, true);
           ++i;
         }
         else
-          appendExclude(excludedComponent, false);
+          appendExclude(value, valueSize, false);
       }
       else
-        appendExclude(excludedComponent, false);
+        appendExclude(value, valueSize, false);
     }
   }
 };
@@ -9,12 +9,24 @@
 
 #include <ndn-cpp/encoding/block.hpp>
 #include <ndn-cpp/encoding/tlv.hpp>
+#include <ndn-cpp/encoding/encoding-buffer.hpp>
+
+#include <string.h>
 
 namespace ndn {
 
+const uint32_t Block::INDEXED_TYPE_LIMIT;
+const size_t Block::MAX_INDEXED_POSITION;
+
 Block::Block()
   : m_type(std::numeric_limits<uint32_t>::max())
+  , m_begin(0)
+  , m_end(0)
+  , m_size(0)
+  , m_value_begin(0)
+  , m_value_end(0)
 {
+  clearIndex();
 }
 
 Block::Block(const ConstBufferPtr &wire,
@@ -23,34 +35,42 @@ Block::Block(const ConstBufferPtr &wire,
              const Buffer::const_iterator &valueBegin, Buffer::const_iterator &valueEnd)
   : m_buffer(wire)
   , m_type(type)
-  , m_begin(begin)
-  , m_end(end)
+  , m_begin(begin - wire->begin())
+  , m_end(end - wire->begin())
   , m_size(m_end - m_begin)
-  , m_value_begin(valueBegin)
-  , m_value_end(valueEnd)
+  , m_value_begin(valueBegin - wire->begin())
+  , m_value_end(valueEnd - wire->begin())
 {
+  clearIndex();
 }
 
 Block::Block(const ConstBufferPtr &buffer)
   : m_buffer(buffer)
-  , m_begin(m_buffer->begin())
-  , m_end(m_buffer->end())
+  , m_begin(0)
+  , m_end(buffer->size())
   , m_size(m_end - m_begin)
 {
-  m_value_begin = m_buffer->begin();
-  m_value_end   = m_buffer->end();
+  clearIndex();
+
+  Buffer::const_iterator valueBegin = m_buffer->begin();
+  Buffer::const_iterator valueEnd = m_buffer->end();
   
-  m_type = Tlv::readType(m_value_begin, m_value_end);
+  m_type = Tlv::readType(valueBegin, valueEnd);
 
-  uint64_t length = Tlv::readVarNumber(m_value_begin, m_value_end);
-  if (length != (m_value_end - m_value_begin))
+  uint64_t length = Tlv::readVarNumber(valueBegin, valueEnd);
+  if (length != (valueEnd - valueBegin))
     {
       throw Tlv::Error("TLV length doesn't match buffer length");
     }
+
+  m_value_begin = valueBegin - m_buffer->begin();
+  m_value_end = m_end;
 }
 
 Block::Block(const uint8_t *buffer, size_t maxlength)
 {
+  clearIndex();
+
   const uint8_t * tmp_begin = buffer;
   const uint8_t * tmp_end   = buffer + maxlength;  
   
@@ -62,20 +82,23 @@ Block::Block(const uint8_t *buffer, size_t maxlength)
       throw Tlv::Error("Not enough data in the buffer to fully parse TLV");
     }
 
-  m_buffer = ptr_lib::make_shared<Buffer> (buffer, (tmp_begin - buffer) + length);
+  size_t size = (tmp_begin - buffer) + length;
+  m_buffer = allocateBuffer(buffer, size);
 
-  m_begin = m_buffer->begin();
-  m_end = m_buffer->end();
-  m_size = m_end - m_begin;
+  m_begin = 0;
+  m_end = size;
+  m_size = size;
 
-  m_value_begin = m_buffer->begin() + (tmp_begin - buffer);
-  m_value_end   = m_buffer->end();
+  m_value_begin = tmp_begin - buffer;
+  m_value_end   = size;
 }
 
 Block::Block(const void *bufferX, size_t maxlength)
 {
   const uint8_t * buffer = reinterpret_cast<const uint8_t*>(bufferX);
   
+  clearIndex();
+
   const uint8_t * tmp_begin = buffer;
   const uint8_t * tmp_end   = buffer + maxlength;  
   
@@ -87,40 +110,73 @@ Block::Block(const void *bufferX, size_t maxlength)
       throw Tlv::Error("Not enough data in the buffer to fully parse TLV");
     }
 
-  m_buffer = ptr_lib::make_shared<Buffer> (buffer, (tmp_begin - buffer) + length);
+  size_t size = (tmp_begin - buffer) + length;
+  m_buffer = allocateBuffer(buffer, size);
 
-  m_begin = m_buffer->begin();
-  m_end = m_buffer->end();
-  m_size = m_end - m_begin;
+  m_begin = 0;
+  m_end = size;
+  m_size = size;
 
-  m_value_begin = m_buffer->begin() + (tmp_begin - buffer);
-  m_value_end   = m_buffer->end();
+  m_value_begin = tmp_begin - buffer;
+  m_value_end   = size;
 }
 
 Block::Block(uint32_t type)
   : m_type(type)
+  , m_begin(0)
+  , m_end(0)
+  , m_size(0)
+  , m_value_begin(0)
+  , m_value_end(0)
 {
+  clearIndex();
 }
 
 Block::Block(uint32_t type, const ConstBufferPtr &value)
   : m_buffer(value)
   , m_type(type)
-  , m_begin(m_buffer->end())
-  , m_end(m_buffer->end())
-  , m_value_begin(m_buffer->begin())
-  , m_value_end(m_buffer->end())
+  , m_begin(value->size())
+  , m_end(value->size())
+  , m_value_begin(0)
+  , m_value_end(value->size())
 {
+  clearIndex();
   m_size = Tlv::sizeOfVarNumber(m_type) + Tlv::sizeOfVarNumber(value_size()) + value_size();
 }
 
+Block::Block(uint32_t type, const uint8_t *value, size_t valueSize)
+  : m_type(type)
+{
+  clearIndex();
+
+  size_t valueOffset = Tlv::sizeOfVarNumber(type) + Tlv::sizeOfVarNumber(valueSize);
+  size_t size = valueOffset + valueSize;
+
+  BufferPtr buffer = allocateBuffer(size);
+  m_buffer = buffer;
+
+  uint8_t *i = buffer->buf();
+  i += Tlv::writeVarNumber(i, type);
+  i += Tlv::writeVarNumber(i, valueSize);
+  if (valueSize > 0)
+    memcpy(i, value, valueSize);
+
+  m_begin = 0;
+  m_end = size;
+  m_size = size;
+  m_value_begin = valueOffset;
+  m_value_end = size;
+}
+
 Block::Block(uint32_t type, const Block &value)
-  : m_buffer(value.m_buffer)
+  : m_buffer(value.sharedBuffer())
   , m_type(type)
-  , m_begin(m_buffer->end())
-  , m_end(m_buffer->end())
-  , m_value_begin(m_buffer->begin())
-  , m_value_end(m_buffer->end())
+  , m_begin(m_buffer->size())
+  , m_end(m_buffer->size())
+  , m_value_begin(0)
+  , m_value_end(m_buffer->size())
 {
+  clearIndex();
   m_size = Tlv::sizeOfVarNumber(m_type) + Tlv::sizeOfVarNumber(value_size()) + value_size();
 }
 
@@ -130,81 +186,127 @@ Block::parse()
   if (!m_subBlocks.empty() || value_size()==0)
     return;
   
-  Buffer::const_iterator begin = value_begin(),
-    end = value_end();
+  const uint8_t *begin = value();
+  const uint8_t *end = begin + value_size();
 
+  // First pass only validates the framing and counts the sub-elements, so the
+  // container can be allocated exactly once
+  size_t nElements = 0;
   while (begin != end)
     {
-      Buffer::const_iterator element_begin = begin;
-      
-      uint32_t type = Tlv::readType(begin, end);
+      Tlv::readType(begin, end);
       uint64_t length = Tlv::readVarNumber(begin, end);
 
-      if (end-begin < length)
+      if (static_cast<uint64_t>(end - begin) < length)
         {
-          m_subBlocks.clear();
           throw Tlv::Error("TLV length exceeds buffer length");
         }
-      Buffer::const_iterator element_end = begin + length;
+      begin += length;
+      ++nElements;
+    }
+
+  m_subBlocks.reserve(nElements);
+  clearIndex();
+
+  begin = value();
+  while (begin != end)
+    {
+      const uint8_t *element_begin = begin;
       
-      m_subBlocks.push_back(Block(m_buffer,
-                                  type,
-                                  element_begin, element_end,
-                                  begin, element_end));
+      uint32_t type = Tlv::readType(begin, end);
+      uint64_t length = Tlv::readVarNumber(begin, end);
+
+      const uint8_t *element_end = begin + length;
+
+      m_subBlocks.push_back(makeSubBlock(type, element_begin, begin, element_end));
+      indexElement(m_subBlocks.size() - 1);
 
       begin = element_end;
       // don't do recursive parsing, just the top level
     }
 }
 
+Block
+Block::slice(const uint8_t *wire, size_t size) const
+{
+  const uint8_t *begin = wire;
+  const uint8_t *end = wire + size;
+
+  uint32_t type = Tlv::readType(begin, end);
+  uint64_t length = Tlv::readVarNumber(begin, end);
+  if (static_cast<uint64_t>(end - begin) < length)
+    {
+      throw Tlv::Error("TLV length exceeds buffer length");
+    }
+
+  return makeSubBlock(type, wire, begin, begin + length);
+}
+
+Block
+Block::makeSubBlock(uint32_t type, const uint8_t *wire, const uint8_t *valueBegin, const uint8_t *end) const
+{
+  const uint8_t *base = storage();
+  Buffer::const_iterator wireBegin = m_buffer->begin() + (wire - base);
+  Buffer::const_iterator wireEnd = m_buffer->begin() + (end - base);
+  Buffer::const_iterator valueIterator = m_buffer->begin() + (valueBegin - base);
+
+  return Block(m_buffer,
+               type,
+               wireBegin, wireEnd,
+               valueIterator, wireEnd);
+}
+
+Block::element_container
+Block::getAll(uint32_t type) const
+{
+  element_container result;
+  for (element_const_iterator i = m_subBlocks.begin(); i != m_subBlocks.end(); ++i)
+    {
+      if (i->type() == type)
+        result.push_back(*i);
+    }
+  return result;
+}
+
+void
+Block::rebuildIndex()
+{
+  clearIndex();
+  for (size_t i = 0; i < m_subBlocks.size() && i < MAX_INDEXED_POSITION; ++i)
+    indexElement(i);
+}
+
 void
 Block::encode()
 {
   if (hasWire())
     return;
 
-  OBufferStream os;
-  Tlv::writeVarNumber(os, type());
+  EncodingEstimator estimator;
+  size_t totalLength = prependBlock(estimator, *this);
 
-  if (hasValue())
-    {
-      Tlv::writeVarNumber(os, value_size());
-      os.write(reinterpret_cast<const char*>(value()), value_size());
-    }
-  else
-    {
-      size_t valueSize = 0;
-      for (element_const_iterator i = m_subBlocks.begin(); i != m_subBlocks.end(); ++i) {
-        valueSize += i->size();
-      }
-  
-      Tlv::writeVarNumber(os, valueSize);
-
-      for (element_const_iterator i = m_subBlocks.begin(); i != m_subBlocks.end(); ++i) {
-        if (i->hasWire())
-          os.write(reinterpret_cast<const char*>(i->wire()), i->size());
-        else if (i->hasValue()) {
-          Tlv::writeVarNumber(os, i->type());
-          Tlv::writeVarNumber(os, i->value_size());
-          os.write(reinterpret_cast<const char*>(i->value()), i->value_size());
-        }
-        else
-          throw Error("Underlying value buffer is empty");
-      }
-    }
+  EncodingBuffer encoder(totalLength, 0);
+  prependBlock(encoder, *this);
 
   // now assign correct block
 
-  m_buffer = os.buf();
-  m_begin = m_buffer->begin();
-  m_end   = m_buffer->end();
-  m_size  = m_end - m_begin;
+  Block wire = encoder.block();
+  bool isNested = !hasValue();
 
-  m_value_begin = m_buffer->begin();
-  m_value_end   = m_buffer->end();
-  
-  Tlv::readType(m_value_begin, m_value_end);
-  Tlv::readVarNumber(m_value_begin, m_value_end);
+  m_buffer = wire.m_buffer;
+  m_begin = wire.m_begin;
+  m_end   = wire.m_end;
+  m_size  = wire.m_size;
+
+  m_value_begin = wire.m_value_begin;
+  m_value_end   = wire.m_value_end;
+
+  if (isNested)
+    {
+      // sub-elements reference the new wire instead of keeping their own buffers
+      m_subBlocks.clear();
+      parse();
+    }
 }
 
 } // namespace ndn
@@ -0,0 +1,283 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include <ndn-cpp/encoding/buffer-pool.hpp>
+
+#include <algorithm>
+#include <new>
+
+namespace ndn {
+
+const size_t BufferPool::MIN_POOLED_SIZE;
+const size_t BufferPool::MAX_POOLED_SIZE;
+const size_t BufferPool::N_SIZE_CLASSES;
+
+/**
+ * Size of the pooled shared_ptr control blocks (larger ones are allocated as usual)
+ */
+static const size_t CONTROL_BLOCK_SIZE = 64;
+
+#if NDN_CPP_HAVE_CXX11
+static thread_local BufferPool *g_installedPool = 0;
+#else
+static __thread BufferPool *g_installedPool = 0;
+#endif
+
+/**
+ * @brief Deleter of pooled buffers, gives the buffer to the pool installed in the releasing thread
+ */
+class BufferPool::Deleter
+{
+public:
+  void
+  operator()(Buffer *buffer) const
+  {
+    if (g_installedPool != 0)
+      g_installedPool->release(buffer);
+    else
+      delete buffer;
+  }
+};
+
+/**
+ * @brief Allocator of shared_ptr control blocks for pooled buffers
+ *
+ * Like the buffers, released control blocks go to the pool installed in the releasing thread
+ */
+template<class T>
+class BufferPool::ControlBlockAllocator
+{
+public:
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  template<class U>
+  struct rebind
+  {
+    typedef ControlBlockAllocator<U> other;
+  };
+
+  ControlBlockAllocator()
+  {
+  }
+
+  template<class U>
+  ControlBlockAllocator(const ControlBlockAllocator<U>&)
+  {
+  }
+
+  pointer
+  allocate(size_type n, const void* = 0)
+  {
+    if (g_installedPool != 0)
+      return static_cast<pointer>(g_installedPool->allocateControlBlock(n * sizeof(T)));
+
+    return static_cast<pointer>(::operator new(std::max(n * sizeof(T), CONTROL_BLOCK_SIZE)));
+  }
+
+  void
+  deallocate(pointer p, size_type n)
+  {
+    if (g_installedPool != 0)
+      g_installedPool->releaseControlBlock(p, n * sizeof(T));
+    else
+      ::operator delete(p);
+  }
+
+  void
+  construct(pointer p, const T &value)
+  {
+    new (p) T(value);
+  }
+
+  void
+  destroy(pointer p)
+  {
+    p->~T();
+  }
+
+  size_type
+  max_size() const
+  {
+    return static_cast<size_type>(-1) / sizeof(T);
+  }
+
+  template<class U>
+  bool
+  operator==(const ControlBlockAllocator<U>&) const
+  {
+    return true;
+  }
+
+  template<class U>
+  bool
+  operator!=(const ControlBlockAllocator<U>&) const
+  {
+    return false;
+  }
+};
+
+BufferPool::BufferPool(size_t maxCachedPerClass/* = 256*/)
+  : m_maxCachedPerClass(maxCachedPerClass)
+  , m_nAllocations(0)
+  , m_nHits(0)
+{
+}
+
+BufferPool::~BufferPool()
+{
+  if (g_installedPool == this)
+    g_installedPool = 0;
+
+  for (size_t i = 0; i < N_SIZE_CLASSES; ++i)
+    {
+      for (size_t j = 0; j < m_buffers[i].size(); ++j)
+        delete m_buffers[i][j];
+    }
+
+  for (size_t i = 0; i < m_controlBlocks.size(); ++i)
+    ::operator delete(m_controlBlocks[i]);
+}
+
+size_t
+BufferPool::getSizeClass(size_t size)
+{
+  size_t sizeClass = 0;
+  while ((MIN_POOLED_SIZE << sizeClass) < size)
+    ++sizeClass;
+  return sizeClass;
+}
+
+BufferPtr
+BufferPool::allocate(size_t size)
+{
+  ++m_nAllocations;
+  if (size > MAX_POOLED_SIZE)
+    return ptr_lib::make_shared<Buffer>(size);
+
+  size_t sizeClass = getSizeClass(size);
+
+  Buffer *buffer;
+  if (!m_buffers[sizeClass].empty())
+    {
+      ++m_nHits;
+      buffer = m_buffers[sizeClass].back();
+      m_buffers[sizeClass].pop_back();
+
+      // a reused buffer keeps its capacity, so this only fills it with zeros
+      buffer->clear();
+      buffer->resize(size, 0);
+    }
+  else
+    {
+      buffer = new Buffer();
+      buffer->reserve(MIN_POOLED_SIZE << sizeClass);
+      buffer->resize(size, 0);
+    }
+
+  return BufferPtr(buffer, Deleter(), ControlBlockAllocator<Buffer>());
+}
+
+void
+BufferPool::release(Buffer *buffer)
+{
+  size_t capacity = buffer->capacity();
+  if (capacity >= MIN_POOLED_SIZE && capacity <= MAX_POOLED_SIZE)
+    {
+      // the largest class whose size the buffer can hold
+      size_t sizeClass = getSizeClass(capacity);
+      if ((MIN_POOLED_SIZE << sizeClass) > capacity)
+        --sizeClass;
+
+      if (m_buffers[sizeClass].size() < m_maxCachedPerClass)
+        {
+          m_buffers[sizeClass].push_back(buffer);
+          return;
+        }
+    }
+
+  delete buffer;
+}
+
+void*
+BufferPool::allocateControlBlock(size_t size)
+{
+  if (size > CONTROL_BLOCK_SIZE)
+    return ::operator new(size);
+
+  if (m_controlBlocks.empty())
+    return ::operator new(CONTROL_BLOCK_SIZE);
+
+  void *block = m_controlBlocks.back();
+  m_controlBlocks.pop_back();
+  return block;
+}
+
+void
+BufferPool::releaseControlBlock(void *block, size_t size)
+{
+  if (size <= CONTROL_BLOCK_SIZE && m_controlBlocks.size() < m_maxCachedPerClass * N_SIZE_CLASSES)
+    m_controlBlocks.push_back(block);
+  else
+    ::operator delete(block);
+}
+
+uint64_t
+BufferPool::getNAllocations() const
+{
+  return m_nAllocations;
+}
+
+uint64_t
+BufferPool::getNHits() const
+{
+  return m_nHits;
+}
+
+double
+BufferPool::getHitRate() const
+{
+  if (m_nAllocations == 0)
+    return 0;
+
+  return static_cast<double>(m_nHits) / m_nAllocations;
+}
+
+size_t
+BufferPool::getNCached() const
+{
+  size_t nCached = 0;
+  for (size_t i = 0; i < N_SIZE_CLASSES; ++i)
+    nCached += m_buffers[i].size();
+  return nCached;
+}
+
+void
+BufferPool::resetStatistics()
+{
+  m_nAllocations = 0;
+  m_nHits = 0;
+}
+
+void
+BufferPool::install(BufferPool *pool)
+{
+  g_installedPool = pool;
+}
+
+BufferPool*
+BufferPool::getInstalled()
+{
+  return g_installedPool;
+}
+
+} // namespace ndn
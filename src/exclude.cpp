@@ -9,117 +9,454 @@
  */
 
 #include <ndn-cpp/exclude.hpp>
+#include <ndn-cpp/encoding/tlv-reader.hpp>
+#include "c/util/ndn_memory.h"
+
+#include <algorithm>
 
 namespace ndn
 {
 
+const size_t Exclude::PREFIX_SIZE;
+const size_t Exclude::MAX_TERMS_IN_WIRE;
+
+/**
+ * Get the 8 bytes as a big-endian number.  Compilers turn this into one load and a byte swap.
+ */
+static inline uint64_t
+loadBigEndian (const uint8_t *bytes)
+{
+  return (static_cast<uint64_t> (bytes[0]) << 56) | (static_cast<uint64_t> (bytes[1]) << 48) |
+         (static_cast<uint64_t> (bytes[2]) << 40) | (static_cast<uint64_t> (bytes[3]) << 32) |
+         (static_cast<uint64_t> (bytes[4]) << 24) | (static_cast<uint64_t> (bytes[5]) << 16) |
+         (static_cast<uint64_t> (bytes[6]) << 8) | static_cast<uint64_t> (bytes[7]);
+}
+
+/**
+ * Compare the values of two components in the NDN canonical order (see Name::Component::compare).
+ */
+static inline int
+compareValues (const uint8_t *value1, size_t size1, const uint8_t *value2, size_t size2)
+{
+  if (size1 != size2)
+    return size1 < size2 ? -1 : 1;
+  if (size1 >= 8)
+    {
+      // most values of the same size differ in the first bytes
+      uint64_t word1 = loadBigEndian (value1);
+      uint64_t word2 = loadBigEndian (value2);
+      if (word1 != word2)
+        return word1 < word2 ? -1 : 1;
+    }
+  return size1 == 0 ? 0 : ndn_memcmp (value1, value2, size1);
+}
+
+/**
+ * Get the value of the component, 0 if it is empty (Name::Component() has no buffer at all).
+ */
+static inline const uint8_t*
+getValue (const Name::Component &component)
+{
+  return component.empty () ? 0 : component.getValue ().buf ();
+}
+
+static inline size_t
+getValueSize (const Name::Component &component)
+{
+  return component.empty () ? 0 : component.getValue ().size ();
+}
+
 Exclude::Exclude ()
+  : m_nUnusedBytes (0)
+  , m_hasTerms (true)
 {
 }
 
+/**
+ * Cursor over the terms of an encoded Exclude, which reads a component together with the Any after it
+ *
+ * Exclude ::= EXCLUDE-TYPE TLV-LENGTH Any? (NameComponent (Any)?)+
+ */
+class ExcludeTermReader
+{
+public:
+  explicit
+  ExcludeTermReader (const Block &wire)
+    : m_reader (wire)
+    , m_hasElement (m_reader.next ())
+    , m_isFirst (true)
+    , m_value (0)
+    , m_valueSize (0)
+    , m_hasAny (false)
+  {
+  }
+
+  /**
+   * Move to the next term (the first one on the first call).  A leading Any is read as a term with
+   * an empty value.
+   * @return false if there are no more terms
+   * @throws Exclude::Error if the element is not a NameComponent
+   */
+  bool
+  next ()
+  {
+    if (!m_hasElement)
+      return false;
+
+    if (m_isFirst && m_reader.type () == Tlv::Any)
+      {
+        m_value = 0;
+        m_valueSize = 0;
+        m_hasAny = true;
+      }
+    else
+      {
+        if (m_reader.type () != Tlv::NameComponent)
+          throw Exclude::Error ("Incorrect format of Exclude filter");
+
+        m_value = m_reader.value ();
+        m_valueSize = m_reader.value_size ();
+        m_hasElement = m_reader.next ();
+        m_hasAny = m_hasElement && m_reader.type () == Tlv::Any;
+      }
+    m_isFirst = false;
+
+    if (m_hasAny)
+      m_hasElement = m_reader.next ();
+    return true;
+  }
+
+  const uint8_t*
+  value () const
+  {
+    return m_value;
+  }
+
+  size_t
+  value_size () const
+  {
+    return m_valueSize;
+  }
+
+  bool
+  hasAny () const
+  {
+    return m_hasAny;
+  }
+
+private:
+  TlvReader m_reader;
+  bool m_hasElement;
+  bool m_isFirst;
+  const uint8_t *m_value;
+  size_t m_valueSize;
+  bool m_hasAny;
+};
+
+/**
+ * Get the first 8 bytes of the value, padded with zeros, as a big-endian number.
+ */
+static inline uint64_t
+getKeyWord (const uint8_t *value, size_t valueSize)
+{
+  if (valueSize >= 8)
+    return loadBigEndian (value);
+
+  uint64_t word = 0;
+  for (size_t i = 0; i < 8; ++i)
+    word = (word << 8) | (i < valueSize ? value[i] : 0);
+  return word;
+}
+
+inline Exclude::PrefixKey
+Exclude::getPrefixKey (const uint8_t *value, size_t valueSize)
+{
+  PrefixKey key;
+  key.high = getKeyWord (value, valueSize);
+  key.low = valueSize > 8 ? getKeyWord (value + 8, valueSize - 8) : 0;
+  return key;
+}
+
+inline int
+Exclude::compareTerm (size_t i, const uint8_t *value, size_t valueSize, const PrefixKey &prefixKey) const
+{
+  const Term &term = m_terms[i];
+  if (term.size != valueSize)
+    return term.size < valueSize ? -1 : 1;
+
+  // For values of the same size, the keys are in the order of their first bytes.
+  uint64_t high = loadBigEndian (term.prefix);
+  if (high != prefixKey.high)
+    return high < prefixKey.high ? -1 : 1;
+  uint64_t low = loadBigEndian (term.prefix + 8);
+  if (low != prefixKey.low)
+    return low < prefixKey.low ? -1 : 1;
+  if (valueSize <= PREFIX_SIZE)
+    return 0;
+
+  return ndn_memcmp (&m_values[term.offset] + PREFIX_SIZE, value + PREFIX_SIZE, valueSize - PREFIX_SIZE);
+}
+
+size_t
+Exclude::findUpperBound (const uint8_t *value, size_t valueSize, bool &isEqual) const
+{
+  PrefixKey prefixKey = getPrefixKey (value, valueSize);
+  isEqual = false;
+  size_t low = 0;
+  size_t high = m_terms.size ();
+  while (low < high)
+    {
+      size_t middle = low + (high - low) / 2;
+      int result = compareTerm (middle, value, valueSize, prefixKey);
+      if (result < 0)
+        low = middle + 1;
+      else if (result > 0)
+        high = middle;
+      else
+        {
+          isEqual = true;
+          return middle + 1;
+        }
+    }
+  return low;
+}
+
 // example: ANY /b /d ANY /f
 //
-// ordered in map as:
+// ordered in the terms as:
+//
+// / (true); /b (false); /d (true); /f (false)
 //
-// /f (false); /d (true); /b (false); / (true)
+// The last term not greater than the component decides:
 //
-// lower_bound (/)  -> / (true) <-- excluded (equal)
-// lower_bound (/a) -> / (true) <-- excluded (any)
-// lower_bound (/b) -> /b (false) <--- excluded (equal)
-// lower_bound (/c) -> /b (false) <--- not excluded (not equal and no ANY)
-// lower_bound (/d) -> /d (true) <- excluded
-// lower_bound (/e) -> /d (true) <- excluded
+// /    -> / (true) <-- excluded (equal)
+// /a   -> / (true) <-- excluded (any)
+// /b   -> /b (false) <--- excluded (equal)
+// /c   -> /b (false) <--- not excluded (not equal and no ANY)
+// /d   -> /d (true) <- excluded
+// /e   -> /d (true) <- excluded
 bool
 Exclude::isExcluded (const Name::Component &comp) const
 {
-  const_iterator lowerBound = m_exclude.lower_bound (comp);
-  if (lowerBound == end ())
-    return false;
+  return isExcluded (getValue (comp), getValueSize (comp));
+}
 
-  if (lowerBound->second)
-    return true;
-  else
-    return lowerBound->first == comp;
+bool
+Exclude::isExcluded (const uint8_t *value, size_t valueSize) const
+{
+  if (!m_hasTerms)
+    return isExcludedInWire (value, valueSize);
 
-  return false;
+  bool isEqual;
+  size_t i = findUpperBound (value, valueSize, isEqual);
+  return isEqual || (i > 0 && m_terms[i - 1].any);
 }
 
-Exclude &
-Exclude::excludeOne (const Name::Component &comp)
+bool
+Exclude::isExcludedInWire (const uint8_t *value, size_t valueSize) const
 {
-  if (!isExcluded (comp))
+  // The same rule as above, with the terms read in order until one is greater than the value.
+  ExcludeTermReader reader (wire_);
+  bool isAfterAny = false;
+  while (reader.next ())
     {
-      m_exclude.insert (std::make_pair (comp, false));
+      int result = compareValues (reader.value (), reader.value_size (), value, valueSize);
+      if (result == 0)
+        return true;
+      if (result > 0)
+        return isAfterAny;
+      isAfterAny = reader.hasAny ();
     }
-  return *this;
+  return isAfterAny;
 }
 
+size_t
+Exclude::countTermsInWire () const
+{
+  size_t nTerms = 0;
+  ExcludeTermReader reader (wire_);
+  while (reader.next ())
+    ++nTerms;
+  return nTerms;
+}
 
-// example: ANY /b0 /d0 ANY /f0
-//
-// ordered in map as:
-//
-// /f0 (false); /d0 (true); /b0 (false); / (true)
-//
-// lower_bound (/)  -> / (true) <-- excluded (equal)
-// lower_bound (/a0) -> / (true) <-- excluded (any)
-// lower_bound (/b0) -> /b0 (false) <--- excluded (equal)
-// lower_bound (/c0) -> /b0 (false) <--- not excluded (not equal and no ANY)
-// lower_bound (/d0) -> /d0 (true) <- excluded
-// lower_bound (/e0) -> /d0 (true) <- excluded
+void
+Exclude::readTermInWire (size_t i, const uint8_t *&value, size_t &valueSize, bool &any) const
+{
+  ExcludeTermReader reader (wire_);
+  for (size_t j = 0; j <= i; ++j)
+    {
+      if (!reader.next ())
+        throw Error ("Exclude term index is out of range");
+    }
+  value = reader.value ();
+  valueSize = reader.value_size ();
+  any = reader.hasAny ();
+}
+
+void
+Exclude::decodeTerms ()
+{
+  Block wire = wire_;
+  m_hasTerms = true;
 
+  ExcludeTermReader reader (wire);
+  while (reader.next ())
+    appendExclude (reader.value (), reader.value_size (), reader.hasAny ());
 
-// examples with desired outcomes
-// excludeRange (/, /f0) ->  ANY /f0
-//                          /f0 (false); / (true)
-// excludeRange (/, /f1) ->  ANY /f1
-//                          /f1 (false); / (true)
-// excludeRange (/a0, /e0) ->  ANY /f0
-//                          /f0 (false); / (true)
-// excludeRange (/a0, /e0) ->  ANY /f0
-//                          /f0 (false); / (true)
+  // appendExclude() reset the wire, which still encodes the filter
+  wire_ = wire;
+}
 
-// excludeRange (/b1, /c0) ->  ANY /b0 /b1 ANY /c0 /d0 ANY /f0
-//                          /f0 (false); /d0 (true); /c0 (false); /b1 (true); /b0 (false); / (true)
+void
+Exclude::insertTerm (size_t i, const uint8_t *value, size_t valueSize, bool any)
+{
+  Term term;
+  memset (term.prefix, 0, PREFIX_SIZE);
+  if (valueSize > 0)
+    memcpy (term.prefix, value, std::min (valueSize, PREFIX_SIZE));
+  term.offset = 0;
+  term.size = valueSize;
+  term.any = any;
+
+  if (valueSize > PREFIX_SIZE)
+    {
+      // The value may be one of our own, which resize() can move.
+      const uint8_t *begin = m_values.empty () ? 0 : &m_values[0];
+      bool isOwnValue = begin != 0 && value >= begin && value < begin + m_values.size ();
+      size_t ownOffset = isOwnValue ? value - begin : 0;
+
+      term.offset = m_values.size ();
+      m_values.resize (term.offset + valueSize);
+      memcpy (&m_values[term.offset], isOwnValue ? &m_values[ownOffset] : value, valueSize);
+    }
 
-Exclude &
-Exclude::excludeRange (const Name::Component &from, const Name::Component &to)
+  if (m_terms.capacity () == 0)
+    // start with room for a few terms rather than growing one term at a time
+    m_terms.reserve (8);
+  m_terms.insert (m_terms.begin () + i, term);
+  wire_.reset ();
+}
+
+void
+Exclude::eraseTerms (size_t iBegin, size_t iEnd)
 {
-  if (from >= to)
+  if (iBegin >= iEnd)
+    return;
+
+  for (size_t i = iBegin; i < iEnd; ++i)
     {
-      throw Error ("Invalid exclude range [" +
-                   from.toEscapedString() + ", " +
-                   to.toEscapedString() +
-                   "] (for single name exclude use Exclude::excludeOne)");
+      if (m_terms[i].size > PREFIX_SIZE)
+        m_nUnusedBytes += m_terms[i].size;
     }
+  m_terms.erase (m_terms.begin () + iBegin, m_terms.begin () + iEnd);
+  wire_.reset ();
 
-  iterator newFrom = m_exclude.lower_bound (from);
-  if (newFrom == end () || !newFrom->second /*without ANY*/)
+  if (m_nUnusedBytes > 256 && m_nUnusedBytes > m_values.size () / 2)
     {
-      std::pair<iterator, bool> fromResult = m_exclude.insert (std::make_pair (from, true));
-      newFrom = fromResult.first;
-      if (!fromResult.second)
+      // Pack the values that are still used.
+      std::vector<uint8_t> values;
+      values.reserve (m_values.size () - m_nUnusedBytes);
+      for (size_t i = 0; i < m_terms.size (); ++i)
         {
-          // this means that the lower bound is equal to the item itself. So, just update ANY flag
-          newFrom->second = true;
+          Term &term = m_terms[i];
+          if (term.size <= PREFIX_SIZE)
+            continue;
+
+          size_t offset = values.size ();
+          values.insert (values.end (), m_values.begin () + term.offset,
+                         m_values.begin () + term.offset + term.size);
+          term.offset = offset;
         }
+      m_values.swap (values);
+      m_nUnusedBytes = 0;
     }
-  // else
-  // nothing special if start of the range already exists with ANY flag set
+}
+
+Exclude &
+Exclude::excludeOne (const Name::Component &comp)
+{
+  return excludeOne (getValue (comp), getValueSize (comp));
+}
+
+Exclude &
+Exclude::excludeOne (const uint8_t *value, size_t valueSize)
+{
+  if (!m_hasTerms)
+    decodeTerms ();
 
-  iterator newTo = m_exclude.lower_bound (to); // !newTo cannot be end ()
-  if (newTo == newFrom || !newTo->second)
+  bool isEqual;
+  size_t i = findUpperBound (value, valueSize, isEqual);
+  if (!isEqual && !(i > 0 && m_terms[i - 1].any))
+    insertTerm (i, value, valueSize, false);
+  return *this;
+}
+
+size_t
+Exclude::setRangeStart (const uint8_t *value, size_t valueSize)
+{
+  bool isEqual;
+  size_t i = findUpperBound (value, valueSize, isEqual);
+  if (i > 0)
     {
-      std::pair<iterator, bool> toResult = m_exclude.insert (std::make_pair (to, false));
-      newTo = toResult.first;
-      ++ newTo;
+      Term &term = m_terms[i - 1];
+      if (term.any)
+        // the value is already in the range after the term
+        return i - 1;
+
+      if (isEqual)
+        {
+          term.any = true;
+          wire_.reset ();
+          return i - 1;
+        }
     }
-  else
+
+  insertTerm (i, value, valueSize, true);
+  return i;
+}
+
+// examples with desired outcomes
+// excludeRange (/, /f0) ->  ANY /f0
+//                          / (true); /f0 (false)
+// excludeRange (/, /f1) ->  ANY /f1
+//                          / (true); /f1 (false)
+// excludeRange (/a0, /e0) on ANY /f0 -> ANY /f0 (already excluded)
+//                          / (true); /f0 (false)
+//
+// excludeRange (/b1, /c0) on ANY /b0 /d0 ANY /f0 ->  ANY /b0 /b1 ANY /c0 /d0 ANY /f0
+//                          / (true); /b0 (false); /b1 (true); /c0 (false); /d0 (true); /f0 (false)
+
+Exclude &
+Exclude::excludeRange (const Name::Component &from, const Name::Component &to)
+{
+  return excludeRange (getValue (from), getValueSize (from), getValue (to), getValueSize (to));
+}
+
+Exclude &
+Exclude::excludeRange (const uint8_t *fromValue, size_t fromValueSize,
+                       const uint8_t *toValue, size_t toValueSize)
+{
+  if (compareValues (fromValue, fromValueSize, toValue, toValueSize) >= 0)
     {
-      // nothing to do really
+      throw Error ("Invalid exclude range [" +
+                   Name::toEscapedString (fromValue, fromValueSize) + ", " +
+                   Name::toEscapedString (toValue, toValueSize) +
+                   "] (for single name exclude use Exclude::excludeOne)");
     }
+  if (!m_hasTerms)
+    decodeTerms ();
 
-  m_exclude.erase (newTo, newFrom); // remove any intermediate node, since all of the are excluded
+  // If the components just after the end of the range are already excluded, the range joins them.
+  bool isEqual;
+  size_t iTo = findUpperBound (toValue, toValueSize, isEqual);
+  bool isAfterRangeExcluded = iTo > 0 && m_terms[iTo - 1].any;
+
+  size_t iStart = setRangeStart (fromValue, fromValueSize);
+  // remove the terms inside the range, since all of them are excluded
+  eraseTerms (iStart + 1, findUpperBound (toValue, toValueSize, isEqual));
+  if (!isAfterRangeExcluded)
+    insertTerm (iStart + 1, toValue, toValueSize, false);
 
   return *this;
 }
@@ -127,42 +464,84 @@ Exclude::excludeRange (const Name::Component &from, const Name::Component &to)
 Exclude &
 Exclude::excludeAfter (const Name::Component &from)
 {
-  iterator newFrom = m_exclude.lower_bound (from);
-  if (newFrom == end () || !newFrom->second /*without ANY*/)
+  if (!m_hasTerms)
+    decodeTerms ();
+
+  size_t iStart = setRangeStart (getValue (from), getValueSize (from));
+  // remove the terms after the start, since all of them are excluded
+  eraseTerms (iStart + 1, m_terms.size ());
+
+  return *this;
+}
+
+Exclude &
+Exclude::excludeBefore (const Name::Component &to)
+{
+  return excludeRange (0, 0, getValue (to), getValueSize (to));
+}
+
+void
+Exclude::appendExclude (const Name::Component &name, bool any)
+{
+  appendExclude (getValue (name), getValueSize (name), any);
+}
+
+void
+Exclude::appendExclude (const uint8_t *value, size_t valueSize, bool any)
+{
+  if (!m_hasTerms)
+    decodeTerms ();
+
+  size_t i = m_terms.size ();
+  if (i > 0 && compareTerm (i - 1, value, valueSize, getPrefixKey (value, valueSize)) >= 0)
     {
-      std::pair<iterator, bool> fromResult = m_exclude.insert (std::make_pair (from, true));
-      newFrom = fromResult.first;
-      if (!fromResult.second)
+      // not in the canonical order
+      bool isEqual;
+      i = findUpperBound (value, valueSize, isEqual);
+      if (isEqual)
         {
-          // this means that the lower bound is equal to the item itself. So, just update ANY flag
-          newFrom->second = true;
+          m_terms[i - 1].any = any;
+          wire_.reset ();
+          return;
         }
     }
-  // else
-  // nothing special if start of the range already exists with ANY flag set
 
-  if (newFrom != m_exclude.begin ())
-    {
-      m_exclude.erase (m_exclude.begin (), newFrom); // remove any intermediate node, since all of the are excluded
-    }
+  insertTerm (i, value, valueSize, any);
+}
 
-  return *this;
+void
+Exclude::reserve (size_t nTerms, size_t nValueBytes)
+{
+  if (!m_hasTerms)
+    decodeTerms ();
+
+  m_terms.reserve (nTerms);
+  m_values.reserve (nValueBytes);
 }
 
+void
+Exclude::clear ()
+{
+  m_terms.clear ();
+  m_values.clear ();
+  m_nUnusedBytes = 0;
+  m_hasTerms = true;
+  wire_.reset ();
+}
 
 std::ostream&
 operator << (std::ostream &os, const Exclude &exclude)
 {
   bool empty = true;
-  for (Exclude::const_reverse_iterator i = exclude.rbegin (); i != exclude.rend (); i++)
+  for (size_t i = 0; i < exclude.size (); ++i)
     {
-      if (!i->first.empty())
+      if (exclude.getComponentValueSize (i) > 0)
         {
           if (!empty) os << ",";
-          os << i->first.toEscapedString ();
+          Name::toEscapedString (exclude.getComponentValue (i), exclude.getComponentValueSize (i), os);
           empty = false;
         }
-      if (i->second)
+      if (exclude.hasAnyAfter (i))
         {
           if (!empty) os << ",";
           os << "*";
@@ -172,77 +551,82 @@ operator << (std::ostream &os, const Exclude &exclude)
   return os;
 }
 
-const Block&
-Exclude::wireEncode() const
+template<bool T>
+size_t
+Exclude::wireEncode(EncodingImpl<T> &block) const
 {
   if (wire_.hasWire())
-    return wire_;
-
-  wire_ = Block(Tlv::Exclude);
+    return block.prependByteArray(wire_.wire(), wire_.size());
 
-  for (Exclude::const_reverse_iterator i = m_exclude.rbegin (); i != m_exclude.rend (); i++)
+  // The terms are prepended from the last one
+  size_t totalLength = 0;
+  for (size_t i = m_terms.size (); i > 0; --i)
     {
-      if (!i->first.empty())
+      const Term &term = m_terms[i - 1];
+      if (term.any)
         {
-          OBufferStream os;
-          Tlv::writeVarNumber(os, Tlv::NameComponent);
-          Tlv::writeVarNumber(os, i->first.getValue().size());
-          os.write(reinterpret_cast<const char *>(i->first.getValue().buf()), i->first.getValue().size());
-          
-          wire_.push_back(Block(os.buf()));
-
+          totalLength += prependBooleanBlock(block, Tlv::Any);
         }
-      if (i->second)
+      if (term.size > 0)
         {
-          OBufferStream os;
-          Tlv::writeVarNumber(os, Tlv::Any);
-          Tlv::writeVarNumber(os, 0);
-          wire_.push_back(Block(os.buf()));
+          totalLength += prependByteArrayBlock(block, Tlv::NameComponent,
+                                               getComponentValue (i - 1), term.size);
         }
     }
 
-  wire_.encode();
+  totalLength += block.prependVarNumber(totalLength);
+  totalLength += block.prependVarNumber(Tlv::Exclude);
+  return totalLength;
+}
+
+template size_t
+Exclude::wireEncode<true>(EncodingImpl<true> &block) const;
+
+template size_t
+Exclude::wireEncode<false>(EncodingImpl<false> &block) const;
+
+const Block&
+Exclude::wireEncode() const
+{
+  if (wire_.hasWire())
+    return wire_;
+
+  EncodingEstimator estimator;
+  size_t estimatedSize = wireEncode(estimator);
+
+  EncodingBuffer buffer(estimatedSize, 0);
+  wireEncode(buffer);
+
+  wire_ = buffer.block();
   return wire_;
 }
   
 void 
 Exclude::wireDecode(const Block &wire)
 {
-  wire_ = wire;
-  wire_.parse();
-
-  Block::element_const_iterator i = wire_.getAll().begin();
-  if (i->type() == Tlv::Any)
+  clear();
+
+  // Check the format, and whether the terms can be searched in place, which needs each term to be
+  // greater than the one before it.
+  bool isCanonical = true;
+  size_t nTerms = 0;
+  const uint8_t *previousValue = 0;
+  size_t previousValueSize = 0;
+  ExcludeTermReader reader(wire);
+  for (; reader.next(); ++nTerms)
     {
-      appendExclude("/", true);
-      ++i;
+      if (nTerms > 0 &&
+          compareValues(previousValue, previousValueSize, reader.value(), reader.value_size()) >= 0)
+        isCanonical = false;
+      previousValue = reader.value();
+      previousValueSize = reader.value_size();
     }
 
-  while (i != wire_.getAll().end())
-    {
-      if (i->type() != Tlv::NameComponent)
-        throw Error("Incorrect format of Exclude filter");
-
-      Name::Component excludedComponent (i->value(), i->value_size());
-      ++i;
-
-      if (i != wire_.getAll().end())
-        {
-          if (i->type() == Tlv::Any)
-            {
-              appendExclude(excludedComponent, true);
-              ++i;
-            }
-          else
-            {
-              appendExclude(excludedComponent, false);
-            }
-        }
-      else
-        {
-          appendExclude(excludedComponent, false);
-        }
-    }
+  wire_ = wire;
+  m_hasTerms = false;
+  if (!isCanonical || nTerms > MAX_TERMS_IN_WIRE)
+    // appendExclude() sorts the terms and merges the equal ones
+    decodeTerms();
 }
 
 
@@ -8,6 +8,7 @@
 #include <stdexcept>
 #include <ndn-cpp/common.hpp>
 #include <ndn-cpp/interest.hpp>
+#include <ndn-cpp/encoding/tlv-schema.hpp>
 
 #if __clang__
 #pragma clang diagnostic push
@@ -22,6 +23,8 @@
 #endif
 
 #include <cryptopp/osrng.h>
+#include <ndn-cpp/util/atomic.hpp>
+#include "util/sip-hash.hpp"
 
 using namespace std;
 
@@ -29,15 +32,63 @@ namespace ndn {
 
 const Milliseconds DEFAULT_INTEREST_LIFETIME = 4000;
 
-const uint32_t&
-Interest::getNonce() const
+/**
+ * The source of the nonces, which the threads expressing Interests use at once: each nonce is the
+ * SipHash of the next value of a counter under a random key, so no thread locks or changes a shared
+ * random pool.
+ */
+class NonceGenerator
 {
-  static CryptoPP::AutoSeededRandomPool rng;
+public:
+  NonceGenerator()
+  {
+    CryptoPP::AutoSeededRandomPool rng;
+    rng.GenerateBlock(reinterpret_cast<uint8_t*>(key_), sizeof(key_));
+  }
 
-  if (nonce_ == 0)
-    nonce_ = rng.GenerateWord32();
+  uint32_t
+  generate()
+  {
+    uint64_t hash = sipHash(key_, counter_.fetchAdd(1), 0, 0);
+    return static_cast<uint32_t>(hash ^ (hash >> 32));
+  }
 
-  return nonce_;
+private:
+  uint64_t key_[2];
+  Atomic<uint64_t> counter_;
+};
+
+Interest&
+Interest::operator=(const Interest& interest)
+{
+  name_ = interest.name_;
+  minSuffixComponents_ = interest.minSuffixComponents_;
+  maxSuffixComponents_ = interest.maxSuffixComponents_;
+  exclude_ = interest.exclude_;
+  childSelector_ = interest.childSelector_;
+  mustBeFresh_ = interest.mustBeFresh_;
+  scope_ = interest.scope_;
+  interestLifetime_ = interest.interestLifetime_;
+  nonce_.store(interest.nonce_.load());
+  wire_ = interest.wire_;
+  return *this;
+}
+
+uint32_t
+Interest::getNonce() const
+{
+  static NonceGenerator generator;
+
+  // A nonce of 0 means that it is not set.  If another thread sets it first, compareExchange reads
+  // its nonce, which is kept.
+  uint32_t nonce = nonce_.load();
+  while (nonce == 0) {
+    uint32_t generated = generator.generate();
+    if (nonce_.compareExchange(nonce, generated))
+      nonce = generated;
+  }
+
+  return nonce;
 }
 
 
@@ -58,7 +109,7 @@ Interest::matchesName(const Name &name) const
     return false;
 
   if (!exclude_.empty() && name.size() > name_.size() &&
-      exclude_.isExcluded(name[name_.size()]))
+      exclude_.isExcluded(name.getComponentValue(name_.size()), name.getComponentValueSize(name_.size())))
     return false;
 
   return true;
@@ -108,73 +159,104 @@ operator << (std::ostream &os, const Interest &interest)
   return os;
 }
 
-const Block&
-Interest::wireEncode() const
+/**
+ * @brief Codec of the Nonce, which is generated on encoding if it is not set
+ *
+ * The field is optional on decoding, like it was before the schema: an Interest without a Nonce
+ * gets one when it is used.  It is always encoded.
+ */
+struct Interest::NonceCodec
 {
-  if (wire_.hasWire())
-    return wire_;
-
-  // Interest ::= INTEREST-TYPE TLV-LENGTH
-  //                Name
-  //                Selectors?
-  //                Nonce
-  //                Scope?
-  //                InterestLifetime?  
-  
-  wire_ = Block(Tlv::Interest);
-  wire_.push_back(getName().wireEncode());
-
-  // selectors
+  static void
+  decode(Interest &interest, const Block &parent, const TlvReader &element)
   {
-    Block selectors(Tlv::Selectors);
-    
-    if (getMinSuffixComponents() >= 0) {
-      selectors.push_back
-        (nonNegativeIntegerBlock(Tlv::MinSuffixComponents, getMinSuffixComponents()));
-    }
-    if (getMaxSuffixComponents() >= 0) {
-      selectors.push_back
-        (nonNegativeIntegerBlock(Tlv::MaxSuffixComponents, getMaxSuffixComponents()));
-    }
-    if (!getExclude().empty()) {
-      selectors.push_back
-        (getExclude().wireEncode());
-    }
-    if (getChildSelector() >= 0) {
-      selectors.push_back
-        (nonNegativeIntegerBlock(Tlv::ChildSelector, getChildSelector()));
-    }
-    if (getMustBeFresh()) {
-      selectors.push_back
-        (booleanBlock(Tlv::MustBeFresh));
-    }
-
-    if (!selectors.getAll().empty())
-      {
-        selectors.encode();
-        wire_.push_back(selectors);
-      }
+    interest.nonce_.store(static_cast<uint32_t>(element.readNonNegativeInteger()));
   }
 
-  // Nonce
+  static void
+  reset(Interest &interest)
   {
-    wire_.push_back
-      (nonNegativeIntegerBlock(Tlv::Nonce, getNonce()));
+    interest.nonce_.store(0);
   }
 
-  // Scope
-  if (getScope() >= 0) {
-    wire_.push_back
-      (nonNegativeIntegerBlock(Tlv::Scope, getScope()));
+  static bool
+  isPresent(const Interest &interest)
+  {
+    return true;
   }
 
-  // InterestLifetime
-  if (getInterestLifetime() >= 0 && getInterestLifetime() != DEFAULT_INTEREST_LIFETIME) {
-    wire_.push_back
-      (nonNegativeIntegerBlock(Tlv::InterestLifetime, getInterestLifetime()));
+  template<bool T>
+  static size_t
+  encode(EncodingImpl<T> &block, uint32_t type, const Interest &interest)
+  {
+    return prependNonNegativeIntegerBlock(block, type, interest.getNonce());
   }
-  
-  wire_.encode();
+};
+
+// Selectors ::= SELECTORS-TYPE TLV-LENGTH
+//                 MinSuffixComponents?
+//                 MaxSuffixComponents?
+//                 Exclude?
+//                 ChildSelector?
+//                 MustBeFresh?
+class Interest::SelectorsSchema : public TlvSchema<Interest,
+  TlvField<Tlv::MinSuffixComponents, TLV_OPTIONAL, TlvNonNegativeInteger<Interest, int, &Interest::minSuffixComponents_> >,
+  TlvField<Tlv::MaxSuffixComponents, TLV_OPTIONAL, TlvNonNegativeInteger<Interest, int, &Interest::maxSuffixComponents_> >,
+  TlvField<Tlv::Exclude,             TLV_OPTIONAL, TlvNested<Interest, Exclude, &Interest::exclude_> >,
+  TlvField<Tlv::ChildSelector,       TLV_OPTIONAL, TlvNonNegativeInteger<Interest, int, &Interest::childSelector_> >,
+  TlvField<Tlv::MustBeFresh,         TLV_OPTIONAL, TlvBoolean<Interest, &Interest::mustBeFresh_> >
+  >
+{
+};
+
+// Interest ::= INTEREST-TYPE TLV-LENGTH
+//                Name
+//                Selectors?
+//                Nonce (optional on decoding)
+//                Scope?
+//                InterestLifetime?
+class Interest::Schema : public TlvSchema<Interest,
+  TlvField<Tlv::Name,             TLV_REQUIRED, TlvNested<Interest, Name, &Interest::name_> >,
+  TlvField<Tlv::Selectors,        TLV_OPTIONAL, TlvGroup<Interest, Interest::SelectorsSchema> >,
+  TlvField<Tlv::Nonce,            TLV_OPTIONAL, Interest::NonceCodec>,
+  TlvField<Tlv::Scope,            TLV_OPTIONAL, TlvNonNegativeInteger<Interest, int, &Interest::scope_> >,
+  TlvField<Tlv::InterestLifetime, TLV_OPTIONAL, TlvNonNegativeInteger<Interest, Milliseconds,
+                                                                      &Interest::interestLifetime_,
+                                                                      DEFAULT_INTEREST_LIFETIME> >
+  >
+{
+};
+
+template<bool T>
+size_t
+Interest::wireEncode(EncodingImpl<T> &block) const
+{
+  size_t totalLength = Schema::encode(block, *this);
+
+  totalLength += block.prependVarNumber(totalLength);
+  totalLength += block.prependVarNumber(Tlv::Interest);
+  return totalLength;
+}
+
+template size_t
+Interest::wireEncode<true>(EncodingImpl<true> &block) const;
+
+template size_t
+Interest::wireEncode<false>(EncodingImpl<false> &block) const;
+
+const Block&
+Interest::wireEncode() const
+{
+  if (wire_.hasWire())
+    return wire_;
+
+  EncodingEstimator estimator;
+  size_t estimatedSize = wireEncode(estimator);
+
+  EncodingBuffer buffer(estimatedSize, 0);
+  wireEncode(buffer);
+
+  wire_ = buffer.block();
   return wire_;
 }
   
@@ -182,84 +264,12 @@ void
 Interest::wireDecode(const Block &wire) 
 {
   wire_ = wire;
-  wire_.parse();
-
-  // Interest ::= INTEREST-TYPE TLV-LENGTH
-  //                Name
-  //                Selectors?
-  //                Nonce
-  //                Scope?
-  //                InterestLifetime?  
-  
-  // Name
-  name_.wireDecode(wire_.get(Tlv::Name));
-
-  // Selectors
-  Block::element_iterator selectors = wire_.find(Tlv::Selectors);
-  if (selectors != wire_.getAll().end())
-    {
-      selectors->parse();
-
-      // MinSuffixComponents
-      Block::element_iterator val = selectors->find(Tlv::MinSuffixComponents);
-      if (val != selectors->getAll().end())
-        {
-          minSuffixComponents_ = readNonNegativeInteger(*val);
-        }
-
-      // MaxSuffixComponents
-      val = selectors->find(Tlv::MaxSuffixComponents);
-      if (val != selectors->getAll().end())
-        {
-          maxSuffixComponents_ = readNonNegativeInteger(*val);
-        }
-
-      // Exclude
-      val = selectors->find(Tlv::Exclude);
-      if (val != selectors->getAll().end())
-        {
-          exclude_.wireDecode(*val);
-        }
-
-      // ChildSelector
-      val = selectors->find(Tlv::ChildSelector);
-      if (val != selectors->getAll().end())
-        {
-          childSelector_ = readNonNegativeInteger(*val);
-        }
-
-      //MustBeFresh aka AnswerOriginKind
-      val = selectors->find(Tlv::MustBeFresh);
-      if (val != selectors->getAll().end())
-        {
-          mustBeFresh_ = true;
-        }
-    }
-  
-  // Nonce
-  Block::element_iterator val = wire_.find(Tlv::Nonce);
-  if (val != wire_.getAll().end())
-    {
-      nonce_ = readNonNegativeInteger(*val);
-    }
-
-  // Scope
-  val = wire_.find(Tlv::Scope);
-  if (val != wire_.getAll().end())
-    {
-      scope_ = readNonNegativeInteger(*val);
-    }
-  
-  // InterestLifetime
-  val = wire_.find(Tlv::InterestLifetime);
-  if (val != wire_.getAll().end())
-    {
-      interestLifetime_ = readNonNegativeInteger(*val);
-    }
-  else
-    {
-      interestLifetime_ = DEFAULT_INTEREST_LIFETIME;
-    }
+
+  Schema::decode(*this, wire_);
+
+  // Without a Nonce, the wire cannot be sent as it is: it is encoded again with the generated one.
+  if (nonce_.load() == 0)
+    wire_.reset();
 }
 
 
@@ -10,162 +10,590 @@
 #include <algorithm>
 #include <string.h>
 #include <ndn-cpp/name.hpp>
+#include <ndn-cpp/encoding/tlv-reader.hpp>
 #include "c/util/ndn_memory.h"
 #include "c/util/time.h"
 
-#include "util/string-helper.hpp"
+#include "util/sip-hash.hpp"
 
 using namespace std;
 
 namespace ndn {
 
+const size_t Name::HEADER_RESERVE;
+const size_t Name::npos;
+
+/**
+ * Compare the values of two components using NDN canonical ordering (see Name::Component::compare).
+ */
+static int
+compareValues(const uint8_t *value1, size_t size1, const uint8_t *value2, size_t size2)
+{
+  if (size1 < size2)
+    return -1;
+  if (size1 > size2)
+    return 1;
+  if (size1 == 0)
+    return 0;
+
+  return ndn_memcmp(value1, value2, size1);
+}
+
+static inline bool
+isWhitespace(char c)
+{
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+/**
+ * Move begin and end inwards past whitespace.
+ */
+static inline void
+trimWhitespace(const char *&begin, const char *&end)
+{
+  while (begin < end && isWhitespace(*begin))
+    ++begin;
+  while (end > begin && isWhitespace(*(end - 1)))
+    --end;
+}
+
+static inline int
+fromHexChar(char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  else if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  else if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  else
+    return -1;
+}
+
+/**
+ * Decode each "%XX" between begin and end to the byte value (other characters, including an
+ * invalid escape, are copied through).
+ * @param value Set to the decoded bytes, must have room for end - begin bytes.
+ * @return The number of decoded bytes.
+ */
+static size_t
+unescape(const char *begin, const char *end, uint8_t *value)
+{
+  uint8_t *out = value;
+  while (begin < end)
+    {
+      if (*begin == '%' && end - begin > 2)
+        {
+          int hi = fromHexChar(begin[1]);
+          int lo = fromHexChar(begin[2]);
+          if (hi < 0 || lo < 0)
+            {
+              // Invalid hex characters, so just keep the escaped string.
+              memcpy(out, begin, 3);
+              out += 3;
+            }
+          else
+            *out++ = static_cast<uint8_t>(16 * hi + lo);
+          begin += 3;
+        }
+      else
+        *out++ = static_cast<uint8_t>(*begin++);
+    }
+  return out - value;
+}
+
+static bool
+isAllPeriods(const uint8_t *value, size_t valueSize)
+{
+  for (size_t i = 0; i < valueSize; ++i)
+    {
+      if (value[i] != '.')
+        return false;
+    }
+  return true;
+}
+
+/**
+ * Return the index of the first byte where the arrays differ, or size if they are equal.
+ */
+static size_t
+findMismatch(const uint8_t *array1, const uint8_t *array2, size_t size)
+{
+  if (array1 == array2)
+    return size;
+
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+    {
+      uint64_t word1, word2;
+      memcpy(&word1, array1 + i, sizeof(word1));
+      memcpy(&word2, array2 + i, sizeof(word2));
+      if (word1 != word2)
+        break;
+    }
+  while (i < size && array1[i] == array2[i])
+    ++i;
+  return i;
+}
+
+/**
+ * Characters that are not escaped in the NDN URI Scheme: 0-9, A-Z, a-z, (+), (-), (.), (_)
+ */
+static const bool IS_UNRESERVED[256] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 1, 0,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0,
+  0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 1,
+  0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+/**
+ * @brief Writer of a URI into a caller buffer, which counts what does not fit without writing it
+ */
+class UriWriter
+{
+public:
+  UriWriter(char *buffer, size_t bufferSize)
+    : m_buffer(buffer)
+    , m_bufferSize(bufferSize)
+    , m_size(0)
+  {
+  }
+
+  void
+  put(char c)
+  {
+    if (m_size < m_bufferSize)
+      m_buffer[m_size] = c;
+    ++m_size;
+  }
+
+  /**
+   * @brief Write the value escaped according to the NDN URI Scheme, adding "..." to a value of
+   *        zero or more periods
+   */
+  void
+  putEscaped(const uint8_t *value, size_t valueSize)
+  {
+    if (isAllPeriods(value, valueSize))
+      {
+        for (size_t i = 0; i < valueSize + 3; ++i)
+          put('.');
+        return;
+      }
+
+    for (size_t i = 0; i < valueSize; ++i)
+      {
+        uint8_t x = value[i];
+        if (IS_UNRESERVED[x])
+          put(static_cast<char>(x));
+        else
+          {
+            put('%');
+            put(HEX_DIGITS[x >> 4]);
+            put(HEX_DIGITS[x & 0xf]);
+          }
+      }
+  }
+
+  /**
+   * @brief Terminate the string with a zero (truncating it if necessary)
+   * @return The size of the whole string, not counting the terminating zero
+   */
+  size_t
+  finish()
+  {
+    if (m_bufferSize > 0)
+      m_buffer[m_size < m_bufferSize ? m_size : m_bufferSize - 1] = 0;
+    return m_size;
+  }
+
+private:
+  char *m_buffer;
+  size_t m_bufferSize;
+  size_t m_size;
+};
+
+/**
+ * Get the number of bytes of the network-ordered encoding of the number, without leading zeros
+ * (0 for the number 0).
+ */
+static inline size_t
+getNumberSize(uint64_t number)
+{
+  size_t size = 0;
+  for (; number != 0; number >>= 8)
+    ++size;
+  return size;
+}
+
+/**
+ * Write the size bytes of the network-ordered encoding of the number to value.
+ */
+static inline void
+writeNumber(uint64_t number, size_t size, uint8_t *value)
+{
+  for (size_t i = size; i > 0; --i) {
+    value[i - 1] = number & 0xff;
+    number >>= 8;
+  }
+}
+
+static inline uint64_t
+readNumber(const uint8_t *value, size_t size)
+{
+  uint64_t result = 0;
+  for (size_t i = 0; i < size; ++i)
+    result = (result << 8) | value[i];
+  return result;
+}
+
 uint64_t
 Name::Component::toNumberWithMarker(uint8_t marker) const
 {
-  if (empty() || *getValue().begin() != marker)
+  if (numberMarker_ == marker)
+    return number_;
+
+  if (empty() || value_->front() != marker)
     throw runtime_error("Name component does not begin with the expected marker");
-  
-  uint64_t result = 0;
-  for (Buffer::const_iterator i = getValue().begin()+1; i != getValue().end(); ++i) {
-    result <<= 8;
-    result |= *i;
-  }
-  
-  return result;
+
+  return readNumber(value_->buf() + 1, value_->size() - 1);
 }
 
 Name::Component 
 Name::Component::fromNumber(uint64_t number)
 {
-  ptr_lib::shared_ptr<Buffer> value(new Buffer);
-  
-  // First encode in little endian.
-  while (number != 0) {
-    value->push_back(number & 0xff);
-    number >>= 8;
-  }
-  
-  // Make it big endian.
-  reverse(value->begin(), value->end());
-  return Component(value);
+  uint8_t value[8];
+  size_t size = getNumberSize(number);
+  writeNumber(number, size, value);
+  return Component(value, size, number, NO_MARKER);
 }
 
 Name::Component
 Name::Component::fromNumberWithMarker(uint64_t number, uint8_t marker)
 {
-  ptr_lib::shared_ptr<Buffer> value(new Buffer);
-  
-  // Add the leading marker.
-  value->push_back(marker);
-  
-  // First encode in little endian.
-  while (number != 0) {
-    value->push_back(number & 0xff);
-    number >>= 8;
-  }
-  
-  // Make it big endian.
-  reverse(value->begin() + 1, value->end());
-  return Component(value);
+  uint8_t value[1 + 8];
+  size_t size = getNumberSize(number);
+  value[0] = marker;
+  writeNumber(number, size, value + 1);
+  return Component(value, 1 + size, number, marker);
 }
 
 uint64_t
 Name::Component::toNumber() const
 {
-  uint64_t result = 0;
-  for (Buffer::const_iterator i = getValue().begin(); i != getValue().end(); ++i) {
-    result <<= 8;
-    result |= *i;
-  }
-  
-  return result;
+  if (numberMarker_ == NO_MARKER)
+    return number_;
+
+  return empty() ? 0 : readNumber(value_->buf(), value_->size());
 }
 
 int
 Name::Component::compare(const Name::Component& other) const
 {
   // Imitate ndn_Exclude_compareComponents.
-  if (getValue().size() < other.getValue().size())
-    return -1;
-  if (getValue().size() > other.getValue().size())
-    return 1;
+  // (buf() of an empty value is not a valid pointer, and compareValues does not read it)
+  const Buffer &value = getValue();
+  const Buffer &otherValue = other.getValue();
+  return compareValues(value.empty() ? 0 : value.buf(), value.size(),
+                       otherValue.empty() ? 0 : otherValue.buf(), otherValue.size());
+}
 
-  // The components are equal length.  Just do a byte compare.  
-  return ndn_memcmp(getValue().buf(), other.getValue().buf(), getValue().size());
+Name::Storage::Storage(const Storage &other, size_t iBegin, size_t iEnd, size_t end)
+  : buffer(other.buffer)
+  , offsets(other.offsets.begin() + iBegin, other.offsets.begin() + iEnd)
+  , end(end)
+{
 }
 
-// const Block &
-// Name::wireEncode() const
-// {
-  
-// }
+void
+Name::clear()
+{
+  prefix_.reset();
+  nPrefix_ = 0;
+  wire_.reset();
+
+  if (isStorageUnique())
+    {
+      // keep the memory for the next components
+      storage_->offsets.clear();
+      const_cast<Buffer&>(*storage_->buffer).resize(HEADER_RESERVE);
+      storage_->end = HEADER_RESERVE;
+    }
+  else
+    storage_.reset();
+}
+
+uint8_t*
+Name::appendUninitialized(size_t valueSize)
+{
+  wire_.reset();
+
+  size_t valueOffset = Tlv::sizeOfVarNumber(Tlv::NameComponent) + Tlv::sizeOfVarNumber(valueSize);
+  size_t elementSize = valueOffset + valueSize;
+
+  if (!isStorageUnique())
+    {
+      size_t nOwn = storage_ ? storage_->offsets.size() : 0;
+      if (nPrefix_ == 0 && nOwn > 0)
+        {
+          // The components can no longer change, so they become the prefix shared with the
+          // other names holding them, and the new storage gets only the new components.
+          prefix_ = storage_;
+          nPrefix_ = nOwn;
+          nOwn = 0;
+        }
+
+      // Leave room for the type and length of the Name and a copy of the prefix, so that
+      // wireEncode() can make the wire in this buffer, and for more components.
+      size_t reserve = HEADER_RESERVE;
+      if (nPrefix_ > 0)
+        reserve += getPrefixEnd() - prefix_->offsets[0].begin;
+      size_t begin = nOwn > 0 ? storage_->offsets[0].begin : 0;
+      size_t size = nOwn > 0 ? storage_->end - begin : 0;
+
+      BufferPtr buffer = allocateBuffer(reserve + 2 * (size + elementSize));
+      buffer->resize(reserve + size);
+
+      // Copy the components after the prefix.
+      ptr_lib::shared_ptr<Storage> storage = ptr_lib::make_shared<Storage>();
+      storage->offsets.reserve(nOwn + 1);
+      for (size_t i = 0; i < nOwn; ++i)
+        {
+          ComponentOffset offset;
+          offset.begin = storage_->offsets[i].begin - begin + reserve;
+          offset.value = storage_->offsets[i].value - begin + reserve;
+          storage->offsets.push_back(offset);
+        }
+      if (size > 0)
+        memcpy(buffer->buf() + reserve, storage_->buffer->buf() + begin, size);
+
+      storage->buffer = buffer;
+      storage->end = reserve + size;
+      storage_ = storage;
+    }
+
+  // No one else can see the buffer, so it can be changed.
+  Buffer &buffer = const_cast<Buffer&>(*storage_->buffer);
+  size_t end = storage_->end;
+  buffer.resize(end + elementSize);
+
+  uint8_t *element = buffer.buf() + end;
+  element += Tlv::writeVarNumber(element, Tlv::NameComponent);
+  element += Tlv::writeVarNumber(element, valueSize);
+
+  ComponentOffset offset;
+  offset.begin = static_cast<uint32_t>(end);
+  offset.value = static_cast<uint32_t>(end + valueOffset);
+  storage_->offsets.push_back(offset);
+  storage_->end = end + elementSize;
+
+  return element;
+}
+
+Name&
+Name::appendNumber(uint64_t number)
+{
+  size_t size = getNumberSize(number);
+  writeNumber(number, size, appendUninitialized(size));
+  return *this;
+}
+
+Name&
+Name::appendNumberWithMarker(uint64_t number, uint8_t marker)
+{
+  size_t size = getNumberSize(number);
+  uint8_t *value = appendUninitialized(1 + size);
+  value[0] = marker;
+  writeNumber(number, size, value + 1);
+  return *this;
+}
+
+uint64_t
+Name::getComponentNumber(size_t i) const
+{
+  return readNumber(getComponentValue(i), getComponentValueSize(i));
+}
+
+uint64_t
+Name::getComponentNumberWithMarker(size_t i, uint8_t marker) const
+{
+  const uint8_t *value = getComponentValue(i);
+  size_t size = getComponentValueSize(i);
+  if (size == 0 || value[0] != marker)
+    throw runtime_error("Name component does not begin with the expected marker");
+
+  return readNumber(value + 1, size - 1);
+}
+
+size_t
+Name::getPrefixHash(size_t nComponents) const
+{
+  if (nComponents > size())
+    nComponents = size();
+
+  // The hash of each prefix chains the hash of the prefix one component shorter with the value
+  // of the last component.
+  const uint64_t *key = getProcessSipHashKey();
+  uint64_t hash = sipHash(key, 0, 0, 0);
+  for (size_t i = 0; i < nComponents; ++i)
+    hash = sipHash(key, hash, getComponentValue(i), getComponentValueSize(i));
+
+  return static_cast<size_t>(hash);
+}
+
+void
+Name::getPrefixHashes(size_t nComponents, std::vector<size_t> &hashes) const
+{
+  if (nComponents > size())
+    nComponents = size();
+
+  const uint64_t *key = getProcessSipHashKey();
+  uint64_t hash = sipHash(key, 0, 0, 0);
+  hashes.resize(nComponents + 1);
+  hashes[0] = static_cast<size_t>(hash);
+  for (size_t i = 0; i < nComponents; ++i)
+    {
+      hash = sipHash(key, hash, getComponentValue(i), getComponentValueSize(i));
+      hashes[i + 1] = static_cast<size_t>(hash);
+    }
+}
 
 void 
-Name::set(const char *uri_cstr) 
+Name::set(const char *uri) 
 {
-  components_.clear();
-  
-  string uri = uri_cstr;
-  trim(uri);
-  if (uri.size() == 0)
+  clear();
+
+  const char *begin = uri;
+  const char *end = uri + ::strlen(uri);
+  trimWhitespace(begin, end);
+  if (begin == end)
     return;
 
-  size_t iColon = uri.find(':');
-  if (iColon != string::npos) {
+  const char *colon = static_cast<const char*>(memchr(begin, ':', end - begin));
+  if (colon != 0) {
     // Make sure the colon came before a '/'.
-    size_t iFirstSlash = uri.find('/');
-    if (iFirstSlash == string::npos || iColon < iFirstSlash) {
+    const char *firstSlash = static_cast<const char*>(memchr(begin, '/', end - begin));
+    if (firstSlash == 0 || colon < firstSlash) {
       // Omit the leading protocol such as ndn:
-      uri.erase(0, iColon + 1);
-      trim(uri);
+      begin = colon + 1;
+      trimWhitespace(begin, end);
+      if (begin == end)
+        return;
     }
   }
-    
+
   // Trim the leading slash and possibly the authority.
-  if (uri[0] == '/') {
-    if (uri.size() >= 2 && uri[1] == '/') {
+  if (*begin == '/') {
+    if (end - begin >= 2 && begin[1] == '/') {
       // Strip the authority following "//".
-      size_t iAfterAuthority = uri.find('/', 2);
-      if (iAfterAuthority == string::npos)
+      const char *afterAuthority = static_cast<const char*>(memchr(begin + 2, '/', end - begin - 2));
+      if (afterAuthority == 0)
         // Unusual case: there was only an authority.
         return;
-      else {
-        uri.erase(0, iAfterAuthority + 1);
-        trim(uri);
-      }
+      else
+        begin = afterAuthority + 1;
     }
-    else {
-      uri.erase(0, 1);
-      trim(uri);
+    else
+      ++begin;
+    trimWhitespace(begin, end);
+  }
+
+  // Unescape the components directly into the buffer.
+  while (begin < end) {
+    const char *componentEnd = static_cast<const char*>(memchr(begin, '/', end - begin));
+    if (componentEnd == 0)
+      componentEnd = end;
+
+    appendEscaped(begin, componentEnd);
+    begin = componentEnd + 1;
+  }
+}
+
+void
+Name::appendEscaped(const char *begin, const char *end)
+{
+  trimWhitespace(begin, end);
+  if (begin == end)
+    return;
+
+  size_t maxSize = end - begin;
+  uint8_t *value = appendUninitialized(maxSize);
+  size_t valueSize = unescape(begin, end, value);
+
+  if (isAllPeriods(value, valueSize)) {
+    // Zero, one or two periods is illegal and the component is ignored, otherwise remove 3 periods.
+    // As before, a component that becomes empty is also ignored.
+    if (valueSize <= 3) {
+      removeLastComponent();
+      return;
     }
+    memmove(value, value + 3, valueSize - 3);
+    valueSize -= 3;
   }
 
-  size_t iComponentStart = 0;
-  
-  // Unescape the components.
-  while (iComponentStart < uri.size()) {
-    size_t iComponentEnd = uri.find("/", iComponentStart);
-    if (iComponentEnd == string::npos)
-      iComponentEnd = uri.size();
-    
-    Component component(fromEscapedString(&uri[0], iComponentStart, iComponentEnd));
-    // Ignore illegal components.  This also gets rid of a trailing '/'.
-    if (!component.empty())
-      components_.push_back(Component(component));
-    
-    iComponentStart = iComponentEnd + 1;
+  if (valueSize != maxSize)
+    resizeLastComponent(valueSize);
+}
+
+void
+Name::resizeLastComponent(size_t valueSize)
+{
+  // appendUninitialized() has made storage_ our own.
+  Buffer &buffer = const_cast<Buffer&>(*storage_->buffer);
+  ComponentOffset &offset = storage_->offsets.back();
+
+  uint8_t *element = buffer.buf() + offset.begin;
+  size_t typeSize = Tlv::sizeOfVarNumber(Tlv::NameComponent);
+  size_t headerSize = typeSize + Tlv::sizeOfVarNumber(valueSize);
+  if (offset.begin + headerSize != offset.value) {
+    // the length takes fewer bytes now
+    memmove(element + headerSize, buffer.buf() + offset.value, valueSize);
+    offset.value = static_cast<uint32_t>(offset.begin + headerSize);
   }
+  Tlv::writeVarNumber(element + typeSize, valueSize);
+
+  storage_->end = offset.value + valueSize;
+  buffer.resize(storage_->end);
+}
+
+void
+Name::removeLastComponent()
+{
+  storage_->end = storage_->offsets.back().begin;
+  storage_->offsets.pop_back();
+  const_cast<Buffer&>(*storage_->buffer).resize(storage_->end);
 }
 
 Name&
 Name::append(const Name& name)
 {
+  if (empty())
+    {
+      // share the components of the other name
+      *this = name;
+      return *this;
+    }
+
   if (&name == this)
     // Copying from this name, so need to make a copy first.
     return append(Name(name));
 
-  for (size_t i = 0; i < name.components_.size(); ++i)
-    components_.push_back(name.components_[i]);
+  for (size_t i = 0; i < name.size(); ++i)
+    append(name.getComponentValue(i), name.getComponentValueSize(i));
   
   return *this;
 }
@@ -181,10 +609,53 @@ Name
 Name::getSubName(size_t iStartComponent, size_t nComponents) const
 {
   Name result;
-  
-  size_t iEnd = iStartComponent + nComponents;
-  for (size_t i = iStartComponent; i < iEnd && i < components_.size(); ++i)
-    result.components_.push_back(components_[i]);
+  if (iStartComponent >= size())
+    return result;
+
+  size_t iEnd = size();
+  if (nComponents < iEnd - iStartComponent)
+    iEnd = iStartComponent + nComponents;
+  if (iEnd == iStartComponent)
+    return result;
+
+  if (iStartComponent == 0 && iEnd == size())
+    {
+      result = *this;
+    }
+  else if (iStartComponent == 0 && iEnd <= nPrefix_)
+    {
+      result.prefix_ = prefix_;
+      result.nPrefix_ = iEnd;
+    }
+  else if (iStartComponent == 0 && nPrefix_ == 0)
+    {
+      // A prefix of the storage is shared as it is.
+      result.prefix_ = storage_;
+      result.nPrefix_ = iEnd;
+    }
+  else
+    {
+      // The result shares the buffers, only the offsets are copied.
+      if (iStartComponent < nPrefix_)
+        {
+          size_t iPrefixEnd = std::min(iEnd, nPrefix_);
+          if (iStartComponent == 0)
+            result.prefix_ = prefix_;
+          else
+            result.prefix_ = ptr_lib::make_shared<Storage>(*prefix_, iStartComponent, iPrefixEnd,
+                                                           getComponentEnd(iPrefixEnd - 1));
+          result.nPrefix_ = iPrefixEnd - iStartComponent;
+        }
+      if (iEnd > nPrefix_)
+        {
+          size_t iBegin = std::max(iStartComponent, nPrefix_);
+          if (iBegin == nPrefix_ && iEnd == size())
+            result.storage_ = storage_;
+          else
+            result.storage_ = ptr_lib::make_shared<Storage>(*storage_, iBegin - nPrefix_, iEnd - nPrefix_,
+                                                            getComponentEnd(iEnd - 1));
+        }
+    }
   
   return result;
 }
@@ -192,64 +663,114 @@ Name::getSubName(size_t iStartComponent, size_t nComponents) const
 Name
 Name::getSubName(size_t iStartComponent) const
 {
-  Name result;
-  
-  for (size_t i = iStartComponent; i < components_.size(); ++i)
-    result.components_.push_back(components_[i]);
-  
-  return result;
+  return getSubName(iStartComponent, size());
 }
 
 bool 
 Name::equals(const Name& name) const
 {
-  if (components_.size() != name.components_.size())
-    return false;
-
-  for (size_t i = 0; i < components_.size(); ++i) {
-    if (components_[i].getValue() != name.components_[i].getValue())
-      return false;
-  }
-
-  return true;
+  return size() == name.size() && compare(name) == 0;
 }
 
 bool 
 Name::isPrefixOf(const Name& name) const
 {
-  // Imitate ndn_Name_match.
-  
   // This name is longer than the name we are checking it against.
-  if (components_.size() > name.components_.size())
+  if (size() > name.size())
     return false;
 
-  // Check if at least one of given components doesn't match.
-  for (size_t i = 0; i < components_.size(); ++i) {
-    if (components_[i].getValue() != name.components_[i].getValue())
-      return false;
-  }
+  return compare(0, size(), name, 0, size()) == 0;
+}
 
-  return true;
+int
+Name::compare(size_t iStartComponent, size_t nComponents, const Name &other,
+              size_t iOtherStartComponent/* = 0*/, size_t nOtherComponents/* = npos*/) const
+{
+  size_t i1 = std::min(iStartComponent, size());
+  size_t end1 = i1 + std::min(nComponents, size() - i1);
+  size_t i2 = std::min(iOtherStartComponent, other.size());
+  size_t end2 = i2 + std::min(nOtherComponents, other.size() - i2);
+
+  while (i1 < end1 && i2 < end2)
+    {
+      // Identical bytes decode to identical components, so the components before the first byte
+      // where the encodings differ are equal, and the component containing that byte is the
+      // first one which can differ.
+      // The components are compared a run at a time, a run being the components in the same
+      // buffer.  A shared prefix is found equal at once, being at the same address.
+      size_t j1, jEnd1, j2, jEnd2;
+      const Storage &run1 = getRun(i1, end1, j1, jEnd1);
+      const Storage &run2 = other.getRun(i2, end2, j2, jEnd2);
+      size_t begin1 = run1.offsets[j1].begin;
+      size_t begin2 = run2.offsets[j2].begin;
+      size_t size1 = run1.getComponentEnd(jEnd1 - 1) - begin1;
+      size_t size2 = run2.getComponentEnd(jEnd2 - 1) - begin2;
+      size_t mismatch = findMismatch(run1.buffer->buf() + begin1, run2.buffer->buf() + begin2,
+                                     std::min(size1, size2));
+      if (mismatch == std::min(size1, size2))
+        {
+          // One run of components is the other one or a prefix of it, so continue after the shorter.
+          size_t n = size1 <= size2 ? jEnd1 - j1 : jEnd2 - j2;
+          i1 += n;
+          i2 += n;
+          continue;
+        }
+
+      // Find the last component of this name beginning at or before the mismatch.
+      size_t low = j1;
+      size_t high = jEnd1;
+      while (high - low > 1)
+        {
+          size_t middle = low + (high - low) / 2;
+          if (run1.offsets[middle].begin - begin1 <= mismatch)
+            low = middle;
+          else
+            high = middle;
+        }
+      size_t k1 = low;
+      size_t k2 = j2 + (low - j1);
+
+      size_t value1 = run1.offsets[k1].value;
+      size_t value2 = run2.offsets[k2].value;
+      int result = compareValues(run1.buffer->buf() + value1, run1.getComponentEnd(k1) - value1,
+                                 run2.buffer->buf() + value2, run2.getComponentEnd(k2) - value2);
+      if (result != 0)
+        return result;
+
+      // Equal values with differently encoded lengths, so continue after them.
+      i1 += low - j1 + 1;
+      i2 += low - j1 + 1;
+    }
+
+  size_t n1 = end1 - i1;
+  size_t n2 = end2 - i2;
+  return n1 == n2 ? 0 : (n1 < n2 ? -1 : 1);
 }
 
 Name::Component 
 Name::fromEscapedString(const char *escapedString, size_t beginOffset, size_t endOffset)
 {
-  string trimmedString(escapedString + beginOffset, escapedString + endOffset);
-  trim(trimmedString);
-  string value = unescape(trimmedString);
-        
-  if (value.find_first_not_of(".") == string::npos) {
+  const char *begin = escapedString + beginOffset;
+  const char *end = escapedString + endOffset;
+  trimWhitespace(begin, end);
+  if (begin == end)
+    // An empty component is illegal.
+    return Component();
+
+  BufferPtr value = allocateBuffer(end - begin);
+  value->resize(unescape(begin, end, value->buf()));
+
+  if (isAllPeriods(value->buf(), value->size())) {
     // Special case for component of only periods.  
-    if (value.size() <= 2)
+    if (value->size() <= 2)
       // Zero, one or two periods is illegal.  Ignore this component.
       return Component();
     else
       // Remove 3 periods.
-      return Component((const uint8_t *)&value[3], value.size() - 3); 
+      value->erase(value->begin(), value->begin() + 3);
   }
-  else
-    return Component((const uint8_t *)&value[0], value.size()); 
+  NDN_INSTRUMENT(COMPONENT_ALLOCATIONS);
+  return Component(value);
 }
 
 Name::Component
@@ -258,117 +779,242 @@ Name::fromEscapedString(const char *escapedString)
   return fromEscapedString(escapedString, 0, ::strlen(escapedString));
 }
 
-void
-Name::toEscapedString(const uint8_t *value, size_t valueSize, std::ostream& result)
+/**
+ * Write the string made by the function into the stream, using a buffer on the stack if the string
+ * fits into it.
+ */
+template<class Function>
+static void
+writeString(std::ostream &os, Function function)
 {
-  bool gotNonDot = false;
-  for (unsigned i = 0; i < valueSize; ++i) {
-    if (value[i] != 0x2e) {
-      gotNonDot = true;
-      break;
+  char buffer[256];
+  size_t size = function(buffer, sizeof(buffer));
+  if (size < sizeof(buffer))
+    os.write(buffer, size);
+  else
+    {
+      std::vector<char> largeBuffer(size + 1);
+      function(&largeBuffer[0], largeBuffer.size());
+      os.write(&largeBuffer[0], size);
     }
+}
+
+size_t
+Name::toEscapedString(const uint8_t *value, size_t valueSize, char *buffer, size_t bufferSize)
+{
+  UriWriter writer(buffer, bufferSize);
+  writer.putEscaped(value, valueSize);
+  return writer.finish();
+}
+
+/**
+ * @brief Function object for writeString that calls Name::toEscapedString
+ */
+class EscapedStringFunction
+{
+public:
+  EscapedStringFunction(const uint8_t *value, size_t valueSize)
+    : m_value(value)
+    , m_valueSize(valueSize)
+  {
   }
-  if (!gotNonDot) {
-    // Special case for component of zero or more periods.  Add 3 periods.
-    result << "...";
-    for (size_t i = 0; i < valueSize; ++i)
-      result << '.';
+
+  size_t
+  operator()(char *buffer, size_t bufferSize) const
+  {
+    return Name::toEscapedString(m_value, m_valueSize, buffer, bufferSize);
   }
-  else {
-    // In case we need to escape, set to upper case hex and save the previous flags.
-    ios::fmtflags saveFlags = result.flags(ios::hex | ios::uppercase);
-    
-    for (size_t i = 0; i < valueSize; ++i) {
-      uint8_t x = value[i];
-      // Check for 0-9, A-Z, a-z, (+), (-), (.), (_)
-      if ((x >= 0x30 && x <= 0x39) || (x >= 0x41 && x <= 0x5a) ||
-          (x >= 0x61 && x <= 0x7a) || x == 0x2b || x == 0x2d || 
-          x == 0x2e || x == 0x5f)
-        result << x;
-      else {
-        result << '%';
-        if (x < 16)
-          result << '0';
-        result << (unsigned int)x;
-      }
+
+private:
+  const uint8_t *m_value;
+  size_t m_valueSize;
+};
+
+void
+Name::toEscapedString(const uint8_t *value, size_t valueSize, std::ostream& result)
+{
+  writeString(result, EscapedStringFunction(value, valueSize));
+}
+
+size_t
+Name::toUri(char *buffer, size_t bufferSize) const
+{
+  UriWriter writer(buffer, bufferSize);
+  if (empty())
+    writer.put('/');
+  else
+    {
+      for (size_t i = 0; i < size(); ++i)
+        {
+          writer.put('/');
+          writer.putEscaped(getComponentValue(i), getComponentValueSize(i));
+        }
     }
-    
-    // Restore.
-    result.flags(saveFlags);
-  }  
+  return writer.finish();
+}
+
+std::string
+Name::toUri() const
+{
+  char buffer[256];
+  size_t size = toUri(buffer, sizeof(buffer));
+  if (size < sizeof(buffer))
+    return std::string(buffer, size);
+
+  std::string uri(size + 1, 0);
+  toUri(&uri[0], uri.size());
+  uri.resize(size);
+  return uri;
 }
 
 bool 
 Name::breadthFirstLess(const Name& name1, const Name& name2)
 {
-  for (size_t i = 0; i < name1.size() && i < name2.size(); ++i) {
-    if (name1[i] == name2[i])
-      // The components at this index are equal, so check the next components.
-      continue;
-    
-    // Otherwise, the result is based on the components at this index.
-    return name1[i] < name2[i];
-  }
-  
-  // The components up to min(name1.size(), name2.size()) are equal, so sort on the shorter name.
-  return name1.size() < name2.size();
+  return name1.compare(name2) < 0;
 }
 
+/**
+ * @brief Function object for writeString that calls Name::toUri
+ */
+class UriFunction
+{
+public:
+  explicit
+  UriFunction(const Name &name)
+    : m_name(name)
+  {
+  }
+
+  size_t
+  operator()(char *buffer, size_t bufferSize) const
+  {
+    return m_name.toUri(buffer, bufferSize);
+  }
+
+private:
+  const Name &m_name;
+};
+
 std::ostream&
 operator << (std::ostream& os, const Name& name)
 {
-  if (name.empty())
+  writeString(os, UriFunction(name));
+  return os;
+}
+
+template<bool T>
+size_t
+Name::wireEncode(EncodingImpl<T> &block) const
+{
+  if (wire_.hasWire())
+    return block.prependByteArray(wire_.wire(), wire_.size());
+
+  // the components are already encoded
+  size_t totalLength = 0;
+  if (storage_ && !storage_->offsets.empty())
     {
-      os << "/";
+      size_t begin = storage_->offsets[0].begin;
+      totalLength += block.prependByteArray(storage_->buffer->buf() + begin, storage_->end - begin);
     }
-  else
+  if (nPrefix_ > 0)
     {
-      for (Name::const_iterator i = name.begin(); i != name.end(); i++) {
-        os << "/";
-        i->toEscapedString(os);
-      }
+      size_t begin = prefix_->offsets[0].begin;
+      totalLength += block.prependByteArray(prefix_->buffer->buf() + begin, getPrefixEnd() - begin);
     }
-  
-  return os;
+
+  totalLength += block.prependVarNumber(totalLength);
+  totalLength += block.prependVarNumber(Tlv::Name);
+  return totalLength;
 }
 
+template size_t
+Name::wireEncode<true>(EncodingImpl<true> &block) const;
+
+template size_t
+Name::wireEncode<false>(EncodingImpl<false> &block) const;
+
 const Block &
 Name::wireEncode() const
 {
   if (wire_.hasWire())
     return wire_;
 
-  wire_ = Block(Tlv::Name);
-  for (Name::const_iterator i = begin(); i != end(); i++) {
-    OBufferStream os;
-    Tlv::writeVarNumber(os, Tlv::NameComponent);
-    Tlv::writeVarNumber(os, i->getValue().size());
-    os.write(reinterpret_cast<const char*>(i->getValue().buf()), i->getValue().size());
+  if (isStorageUnique() && !storage_->offsets.empty())
+    {
+      const ConstBufferPtr &storageBuffer = storage_->buffer;
+      const uint8_t *prefix = 0;
+      size_t prefixSize = 0;
+      if (nPrefix_ > 0)
+        {
+          prefix = prefix_->buffer->buf() + prefix_->offsets[0].begin;
+          prefixSize = getPrefixEnd() - prefix_->offsets[0].begin;
+        }
+      size_t valueSize = prefixSize + storage_->end - storage_->offsets[0].begin;
+      size_t headerSize = Tlv::sizeOfVarNumber(Tlv::Name) + Tlv::sizeOfVarNumber(valueSize);
+      if (headerSize + prefixSize <= storage_->offsets[0].begin)
+        {
+          // No one else can see the buffer, so the prefix, then the type and length are written
+          // just before the components and the wire is the buffer itself.
+          size_t begin = storage_->offsets[0].begin - prefixSize;
+          uint8_t *header = const_cast<uint8_t*>(storageBuffer->buf()) + begin - headerSize;
+          if (prefixSize > 0)
+            memcpy(header + headerSize, prefix, prefixSize);
+          header += Tlv::writeVarNumber(header, Tlv::Name);
+          Tlv::writeVarNumber(header, valueSize);
+
+          Buffer::const_iterator wireBegin = storageBuffer->begin() + (begin - headerSize);
+          Buffer::const_iterator wireEnd = storageBuffer->begin() + storage_->end;
+          Buffer::const_iterator valueBegin = storageBuffer->begin() + begin;
+          Buffer::const_iterator valueEnd = wireEnd;
+          wire_ = Block(storageBuffer, Tlv::Name, wireBegin, wireEnd, valueBegin, valueEnd);
+          return wire_;
+        }
+    }
 
-    wire_.push_back(Block(os.buf()));
-  }
-        
-  wire_.encode();
+  EncodingEstimator estimator;
+  size_t estimatedSize = wireEncode(estimator);
+
+  EncodingBuffer buffer(estimatedSize, 0);
+  wireEncode(buffer);
+
+  wire_ = buffer.block();
   return wire_;
 }
 
 void
 Name::wireDecode(const Block &wire)
 {
-  clear();
-  
+  prefix_.reset();
+  nPrefix_ = 0;
   wire_ = wire;
-  wire_.parse();
 
-  components_.clear();
-  components_.reserve(wire_.getAll().size());
+  if (wire_.value_size() == 0)
+    {
+      storage_.reset();
+      return;
+    }
+
+  if (storage_ && storage_.unique())
+    storage_->offsets.clear();
+  else
+    storage_ = ptr_lib::make_shared<Storage>();
+
+  // The components stay in the buffer of the wire, only their offsets are recorded.
+  storage_->buffer = wire_.sharedBuffer();
+  const uint8_t *base = storage_->buffer->buf();
+  const uint8_t *value = base + (wire_.value_begin() - storage_->buffer->begin());
 
-  for (Block::element_const_iterator i = wire_.getAll().begin();
-       i != wire_.getAll().end();
-       ++i)
+  std::vector<ComponentOffset> &offsets = storage_->offsets;
+  TlvReader reader(value, value + wire_.value_size());
+  offsets.reserve(reader.count());
+  while (reader.next())
     {
-      append(i->value(), i->value_size());
+      ComponentOffset offset;
+      offset.begin = static_cast<uint32_t>(reader.wire() - base);
+      offset.value = static_cast<uint32_t>(reader.value() - base);
+      offsets.push_back(offset);
     }
+  storage_->end = value + wire_.value_size() - base;
 }
 
 
@@ -6,11 +6,14 @@
  */
 
 #include <stdexcept>
+#include <algorithm>
+#include <cmath>
 #include "c/util/time.h"
 
 #include <ndn-cpp/forwarding-entry.hpp>
 #include <ndn-cpp/face-instance.hpp>
 #include <ndn-cpp/node.hpp>
+#include <ndn-cpp/encoding/tlv-reader.hpp>
 
 #include "util/ndnd-id-fetcher.hpp"
 
@@ -25,13 +28,18 @@ using namespace ndn::func_lib::placeholders;
 
 namespace ndn {
 
-uint64_t Node::PendingInterest::lastPendingInterestId_ = 0;
-uint64_t Node::RegisteredPrefix::lastRegisteredPrefixId_ = 0;
+Atomic<uint64_t> Node::PendingInterest::lastPendingInterestId_;
+Atomic<uint64_t> Node::RegisteredPrefix::lastRegisteredPrefixId_;
 
 Node::Node(const ptr_lib::shared_ptr<Transport>& transport)
   : pitTimeoutCheckTimerActive_(false)
+  , pitTimeoutCheckTimeMilliseconds_(0)
+  , pitEmptyCheckPosted_(false)
   , transport_(transport)
+  , registeredPrefixTable_(false)
   , ndndIdFetcherInterest_(Name("/%C1.M.S.localhost/%C1.M.SRV/ndnd/KEY"), 4000.0)
+  , isThreadSafe_(false)
+  , isProcessingCommands_(false)
 {
   ioService_ = ptr_lib::make_shared<boost::asio::io_service>();      
   pitTimeoutCheckTimer_      = ptr_lib::make_shared<boost::asio::deadline_timer>(boost::ref(*ioService_));
@@ -41,8 +49,13 @@ Node::Node(const ptr_lib::shared_ptr<Transport>& transport)
 Node::Node(const ptr_lib::shared_ptr<Transport>& transport, const ptr_lib::shared_ptr<boost::asio::io_service> &ioService)
   : ioService_(ioService)
   , pitTimeoutCheckTimerActive_(false)
+  , pitTimeoutCheckTimeMilliseconds_(0)
+  , pitEmptyCheckPosted_(false)
   , transport_(transport)
+  , registeredPrefixTable_(false)
   , ndndIdFetcherInterest_(Name("/%C1.M.S.localhost/%C1.M.SRV/ndnd/KEY"), 4000.0)
+  , isThreadSafe_(false)
+  , isProcessingCommands_(false)
 {
   pitTimeoutCheckTimer_      = ptr_lib::make_shared<boost::asio::deadline_timer>(boost::ref(*ioService_));
   processEventsTimeoutTimer_ = ptr_lib::make_shared<boost::asio::deadline_timer>(boost::ref(*ioService_));
@@ -51,45 +64,77 @@ Node::Node(const ptr_lib::shared_ptr<Transport>& transport, const ptr_lib::share
 uint64_t 
 Node::expressInterest(const Interest& interest, const OnData& onData, const OnTimeout& onTimeout)
 {
-  if (!transport_->isConnected())
-    transport_->connect(*ioService_,
-                        ptr_lib::bind(&Node::onReceiveElement, this, _1));
-  
   uint64_t pendingInterestId = PendingInterest::getNextPendingInterestId();
-  pendingInterestTable_.push_back(ptr_lib::shared_ptr<PendingInterest>(new PendingInterest
-    (pendingInterestId, ptr_lib::shared_ptr<const Interest>(new Interest(interest)), onData, onTimeout)));
-
-  transport_->send(interest.wireEncode());
-
-  if (!pitTimeoutCheckTimerActive_) {
-    pitTimeoutCheckTimerActive_ = true;
-    pitTimeoutCheckTimer_->expires_from_now(boost::posix_time::milliseconds(100));
-    pitTimeoutCheckTimer_->async_wait(func_lib::bind(&Node::checkPitExpire, this));
+  ptr_lib::shared_ptr<const Interest> interestCopy(new Interest(interest));
+  if (isThreadSafe_) {
+    // Encode in the calling thread rather than in the thread running processEvents.  The copy is
+    // not shared yet, and Interest::getNonce may be called from several threads at once.
+    interestCopy->wireEncode();
+    callInIoThread(func_lib::bind(&Node::expressInterestHelper, this,
+                                  pendingInterestId, interestCopy, onData, onTimeout));
   }
+  else
+    expressInterestHelper(pendingInterestId, interestCopy, onData, onTimeout);
   
   return pendingInterestId;
 }
 
+void
+Node::expressInterestHelper(uint64_t pendingInterestId, const ptr_lib::shared_ptr<const Interest>& interest,
+                            const OnData& onData, const OnTimeout& onTimeout)
+{
+  if (!transport_->isConnected())
+    transport_->connect(*ioService_,
+                        ptr_lib::bind(&Node::onReceiveElement, this, _1));
+  
+  ptr_lib::shared_ptr<PendingInterest> pendingInterest
+    (new PendingInterest(pendingInterestId, interest, onData, onTimeout));
+  pendingInterestTable_.insert(pendingInterestId, *interest, pendingInterest);
+  pendingInterestTimeouts_.push_back(PendingInterestTimeout(pendingInterest));
+  std::push_heap(pendingInterestTimeouts_.begin(), pendingInterestTimeouts_.end());
+
+  transport_->send(interest->wireEncode());
+
+  // Only reset the timer if this interest times out before the one it is set for.
+  if (!pitTimeoutCheckTimerActive_ ||
+      pendingInterest->getTimeoutTimeMilliseconds() < pitTimeoutCheckTimeMilliseconds_)
+    schedulePitTimeoutCheck(pendingInterest->getTimeoutTimeMilliseconds());
+}
+
 void
 Node::put(const Data &data)
+{
+  if (isThreadSafe_)
+    callInIoThread(func_lib::bind(&Node::putHelper, this, data.wireEncode()));
+  else
+    putHelper(data.wireEncode());
+}
+
+void
+Node::putHelper(const Block &wire)
 {
   if (!transport_->isConnected())
     transport_->connect(*ioService_,
                         ptr_lib::bind(&Node::onReceiveElement, this, _1));
 
-  transport_->send(data.wireEncode());
+  transport_->send(wire);
 }
 
 
 void
 Node::removePendingInterest(uint64_t pendingInterestId)
 {
-  // Go backwards through the list so we can erase entries.
-  // Remove all entries even though pendingInterestId should be unique.
-  for (int i = (int)pendingInterestTable_.size() - 1; i >= 0; --i) {
-    if (pendingInterestTable_[i]->getPendingInterestId() == pendingInterestId)
-      pendingInterestTable_.erase(pendingInterestTable_.begin() + i);
-  }
+  if (isThreadSafe_)
+    callInIoThread(func_lib::bind(&Node::removePendingInterestHelper, this, pendingInterestId));
+  else
+    removePendingInterestHelper(pendingInterestId);
+}
+
+void
+Node::removePendingInterestHelper(uint64_t pendingInterestId)
+{
+  if (pendingInterestTable_.erase(pendingInterestId))
+    removeStalePendingInterestTimeouts();
 }
 
 uint64_t 
@@ -100,6 +145,20 @@ Node::registerPrefix
   uint64_t registeredPrefixId = RegisteredPrefix::getNextRegisteredPrefixId();
   ptr_lib::shared_ptr<const Name> prefixPtr = ptr_lib::make_shared<const Name>(prefix);
   
+  if (isThreadSafe_)
+    callInIoThread(func_lib::bind(&Node::fetchNdndIdAndRegisterPrefix, this,
+                                  registeredPrefixId, prefixPtr, onInterest, onRegisterFailed, flags));
+  else
+    fetchNdndIdAndRegisterPrefix(registeredPrefixId, prefixPtr, onInterest, onRegisterFailed, flags);
+  
+  return registeredPrefixId;
+}
+
+void
+Node::fetchNdndIdAndRegisterPrefix
+  (uint64_t registeredPrefixId, const ptr_lib::shared_ptr<const Name>& prefixPtr, const OnInterest& onInterest,
+   const OnRegisterFailed& onRegisterFailed, const ForwardingFlags& flags)
+{
   if (ndndId_.size() == 0) {
     // First fetch the ndndId of the connected hub.
     NdndIdFetcher fetcher(ndndId_,
@@ -109,50 +168,63 @@ Node::registerPrefix
 
     // @todo: Check if this crash
     // It is OK for func_lib::function make a copy of the function object because the Info is in a ptr_lib::shared_ptr.
-    expressInterest(ndndIdFetcherInterest_, fetcher, fetcher);
+    expressInterestHelper(PendingInterest::getNextPendingInterestId(),
+                          ptr_lib::make_shared<Interest>(ndndIdFetcherInterest_), fetcher, fetcher);
   }
   else
     registerPrefixHelper(registeredPrefixId, prefixPtr, onInterest, onRegisterFailed, flags);
-  
-  return registeredPrefixId;
 }
 
 void
 Node::removeRegisteredPrefix(uint64_t registeredPrefixId)
 {
-  // Go backwards through the list so we can erase entries.
-  // Remove all entries even though pendingInterestId should be unique.
+  if (isThreadSafe_)
+    callInIoThread(func_lib::bind(&Node::removeRegisteredPrefixHelper, this, registeredPrefixId));
+  else
+    removeRegisteredPrefixHelper(registeredPrefixId);
+}
 
-  for (RegisteredPrefixTable::iterator i = registeredPrefixTable_.begin();
-       i != registeredPrefixTable_.end();
-       ++i)
-    {
-      if ((*i)->getRegisteredPrefixId() == registeredPrefixId) {
-        ForwardingEntry forwardingEntry("unreg", *(*i)->getPrefix(), faceId_);
-        Data data;
-        data.setContent(forwardingEntry.wireEncode());
-        
-        SignatureSha256WithRsa signature;
-        signature.setValue(Block(Tlv::SignatureValue, ptr_lib::make_shared<Buffer>()));
-        data.setSignature(signature);
-
-        // Create an interest where the name has the encoded Data packet.
-        Name interestName;
-        interestName.append("ndnx");
-        interestName.append(ndndId_);
-        interestName.append("unreg");
-        interestName.append(data.wireEncode());
-
-        Interest interest(interestName);
-        interest.setScope(1);
-        interest.setInterestLifetime(1000);
-
-        expressInterest(interest, OnData(), OnTimeout());
-        
-        registeredPrefixTable_.erase(i);
-        break;
-      }
-    }
+void
+Node::removeRegisteredPrefixHelper(uint64_t registeredPrefixId)
+{
+  RegisteredPrefixIdIndex::iterator entry = registeredPrefixIds_.find(registeredPrefixId);
+  if (entry == registeredPrefixIds_.end())
+    return;
+  ptr_lib::shared_ptr<RegisteredPrefix> registeredPrefix = entry->second;
+  registeredPrefixIds_.erase(entry);
+
+  const Name &prefix = *registeredPrefix->getPrefix();
+  RegisteredPrefixList entries;
+  registeredPrefixTable_.findExactMatch(prefix, entries);
+  entries.erase(std::find(entries.begin(), entries.end(), registeredPrefix));
+  if (!entries.empty()) {
+    // Other entries still need the prefix to be registered with the hub.
+    registeredPrefixTable_.insert(prefix, entries);
+    return;
+  }
+  registeredPrefixTable_.erase(prefix);
+
+  ForwardingEntry forwardingEntry("unreg", prefix, faceId_);
+  Data data;
+  data.setContent(forwardingEntry.wireEncode());
+
+  SignatureSha256WithRsa signature;
+  signature.setValue(Block(Tlv::SignatureValue, ptr_lib::make_shared<Buffer>()));
+  data.setSignature(signature);
+
+  // Create an interest where the name has the encoded Data packet.
+  Name interestName;
+  interestName.append("ndnx");
+  interestName.append(ndndId_);
+  interestName.append("unreg");
+  interestName.append(data.wireEncode());
+
+  Interest interest(interestName);
+  interest.setScope(1);
+  interest.setInterestLifetime(1000);
+
+  expressInterestHelper(PendingInterest::getNextPendingInterestId(), ptr_lib::make_shared<Interest>(interest),
+                        OnData(), OnTimeout());
 }
 
 void 
@@ -190,10 +262,10 @@ Node::registerPrefixHelper(uint64_t registeredPrefixId,
   interest.setScope(1);
   interest.setInterestLifetime(1000);
 
-  expressInterest(interest,
-                  func_lib::bind(&Node::registerPrefixFinal, this,
-                                 registeredPrefixId, prefix, onInterest, onRegisterFailed, _1, _2),
-                  func_lib::bind(onRegisterFailed, prefix));
+  expressInterestHelper(PendingInterest::getNextPendingInterestId(), ptr_lib::make_shared<Interest>(interest),
+                        func_lib::bind(&Node::registerPrefixFinal, this,
+                                       registeredPrefixId, prefix, onInterest, onRegisterFailed, _1, _2),
+                        func_lib::bind(onRegisterFailed, prefix));
 }
 
 void
@@ -206,13 +278,13 @@ Node::registerPrefixFinal(uint64_t registeredPrefixId,
   Block content = data->getContent();
   content.parse();
 
-  if (content.getAll().empty())
+  if (content.elements_size() == 0)
     {
       onRegisterFailed(prefix);
       return;
     }
 
-  Block::element_iterator val = content.getAll().begin();
+  Block::element_const_iterator val = content.elements_begin();
   
   switch(val->type())
     {
@@ -221,8 +293,14 @@ Node::registerPrefixFinal(uint64_t registeredPrefixId,
         ForwardingEntry entry;
         entry.wireDecode(*val);
 
-        // Save the onInterest callback and send the registration interest.
-        registeredPrefixTable_.push_back(ptr_lib::make_shared<RegisteredPrefix>(registeredPrefixId, prefix, onInterest));
+        // Save the onInterest callback after those already registered for the prefix.
+        ptr_lib::shared_ptr<RegisteredPrefix> registeredPrefix =
+          ptr_lib::make_shared<RegisteredPrefix>(registeredPrefixId, prefix, onInterest);
+        RegisteredPrefixList entries;
+        registeredPrefixTable_.findExactMatch(*prefix, entries);
+        entries.push_back(registeredPrefix);
+        registeredPrefixTable_.insert(*prefix, entries);
+        registeredPrefixIds_[registeredPrefixId] = registeredPrefix;
 
         /// @todo Notify user about successful registration
         
@@ -250,6 +328,46 @@ Node::registerPrefixFinal(uint64_t registeredPrefixId,
     }
 }
 
+void
+Node::enableThreadSafety()
+{
+  isThreadSafe_ = true;
+}
+
+void
+Node::callInIoThread(const Command &command)
+{
+  commands_.push(command);
+  // Only post processCommands if it is not already posted or running, so that the lock of the
+  // io_service is taken once for all the commands queued meanwhile.
+  if (!isProcessingCommands_.exchange(true))
+    ioService_->post(func_lib::bind(&Node::processCommands, this));
+}
+
+void
+Node::processCommands()
+{
+  for (;;) {
+    Command command;
+    while (commands_.pop(command)) {
+      try {
+        command();
+      }
+      catch (...) {
+        // Let processEvents handle the exception, and process the rest of the commands after it.
+        ioService_->post(func_lib::bind(&Node::processCommands, this));
+        throw;
+      }
+    }
+
+    isProcessingCommands_.store(false);
+    // A command queued before the store, whose caller saw that processCommands was running, must
+    // not wait for the next one.
+    if (commands_.empty() || isProcessingCommands_.exchange(true))
+      return;
+  }
+}
+
 void 
 Node::processEvents(Milliseconds timeout/* = 0 */, bool keepThread/* = false*/)
 {
@@ -259,6 +377,8 @@ Node::processEvents(Milliseconds timeout/* = 0 */, bool keepThread/* = false*/)
         {
           // do not block if timeout is negative, but process pending events
           ioService_->poll();
+          // poll stops the io_service when it runs out of work, which the next call must undo
+          ioService_->reset();
           return;
         }
 
@@ -285,7 +405,9 @@ Node::processEvents(Milliseconds timeout/* = 0 */, bool keepThread/* = false*/)
     {
       ioService_->reset();
       pendingInterestTable_.clear();
+      pendingInterestTimeouts_.clear();
       registeredPrefixTable_.clear();
+      registeredPrefixIds_.clear();
       throw;
     }
 }
@@ -298,74 +420,214 @@ Node::fireProcessEventsTimeout(const boost::system::error_code& error)
 }
 
 void
-Node::checkPitExpire()
+Node::schedulePitTimeoutCheck(MillisecondsSince1970 timeoutTimeMilliseconds)
+{
+  // Round up, so that the interests have timed out when checkPitExpire is called.
+  MillisecondsSince1970 delayMilliseconds = ceil(timeoutTimeMilliseconds - ndn_getNowMilliseconds());
+  pitTimeoutCheckTimer_->expires_from_now
+    (boost::posix_time::milliseconds(delayMilliseconds > 0 ? static_cast<long>(delayMilliseconds) : 0));
+  pitTimeoutCheckTimer_->async_wait(func_lib::bind(&Node::checkPitExpire, this, _1));
+  pitTimeoutCheckTimerActive_ = true;
+  pitTimeoutCheckTimeMilliseconds_ = timeoutTimeMilliseconds;
+}
+
+void
+Node::checkPitExpire(const boost::system::error_code &error)
 {
-  // Check for PIT entry timeouts.  Go backwards through the list so we can erase entries.
+  if (error == boost::asio::error::operation_aborted)
+    // The timer was set again, or canceled by shutdown.
+    return;
+  pitTimeoutCheckTimerActive_ = false;
+
+  // Take the timed out entries from the top of the heap, skipping those of pending interests which
+  // are no longer in the table.  A timeout callback may express or remove interests.
   MillisecondsSince1970 nowMilliseconds = ndn_getNowMilliseconds();
-  for (int i = (int)pendingInterestTable_.size() - 1; i >= 0; --i) {
-    if (pendingInterestTable_[i]->isTimedOut(nowMilliseconds)) {
-      // Save the PendingInterest and remove it from the PIT.  Then call the callback.
-      ptr_lib::shared_ptr<PendingInterest> pendingInterest = pendingInterestTable_[i];
-      pendingInterestTable_.erase(pendingInterestTable_.begin() + i);
+  while (!pendingInterestTimeouts_.empty()) {
+    ptr_lib::shared_ptr<PendingInterest> pendingInterest = pendingInterestTimeouts_.front().pendingInterest;
+    bool isPending = pendingInterestTable_.contains(pendingInterest->getPendingInterestId());
+    if (isPending && !pendingInterest->isTimedOut(nowMilliseconds))
+      break;
+
+    std::pop_heap(pendingInterestTimeouts_.begin(), pendingInterestTimeouts_.end());
+    pendingInterestTimeouts_.pop_back();
+    if (isPending) {
+      // Remove the PendingInterest from the PIT.  Then call the callback.
+      pendingInterestTable_.erase(pendingInterest->getPendingInterestId());
       pendingInterest->callTimeout();
-      
+
       // Refresh now since the timeout callback might have delayed.
       nowMilliseconds = ndn_getNowMilliseconds();
     }
   }
 
   if (!pendingInterestTable_.empty()) {
-    pitTimeoutCheckTimerActive_ = true;
-    
-    pitTimeoutCheckTimer_->expires_from_now(boost::posix_time::milliseconds(100));
-    pitTimeoutCheckTimer_->async_wait(func_lib::bind(&Node::checkPitExpire, this));
+    if (!pitTimeoutCheckTimerActive_ ||
+        pendingInterestTimeouts_.front().timeoutTimeMilliseconds != pitTimeoutCheckTimeMilliseconds_)
+      schedulePitTimeoutCheck(pendingInterestTimeouts_.front().timeoutTimeMilliseconds);
   }
-  else {
+  else
+    onPitEmpty();
+}
+
+void
+Node::checkPitEmpty()
+{
+  pitEmptyCheckPosted_ = false;
+  if (pendingInterestTable_.empty() && pitTimeoutCheckTimerActive_)
+    onPitEmpty();
+}
+
+void
+Node::onPitEmpty()
+{
+  if (pitTimeoutCheckTimerActive_) {
+    pitTimeoutCheckTimer_->cancel();
     pitTimeoutCheckTimerActive_ = false;
+  }
 
-    if (registeredPrefixTable_.empty()) {
-      transport_->close();
-      if (!ioServiceWork_) {
-        processEventsTimeoutTimer_->cancel();
-      }
+  if (registeredPrefixTable_.empty()) {
+    transport_->close();
+    if (!ioServiceWork_) {
+      processEventsTimeoutTimer_->cancel();
     }
   }
 }
 
+void
+Node::removeStalePendingInterestTimeouts()
+{
+  if (pendingInterestTable_.empty()) {
+    pendingInterestTimeouts_.clear();
+    if (pitTimeoutCheckTimerActive_ && !pitEmptyCheckPosted_) {
+      // Check after the callbacks running now, which may express new interests.
+      pitEmptyCheckPosted_ = true;
+      ioService_->post(func_lib::bind(&Node::checkPitEmpty, this));
+    }
+    return;
+  }
+
+  // Rebuilding the heap takes time in proportion to its size, and at least half of its entries
+  // are dropped, so that the cost of removing an entry is constant on average.
+  if (pendingInterestTimeouts_.size() <= 2 * pendingInterestTable_.size() + 64)
+    return;
+
+  PendingInterestTimeoutQueue::iterator end = pendingInterestTimeouts_.begin();
+  for (PendingInterestTimeoutQueue::iterator i = pendingInterestTimeouts_.begin();
+       i != pendingInterestTimeouts_.end(); ++i) {
+    if (pendingInterestTable_.contains(i->pendingInterest->getPendingInterestId())) {
+      if (end != i)
+        *end = *i;
+      ++end;
+    }
+  }
+  pendingInterestTimeouts_.erase(end, pendingInterestTimeouts_.end());
+  std::make_heap(pendingInterestTimeouts_.begin(), pendingInterestTimeouts_.end());
+}
+
+
+/**
+ * @brief Get the Name at the start of the packet without decoding the rest of it
+ * @return false if the packet does not start with a well-formed Name
+ */
+static bool
+decodePacketName(const Block &packet, Name &name)
+{
+  try {
+    TlvReader reader(packet);
+    if (!reader.next() || reader.type() != Tlv::Name)
+      return false;
+
+    name = Name(packet.slice(reader.wire(), reader.size()));
+    return true;
+  }
+  catch (Tlv::Error &) {
+    return false;
+  }
+  catch (Block::Error &) {
+    return false;
+  }
+}
+
+/**
+ * @brief Decode the Interest or Data packet
+ * @return false if the packet is malformed
+ */
+template<class Packet>
+static bool
+decodePacket(const Block &wire, Packet &packet)
+{
+  try {
+    packet.wireDecode(wire);
+    return true;
+  }
+  catch (Tlv::Error &) {
+    return false;
+  }
+  catch (Block::Error &) {
+    return false;
+  }
+}
 
 void 
 Node::onReceiveElement(const Block &block)
 {
+  // A malformed packet from the network is dropped: a decoding error must not escape to
+  // processEvents, which would clear the tables of the application.
+
+  // Look at the Name in the packet header before decoding the whole packet, which is only
+  // needed if there is someone to deliver it to.
+  Name name;
+  if (!decodePacketName(block, name))
+    return;
+
   if (block.type() == Tlv::Interest)
     {
+      // The snapshot keeps the entries while the callbacks run, even if they remove them.
+      RegisteredPrefixTable::Snapshot registeredPrefixes = registeredPrefixTable_.getSnapshot();
+      if (registeredPrefixes.empty())
+        return;
+
+      // Find the registered prefixes with the name alone, so that an interest which no one is
+      // waiting for is not decoded.
+      const RegisteredPrefixList *entries = registeredPrefixes.findLongestPrefixMatch(name);
+      if (entries == 0)
+        return;
+
       ptr_lib::shared_ptr<Interest> interest(new Interest());
-      interest->wireDecode(block);
-    
-      RegisteredPrefixTable::iterator entry = getEntryForRegisteredPrefix(interest->getName());
-      if (entry != registeredPrefixTable_.end()) {
+      if (!decodePacket(block, *interest))
+        return;
+
+      for (RegisteredPrefixList::const_iterator entry = entries->begin(); entry != entries->end(); ++entry) {
         (*entry)->getOnInterest()((*entry)->getPrefix(), interest, *transport_, (*entry)->getRegisteredPrefixId());
       }
     }
   else if (block.type() == Tlv::Data)
     {
+      if (pendingInterestTable_.empty())
+        return;
+
+      // Find the pending interests with the name alone, so that a data packet which no one is
+      // waiting for is not decoded.
+      std::vector<ptr_lib::shared_ptr<PendingInterest> > pendingInterests;
+      if (pendingInterestTable_.findMatches(name, pendingInterests) == 0)
+        return;
+
       ptr_lib::shared_ptr<Data> data(new Data());
-      data->wireDecode(block);
+      if (!decodePacket(block, *data))
+        return;
 
-      PendingInterestTable::iterator entry = getEntryIndexForExpressedInterest(data->getName());
-      if (entry != pendingInterestTable_.end()) {
-        // Copy pointers to the needed objects and remove the PIT entry before the calling the callback.
-        const OnData onData = (*entry)->getOnData();
-        const ptr_lib::shared_ptr<const Interest> interest = (*entry)->getInterest();
-        pendingInterestTable_.erase(entry);
+      // Remove the PIT entries before calling the callbacks.
+      for (size_t i = 0; i < pendingInterests.size(); ++i)
+        pendingInterestTable_.erase(pendingInterests[i]->getPendingInterestId());
 
+      for (size_t i = 0; i < pendingInterests.size(); ++i) {
+        const OnData &onData = pendingInterests[i]->getOnData();
         if (onData) {
-          onData(interest, data);
-        }
-
-        if (pendingInterestTable_.empty()) {
-          pitTimeoutCheckTimer_->cancel(); // this will cause checkPitExpire invocation
+          onData(pendingInterests[i]->getInterest(), data);
         }
       }
+
+      removeStalePendingInterestTimeouts();
     }
 }
 
@@ -373,7 +635,9 @@ void
 Node::shutdown()
 {
   pendingInterestTable_.clear();
+  pendingInterestTimeouts_.clear();
   registeredPrefixTable_.clear();
+  registeredPrefixIds_.clear();
 
   transport_->close();
   pitTimeoutCheckTimer_->cancel();
@@ -381,39 +645,6 @@ Node::shutdown()
   pitTimeoutCheckTimerActive_ = false;
 }
 
-Node::PendingInterestTable::iterator 
-Node::getEntryIndexForExpressedInterest(const Name& name)
-{
-  for (PendingInterestTable::iterator i = pendingInterestTable_.begin ();
-       i != pendingInterestTable_.end(); ++i)
-    {
-      if ((*i)->getInterest()->matchesName(name))
-        {
-          return i;
-        }
-    }
-
-  return pendingInterestTable_.end();
-}
-  
-Node::RegisteredPrefixTable::iterator
-Node::getEntryForRegisteredPrefix(const Name& name)
-{
-  RegisteredPrefixTable::iterator longestPrefix = registeredPrefixTable_.end();
-
-  for (RegisteredPrefixTable::iterator i = registeredPrefixTable_.begin();
-       i != registeredPrefixTable_.end();
-       ++i)
-    {
-      if (longestPrefix == registeredPrefixTable_.end() ||
-          (*i)->getPrefix()->size() > (*longestPrefix)->getPrefix()->size())
-        {
-          longestPrefix = i;
-        }
-    }
-  return longestPrefix;
-}
-
 Node::PendingInterest::PendingInterest(uint64_t pendingInterestId,
                                        const ptr_lib::shared_ptr<const Interest>& interest,
                                        const OnData& onData, const OnTimeout& onTimeout)
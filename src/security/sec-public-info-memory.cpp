@@ -21,18 +21,14 @@ SecPublicInfoMemory::~SecPublicInfoMemory()
 bool 
 SecPublicInfoMemory::doesIdentityExist(const Name& identityName)
 {
-  string identityUri = identityName.toUri();
-  return find(identityStore_.begin(), identityStore_.end(), identityUri) != identityStore_.end();
+  return identityStore_.find(identityName) != identityStore_.end();
 }
 
 void
 SecPublicInfoMemory::addIdentity(const Name& identityName)
 {
-  string identityUri = identityName.toUri();
-  if (find(identityStore_.begin(), identityStore_.end(), identityUri) != identityStore_.end())
-    throw Error("Identity already exists: " + identityUri);
-  
-  identityStore_.push_back(identityUri);
+  if (!identityStore_.insert(identityName).second)
+    throw Error("Identity already exists: " + identityName.toUri());
 }
 
 bool 
@@ -46,7 +42,7 @@ SecPublicInfoMemory::revokeIdentity()
 bool 
 SecPublicInfoMemory::doesPublicKeyExist(const Name& keyName)
 {
-  return keyStore_.find(keyName.toUri()) != keyStore_.end();
+  return keyStore_.find(keyName) != keyStore_.end();
 }
 
 void 
@@ -60,13 +56,13 @@ SecPublicInfoMemory::addPublicKey(const Name& keyName, KeyType keyType, const Pu
   if (doesPublicKeyExist(keyName))
     throw Error("a key with the same name already exists!");
   
-  keyStore_[keyName.toUri()] = ptr_lib::make_shared<KeyRecord>(keyType, publicKey);
+  keyStore_[keyName] = ptr_lib::make_shared<KeyRecord>(keyType, publicKey);
 }
 
 ptr_lib::shared_ptr<PublicKey>
 SecPublicInfoMemory::getPublicKey(const Name& keyName)
 {
-  KeyStore::iterator record = keyStore_.find(keyName.toUri());
+  KeyStore::iterator record = keyStore_.find(keyName);
   if (record == keyStore_.end())
     // Not found.  Silently return null.
     return ptr_lib::shared_ptr<PublicKey>();
@@ -93,7 +89,7 @@ SecPublicInfoMemory::deactivatePublicKey(const Name& keyName)
 bool
 SecPublicInfoMemory::doesCertificateExist(const Name& certificateName)
 {
-  return certificateStore_.find(certificateName.toUri()) != certificateStore_.end();
+  return certificateStore_.find(certificateName) != certificateStore_.end();
 }
 
 void 
@@ -115,13 +111,13 @@ SecPublicInfoMemory::addCertificate(const IdentityCertificate& certificate)
     throw Error("Certificate does not match the public key!");
   
   // Insert the certificate.
-  certificateStore_[certificateName.toUri()] = ptr_lib::make_shared<IdentityCertificate> (certificate);
+  certificateStore_[certificateName] = ptr_lib::make_shared<IdentityCertificate> (certificate);
 }
 
 ptr_lib::shared_ptr<IdentityCertificate> 
 SecPublicInfoMemory::getCertificate(const Name& certificateName)
 {
-  CertificateStore::iterator record = certificateStore_.find(certificateName.toUri());
+  CertificateStore::iterator record = certificateStore_.find(certificateName);
   if (record == certificateStore_.end())
     // Not found.  Silently return null.
     return ptr_lib::shared_ptr<IdentityCertificate>();
@@ -138,9 +134,8 @@ SecPublicInfoMemory::getDefaultIdentity()
 void 
 SecPublicInfoMemory::setDefaultIdentityInternal(const Name& identityName)
 {
-  string identityUri = identityName.toUri();
-  if (find(identityStore_.begin(), identityStore_.end(), identityUri) != identityStore_.end())
-    defaultIdentity_ = identityUri;
+  if (identityStore_.find(identityName) != identityStore_.end())
+    defaultIdentity_ = identityName.toUri();
   else
     // The identity doesn't exist, so clear the default.
     defaultIdentity_.clear();
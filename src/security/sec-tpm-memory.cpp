@@ -54,8 +54,8 @@ SecTpmMemory::setKeyPairForKeyName(const Name& keyName,
                                 uint8_t *publicKeyDer, size_t publicKeyDerLength,
                                 uint8_t *privateKeyDer, size_t privateKeyDerLength)
 {
-  publicKeyStore_[keyName.toUri()]  = ptr_lib::make_shared<PublicKey>(publicKeyDer, publicKeyDerLength);
-  privateKeyStore_[keyName.toUri()] = ptr_lib::make_shared<RsaPrivateKey>(privateKeyDer, privateKeyDerLength);
+  publicKeyStore_[keyName]  = ptr_lib::make_shared<PublicKey>(publicKeyDer, publicKeyDerLength);
+  privateKeyStore_[keyName] = ptr_lib::make_shared<RsaPrivateKey>(privateKeyDer, privateKeyDerLength);
 }
 
 void 
@@ -69,7 +69,7 @@ SecTpmMemory::generateKeyPairInTpm(const Name& keyName, KeyType keyType, int key
 ptr_lib::shared_ptr<PublicKey> 
 SecTpmMemory::getPublicKeyFromTpm(const Name& keyName)
 {
-  PublicKeyStore::iterator publicKey = publicKeyStore_.find(keyName.toUri());
+  PublicKeyStore::iterator publicKey = publicKeyStore_.find(keyName);
   if (publicKey == publicKeyStore_.end())
     throw Error(string("MemoryPrivateKeyStorage: Cannot find public key ") + keyName.toUri());
   return publicKey->second;
@@ -84,7 +84,7 @@ SecTpmMemory::signInTpm(const uint8_t *data, size_t dataLength,
     return ConstBufferPtr();
 
   // Find the private key and sign.
-  PrivateKeyStore::iterator privateKey = privateKeyStore_.find(keyName.toUri());
+  PrivateKeyStore::iterator privateKey = privateKeyStore_.find(keyName);
   if (privateKey == privateKeyStore_.end())
     throw Error(string("MemoryPrivateKeyStorage: Cannot find private key ") + keyName.toUri());
   
@@ -118,7 +118,7 @@ SecTpmMemory::signInTpm(Data &d,
     Error("MemoryPrivateKeyStorage::sign only SHA256 digest is supported");
 
   // Find the private key and sign.
-  PrivateKeyStore::iterator privateKey = privateKeyStore_.find(keyName.toUri());
+  PrivateKeyStore::iterator privateKey = privateKeyStore_.find(keyName);
   if (privateKey == privateKeyStore_.end())
     throw Error(string("MemoryPrivateKeyStorage: Cannot find private key ") + keyName.toUri());
   
@@ -176,9 +176,9 @@ bool
 SecTpmMemory::doesKeyExistInTpm(const Name& keyName, KeyClass keyClass)
 {
   if (keyClass == KEY_CLASS_PUBLIC)
-    return publicKeyStore_.find(keyName.toUri()) != publicKeyStore_.end();
+    return publicKeyStore_.find(keyName) != publicKeyStore_.end();
   else if (keyClass == KEY_CLASS_PRIVATE)
-    return privateKeyStore_.find(keyName.toUri()) != privateKeyStore_.end();
+    return privateKeyStore_.find(keyName) != privateKeyStore_.end();
   else
     // KEY_CLASS_SYMMETRIC not implemented yet.
     return false;
@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2013 Regents of the University of California.
+ * See COPYING for copyright and distribution information.
+ */
+
+#include <ndn-cpp/sharded-node.hpp>
+
+using namespace std;
+
+// In the std library, the placeholders are in a different namespace than boost.
+using namespace ndn::func_lib::placeholders;
+
+namespace ndn {
+
+ShardedNode::Shard::Shard(const ptr_lib::shared_ptr<Transport> &transport)
+  : ioService(ptr_lib::make_shared<boost::asio::io_service>())
+  , node(transport, ioService)
+{
+  node.enableThreadSafety();
+}
+
+ShardedNode::ShardedNode(const vector<ptr_lib::shared_ptr<Transport> > &transports)
+{
+  if (transports.empty())
+    throw Error("ShardedNode needs at least one transport");
+
+  for (size_t i = 0; i < transports.size(); ++i)
+    shards_.push_back(ptr_lib::make_shared<Shard>(transports[i]));
+}
+
+uint64_t
+ShardedNode::expressInterest(const Interest& interest, const OnData& onData, const OnTimeout& onTimeout)
+{
+  size_t shard = getShardForName(interest.getName());
+  Shard &entry = *shards_[shard];
+  entry.nExpressedInterests.fetchAdd(1);
+
+  uint64_t nodeId = entry.node.expressInterest
+    (interest,
+     func_lib::bind(&ShardedNode::onShardData, this, shard, onData, _1, _2),
+     func_lib::bind(&ShardedNode::onShardTimeout, this, shard, onTimeout, _1));
+  return makeId(nodeId, shard);
+}
+
+void
+ShardedNode::removePendingInterest(uint64_t pendingInterestId)
+{
+  uint64_t nodeId;
+  getShardForId(pendingInterestId, nodeId).node.removePendingInterest(nodeId);
+}
+
+uint64_t
+ShardedNode::registerPrefix
+  (const Name& prefix, const OnInterest& onInterest, const OnRegisterFailed& onRegisterFailed,
+   const ForwardingFlags& flags)
+{
+  size_t shard = getShardForName(prefix);
+  uint64_t nodeId = shards_[shard]->node.registerPrefix
+    (prefix,
+     func_lib::bind(&ShardedNode::onShardInterest, this, shard, onInterest, _1, _2, _3, _4),
+     onRegisterFailed, flags);
+  return makeId(nodeId, shard);
+}
+
+void
+ShardedNode::removeRegisteredPrefix(uint64_t registeredPrefixId)
+{
+  uint64_t nodeId;
+  getShardForId(registeredPrefixId, nodeId).node.removeRegisteredPrefix(nodeId);
+}
+
+void
+ShardedNode::put(const Data &data, uint64_t registeredPrefixId)
+{
+  uint64_t nodeId;
+  Shard &shard = getShardForId(registeredPrefixId, nodeId);
+  shard.nPutData.fetchAdd(1);
+  shard.node.put(data);
+}
+
+void
+ShardedNode::processEvents(size_t shard, Milliseconds timeout/* = 0 */, bool keepThread/* = false*/)
+{
+  if (shard >= shards_.size())
+    throw Error("ShardedNode::processEvents: there is no such shard");
+
+  shards_[shard]->node.processEvents(timeout, keepThread);
+}
+
+void
+ShardedNode::shutdown()
+{
+  for (size_t i = 0; i < shards_.size(); ++i)
+    shards_[i]->ioService->post(func_lib::bind(&ShardedNode::shutdownShard, shards_[i].get()));
+}
+
+ShardedNode::ShardStatistics
+ShardedNode::getShardStatistics(size_t shard) const
+{
+  if (shard >= shards_.size())
+    throw Error("ShardedNode::getShardStatistics: there is no such shard");
+
+  const Shard &entry = *shards_[shard];
+  ShardStatistics statistics;
+  statistics.nExpressedInterests = entry.nExpressedInterests.load();
+  statistics.nSatisfiedInterests = entry.nSatisfiedInterests.load();
+  statistics.nTimedOutInterests = entry.nTimedOutInterests.load();
+  statistics.nReceivedInterests = entry.nReceivedInterests.load();
+  statistics.nPutData = entry.nPutData.load();
+  return statistics;
+}
+
+ShardedNode::Shard&
+ShardedNode::getShardForId(uint64_t id, uint64_t &nodeId)
+{
+  nodeId = id / shards_.size();
+  return *shards_[id % shards_.size()];
+}
+
+void
+ShardedNode::onShardData(size_t shard, const OnData &onData,
+                         const ptr_lib::shared_ptr<const Interest> &interest, const ptr_lib::shared_ptr<Data> &data)
+{
+  shards_[shard]->nSatisfiedInterests.fetchAdd(1);
+  if (onData)
+    onData(interest, data);
+}
+
+void
+ShardedNode::onShardTimeout(size_t shard, const OnTimeout &onTimeout, const ptr_lib::shared_ptr<const Interest> &interest)
+{
+  shards_[shard]->nTimedOutInterests.fetchAdd(1);
+  if (onTimeout)
+    onTimeout(interest);
+}
+
+void
+ShardedNode::onShardInterest(size_t shard, const OnInterest &onInterest,
+                             const ptr_lib::shared_ptr<const Name> &prefix, const ptr_lib::shared_ptr<const Interest> &interest,
+                             Transport &transport, uint64_t registeredPrefixId)
+{
+  shards_[shard]->nReceivedInterests.fetchAdd(1);
+  onInterest(prefix, interest, transport, makeId(registeredPrefixId, shard));
+}
+
+void
+ShardedNode::shutdownShard(Shard *shard)
+{
+  shard->node.shutdown();
+  // processEvents may have been called with keepThread.
+  shard->ioService->stop();
+}
+
+}
@@ -7,10 +7,11 @@
 
 #include <stdexcept>
 #include <stdlib.h>
+#include <list>
 
 #include <ndn-cpp/face.hpp>
 #include <ndn-cpp/transport/unix-transport.hpp>
-#include "../c/util/ndn_memory.h"
+#include <ndn-cpp/encoding/tlv-framer.hpp>
 
 #include <boost/asio.hpp>
 #if NDN_CPP_HAVE_CXX11
@@ -31,7 +32,7 @@ public:
   Impl(UnixTransport &transport)
     : transport_(transport)
     , socket_(*transport_.ioService_)
-    , partialDataSize_(0)
+    , framer_(MAX_LENGTH)
     , connectionInProgress_(false)
     , connectTimer_(*transport_.ioService_)
   {
@@ -45,9 +46,8 @@ public:
 
     if (!error)
       {
-        partialDataSize_ = 0;
-        socket_.async_receive(boost::asio::buffer(inputBuffer_, MAX_LENGTH), 0,
-                              func_lib::bind(&Impl::handle_async_receive, this, _1, _2));
+        framer_.reset();
+        asyncReceive();
 
         transport_.isConnected_ = true;
 
@@ -113,23 +113,31 @@ public:
                          func_lib::bind(&Impl::handle_async_send, this, _1, wire));
   }
 
+  void
+  asyncReceive()
+  {
+    socket_.async_receive(boost::asio::buffer(framer_.receiveBuffer(), framer_.receiveBufferSize()), 0,
+                          func_lib::bind(&Impl::handle_async_receive, this, _1, _2));
+  }
+
+  /**
+   * @brief Deliver every complete element received so far
+   *
+   * Elements are slices of the framer's receive buffer, so received data is never copied
+   */
   inline void
-  processAll(uint8_t *buffer, size_t &offset, size_t availableSize)
+  processAll()
   {
-    while(offset < availableSize)
+    Block element;
+    while (framer_.next(element))
       {
-        Block element(buffer + offset, availableSize - offset);
         transport_.receive(element);
-
-        offset += element.size();
       }
   }
   
   void
   handle_async_receive(const boost::system::error_code& error, std::size_t bytes_recvd)
   {
-    /// @todo The socket is not datagram, so need to have internal buffer to handle partial data reception
-
     if (error)
       {
         if (error == boost::system::errc::operation_canceled) {
@@ -144,74 +152,21 @@ public:
     
     if (!error && bytes_recvd > 0)
       {
-        // inputBuffer_ has bytes_recvd received bytes of data
-        if (partialDataSize_ > 0)
+        framer_.received(bytes_recvd);
+        try
           {
-            size_t newDataSize = std::min(bytes_recvd, MAX_LENGTH-partialDataSize_);
-            ndn_memcpy(partialData_ + partialDataSize_, inputBuffer_, newDataSize);
-            partialDataSize_ += newDataSize;
-              
-            size_t offset = 0;
-            try
-              {
-                processAll(partialData_, offset, partialDataSize_);
-
-                // no exceptions => processed the whole thing
-                if (bytes_recvd - newDataSize > 0)
-                  {
-                    // there is a little bit more data available
-                        
-                    offset = 0;
-                    partialDataSize_ = bytes_recvd - newDataSize;
-                    ndn_memcpy(partialData_, inputBuffer_ + newDataSize, partialDataSize_);
-
-                    processAll(partialData_, offset, partialDataSize_);
-
-                    // no exceptions => processed the whole thing
-                    partialDataSize_ = 0;
-                  }
-                else
-                  {
-                    // done processing
-                    partialDataSize_ = 0;
-                  }
-              }
-            catch(Tlv::Error &)
-              {
-                if (offset > 0)
-                  {
-                    partialDataSize_ -= offset;
-                    ndn_memcpy(partialData_, partialData_ + offset, partialDataSize_);
-                  }
-                else if (offset == 0 && partialDataSize_ == MAX_LENGTH)
-                  {
-                    // very bad... should close connection
-                    socket_.close();
-                    transport_.isConnected_ = true;
-                    throw Transport::Error(boost::system::error_code(), "input buffer full, but a valid TLV cannot be decoded");
-                  }
-              }
+            processAll();
           }
-        else
+        catch(TlvFramer::Error &e)
           {
-            size_t offset = 0;
-            try
-              {
-                processAll(inputBuffer_, offset, bytes_recvd);
-              }
-            catch(Tlv::Error &error)
-              {
-                if (offset > 0)
-                  {
-                    partialDataSize_ = bytes_recvd - offset;
-                    ndn_memcpy(partialData_, inputBuffer_ + offset, partialDataSize_);
-                  }
-              }
+            // the stream is out of sync, cannot recover
+            socket_.close();
+            transport_.isConnected_ = false;
+            throw Transport::Error(boost::system::error_code(), e.what());
           }
       }
 
-    socket_.async_receive(boost::asio::buffer(inputBuffer_, MAX_LENGTH), 0,
-                          func_lib::bind(&Impl::handle_async_receive, this, _1, _2));
+    asyncReceive();
   }
 
   void
@@ -224,10 +179,7 @@ private:
   UnixTransport &transport_;
   
   protocol::socket socket_;
-  uint8_t inputBuffer_[MAX_LENGTH];
-
-  uint8_t partialData_[MAX_LENGTH];
-  size_t partialDataSize_;
+  TlvFramer framer_;
 
   std::list< Block > sendQueue_;
   bool connectionInProgress_;
@@ -0,0 +1,82 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include <ndn-cpp/util/instrumentation.hpp>
+
+namespace ndn {
+
+#if NDN_CPP_HAVE_CXX11
+static thread_local uint64_t g_counters[Instrumentation::N_COUNTERS];
+#else
+static __thread uint64_t g_counters[Instrumentation::N_COUNTERS];
+#endif
+
+static const char* const COUNTER_NAMES[Instrumentation::N_COUNTERS] = {
+  "buffer-allocations",
+  "buffer-copies",
+  "block-copies",
+  "component-allocations",
+  "component-copies",
+  "obufferstream-allocations",
+  "transport-receive-allocations",
+  "transport-receive-copied-bytes",
+};
+
+Instrumentation::Snapshot::Snapshot()
+{
+  reset();
+}
+
+uint64_t
+Instrumentation::Snapshot::get(Counter counter) const
+{
+  return g_counters[counter] - m_values[counter];
+}
+
+void
+Instrumentation::Snapshot::reset()
+{
+  for (int i = 0; i < N_COUNTERS; ++i)
+    m_values[i] = g_counters[i];
+}
+
+bool
+Instrumentation::isEnabled()
+{
+#if NDN_CPP_WITH_INSTRUMENTATION
+  return true;
+#else
+  return false;
+#endif
+}
+
+uint64_t
+Instrumentation::get(Counter counter)
+{
+  return g_counters[counter];
+}
+
+void
+Instrumentation::add(Counter counter, uint64_t n/* = 1*/)
+{
+  g_counters[counter] += n;
+}
+
+void
+Instrumentation::reset()
+{
+  for (int i = 0; i < N_COUNTERS; ++i)
+    g_counters[i] = 0;
+}
+
+const char*
+Instrumentation::getName(Counter counter)
+{
+  return COUNTER_NAMES[counter];
+}
+
+} // namespace ndn
@@ -0,0 +1,119 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "sip-hash.hpp"
+
+#if __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wreorder"
+#pragma clang diagnostic ignored "-Wtautological-compare"
+#pragma clang diagnostic ignored "-Wunused-variable"
+#pragma clang diagnostic ignored "-Wunused-function"
+#elif __GNUC__
+#pragma GCC diagnostic ignored "-Wreorder"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wunused-function"
+#endif
+
+#include <cryptopp/osrng.h>
+
+namespace ndn {
+
+static inline uint64_t
+rotate(uint64_t x, int bits)
+{
+  return (x << bits) | (x >> (64 - bits));
+}
+
+static inline uint64_t
+load64(const uint8_t *data)
+{
+  // compiles to a single load on little-endian machines
+  return  static_cast<uint64_t>(data[0])        | (static_cast<uint64_t>(data[1]) << 8)  |
+         (static_cast<uint64_t>(data[2]) << 16) | (static_cast<uint64_t>(data[3]) << 24) |
+         (static_cast<uint64_t>(data[4]) << 32) | (static_cast<uint64_t>(data[5]) << 40) |
+         (static_cast<uint64_t>(data[6]) << 48) | (static_cast<uint64_t>(data[7]) << 56);
+}
+
+#define SIP_ROUND                                                        \
+  do {                                                                  \
+    v0 += v1; v1 = rotate(v1, 13); v1 ^= v0; v0 = rotate(v0, 32);       \
+    v2 += v3; v3 = rotate(v3, 16); v3 ^= v2;                            \
+    v0 += v3; v3 = rotate(v3, 21); v3 ^= v0;                            \
+    v2 += v1; v1 = rotate(v1, 17); v1 ^= v2; v2 = rotate(v2, 32);       \
+  } while (0)
+
+uint64_t
+sipHash(const uint64_t key[2], uint64_t chainingValue, const uint8_t *data, size_t size)
+{
+  uint64_t v0 = key[0] ^ 0x736f6d6570736575ULL;
+  uint64_t v1 = key[1] ^ 0x646f72616e646f6dULL;
+  uint64_t v2 = key[0] ^ 0x6c7967656e657261ULL;
+  uint64_t v3 = key[1] ^ 0x7465646279746573ULL;
+
+  v3 ^= chainingValue;
+  SIP_ROUND;
+  v0 ^= chainingValue;
+
+  const uint8_t *end = data + (size & ~static_cast<size_t>(7));
+  for (; data != end; data += 8)
+    {
+      uint64_t word = load64(data);
+      v3 ^= word;
+      SIP_ROUND;
+      v0 ^= word;
+    }
+
+  // the last word holds the remaining bytes and the total input size
+  uint64_t last = static_cast<uint64_t>(size + 8) << 56;
+  switch (size & 7)
+    {
+    case 7: last |= static_cast<uint64_t>(data[6]) << 48;
+    case 6: last |= static_cast<uint64_t>(data[5]) << 40;
+    case 5: last |= static_cast<uint64_t>(data[4]) << 32;
+    case 4: last |= static_cast<uint64_t>(data[3]) << 24;
+    case 3: last |= static_cast<uint64_t>(data[2]) << 16;
+    case 2: last |= static_cast<uint64_t>(data[1]) << 8;
+    case 1: last |= static_cast<uint64_t>(data[0]);
+    }
+  v3 ^= last;
+  SIP_ROUND;
+  v0 ^= last;
+
+  v2 ^= 0xff;
+  SIP_ROUND;
+  SIP_ROUND;
+  SIP_ROUND;
+
+  return v0 ^ v1 ^ v2 ^ v3;
+}
+
+#undef SIP_ROUND
+
+/**
+ * @brief Random key, generated when the first hash is computed
+ */
+class ProcessSipHashKey
+{
+public:
+  ProcessSipHashKey()
+  {
+    CryptoPP::AutoSeededRandomPool rng;
+    rng.GenerateBlock(reinterpret_cast<uint8_t*>(key), sizeof(key));
+  }
+
+  uint64_t key[2];
+};
+
+const uint64_t*
+getProcessSipHashKey()
+{
+  static ProcessSipHashKey processKey;
+  return processKey.key;
+}
+
+} // namespace ndn
@@ -0,0 +1,32 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2013, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef NDN_SIP_HASH_HPP
+#define NDN_SIP_HASH_HPP
+
+#include <ndn-cpp/common.hpp>
+
+namespace ndn {
+
+/**
+ * @brief SipHash-1-3 with a 128-bit key
+ *
+ * The input is the 8-byte little-endian chainingValue followed by the size bytes at data, which
+ * lets a sequence of values be hashed incrementally by passing the previous hash as chainingValue.
+ */
+uint64_t
+sipHash(const uint64_t key[2], uint64_t chainingValue, const uint8_t *data, size_t size);
+
+/**
+ * @brief Get the SipHash key of this process, which is chosen randomly on the first call
+ */
+const uint64_t*
+getProcessSipHashKey();
+
+} // namespace ndn
+
+#endif // NDN_SIP_HASH_HPP
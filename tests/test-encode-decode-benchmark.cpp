@@ -10,7 +10,11 @@
 #include <sys/time.h>
 #include <sstream>
 #include <stdexcept>
+#include <list>
+#include <new>
+#include <cstdlib>
 #include <ndn-cpp/data.hpp>
+#include <ndn-cpp/encoding/buffer-pool.hpp>
 #include <ndn-cpp/security/key-chain.hpp>
 // #include <ndn-cpp/security/policy/self-verify-policy-manager.hpp>
 
@@ -23,6 +27,32 @@
 using namespace std;
 using namespace ndn;
 
+/**
+ * Number of heap allocations made by the process so far (counted by the operator new replacement below).
+ */
+static uint64_t g_nAllocations = 0;
+
+#if NDN_CPP_HAVE_CXX11
+void*
+operator new(std::size_t size)
+#else
+void*
+operator new(std::size_t size) throw(std::bad_alloc)
+#endif
+{
+  ++g_nAllocations;
+  void* p = std::malloc(size == 0 ? 1 : size);
+  if (p == 0)
+    throw std::bad_alloc();
+  return p;
+}
+
+void
+operator delete(void* p) throw()
+{
+  std::free(p);
+}
+
 static double
 getNowSeconds()
 {
@@ -111,10 +141,11 @@ static uint8_t DEFAULT_PRIVATE_KEY_DER[] = {
  * and only required fields.
  * @param useCrypto If true, sign the data packet.  If false, use a blank signature.
  * @param encoding Set this to the wire encoding.
+ * @param nAllocations Set to the number of heap allocations for all iterations.
  * @return The number of seconds for all iterations.
  */
 static double
-benchmarkEncodeDataSecondsCpp(int nIterations, bool useComplex, bool useCrypto, Block& encoding)
+benchmarkEncodeDataSecondsCpp(int nIterations, bool useComplex, bool useCrypto, Block& encoding, uint64_t &nAllocations)
 {
   Name name;
   Block content;
@@ -157,6 +188,7 @@ benchmarkEncodeDataSecondsCpp(int nIterations, bool useComplex, bool useCrypto,
   memset(signatureBitsArray, 0, sizeof(signatureBitsArray));
   Block signatureValue = dataBlock(Tlv::SignatureValue, signatureBitsArray, sizeof(signatureBitsArray));
 
+  uint64_t allocationsStart = g_nAllocations;
   double start = getNowSeconds();
   for (int i = 0; i < nIterations; ++i) {
     Data data(name);
@@ -179,6 +211,7 @@ benchmarkEncodeDataSecondsCpp(int nIterations, bool useComplex, bool useCrypto,
     encoding = data.wireEncode();
   }
   double finish = getNowSeconds();
+  nAllocations = g_nAllocations - allocationsStart;
     
   return finish - start;
 }
@@ -228,6 +261,89 @@ benchmarkDecodeDataSecondsCpp(int nIterations, bool useCrypto, const ConstBuffer
   return finish - start;
 }
 
+/**
+ * Sub-element types that Data::wireDecode looks up.
+ */
+static const uint32_t DATA_ELEMENT_TYPES[] = {
+  Tlv::Name, Tlv::MetaInfo, Tlv::Content, Tlv::SignatureInfo, Tlv::SignatureValue
+};
+
+/**
+ * Loop to parse the top level of a data packet and look up each of its fields nIterations times, using the
+ * sub-element storage that Block had before: a std::list node per sub-element and a linear scan per lookup.
+ * @param nIterations The number of iterations.
+ * @param encoding The wire encoding to parse.
+ * @param nAllocations Set to the number of heap allocations for all iterations.
+ * @return The number of seconds for all iterations.
+ */
+static double
+benchmarkDecodeDataListSeconds(int nIterations, const ConstBufferPtr &encoding, uint64_t &nAllocations)
+{
+  size_t nFound = 0;
+  uint64_t allocationsStart = g_nAllocations;
+  double start = getNowSeconds();
+  for (int i = 0; i < nIterations; ++i) {
+    Block wire(encoding);
+    std::list<Block> subBlocks;
+
+    Buffer::const_iterator begin = wire.value_begin();
+    Buffer::const_iterator end = wire.value_end();
+    while (begin != end) {
+      Buffer::const_iterator elementBegin = begin;
+      uint32_t type = Tlv::readType(begin, end);
+      uint64_t length = Tlv::readVarNumber(begin, end);
+      Buffer::const_iterator elementEnd = begin + length;
+
+      subBlocks.push_back(Block(encoding, type, elementBegin, elementEnd, begin, elementEnd));
+      begin = elementEnd;
+    }
+
+    for (size_t j = 0; j < sizeof(DATA_ELEMENT_TYPES) / sizeof(DATA_ELEMENT_TYPES[0]); ++j) {
+      for (std::list<Block>::const_iterator k = subBlocks.begin(); k != subBlocks.end(); ++k) {
+        if (k->type() == DATA_ELEMENT_TYPES[j]) {
+          nFound += k->value_size();
+          break;
+        }
+      }
+    }
+  }
+  double finish = getNowSeconds();
+  nAllocations = g_nAllocations - allocationsStart;
+
+  if (nFound == 0)
+    cout << "Error: no fields found" << endl;
+  return finish - start;
+}
+
+/**
+ * Loop to parse the top level of a data packet and look up each of its fields nIterations times with Block::parse
+ * and Block::get (contiguous sub-element storage with the type index).
+ * @param nIterations The number of iterations.
+ * @param encoding The wire encoding to parse.
+ * @param nAllocations Set to the number of heap allocations for all iterations.
+ * @return The number of seconds for all iterations.
+ */
+static double
+benchmarkDecodeDataBlockSeconds(int nIterations, const ConstBufferPtr &encoding, uint64_t &nAllocations)
+{
+  size_t nFound = 0;
+  uint64_t allocationsStart = g_nAllocations;
+  double start = getNowSeconds();
+  for (int i = 0; i < nIterations; ++i) {
+    Block wire(encoding);
+    wire.parse();
+
+    for (size_t j = 0; j < sizeof(DATA_ELEMENT_TYPES) / sizeof(DATA_ELEMENT_TYPES[0]); ++j)
+      nFound += wire.get(DATA_ELEMENT_TYPES[j]).value_size();
+  }
+  double finish = getNowSeconds();
+  nAllocations = g_nAllocations - allocationsStart;
+
+  if (nFound == 0)
+    cout << "Error: no fields found" << endl;
+  return finish - start;
+}
+
 /**
  * Loop to encode a data packet nIterations times using C.
  * @param nIterations The number of iterations.
@@ -422,17 +538,63 @@ benchmarkEncodeDecodeDataCpp(bool useComplex, bool useCrypto)
   Block encoding;
   {
     int nIterations = useCrypto ? 20000 : 200000;
-    double duration = benchmarkEncodeDataSecondsCpp(nIterations, useComplex, useCrypto, encoding);
+    uint64_t nAllocations;
+    double duration = benchmarkEncodeDataSecondsCpp(nIterations, useComplex, useCrypto, encoding, nAllocations);
     cout << "Encode " << (useComplex ? "complex" : "simple ") << " data C++: Crypto? " << (useCrypto ? "yes" : "no ") 
-         << ", Duration sec, Hz: " << duration << ", " << (nIterations / duration) << endl;  
+         << ", Duration sec, Hz: " << duration << ", " << (nIterations / duration)
+         << ", Allocations per packet: " << (double)nAllocations / nIterations << endl;  
   }
 
   BufferPtr wire = ptr_lib::make_shared<Buffer>(encoding.wire(), encoding.size());
   {
     int nIterations = useCrypto ? 10000 : 1000000;
+    uint64_t allocationsStart = g_nAllocations;
     double duration = benchmarkDecodeDataSecondsCpp(nIterations, useCrypto, wire);
     cout << "Decode " << (useComplex ? "complex" : "simple ") << " data C++: Crypto? " << (useCrypto ? "yes" : "no ") 
-         << ", Duration sec, Hz: " << duration << ", " << (nIterations / duration) << endl;  
+         << ", Duration sec, Hz: " << duration << ", " << (nIterations / duration)
+         << ", Allocations per packet: " << (double)(g_nAllocations - allocationsStart) / nIterations << endl;  
+  }
+
+  if (!useCrypto) {
+    int nIterations = 1000000;
+    uint64_t nAllocations;
+    double duration = benchmarkDecodeDataListSeconds(nIterations, wire, nAllocations);
+    cout << "Parse  " << (useComplex ? "complex" : "simple ") << " data C++: Before (list)  "
+         << ", Duration sec, Hz: " << duration << ", " << (nIterations / duration)
+         << ", Allocations per packet: " << (double)nAllocations / nIterations << endl;
+
+    duration = benchmarkDecodeDataBlockSeconds(nIterations, wire, nAllocations);
+    cout << "Parse  " << (useComplex ? "complex" : "simple ") << " data C++: After (indexed)"
+         << ", Duration sec, Hz: " << duration << ", " << (nIterations / duration)
+         << ", Allocations per packet: " << (double)nAllocations / nIterations << endl;
+  }
+
+  if (!useCrypto) {
+    // Repeat with all library buffers taken from a BufferPool.
+    BufferPool pool;
+    BufferPool::install(&pool);
+    {
+      int nIterations = 200000;
+      uint64_t nAllocations;
+      Block poolEncoding;
+      double duration = benchmarkEncodeDataSecondsCpp(nIterations, useComplex, useCrypto, poolEncoding, nAllocations);
+      cout << "Encode " << (useComplex ? "complex" : "simple ") << " data C++: BufferPool  "
+           << ", Duration sec, Hz: " << duration << ", " << (nIterations / duration)
+           << ", Allocations per packet: " << (double)nAllocations / nIterations
+           << ", Pool hit rate: " << pool.getHitRate() << endl;
+    }
+
+    pool.resetStatistics();
+    {
+      int nIterations = 1000000;
+      uint64_t allocationsStart = g_nAllocations;
+      double duration = benchmarkDecodeDataSecondsCpp(nIterations, useCrypto, wire);
+      cout << "Decode " << (useComplex ? "complex" : "simple ") << " data C++: BufferPool  "
+           << ", Duration sec, Hz: " << duration << ", " << (nIterations / duration)
+           << ", Allocations per packet: " << (double)(g_nAllocations - allocationsStart) / nIterations
+           << ", Pool hit rate: " << pool.getHitRate() << endl;
+    }
+    BufferPool::install(0);
   }
 }
 
@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2013 Regents of the University of California.
+ * See COPYING for copyright and distribution information.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <cstdlib>
+#include <vector>
+#include <sys/time.h>
+#include <ndn-cpp/util/interest-matcher.hpp>
+
+using namespace std;
+using namespace ndn;
+
+static double
+getNowSeconds()
+{
+  struct timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec + t.tv_usec / 1000000.0;
+}
+
+/**
+ * Make the Interests of consumers fetching files segment by segment, one in 5 of them with
+ * MaxSuffixComponents and one in 10 with an Exclude.
+ */
+static void
+makeInterests(size_t nInterests, vector<Interest> &interests)
+{
+  for (size_t i = 0; i < nInterests; ++i) {
+    ostringstream uri;
+    uri << "/site-" << rand() % 100 << "/app/file-" << rand() % 1000;
+    Interest interest(Name(uri.str()).appendSegment(i));
+    if (i % 5 == 0)
+      interest.setMaxSuffixComponents(2);
+    if (i % 10 == 0) {
+      for (int j = 0; j < 4; ++j) {
+        ostringstream excluded;
+        excluded << "version-" << j;
+        interest.getExclude().excludeOne(Name::Component(excluded.str().c_str()));
+      }
+    }
+    interests.push_back(interest);
+  }
+}
+
+/**
+ * Make Data names: the name of an Interest, the same with a version component, or (one in 4) a
+ * name which no Interest wants.
+ */
+static void
+makeDataNames(const vector<Interest> &interests, size_t nNames, vector<Name> &names)
+{
+  for (size_t i = 0; i < nNames; ++i) {
+    Name name = interests[rand() % interests.size()].getName();
+    if (i % 4 == 1)
+      name.append("version-9");
+    else if (i % 4 == 3)
+      name = Name("/site-1/app/unknown").appendSegment(i);
+    names.push_back(name);
+  }
+}
+
+/**
+ * Copy the names into new Name objects, each decoded into a buffer of its own, as for a Data
+ * packet just received.
+ */
+static void
+copyNames(const vector<Name> &names, vector<Name> &copies)
+{
+  copies.clear();
+  for (size_t i = 0; i < names.size(); ++i)
+    copies.push_back(Name(names[i].toUri()));
+}
+
+/**
+ * Find the Interests for each Data name, as a pending interest table kept in a vector would, by
+ * calling matchesName on all of them.
+ */
+static size_t
+findMatchesByScan(const vector<Interest> &interests, const Name &name, vector<size_t> &matches)
+{
+  size_t nMatches = 0;
+  for (size_t i = 0; i < interests.size(); ++i) {
+    if (interests[i].matchesName(name)) {
+      matches.push_back(i);
+      ++nMatches;
+    }
+  }
+  return nMatches;
+}
+
+static void
+benchmark(size_t nInterests)
+{
+  vector<Interest> interests;
+  makeInterests(nInterests, interests);
+  vector<Name> names;
+  makeDataNames(interests, 1000, names);
+
+  InterestMatcher<size_t> matcher;
+  double start = getNowSeconds();
+  for (size_t i = 0; i < interests.size(); ++i)
+    matcher.insert(i, interests[i], i);
+  double insertSeconds = getNowSeconds() - start;
+
+  vector<Name> copies;
+  vector<size_t> matches;
+  size_t nMatches = 0;
+  size_t nLookups = 0;
+  double matcherSeconds = 0;
+  for (int pass = 0; pass < 100 && matcherSeconds < 1; ++pass) {
+    copyNames(names, copies);
+    start = getNowSeconds();
+    for (size_t i = 0; i < copies.size(); ++i) {
+      matches.clear();
+      nMatches += matcher.findMatches(copies[i], matches);
+    }
+    matcherSeconds += getNowSeconds() - start;
+    nLookups += copies.size();
+  }
+
+  // The scan takes time in proportion to the number of Interests, so fewer names are looked up.
+  size_t nScanMatches = 0;
+  size_t nScanLookups = 0;
+  copyNames(names, copies);
+  start = getNowSeconds();
+  for (size_t i = 0; i < copies.size() && getNowSeconds() - start < 1; ++i) {
+    matches.clear();
+    nScanMatches += findMatchesByScan(interests, copies[i], matches);
+    ++nScanLookups;
+  }
+  double scanSeconds = getNowSeconds() - start;
+
+  // Check that both agree on the names looked up by the scan.
+  size_t nExpectedMatches = 0;
+  for (size_t i = 0; i < nScanLookups; ++i) {
+    matches.clear();
+    nExpectedMatches += matcher.findMatches(names[i], matches);
+  }
+  if (nExpectedMatches != nScanMatches)
+    cout << "Error: InterestMatcher found " << nExpectedMatches << " matches, the scan "
+         << nScanMatches << endl;
+
+  start = getNowSeconds();
+  for (size_t i = 0; i < interests.size(); ++i)
+    matcher.erase(i);
+  double eraseSeconds = getNowSeconds() - start;
+  if (!matcher.empty())
+    cout << "Error: the table is not empty after erasing all the Interests" << endl;
+
+  cout << nInterests << " Interests: per Data name InterestMatcher "
+       << matcherSeconds * 1e9 / nLookups << " ns (" << (double)nMatches / nLookups
+       << " matches), matchesName scan " << scanSeconds * 1e9 / nScanLookups << " ns"
+       << "; per Interest insert " << insertSeconds * 1e9 / nInterests << " ns, erase "
+       << eraseSeconds * 1e9 / nInterests << " ns" << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    srand(1);
+    static const size_t N_INTERESTS[] = { 1000, 10000, 100000 };
+    for (size_t i = 0; i < sizeof(N_INTERESTS) / sizeof(N_INTERESTS[0]); ++i)
+      benchmark(N_INTERESTS[i]);
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,1113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2013 Regents of the University of California.
+ * See COPYING for copyright and distribution information.
+ */
+
+/**
+ * Micro-benchmarks of the common operations of the library.
+ *
+ * Each case is first run with a growing number of iterations until one run takes --min-time, which
+ * also warms up the caches, then the calibrated run is repeated --repetitions times.  The time per
+ * iteration of every repetition is a sample, and the summary of the samples is printed as a table
+ * (default), CSV or JSON, so the results of two releases can be compared with a script.
+ *
+ * If the library is configured with --enable-instrumentation, the CSV and JSON output also have the
+ * average of each Instrumentation counter per iteration, e.g. the buffer allocations of one decode.
+ *
+ * Usage: test-micro-benchmarks [--format=text|csv|json] [--repetitions=N] [--min-time=SECONDS]
+ *                              [--filter=SUBSTRING] [--list]
+ */
+
+#include <iostream>
+#include <sys/time.h>
+#include <sstream>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <ndn-cpp/data.hpp>
+#include <ndn-cpp/interest.hpp>
+#include <ndn-cpp/security/sec-tpm-memory.hpp>
+#include <ndn-cpp/security/verifier.hpp>
+#include <ndn-cpp/security/signature-sha256-with-rsa.hpp>
+#include <ndn-cpp/c/util/crypto.h>
+#include <ndn-cpp/util/instrumentation.hpp>
+#include <ndn-cpp/util/name-hash-map.hpp>
+
+using namespace std;
+using namespace ndn;
+
+static uint8_t DEFAULT_PUBLIC_KEY_DER[] = {
+0x30, 0x81, 0x9F, 0x30, 0x0D, 0x06, 0x09, 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x01, 0x01, 0x05, 0x00, 0x03, 0x81,
+0x8D, 0x00, 0x30, 0x81, 0x89, 0x02, 0x81, 0x81, 0x00, 0xE1, 0x7D, 0x30, 0xA7, 0xD8, 0x28, 0xAB, 0x1B, 0x84, 0x0B, 0x17,
+0x54, 0x2D, 0xCA, 0xF6, 0x20, 0x7A, 0xFD, 0x22, 0x1E, 0x08, 0x6B, 0x2A, 0x60, 0xD1, 0x6C, 0xB7, 0xF5, 0x44, 0x48, 0xBA,
+0x9F, 0x3F, 0x08, 0xBC, 0xD0, 0x99, 0xDB, 0x21, 0xDD, 0x16, 0x2A, 0x77, 0x9E, 0x61, 0xAA, 0x89, 0xEE, 0xE5, 0x54, 0xD3,
+0xA4, 0x7D, 0xE2, 0x30, 0xBC, 0x7A, 0xC5, 0x90, 0xD5, 0x24, 0x06, 0x7C, 0x38, 0x98, 0xBB, 0xA6, 0xF5, 0xDC, 0x43, 0x60,
+0xB8, 0x45, 0xED, 0xA4, 0x8C, 0xBD, 0x9C, 0xF1, 0x26, 0xA7, 0x23, 0x44, 0x5F, 0x0E, 0x19, 0x52, 0xD7, 0x32, 0x5A, 0x75,
+0xFA, 0xF5, 0x56, 0x14, 0x4F, 0x9A, 0x98, 0xAF, 0x71, 0x86, 0xB0, 0x27, 0x86, 0x85, 0xB8, 0xE2, 0xC0, 0x8B, 0xEA, 0x87,
+0x17, 0x1B, 0x4D, 0xEE, 0x58, 0x5C, 0x18, 0x28, 0x29, 0x5B, 0x53, 0x95, 0xEB, 0x4A, 0x17, 0x77, 0x9F, 0x02, 0x03, 0x01,
+0x00, 0x01
+};
+
+static uint8_t DEFAULT_PRIVATE_KEY_DER[] = {
+0x30, 0x82, 0x02, 0x5d, 0x02, 0x01, 0x00, 0x02, 0x81, 0x81, 0x00, 0xe1, 0x7d, 0x30, 0xa7, 0xd8, 0x28, 0xab, 0x1b, 0x84,
+0x0b, 0x17, 0x54, 0x2d, 0xca, 0xf6, 0x20, 0x7a, 0xfd, 0x22, 0x1e, 0x08, 0x6b, 0x2a, 0x60, 0xd1, 0x6c, 0xb7, 0xf5, 0x44,
+0x48, 0xba, 0x9f, 0x3f, 0x08, 0xbc, 0xd0, 0x99, 0xdb, 0x21, 0xdd, 0x16, 0x2a, 0x77, 0x9e, 0x61, 0xaa, 0x89, 0xee, 0xe5,
+0x54, 0xd3, 0xa4, 0x7d, 0xe2, 0x30, 0xbc, 0x7a, 0xc5, 0x90, 0xd5, 0x24, 0x06, 0x7c, 0x38, 0x98, 0xbb, 0xa6, 0xf5, 0xdc,
+0x43, 0x60, 0xb8, 0x45, 0xed, 0xa4, 0x8c, 0xbd, 0x9c, 0xf1, 0x26, 0xa7, 0x23, 0x44, 0x5f, 0x0e, 0x19, 0x52, 0xd7, 0x32,
+0x5a, 0x75, 0xfa, 0xf5, 0x56, 0x14, 0x4f, 0x9a, 0x98, 0xaf, 0x71, 0x86, 0xb0, 0x27, 0x86, 0x85, 0xb8, 0xe2, 0xc0, 0x8b,
+0xea, 0x87, 0x17, 0x1b, 0x4d, 0xee, 0x58, 0x5c, 0x18, 0x28, 0x29, 0x5b, 0x53, 0x95, 0xeb, 0x4a, 0x17, 0x77, 0x9f, 0x02,
+0x03, 0x01, 0x00, 0x01, 0x02, 0x81, 0x80, 0x1a, 0x4b, 0xfa, 0x4f, 0xa8, 0xc2, 0xdd, 0x69, 0xa1, 0x15, 0x96, 0x0b, 0xe8,
+0x27, 0x42, 0x5a, 0xf9, 0x5c, 0xea, 0x0c, 0xac, 0x98, 0xaa, 0xe1, 0x8d, 0xaa, 0xeb, 0x2d, 0x3c, 0x60, 0x6a, 0xfb, 0x45,
+0x63, 0xa4, 0x79, 0x83, 0x67, 0xed, 0xe4, 0x15, 0xc0, 0xb0, 0x20, 0x95, 0x6d, 0x49, 0x16, 0xc6, 0x42, 0x05, 0x48, 0xaa,
+0xb1, 0xa5, 0x53, 0x65, 0xd2, 0x02, 0x99, 0x08, 0xd1, 0x84, 0xcc, 0xf0, 0xcd, 0xea, 0x61, 0xc9, 0x39, 0x02, 0x3f, 0x87,
+0x4a, 0xe5, 0xc4, 0xd2, 0x07, 0x02, 0xe1, 0x9f, 0xa0, 0x06, 0xc2, 0xcc, 0x02, 0xe7, 0xaa, 0x6c, 0x99, 0x8a, 0xf8, 0x49,
+0x00, 0xf1, 0xa2, 0x8c, 0x0c, 0x8a, 0xb9, 0x4f, 0x6d, 0x73, 0x3b, 0x2c, 0xb7, 0x9f, 0x8a, 0xa6, 0x7f, 0x9b, 0x9f, 0xb7,
+0xa1, 0xcc, 0x74, 0x2e, 0x8f, 0xb8, 0xb0, 0x26, 0x89, 0xd2, 0xe5, 0x66, 0xe8, 0x8e, 0xa1, 0x02, 0x41, 0x00, 0xfc, 0xe7,
+0x52, 0xbc, 0x4e, 0x95, 0xb6, 0x1a, 0xb4, 0x62, 0xcc, 0xd8, 0x06, 0xe1, 0xdc, 0x7a, 0xa2, 0xb6, 0x71, 0x01, 0xaa, 0x27,
+0xfc, 0x99, 0xe5, 0xf2, 0x54, 0xbb, 0xb2, 0x85, 0xe1, 0x96, 0x54, 0x2d, 0xcb, 0xba, 0x86, 0xfa, 0x80, 0xdf, 0xcf, 0x39,
+0xe6, 0x74, 0xcb, 0x22, 0xce, 0x70, 0xaa, 0x10, 0x00, 0x73, 0x1d, 0x45, 0x0a, 0x39, 0x51, 0x84, 0xf5, 0x15, 0x8f, 0x37,
+0x76, 0x91, 0x02, 0x41, 0x00, 0xe4, 0x3f, 0xf0, 0xf4, 0xde, 0x79, 0x77, 0x48, 0x9b, 0x9c, 0x28, 0x45, 0x26, 0x57, 0x3c,
+0x71, 0x40, 0x28, 0x6a, 0xa1, 0xfe, 0xc3, 0xe5, 0x37, 0xa1, 0x03, 0xf6, 0x2d, 0xbe, 0x80, 0x64, 0x72, 0x69, 0x2e, 0x9b,
+0x4d, 0xe3, 0x2e, 0x1b, 0xfe, 0xe7, 0xf9, 0x77, 0x8c, 0x18, 0x53, 0x9f, 0xe2, 0xfe, 0x00, 0xbb, 0x49, 0x20, 0x47, 0xdf,
+0x01, 0x61, 0x87, 0xd6, 0xe3, 0x44, 0xb5, 0x03, 0x2f, 0x02, 0x40, 0x54, 0xec, 0x7c, 0xbc, 0xdd, 0x0a, 0xaa, 0xde, 0xe6,
+0xc9, 0xf2, 0x8d, 0x6c, 0x2a, 0x35, 0xf6, 0x3c, 0x63, 0x55, 0x29, 0x40, 0xf1, 0x32, 0x82, 0x9f, 0x53, 0xb3, 0x9e, 0x5f,
+0xc1, 0x53, 0x52, 0x3e, 0xac, 0x2e, 0x28, 0x51, 0xa1, 0x16, 0xdb, 0x90, 0xe3, 0x99, 0x7e, 0x88, 0xa4, 0x04, 0x7c, 0x92,
+0xae, 0xd2, 0xe7, 0xd4, 0xe1, 0x55, 0x20, 0x90, 0x3e, 0x3c, 0x6a, 0x63, 0xf0, 0x34, 0xf1, 0x02, 0x41, 0x00, 0x84, 0x5a,
+0x17, 0x6c, 0xc6, 0x3c, 0x84, 0xd0, 0x93, 0x7a, 0xff, 0x56, 0xe9, 0x9e, 0x98, 0x2b, 0xcb, 0x5a, 0x24, 0x4a, 0xff, 0x21,
+0xb4, 0x9e, 0x87, 0x3d, 0x76, 0xd8, 0x9b, 0xa8, 0x73, 0x96, 0x6c, 0x2b, 0x5c, 0x5e, 0xd3, 0xa6, 0xff, 0x10, 0xd6, 0x8e,
+0xaf, 0xa5, 0x8a, 0xcd, 0xa2, 0xde, 0xcb, 0x0e, 0xbd, 0x8a, 0xef, 0xae, 0xfd, 0x3f, 0x1d, 0xc0, 0xd8, 0xf8, 0x3b, 0xf5,
+0x02, 0x7d, 0x02, 0x41, 0x00, 0x8b, 0x26, 0xd3, 0x2c, 0x7d, 0x28, 0x38, 0x92, 0xf1, 0xbf, 0x15, 0x16, 0x39, 0x50, 0xc8,
+0x6d, 0x32, 0xec, 0x28, 0xf2, 0x8b, 0xd8, 0x70, 0xc5, 0xed, 0xe1, 0x7b, 0xff, 0x2d, 0x66, 0x8c, 0x86, 0x77, 0x43, 0xeb,
+0xb6, 0xf6, 0x50, 0x66, 0xb0, 0x40, 0x24, 0x6a, 0xaf, 0x98, 0x21, 0x45, 0x30, 0x01, 0x59, 0xd0, 0xc3, 0xfc, 0x7b, 0xae,
+0x30, 0x18, 0xeb, 0x90, 0xfb, 0x17, 0xd3, 0xce, 0xb5
+};
+
+static double
+getNowSeconds()
+{
+  struct timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec + t.tv_usec / 1000000.0;
+}
+
+/**
+ * Results of the benchmark functions are added here, so that the compiler cannot drop the work.
+ */
+static volatile size_t g_sink = 0;
+
+/**
+ * A benchmark function runs the operation nIterations times.
+ * @param nIterations The number of iterations.
+ * @return A value that depends on the results of the operation.
+ */
+typedef size_t (*BenchmarkFunction)(int nIterations);
+
+struct BenchmarkCase
+{
+  const char *name;
+  BenchmarkFunction function;
+};
+
+struct BenchmarkResult
+{
+  string name;
+  int nIterations;
+  vector<double> samples; // nanoseconds per iteration, one per repetition
+
+  double min;
+  double median;
+  double mean;
+  double max;
+  double stddev;
+
+  vector<double> counters; // per iteration, one per Instrumentation::Counter (if enabled)
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Fixtures
+////////////////////////////////////////////////////////////////////////////////
+
+static const char *SHORT_URI = "/ndn/ucla.edu/apps";
+static const char *LONG_URI = "/ndn/ucla.edu/apps/lwndn-test/numbers.txt/%FD%05%05%E8%0C%CE%1D/%00";
+
+/**
+ * Block::parse fan-outs (number of sub-elements) that are measured.
+ */
+static const size_t FANOUTS[] = { 1, 8, 64, 512 };
+static const size_t N_FANOUTS = sizeof(FANOUTS) / sizeof(FANOUTS[0]);
+
+static Name g_shortName;
+static Name g_longName;
+static Name g_longNameOtherLast;
+static Name g_dataName;
+static Block g_dataNameWire;
+
+static NameHashMap<int> g_prefixTable;
+
+/**
+ * Names of 24 components which differ only in the last one, as in a content store of one producer.
+ */
+static const size_t DEEP_NAME_SIZE = 24;
+static Name g_deepName;
+static Name g_deepNameEqual;
+static Name g_deepNameOtherLast;
+static std::map<Name, int> g_deepNameMap;
+
+static Exclude g_exclude;
+static Block g_excludeWire;
+
+/**
+ * SHA-256 digest-like components excluded one by one, as in the Interests of sync protocols.
+ */
+static const size_t N_SYNC_EXCLUDED = 256;
+static std::vector<Name::Component> g_syncExcluded;
+static std::vector<Name::Component> g_syncNotExcluded;
+static Exclude g_syncExclude;
+static Block g_syncExcludeWire;
+static Block g_syncInterestWire;
+static Name g_syncDataName;
+
+static Interest g_plainInterest;
+static Interest g_selectorsInterest;
+static Block g_plainInterestWire;
+static Block g_selectorsInterestWire;
+
+static ConstBufferPtr g_fanoutWire[N_FANOUTS];
+
+static SecTpmMemory g_tpm;
+static Name g_keyName("/testname/dsk-123");
+static ptr_lib::shared_ptr<PublicKey> g_publicKey;
+static Buffer g_message;
+static SignatureSha256WithRsa g_messageSignature;
+static Data g_signedData;
+
+/**
+ * Create the objects that the benchmark functions work on.
+ */
+static void
+setUpFixtures()
+{
+  g_shortName = Name(SHORT_URI);
+  g_longName = Name(LONG_URI);
+  g_longNameOtherLast = g_longName.getPrefix(-1).append("other");
+  g_dataName = Name(SHORT_URI).append("video").appendVersion(1384000000).appendSegment(12);
+  g_dataNameWire = g_dataName.wireEncode();
+
+  // 256 unrelated prefixes and two prefixes of g_longName
+  for (int i = 0; i < 256; ++i) {
+    ostringstream uri;
+    uri << "/ndn/ucla.edu/prefix-" << i;
+    g_prefixTable[Name(uri.str())] = i;
+  }
+  g_prefixTable[g_longName.getPrefix(1)] = 1000;
+  g_prefixTable[g_longName.getPrefix(3)] = 1001;
+
+  ostringstream deepUri;
+  for (size_t i = 0; i < DEEP_NAME_SIZE - 1; ++i)
+    deepUri << "/component-" << i;
+  for (int i = 0; i < 256; ++i) {
+    ostringstream uri;
+    uri << deepUri.str() << "/segment-" << i;
+    g_deepNameMap[Name(uri.str())] = i;
+  }
+  // separate buffers, so that the comparisons do not see the same bytes
+  g_deepName = Name(deepUri.str() + "/segment-100");
+  g_deepNameEqual = Name(deepUri.str() + "/segment-100");
+  g_deepNameOtherLast = Name(deepUri.str() + "/segment-101");
+
+  // 16 terms: single components and ranges
+  for (int i = 0; i < 8; ++i) {
+    ostringstream from, to;
+    from << "component-" << (i * 10);
+    to << "component-" << (i * 10 + 5);
+    g_exclude.excludeOne(Name::Component((from.str() + "-one").c_str()));
+    g_exclude.excludeRange(Name::Component(from.str().c_str()), Name::Component(to.str().c_str()));
+  }
+  g_excludeWire = g_exclude.wireEncode();
+
+  uint32_t random = 1;
+  for (size_t i = 0; i < 2 * N_SYNC_EXCLUDED; ++i) {
+    uint8_t digest[32];
+    for (size_t j = 0; j < sizeof(digest); ++j) {
+      random = random * 1103515245 + 12345;
+      digest[j] = random >> 16;
+    }
+    if (i % 2 == 0)
+      g_syncExcluded.push_back(Name::Component(digest, sizeof(digest)));
+    else
+      g_syncNotExcluded.push_back(Name::Component(digest, sizeof(digest)));
+  }
+  for (size_t i = 0; i < N_SYNC_EXCLUDED; ++i)
+    g_syncExclude.excludeOne(g_syncExcluded[i]);
+  g_syncExcludeWire = g_syncExclude.wireEncode();
+
+  Interest syncInterest(g_shortName);
+  syncInterest.getExclude() = g_syncExclude;
+  syncInterest.setNonce(1);
+  g_syncInterestWire = syncInterest.wireEncode();
+  g_syncDataName = Name(g_shortName).append(g_syncNotExcluded[N_SYNC_EXCLUDED / 2]);
+
+  g_plainInterest = Interest(g_longName);
+  g_plainInterest.setNonce(1);
+  g_plainInterestWire = g_plainInterest.wireEncode();
+
+  g_selectorsInterest = Interest(g_shortName);
+  g_selectorsInterest.setMinSuffixComponents(1);
+  g_selectorsInterest.setMaxSuffixComponents(8);
+  g_selectorsInterest.getExclude() = g_exclude;
+  g_selectorsInterest.setChildSelector(1);
+  g_selectorsInterest.setMustBeFresh(true);
+  g_selectorsInterest.setScope(1);
+  g_selectorsInterest.setInterestLifetime(1000);
+  g_selectorsInterest.setNonce(1);
+  g_selectorsInterestWire = g_selectorsInterest.wireEncode();
+
+  for (size_t i = 0; i < N_FANOUTS; ++i) {
+    Block block(Tlv::Content);
+    for (size_t j = 0; j < FANOUTS[i]; ++j)
+      block.push_back(nonNegativeIntegerBlock(Tlv::FreshnessPeriod, j));
+    block.encode();
+    g_fanoutWire[i] = ptr_lib::make_shared<Buffer>(block.wire(), block.size());
+  }
+
+  g_tpm.setKeyPairForKeyName(g_keyName,
+                             DEFAULT_PUBLIC_KEY_DER, sizeof(DEFAULT_PUBLIC_KEY_DER),
+                             DEFAULT_PRIVATE_KEY_DER, sizeof(DEFAULT_PRIVATE_KEY_DER));
+  g_publicKey = g_tpm.getPublicKeyFromTpm(g_keyName);
+
+  g_message.assign(1000, 0xAB);
+  g_messageSignature.setValue(g_tpm.signInTpm(g_message.buf(), g_message.size(), g_keyName,
+                                              DIGEST_ALGORITHM_SHA256));
+
+  g_signedData.setName(g_dataName);
+  g_signedData.setContent(g_message.buf(), g_message.size());
+  SignatureSha256WithRsa signature;
+  signature.setKeyLocator(KeyLocator(g_keyName));
+  g_signedData.setSignature(signature);
+  g_tpm.signInTpm(g_signedData, g_keyName, DIGEST_ALGORITHM_SHA256);
+  g_signedData.wireEncode();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Benchmark functions
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t
+benchmarkNameParseShort(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += Name(SHORT_URI).size();
+  return result;
+}
+
+static size_t
+benchmarkNameParseLong(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += Name(LONG_URI).size();
+  return result;
+}
+
+static size_t
+benchmarkNamePrintShort(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += g_shortName.toUri().size();
+  return result;
+}
+
+static size_t
+benchmarkNamePrintLong(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += g_longName.toUri().size();
+  return result;
+}
+
+static size_t
+benchmarkNameSetLong(int nIterations)
+{
+  // set() reuses the buffer of the name
+  Name name;
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i) {
+    name.set(LONG_URI);
+    result += name.size();
+  }
+  return result;
+}
+
+static size_t
+benchmarkNamePrintLongToBuffer(int nIterations)
+{
+  char buffer[256];
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += g_longName.toUri(buffer, sizeof(buffer));
+  return result;
+}
+
+static size_t
+benchmarkNameEqualsTrue(int nIterations)
+{
+  Name copy = g_longName;
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += g_longName.equals(copy);
+  return result;
+}
+
+static size_t
+benchmarkNameEqualsLastDiffers(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += !g_longName.equals(g_longNameOtherLast);
+  return result;
+}
+
+static size_t
+benchmarkNameBreadthFirstLess(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += Name::breadthFirstLess(g_longName, g_longNameOtherLast);
+  return result;
+}
+
+static size_t
+benchmarkNameCompareDeepEqual(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += g_deepName.compare(g_deepNameEqual) == 0;
+  return result;
+}
+
+static size_t
+benchmarkNameCompareDeepLastDiffers(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += g_deepName.compare(g_deepNameOtherLast) < 0;
+  return result;
+}
+
+static size_t
+benchmarkNameMapFindDeep(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += g_deepNameMap.find(g_deepName)->second;
+  return result;
+}
+
+static size_t
+benchmarkNameDeriveSegment(int nIterations)
+{
+  // as in ndncatchunks, the derived name shares the components of the base
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += Name(g_deepName).appendSegment(i).size();
+  return result;
+}
+
+static size_t
+benchmarkNameDeriveSegmentEncode(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += Name(g_deepName).appendSegment(i).wireEncode().size();
+  return result;
+}
+
+static size_t
+benchmarkNameDeriveSegmentInterestEncode(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i) {
+    Interest interest(Name(g_deepName).appendSegment(i));
+    interest.setNonce(1);
+    result += interest.wireEncode().size();
+  }
+  return result;
+}
+
+static size_t
+benchmarkNameIsPrefixOfTrue(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += g_shortName.isPrefixOf(g_longName);
+  return result;
+}
+
+static size_t
+benchmarkNameIsPrefixOfFalse(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += g_longNameOtherLast.isPrefixOf(g_longName);
+  return result;
+}
+
+static size_t
+benchmarkNameHash(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += g_longName.getHash();
+  return result;
+}
+
+static size_t
+benchmarkNamePrefixHashes(int nIterations)
+{
+  size_t result = 0;
+  std::vector<size_t> hashes;
+  for (int i = 0; i < nIterations; ++i) {
+    g_longName.getPrefixHashes(g_longName.size(), hashes);
+    result += hashes.back();
+  }
+  return result;
+}
+
+static size_t
+benchmarkNameLongestPrefixLookup(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i) {
+    const Name &name = g_longName;
+    for (int length = name.size(); length >= 0; --length) {
+      NameHashMap<int>::const_iterator entry = g_prefixTable.find(name.getPrefix(length));
+      if (entry != g_prefixTable.end()) {
+        result += entry->second;
+        break;
+      }
+    }
+  }
+  return result;
+}
+
+static size_t
+benchmarkComponentFromNumber(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += Name::Component::fromNumber(1384000000 + i).getValue().size();
+  return result;
+}
+
+static size_t
+benchmarkComponentToNumber(int nIterations)
+{
+  Name::Component component = Name::Component::fromNumber(1384000000);
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += component.toNumber();
+  return result;
+}
+
+static size_t
+benchmarkComponentAppendSegment(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i) {
+    Name name;
+    name.appendSegment(i);
+    result += name.size();
+  }
+  return result;
+}
+
+static size_t
+benchmarkComponentToSegment(int nIterations)
+{
+  const Name::Component &component = g_dataName.get(-1);
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += component.toSegment();
+  return result;
+}
+
+/**
+ * Read the segment number of a name just decoded, as when matching a received Data packet.
+ */
+static size_t
+benchmarkComponentToSegmentDecoded(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i) {
+    Name name(g_dataNameWire);
+    result += name.getComponentNumberWithMarker(name.size() - 1, 0x00);
+  }
+  return result;
+}
+
+static size_t
+benchmarkExcludeBuild(int nIterations)
+{
+  Name::Component one("component-0-one");
+  Name::Component from("component-0");
+  Name::Component to("component-5");
+  Name::Component after("component-9");
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i) {
+    Exclude exclude;
+    exclude.excludeOne(one).excludeRange(from, to).excludeAfter(after);
+    result += exclude.size();
+  }
+  return result;
+}
+
+static size_t
+benchmarkExcludeIsExcludedHit(int nIterations)
+{
+  Name::Component component("component-32");
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += g_exclude.isExcluded(component);
+  return result;
+}
+
+static size_t
+benchmarkExcludeIsExcludedMiss(int nIterations)
+{
+  Name::Component component("component-38");
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += !g_exclude.isExcluded(component);
+  return result;
+}
+
+static size_t
+benchmarkExcludeBuildSync(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i) {
+    Exclude exclude;
+    for (size_t j = 0; j < N_SYNC_EXCLUDED; ++j)
+      exclude.excludeOne(g_syncExcluded[j]);
+    result += exclude.size();
+  }
+  return result;
+}
+
+static size_t
+benchmarkExcludeIsExcludedSync(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i) {
+    size_t j = i % N_SYNC_EXCLUDED;
+    result += g_syncExclude.isExcluded(i % 2 == 0 ? g_syncExcluded[j] : g_syncNotExcluded[j]);
+  }
+  return result;
+}
+
+static size_t
+benchmarkExcludeEncode(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i) {
+    EncodingEstimator estimator;
+    size_t estimatedSize = g_exclude.wireEncode(estimator);
+
+    EncodingBuffer buffer(estimatedSize, 0);
+    result += g_exclude.wireEncode(buffer);
+  }
+  return result;
+}
+
+static size_t
+benchmarkExcludeDecode(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i) {
+    Exclude exclude;
+    exclude.wireDecode(g_excludeWire);
+    result += exclude.size();
+  }
+  return result;
+}
+
+/**
+ * Decode a received filter and check one component against it.  A filter this large is decoded
+ * by wireDecode() rather than read in place.
+ */
+static size_t
+benchmarkExcludeDecodeIsExcludedSync(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i) {
+    Exclude exclude;
+    exclude.wireDecode(g_syncExcludeWire);
+    result += exclude.isExcluded(g_syncNotExcluded[i % N_SYNC_EXCLUDED]);
+  }
+  return result;
+}
+
+/**
+ * Encode the interest as Interest::wireEncode() does, but without the cached wire encoding.
+ */
+static size_t
+encodeInterest(const Interest &interest)
+{
+  EncodingEstimator estimator;
+  size_t estimatedSize = interest.wireEncode(estimator);
+
+  EncodingBuffer buffer(estimatedSize, 0);
+  return interest.wireEncode(buffer);
+}
+
+static size_t
+benchmarkInterestEncodePlain(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += encodeInterest(g_plainInterest);
+  return result;
+}
+
+static size_t
+benchmarkInterestEncodeSelectors(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += encodeInterest(g_selectorsInterest);
+  return result;
+}
+
+static size_t
+benchmarkInterestDecodePlain(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i) {
+    Interest interest;
+    interest.wireDecode(g_plainInterestWire);
+    result += interest.getName().size();
+  }
+  return result;
+}
+
+static size_t
+benchmarkInterestDecodeSelectors(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i) {
+    Interest interest;
+    interest.wireDecode(g_selectorsInterestWire);
+    result += interest.getName().size() + interest.getExclude().size();
+  }
+  return result;
+}
+
+template<size_t FANOUT_INDEX>
+static size_t
+benchmarkBlockParse(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i) {
+    Block block(g_fanoutWire[FANOUT_INDEX]);
+    block.parse();
+    result += block.elements_size();
+  }
+  return result;
+}
+
+static size_t
+benchmarkMatchesNamePlain(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += g_plainInterest.matchesName(g_longName);
+  return result;
+}
+
+static size_t
+benchmarkMatchesNameSelectors(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += g_selectorsInterest.matchesName(g_dataName);
+  return result;
+}
+
+static size_t
+benchmarkDecodeMatchesNameSync(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i) {
+    Interest interest;
+    interest.wireDecode(g_syncInterestWire);
+    result += interest.matchesName(g_syncDataName);
+  }
+  return result;
+}
+
+static size_t
+benchmarkSha256(int nIterations)
+{
+  uint8_t digest[SHA256_DIGEST_LENGTH];
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i) {
+    ndn_digestSha256(g_message.buf(), g_message.size(), digest);
+    result += digest[0];
+  }
+  return result;
+}
+
+static size_t
+benchmarkRsaSign(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += g_tpm.signInTpm(g_message.buf(), g_message.size(), g_keyName, DIGEST_ALGORITHM_SHA256).value_size();
+  return result;
+}
+
+static size_t
+benchmarkRsaVerify(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += Verifier::verifySignature(g_message, g_messageSignature, *g_publicKey);
+  if (result != static_cast<size_t>(nIterations))
+    throw runtime_error("RSA signature verification failed");
+  return result;
+}
+
+static size_t
+benchmarkDataSign(int nIterations)
+{
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i) {
+    Data data(g_dataName);
+    data.setContent(g_message.buf(), g_message.size());
+    SignatureSha256WithRsa signature;
+    signature.setKeyLocator(KeyLocator(g_keyName));
+    data.setSignature(signature);
+
+    g_tpm.signInTpm(data, g_keyName, DIGEST_ALGORITHM_SHA256);
+    result += data.wireEncode().size();
+  }
+  return result;
+}
+
+static size_t
+benchmarkDataVerify(int nIterations)
+{
+  SignatureSha256WithRsa signature(g_signedData.getSignature());
+  size_t result = 0;
+  for (int i = 0; i < nIterations; ++i)
+    result += Verifier::verifySignature(g_signedData, signature, *g_publicKey);
+  if (result != static_cast<size_t>(nIterations))
+    throw runtime_error("Data signature verification failed");
+  return result;
+}
+
+static const BenchmarkCase BENCHMARKS[] = {
+  { "name/parse-uri/short",           benchmarkNameParseShort },
+  { "name/parse-uri/long",            benchmarkNameParseLong },
+  { "name/set-uri/long",              benchmarkNameSetLong },
+  { "name/to-uri/short",              benchmarkNamePrintShort },
+  { "name/to-uri/long",               benchmarkNamePrintLong },
+  { "name/to-uri/long/buffer",        benchmarkNamePrintLongToBuffer },
+  { "name/equals/true",               benchmarkNameEqualsTrue },
+  { "name/equals/last-differs",       benchmarkNameEqualsLastDiffers },
+  { "name/breadth-first-less",        benchmarkNameBreadthFirstLess },
+  { "name/compare/deep/equal",        benchmarkNameCompareDeepEqual },
+  { "name/compare/deep/last-differs", benchmarkNameCompareDeepLastDiffers },
+  { "name/map-find/deep",             benchmarkNameMapFindDeep },
+  { "name/derive/segment",            benchmarkNameDeriveSegment },
+  { "name/derive/encode",             benchmarkNameDeriveSegmentEncode },
+  { "name/derive/interest-encode",    benchmarkNameDeriveSegmentInterestEncode },
+  { "name/is-prefix-of/true",         benchmarkNameIsPrefixOfTrue },
+  { "name/is-prefix-of/false",        benchmarkNameIsPrefixOfFalse },
+  { "name/hash",                      benchmarkNameHash },
+  { "name/prefix-hashes",             benchmarkNamePrefixHashes },
+  { "name/hash-map/longest-prefix",   benchmarkNameLongestPrefixLookup },
+  { "component/from-number",          benchmarkComponentFromNumber },
+  { "component/to-number",            benchmarkComponentToNumber },
+  { "component/append-segment",       benchmarkComponentAppendSegment },
+  { "component/to-segment",           benchmarkComponentToSegment },
+  { "component/to-segment/decoded",   benchmarkComponentToSegmentDecoded },
+  { "exclude/build",                  benchmarkExcludeBuild },
+  { "exclude/is-excluded/hit",        benchmarkExcludeIsExcludedHit },
+  { "exclude/is-excluded/miss",       benchmarkExcludeIsExcludedMiss },
+  { "exclude/build/sync-256",         benchmarkExcludeBuildSync },
+  { "exclude/is-excluded/sync-256",   benchmarkExcludeIsExcludedSync },
+  { "exclude/encode",                 benchmarkExcludeEncode },
+  { "exclude/decode",                 benchmarkExcludeDecode },
+  { "exclude/decode+is-excluded/sync-256", benchmarkExcludeDecodeIsExcludedSync },
+  { "interest/encode/plain",          benchmarkInterestEncodePlain },
+  { "interest/encode/selectors",      benchmarkInterestEncodeSelectors },
+  { "interest/decode/plain",          benchmarkInterestDecodePlain },
+  { "interest/decode/selectors",      benchmarkInterestDecodeSelectors },
+  { "block/parse/fanout-1",           benchmarkBlockParse<0> },
+  { "block/parse/fanout-8",           benchmarkBlockParse<1> },
+  { "block/parse/fanout-64",          benchmarkBlockParse<2> },
+  { "block/parse/fanout-512",         benchmarkBlockParse<3> },
+  { "interest/matches-name/plain",    benchmarkMatchesNamePlain },
+  { "interest/matches-name/selectors", benchmarkMatchesNameSelectors },
+  { "interest/decode+matches-name/sync-256", benchmarkDecodeMatchesNameSync },
+  { "crypto/sha256/1000-bytes",       benchmarkSha256 },
+  { "crypto/rsa-sign/1000-bytes",     benchmarkRsaSign },
+  { "crypto/rsa-verify/1000-bytes",   benchmarkRsaVerify },
+  { "crypto/data-sign",               benchmarkDataSign },
+  { "crypto/data-verify",             benchmarkDataVerify },
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Runner
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Run the function nIterations times.
+ * @return The number of seconds.
+ */
+static double
+runSeconds(BenchmarkFunction function, int nIterations)
+{
+  double start = getNowSeconds();
+  g_sink = g_sink + function(nIterations);
+  return getNowSeconds() - start;
+}
+
+/**
+ * Calibrate the number of iterations so that one run takes at least minSeconds (this also warms up the
+ * caches), then run the benchmark nRepetitions times and summarize the samples.
+ */
+static void
+runBenchmark(const BenchmarkCase &benchmark, int nRepetitions, double minSeconds, BenchmarkResult &result)
+{
+  int nIterations = 1;
+  double seconds = runSeconds(benchmark.function, nIterations);
+  while (seconds < minSeconds && nIterations < (1 << 30)) {
+    // Aim a bit above minSeconds, but grow at most 10 times per step.
+    double factor = seconds > 0 ? std::min(10.0, 1.2 * minSeconds / seconds) : 10.0;
+    nIterations = static_cast<int>(std::max(nIterations * factor, nIterations + 1.0));
+    seconds = runSeconds(benchmark.function, nIterations);
+  }
+
+  result.name = benchmark.name;
+  result.nIterations = nIterations;
+  result.samples.clear();
+  Instrumentation::Snapshot snapshot;
+  for (int i = 0; i < nRepetitions; ++i)
+    result.samples.push_back(runSeconds(benchmark.function, nIterations) * 1e9 / nIterations);
+
+  result.counters.clear();
+  for (int i = 0; i < Instrumentation::N_COUNTERS; ++i)
+    result.counters.push_back(static_cast<double>(snapshot.get(static_cast<Instrumentation::Counter>(i))) /
+                              (static_cast<double>(nIterations) * nRepetitions));
+
+  vector<double> sorted = result.samples;
+  std::sort(sorted.begin(), sorted.end());
+  size_t n = sorted.size();
+
+  result.min = sorted.front();
+  result.max = sorted.back();
+  result.median = (n % 2 == 1) ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+
+  double sum = 0;
+  for (size_t i = 0; i < n; ++i)
+    sum += sorted[i];
+  result.mean = sum / n;
+
+  double squares = 0;
+  for (size_t i = 0; i < n; ++i)
+    squares += (sorted[i] - result.mean) * (sorted[i] - result.mean);
+  result.stddev = n > 1 ? std::sqrt(squares / (n - 1)) : 0;
+}
+
+static void
+printTextHeader()
+{
+  cout << "benchmark                           iterations  median ns    min ns    max ns    stddev %   ops/s" << endl;
+}
+
+static void
+printText(const BenchmarkResult &result)
+{
+  ostringstream line;
+  line.setf(ios::fixed);
+  line.precision(1);
+  line << result.name << string(result.name.size() < 36 ? 36 - result.name.size() : 1, ' ');
+
+  ostringstream iterations;
+  iterations << result.nIterations;
+  line << iterations.str() << string(iterations.str().size() < 12 ? 12 - iterations.str().size() : 1, ' ');
+
+  const double values[] = { result.median, result.min, result.max, 100 * result.stddev / result.mean };
+  for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+    ostringstream value;
+    value.setf(ios::fixed);
+    value.precision(1);
+    value << values[i];
+    line << value.str() << string(value.str().size() < 10 ? 10 - value.str().size() : 1, ' ');
+  }
+  line.precision(0);
+  line << 1e9 / result.median;
+  cout << line.str() << endl;
+}
+
+static void
+printCsvHeader()
+{
+  cout << "name,iterations,repetitions,min_ns,median_ns,mean_ns,max_ns,stddev_ns,ops_per_sec";
+  if (Instrumentation::isEnabled()) {
+    for (int i = 0; i < Instrumentation::N_COUNTERS; ++i)
+      cout << "," << Instrumentation::getName(static_cast<Instrumentation::Counter>(i));
+  }
+  cout << endl;
+}
+
+static void
+printCsv(const BenchmarkResult &result)
+{
+  cout << result.name << "," << result.nIterations << "," << result.samples.size() << ","
+       << result.min << "," << result.median << "," << result.mean << "," << result.max << ","
+       << result.stddev << "," << 1e9 / result.median;
+  if (Instrumentation::isEnabled()) {
+    for (size_t i = 0; i < result.counters.size(); ++i)
+      cout << "," << result.counters[i];
+  }
+  cout << endl;
+}
+
+static void
+printJsonHeader(int nRepetitions, double minSeconds)
+{
+  cout << "{" << endl
+       << "  \"context\": {" << endl
+       << "    \"library\": \"ndn-cpp\"," << endl
+       << "    \"date\": " << static_cast<uint64_t>(getNowSeconds()) << "," << endl
+       << "    \"repetitions\": " << nRepetitions << "," << endl
+       << "    \"min_time_sec\": " << minSeconds << "," << endl
+       << "    \"instrumentation\": " << (Instrumentation::isEnabled() ? "true" : "false") << endl
+       << "  }," << endl
+       << "  \"benchmarks\": [" << endl;
+}
+
+static void
+printJson(const BenchmarkResult &result, bool isFirst)
+{
+  if (!isFirst)
+    cout << "," << endl;
+
+  cout << "    { \"name\": \"" << result.name << "\", \"iterations\": " << result.nIterations
+       << ", \"repetitions\": " << result.samples.size()
+       << ", \"min_ns\": " << result.min << ", \"median_ns\": " << result.median
+       << ", \"mean_ns\": " << result.mean << ", \"max_ns\": " << result.max
+       << ", \"stddev_ns\": " << result.stddev << ", \"ops_per_sec\": " << 1e9 / result.median
+       << ", \"samples_ns\": [";
+  for (size_t i = 0; i < result.samples.size(); ++i)
+    cout << (i > 0 ? ", " : "") << result.samples[i];
+  cout << "]";
+
+  if (Instrumentation::isEnabled()) {
+    cout << ", \"counters_per_iteration\": {";
+    for (size_t i = 0; i < result.counters.size(); ++i)
+      cout << (i > 0 ? ", " : "") << "\"" << Instrumentation::getName(static_cast<Instrumentation::Counter>(i))
+           << "\": " << result.counters[i];
+    cout << "}";
+  }
+  cout << " }";
+}
+
+static void
+printJsonFooter()
+{
+  cout << endl << "  ]" << endl << "}" << endl;
+}
+
+static void
+usage(const char *program)
+{
+  cerr << "Usage: " << program << " [--format=text|csv|json] [--repetitions=N] [--min-time=SECONDS]"
+       << " [--filter=SUBSTRING] [--list]" << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  string format = "text";
+  int nRepetitions = 10;
+  double minSeconds = 0.1;
+  string filter;
+  bool isList = false;
+
+  for (int i = 1; i < argc; ++i) {
+    string argument = argv[i];
+    if (argument.compare(0, 9, "--format=") == 0)
+      format = argument.substr(9);
+    else if (argument.compare(0, 14, "--repetitions=") == 0)
+      nRepetitions = atoi(argument.substr(14).c_str());
+    else if (argument.compare(0, 11, "--min-time=") == 0)
+      minSeconds = atof(argument.substr(11).c_str());
+    else if (argument.compare(0, 9, "--filter=") == 0)
+      filter = argument.substr(9);
+    else if (argument == "--list")
+      isList = true;
+    else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if ((format != "text" && format != "csv" && format != "json") || nRepetitions < 1 || minSeconds < 0) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  const size_t nBenchmarks = sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]);
+  if (isList) {
+    for (size_t i = 0; i < nBenchmarks; ++i)
+      cout << BENCHMARKS[i].name << endl;
+    return 0;
+  }
+
+  try {
+    setUpFixtures();
+
+    if (format == "text")
+      printTextHeader();
+    else if (format == "csv")
+      printCsvHeader();
+    else
+      printJsonHeader(nRepetitions, minSeconds);
+
+    bool isFirst = true;
+    for (size_t i = 0; i < nBenchmarks; ++i) {
+      if (!filter.empty() && string(BENCHMARKS[i].name).find(filter) == string::npos)
+        continue;
+
+      BenchmarkResult result;
+      runBenchmark(BENCHMARKS[i], nRepetitions, minSeconds, result);
+
+      if (format == "text")
+        printText(result);
+      else if (format == "csv")
+        printCsv(result);
+      else
+        printJson(result, isFirst);
+      isFirst = false;
+    }
+
+    if (format == "json")
+      printJsonFooter();
+  } catch (std::exception& e) {
+    cerr << "exception: " << e.what() << endl;
+    return 1;
+  }
+  return 0;
+}
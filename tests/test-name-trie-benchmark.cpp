@@ -0,0 +1,295 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2013 Regents of the University of California.
+ * See COPYING for copyright and distribution information.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cstdlib>
+#include <map>
+#include <vector>
+#include <pthread.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <ndn-cpp/util/name-trie.hpp>
+
+using namespace std;
+using namespace ndn;
+
+static double
+getNowSeconds()
+{
+  struct timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec + t.tv_usec / 1000000.0;
+}
+
+/**
+ * Get the resident set size of the process in bytes, 0 if it cannot be read.
+ */
+static size_t
+getResidentBytes()
+{
+  ifstream statm("/proc/self/statm");
+  size_t totalPages = 0;
+  size_t residentPages = 0;
+  if (!(statm >> totalPages >> residentPages))
+    return 0;
+  return residentPages * sysconf(_SC_PAGESIZE);
+}
+
+/**
+ * Make FIB-like prefixes of 2 to 5 components under a few hundred sites.
+ */
+static void
+makePrefixes(size_t nPrefixes, vector<Name> &prefixes)
+{
+  for (size_t i = 0; i < nPrefixes; ++i) {
+    ostringstream uri;
+    uri << "/site-" << rand() % 300 << "/app-" << rand() % 50;
+    for (int j = rand() % 4; j > 0; --j)
+      uri << "/part-" << rand() % 1000;
+    prefixes.push_back(Name(uri.str()));
+  }
+}
+
+/**
+ * Make names to look up: a prefix with 1 to 3 more components, or (one in 8) an unknown name.
+ */
+static void
+makeQueries(const vector<Name> &prefixes, size_t nQueries, vector<Name> &queries)
+{
+  for (size_t i = 0; i < nQueries; ++i) {
+    if (rand() % 8 == 0) {
+      queries.push_back(Name("/unknown/site/data"));
+      continue;
+    }
+    Name query = prefixes[rand() % prefixes.size()];
+    for (int j = rand() % 3; j >= 0; --j)
+      query.append("segment-1234");
+    queries.push_back(query);
+  }
+}
+
+static void
+benchmarkMemory(const vector<Name> &prefixes)
+{
+  size_t before = getResidentBytes();
+  NameTrie<int> *trie = new NameTrie<int>();
+  for (size_t i = 0; i < prefixes.size(); ++i)
+    trie->insert(prefixes[i], i);
+  size_t trieBytes = getResidentBytes() - before;
+  size_t nEntries = trie->size();
+
+  before = getResidentBytes();
+  map<Name, int> *nameMap = new map<Name, int>();
+  for (size_t i = 0; i < prefixes.size(); ++i)
+    (*nameMap)[Name(prefixes[i].toUri())] = i;
+  size_t mapBytes = getResidentBytes() - before;
+
+  cout << "Memory for " << nEntries << " prefixes, bytes per entry: NameTrie " << trieBytes / nEntries
+       << ", std::map<Name, int> " << mapBytes / nEntries << endl;
+
+  delete nameMap;
+  delete trie;
+}
+
+/**
+ * Longest prefix match in a std::map by looking up the prefixes from the longest one.
+ */
+static const int*
+findLongestPrefixMatch(const map<Name, int> &nameMap, const Name &name)
+{
+  for (int i = name.size(); i >= 0; --i) {
+    map<Name, int>::const_iterator entry = nameMap.find(name.getPrefix(i));
+    if (entry != nameMap.end())
+      return &entry->second;
+  }
+  return 0;
+}
+
+enum Table {
+  TRIE,                ///< NameTrie::findLongestPrefixMatch, taking a snapshot per lookup
+  TRIE_SNAPSHOT,       ///< one NameTrie::Snapshot per pass over the queries
+  LOCKED_MAP           ///< std::map under a pthread read-write lock
+};
+
+static const char* const TABLE_NAMES[] = {
+  "NameTrie, snapshot per lookup",
+  "NameTrie, snapshot per pass  ",
+  "std::map + rwlock            "
+};
+
+/**
+ * The tables shared by the threads of one run and the state of the run
+ */
+struct Run
+{
+  Table table;
+  NameTrie<int> trie;
+  map<Name, int> nameMap;
+  pthread_rwlock_t mapLock;
+
+  const vector<Name> *prefixes;
+  int nPasses;
+
+  pthread_mutex_t mutex;
+  int nReadersRunning;
+  double readerSeconds;
+  size_t nLookups;
+  size_t nMatches;
+  size_t nUpdates;
+};
+
+static bool
+areReadersRunning(Run &run)
+{
+  pthread_mutex_lock(&run.mutex);
+  bool result = run.nReadersRunning > 0;
+  pthread_mutex_unlock(&run.mutex);
+  return result;
+}
+
+static void*
+runReader(void *argument)
+{
+  Run &run = *static_cast<Run*>(argument);
+
+  // Each reader has its own queries, like a worker thread handling its own packets.
+  vector<Name> queries;
+  makeQueries(*run.prefixes, 1000, queries);
+
+  size_t nMatches = 0;
+  double start = getNowSeconds();
+  for (int pass = 0; pass < run.nPasses; ++pass) {
+    if (run.table == TRIE) {
+      int value;
+      for (size_t i = 0; i < queries.size(); ++i)
+        nMatches += run.trie.findLongestPrefixMatch(queries[i], value);
+    }
+    else if (run.table == TRIE_SNAPSHOT) {
+      NameTrie<int>::Snapshot snapshot = run.trie.getSnapshot();
+      for (size_t i = 0; i < queries.size(); ++i)
+        nMatches += snapshot.findLongestPrefixMatch(queries[i]) != 0;
+    }
+    else {
+      for (size_t i = 0; i < queries.size(); ++i) {
+        pthread_rwlock_rdlock(&run.mapLock);
+        nMatches += findLongestPrefixMatch(run.nameMap, queries[i]) != 0;
+        pthread_rwlock_unlock(&run.mapLock);
+      }
+    }
+  }
+  double seconds = getNowSeconds() - start;
+
+  pthread_mutex_lock(&run.mutex);
+  --run.nReadersRunning;
+  run.readerSeconds = max(run.readerSeconds, seconds);
+  run.nLookups += queries.size() * run.nPasses;
+  run.nMatches += nMatches;
+  pthread_mutex_unlock(&run.mutex);
+  return 0;
+}
+
+/**
+ * Replace random prefixes until the readers are done.
+ */
+static void*
+runWriter(void *argument)
+{
+  Run &run = *static_cast<Run*>(argument);
+  const vector<Name> &prefixes = *run.prefixes;
+
+  size_t nUpdates = 0;
+  while (areReadersRunning(run)) {
+    const Name &prefix = prefixes[rand() % prefixes.size()];
+    if (run.table == LOCKED_MAP) {
+      pthread_rwlock_wrlock(&run.mapLock);
+      run.nameMap.erase(prefix);
+      run.nameMap[prefix] = nUpdates;
+      pthread_rwlock_unlock(&run.mapLock);
+    }
+    else {
+      run.trie.erase(prefix);
+      run.trie.insert(prefix, nUpdates);
+    }
+    ++nUpdates;
+  }
+
+  pthread_mutex_lock(&run.mutex);
+  run.nUpdates = nUpdates;
+  pthread_mutex_unlock(&run.mutex);
+  return 0;
+}
+
+/**
+ * Run nReaders reader threads doing longest prefix matches, with or without a writer thread.
+ */
+static void
+benchmarkContention(Table table, const vector<Name> &prefixes, int nReaders, bool withWriter)
+{
+  Run run;
+  run.table = table;
+  for (size_t i = 0; i < prefixes.size(); ++i) {
+    run.trie.insert(prefixes[i], i);
+    run.nameMap[prefixes[i]] = i;
+  }
+  pthread_rwlock_init(&run.mapLock, 0);
+  pthread_mutex_init(&run.mutex, 0);
+  run.prefixes = &prefixes;
+  run.nPasses = 200;
+  run.nReadersRunning = nReaders;
+  run.readerSeconds = 0;
+  run.nLookups = 0;
+  run.nMatches = 0;
+  run.nUpdates = 0;
+
+  vector<pthread_t> readers(nReaders);
+  for (int i = 0; i < nReaders; ++i)
+    pthread_create(&readers[i], 0, runReader, &run);
+  pthread_t writer;
+  if (withWriter)
+    pthread_create(&writer, 0, runWriter, &run);
+
+  for (int i = 0; i < nReaders; ++i)
+    pthread_join(readers[i], 0);
+  if (withWriter)
+    pthread_join(writer, 0);
+
+  if (run.nMatches == 0)
+    cout << "Error: no prefix matched" << endl;
+  cout << TABLE_NAMES[table] << ", " << nReaders << " readers" << (withWriter ? " + writer" : "         ")
+       << ": lookups/s " << run.nLookups / run.readerSeconds
+       << ", per reader " << run.nLookups / nReaders / run.readerSeconds;
+  if (withWriter)
+    cout << ", updates/s " << run.nUpdates / run.readerSeconds;
+  cout << endl;
+
+  pthread_mutex_destroy(&run.mutex);
+  pthread_rwlock_destroy(&run.mapLock);
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    srand(1);
+    vector<Name> prefixes;
+    makePrefixes(100000, prefixes);
+    benchmarkMemory(prefixes);
+
+    static const int N_READERS[] = { 1, 2, 4, 8 };
+    for (int table = TRIE; table <= LOCKED_MAP; ++table) {
+      for (size_t i = 0; i < sizeof(N_READERS) / sizeof(N_READERS[0]); ++i) {
+        benchmarkContention(static_cast<Table>(table), prefixes, N_READERS[i], false);
+        benchmarkContention(static_cast<Table>(table), prefixes, N_READERS[i], true);
+      }
+    }
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
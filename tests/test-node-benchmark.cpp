@@ -0,0 +1,354 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2013 Regents of the University of California.
+ * See COPYING for copyright and distribution information.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <sys/time.h>
+#include <ndn-cpp/node.hpp>
+#include <ndn-cpp/forwarding-entry.hpp>
+#include <ndn-cpp/encoding/block-helpers.hpp>
+#include <ndn-cpp/security/signature-sha256-with-rsa.hpp>
+
+using namespace std;
+using namespace ndn;
+
+static double
+getNowSeconds()
+{
+  struct timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec + t.tv_usec / 1000000.0;
+}
+
+/**
+ * A Transport which sends nothing and receives the packets given to deliver(), so that the
+ * benchmark measures the Node alone.
+ */
+class LoopbackTransport : public Transport
+{
+public:
+  virtual void
+  connect(boost::asio::io_service &ioService, const ReceiveCallback &receiveCallback)
+  {
+    Transport::connect(ioService, receiveCallback);
+    isConnected_ = true;
+  }
+
+  virtual void
+  close()
+  {
+    isConnected_ = false;
+  }
+
+  virtual void
+  send(const Block &wire)
+  {
+  }
+
+  void
+  deliver(const Block &wire)
+  {
+    receive(wire);
+  }
+};
+
+/**
+ * A LoopbackTransport which keeps the Interests sent, for answerHubInterests.
+ */
+class HubTransport : public LoopbackTransport
+{
+public:
+  virtual void
+  send(const Block &wire)
+  {
+    sentInterests.push_back(wire);
+  }
+
+  vector<Block> sentInterests;
+};
+
+static size_t g_nData = 0;
+
+static void
+onData(const ptr_lib::shared_ptr<const Interest> &interest, const ptr_lib::shared_ptr<Data> &data)
+{
+  ++g_nData;
+}
+
+static void
+onTimeout(const ptr_lib::shared_ptr<const Interest> &interest)
+{
+}
+
+static vector<double> g_timeoutLatenesses;
+
+/**
+ * An OnTimeout which records how long after the timeout time of its Interest it is called.
+ */
+class TimeoutRecorder
+{
+public:
+  TimeoutRecorder(double timeoutTimeSeconds)
+    : timeoutTimeSeconds_(timeoutTimeSeconds)
+  {
+  }
+
+  void
+  operator()(const ptr_lib::shared_ptr<const Interest> &interest)
+  {
+    g_timeoutLatenesses.push_back(getNowSeconds() - timeoutTimeSeconds_);
+  }
+
+private:
+  double timeoutTimeSeconds_;
+};
+
+/**
+ * Make the names of the Interests of consumers fetching segments of files.
+ */
+static void
+makeNames(size_t nNames, vector<Name> &names)
+{
+  for (size_t i = 0; i < nNames; ++i) {
+    ostringstream uri;
+    uri << "/site-" << rand() % 100 << "/app/file-" << rand() % 1000;
+    names.push_back(Name(uri.str()).appendSegment(i));
+  }
+}
+
+static Block
+makeDataWire(const Name &name, const Block &signatureValue)
+{
+  Data data(name);
+  const uint8_t content[100] = { 0 };
+  data.setContent(content, sizeof(content));
+  SignatureSha256WithRsa signature;
+  signature.setValue(signatureValue);
+  data.setSignature(signature);
+  return data.wireEncode();
+}
+
+/**
+ * Answer the Interests sent through the transport as an NDN hub does, with its key for the Interest
+ * fetching its ID and a ForwardingEntry for a prefix registration, until no more are sent.
+ */
+static void
+answerHubInterests(HubTransport &transport)
+{
+  uint8_t signatureBits[128];
+  memset(signatureBits, 0, sizeof(signatureBits));
+  SignatureSha256WithRsa signature;
+  signature.setValue(dataBlock(Tlv::SignatureValue, signatureBits, sizeof(signatureBits)));
+  const uint8_t hubKey[128] = { 0 };
+
+  while (!transport.sentInterests.empty()) {
+    vector<Block> interestWires;
+    interestWires.swap(transport.sentInterests);
+    for (size_t i = 0; i < interestWires.size(); ++i) {
+      Interest interest;
+      interest.wireDecode(interestWires[i]);
+      Data data(interest.getName());
+      if (interest.getName().size() > 2 && interest.getName().get(2) == Name::Component("selfreg"))
+        data.setContent(ForwardingEntry("selfreg", Name(), 1).wireEncode());
+      else
+        data.setContent(hubKey, sizeof(hubKey));
+      data.setSignature(signature);
+      transport.deliver(data.wireEncode());
+    }
+  }
+}
+
+static size_t g_nInterests = 0;
+static size_t g_nMisdispatchedInterests = 0;
+static size_t g_nRegisterFailures = 0;
+
+/**
+ * Count the Interest, which is a registered prefix with one more component.
+ */
+static void
+onInterest(const ptr_lib::shared_ptr<const Name> &prefix, const ptr_lib::shared_ptr<const Interest> &interest,
+           Transport &transport, uint64_t registeredPrefixId)
+{
+  ++g_nInterests;
+  if (prefix->size() + 1 != interest->getName().size())
+    ++g_nMisdispatchedInterests;
+}
+
+static void
+onRegisterFailed(const ptr_lib::shared_ptr<const Name> &prefix)
+{
+  ++g_nRegisterFailures;
+}
+
+/**
+ * Make FIB-like prefixes of 2 to 5 components under a few hundred sites.
+ */
+static void
+makePrefixes(size_t nPrefixes, vector<Name> &prefixes)
+{
+  for (size_t i = 0; i < nPrefixes; ++i) {
+    ostringstream uri;
+    uri << "/site-" << rand() % 300 << "/app-" << rand() % 50;
+    for (int j = rand() % 4; j > 0; --j)
+      uri << "/part-" << rand() % 1000;
+    prefixes.push_back(Name(uri.str()));
+  }
+}
+
+/**
+ * Register nPrefixes prefixes with an emulated hub, then measure the time an incoming Interest
+ * under one of them takes to be dispatched to the OnInterest of the longest matching prefix.
+ */
+static void
+benchmarkDispatch(size_t nPrefixes)
+{
+  vector<Name> prefixes;
+  makePrefixes(nPrefixes, prefixes);
+
+  ptr_lib::shared_ptr<HubTransport> transport(new HubTransport());
+  Node node(transport);
+  g_nRegisterFailures = 0;
+  for (size_t i = 0; i < nPrefixes; ++i)
+    node.registerPrefix(prefixes[i], onInterest, onRegisterFailed, ForwardingFlags());
+  answerHubInterests(*transport);
+  if (g_nRegisterFailures != 0)
+    cout << "Error: " << g_nRegisterFailures << " prefix registrations failed" << endl;
+
+  vector<Block> interestWires;
+  for (size_t i = 0; i < 1000; ++i)
+    interestWires.push_back
+      (Interest(Name(prefixes[rand() % nPrefixes]).append("segment-1234")).wireEncode());
+
+  g_nInterests = 0;
+  g_nMisdispatchedInterests = 0;
+  size_t nDelivered = 0;
+  double seconds = 0;
+  for (int pass = 0; pass < 100 && seconds < 1; ++pass) {
+    double start = getNowSeconds();
+    for (size_t i = 0; i < interestWires.size(); ++i)
+      transport->deliver(interestWires[i]);
+    seconds += getNowSeconds() - start;
+    nDelivered += interestWires.size();
+  }
+  if (g_nInterests < nDelivered)
+    cout << "Error: " << nDelivered << " Interests were dispatched " << g_nInterests << " times" << endl;
+  if (g_nMisdispatchedInterests != 0)
+    cout << "Error: " << g_nMisdispatchedInterests << " Interests were dispatched to a prefix which "
+         << "is not the longest match" << endl;
+
+  cout << nPrefixes << " registered prefixes: per Interest " << seconds * 1e9 / nDelivered << " ns"
+       << endl;
+
+  node.shutdown();
+}
+
+/**
+ * Express nInterests Interests which stay outstanding, then measure the time a Data packet takes
+ * to be matched against them.  In each pass, nPassInterests more Interests are expressed and as
+ * many Data packets satisfy them, so that the number of outstanding Interests stays the same.
+ */
+static void
+benchmark(size_t nInterests)
+{
+  const size_t nPassInterests = 1000;
+
+  vector<Name> names;
+  makeNames(nInterests + nPassInterests, names);
+  uint8_t signatureBits[128];
+  memset(signatureBits, 0, sizeof(signatureBits));
+  Block signatureValue = dataBlock(Tlv::SignatureValue, signatureBits, sizeof(signatureBits));
+  vector<Block> dataWires;
+  for (size_t i = nInterests; i < names.size(); ++i)
+    dataWires.push_back(makeDataWire(names[i], signatureValue));
+
+  ptr_lib::shared_ptr<LoopbackTransport> transport(new LoopbackTransport());
+  Node node(transport);
+  for (size_t i = 0; i < nInterests; ++i)
+    node.expressInterest(Interest(names[i], 3600000), onData, onTimeout);
+
+  g_nData = 0;
+  size_t nDelivered = 0;
+  double seconds = 0;
+  for (int pass = 0; pass < 100 && seconds < 1; ++pass) {
+    for (size_t i = nInterests; i < names.size(); ++i)
+      node.expressInterest(Interest(names[i], 3600000), onData, onTimeout);
+
+    double start = getNowSeconds();
+    for (size_t i = 0; i < dataWires.size(); ++i)
+      transport->deliver(dataWires[i]);
+    seconds += getNowSeconds() - start;
+    nDelivered += dataWires.size();
+  }
+  if (g_nData != nDelivered)
+    cout << "Error: " << nDelivered << " Data packets satisfied " << g_nData << " Interests" << endl;
+
+  cout << nInterests << " outstanding Interests: per Data " << seconds * 1e9 / nDelivered << " ns"
+       << endl;
+
+  node.shutdown();
+}
+
+/**
+ * Express nInterests Interests with lifetimes from 1 to 1.5 s which no Data satisfies, and
+ * measure how late their timeout callbacks are called.
+ */
+static void
+benchmarkTimeouts(size_t nInterests)
+{
+  vector<Name> names;
+  makeNames(nInterests, names);
+
+  ptr_lib::shared_ptr<LoopbackTransport> transport(new LoopbackTransport());
+  Node node(transport);
+  g_timeoutLatenesses.clear();
+  double start = getNowSeconds();
+  for (size_t i = 0; i < nInterests; ++i) {
+    Milliseconds lifetime = 1000 + rand() % 500;
+    node.expressInterest(Interest(names[i], lifetime), onData,
+                         TimeoutRecorder(getNowSeconds() + lifetime / 1000.0));
+  }
+  double expressSeconds = getNowSeconds() - start;
+  node.processEvents(5000);
+
+  if (g_timeoutLatenesses.size() != nInterests)
+    cout << "Error: " << g_timeoutLatenesses.size() << " of " << nInterests << " Interests timed out"
+         << endl;
+  double totalLateness = 0;
+  double maxLateness = 0;
+  for (size_t i = 0; i < g_timeoutLatenesses.size(); ++i) {
+    totalLateness += g_timeoutLatenesses[i];
+    maxLateness = max(maxLateness, g_timeoutLatenesses[i]);
+  }
+
+  cout << nInterests << " Interests timing out: per expressInterest "
+       << expressSeconds * 1e9 / nInterests << " ns, OnTimeout late by "
+       << totalLateness * 1000 / g_timeoutLatenesses.size() << " ms on average, "
+       << maxLateness * 1000 << " ms at most" << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    srand(1);
+    static const size_t N_INTERESTS[] = { 100, 1000, 10000, 100000 };
+    for (size_t i = 0; i < sizeof(N_INTERESTS) / sizeof(N_INTERESTS[0]); ++i)
+      benchmark(N_INTERESTS[i]);
+    for (size_t i = 0; i < sizeof(N_INTERESTS) / sizeof(N_INTERESTS[0]); ++i)
+      benchmarkTimeouts(N_INTERESTS[i]);
+
+    static const size_t N_PREFIXES[] = { 10, 100, 1000, 10000 };
+    for (size_t i = 0; i < sizeof(N_PREFIXES) / sizeof(N_PREFIXES[0]); ++i)
+      benchmarkDispatch(N_PREFIXES[i]);
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
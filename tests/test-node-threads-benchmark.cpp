@@ -0,0 +1,244 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2013 Regents of the University of California.
+ * See COPYING for copyright and distribution information.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <set>
+#include <stdexcept>
+#include <vector>
+#include <pthread.h>
+#include <sys/time.h>
+#include <ndn-cpp/node.hpp>
+#include <ndn-cpp/encoding/block-helpers.hpp>
+#include <ndn-cpp/security/signature-sha256-with-rsa.hpp>
+
+using namespace std;
+using namespace ndn;
+
+static double
+getNowSeconds()
+{
+  struct timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec + t.tv_usec / 1000000.0;
+}
+
+/**
+ * A Transport which counts the packets sent and receives nothing, so that the benchmark measures
+ * the Node alone.  If isCheckingNonces, it also counts the Interests sent with a nonce already sent.
+ */
+class CountingTransport : public Transport
+{
+public:
+  CountingTransport()
+    : nSent(0)
+    , isCheckingNonces(false)
+    , nRepeatedNonces(0)
+  {
+  }
+
+  virtual void
+  connect(boost::asio::io_service &ioService, const ReceiveCallback &receiveCallback)
+  {
+    Transport::connect(ioService, receiveCallback);
+    isConnected_ = true;
+  }
+
+  virtual void
+  close()
+  {
+    isConnected_ = false;
+  }
+
+  virtual void
+  send(const Block &wire)
+  {
+    ++nSent;
+    if (isCheckingNonces) {
+      Interest interest;
+      interest.wireDecode(wire);
+      if (!nonces_.insert(interest.getNonce()).second)
+        ++nRepeatedNonces;
+    }
+  }
+
+  size_t nSent;
+  bool isCheckingNonces;
+  size_t nRepeatedNonces;
+
+private:
+  std::set<uint32_t> nonces_;
+};
+
+static void
+onData(const ptr_lib::shared_ptr<const Interest> &interest, const ptr_lib::shared_ptr<Data> &data)
+{
+}
+
+enum Workload {
+  PUT,                 ///< put from the producers to a thread-safe Node
+  POST_PUT,            ///< io_service::post of put to a Node which is not thread-safe
+  EXPRESS_AND_REMOVE,  ///< expressInterest and removePendingInterest to a thread-safe Node
+  EXPRESS              ///< expressInterest to a thread-safe Node, each Interest with a new nonce
+};
+
+static const char* const WORKLOAD_NAMES[] = {
+  "put, thread-safe Node          ",
+  "put posted to the io_service   ",
+  "expressInterest + remove, safe ",
+  "expressInterest, checked nonces"
+};
+
+/**
+ * The Node shared by the threads of one run and the state of the run
+ */
+struct Run
+{
+  Workload workload;
+  ptr_lib::shared_ptr<boost::asio::io_service> ioService;
+  ptr_lib::shared_ptr<CountingTransport> transport;
+  Node *node;
+  size_t nCallsPerProducer;
+  Data data;
+
+  pthread_mutex_t mutex;
+  pthread_cond_t startCondition;
+  bool isStarted;
+  double producerSeconds;
+};
+
+static void*
+runIo(void *argument)
+{
+  Run &run = *static_cast<Run*>(argument);
+  run.node->processEvents(0, true);
+  return 0;
+}
+
+static void*
+runProducer(void *argument)
+{
+  Run &run = *static_cast<Run*>(argument);
+
+  vector<Interest> interests;
+  if (run.workload == EXPRESS_AND_REMOVE || run.workload == EXPRESS) {
+    ostringstream uri;
+    uri << "/producer-" << pthread_self() << "/file";
+    for (size_t i = 0; i < run.nCallsPerProducer; ++i)
+      interests.push_back(Interest(Name(uri.str()).appendSegment(i), 4000));
+  }
+
+  pthread_mutex_lock(&run.mutex);
+  while (!run.isStarted)
+    pthread_cond_wait(&run.startCondition, &run.mutex);
+  pthread_mutex_unlock(&run.mutex);
+
+  double start = getNowSeconds();
+  if (run.workload == PUT) {
+    for (size_t i = 0; i < run.nCallsPerProducer; ++i)
+      run.node->put(run.data);
+  }
+  else if (run.workload == POST_PUT) {
+    for (size_t i = 0; i < run.nCallsPerProducer; ++i)
+      run.ioService->post(func_lib::bind(&Node::put, run.node, run.data));
+  }
+  else if (run.workload == EXPRESS_AND_REMOVE) {
+    for (size_t i = 0; i < run.nCallsPerProducer; ++i)
+      run.node->removePendingInterest(run.node->expressInterest(interests[i], onData, OnTimeout()));
+  }
+  else {
+    // The producers draw the nonces of the Interests at once.
+    for (size_t i = 0; i < run.nCallsPerProducer; ++i)
+      run.node->expressInterest(interests[i], onData, OnTimeout());
+  }
+  double seconds = getNowSeconds() - start;
+
+  pthread_mutex_lock(&run.mutex);
+  run.producerSeconds = max(run.producerSeconds, seconds);
+  pthread_mutex_unlock(&run.mutex);
+  return 0;
+}
+
+/**
+ * Run nProducers threads which make the calls of the workload while the I/O thread runs
+ * processEvents, and measure the time until the I/O thread has carried out all of them.
+ */
+static void
+benchmark(Workload workload, int nProducers, const Data &data)
+{
+  Run run;
+  run.workload = workload;
+  run.ioService = ptr_lib::make_shared<boost::asio::io_service>();
+  run.transport = ptr_lib::make_shared<CountingTransport>();
+  run.transport->isCheckingNonces = (workload == EXPRESS);
+  Node node(run.transport, run.ioService);
+  if (workload != POST_PUT)
+    node.enableThreadSafety();
+  run.node = &node;
+  run.nCallsPerProducer = 200000 / nProducers;
+  run.data = data;
+  pthread_mutex_init(&run.mutex, 0);
+  pthread_cond_init(&run.startCondition, 0);
+  run.isStarted = false;
+  run.producerSeconds = 0;
+
+  pthread_t io;
+  pthread_create(&io, 0, runIo, &run);
+  vector<pthread_t> producers(nProducers);
+  for (int i = 0; i < nProducers; ++i)
+    pthread_create(&producers[i], 0, runProducer, &run);
+
+  pthread_mutex_lock(&run.mutex);
+  run.isStarted = true;
+  pthread_cond_broadcast(&run.startCondition);
+  pthread_mutex_unlock(&run.mutex);
+  double start = getNowSeconds();
+
+  for (int i = 0; i < nProducers; ++i)
+    pthread_join(producers[i], 0);
+  // The calls are carried out before this handler, which is posted after them.
+  run.ioService->post(func_lib::bind(&boost::asio::io_service::stop, run.ioService.get()));
+  pthread_join(io, 0);
+  double seconds = getNowSeconds() - start;
+
+  size_t nCalls = run.nCallsPerProducer * nProducers;
+  if (run.transport->nSent != nCalls)
+    cout << "Error: " << nCalls << " calls sent " << run.transport->nSent << " packets" << endl;
+  // With 32-bit random nonces, a few of the 200000 may repeat by chance.
+  if (run.transport->nRepeatedNonces > 20)
+    cout << "Error: " << run.transport->nRepeatedNonces << " Interests sent with a repeated nonce" << endl;
+
+  cout << WORKLOAD_NAMES[workload] << ", " << nProducers << " producers: calls/s " << nCalls / seconds
+       << ", per producer submitted/s " << run.nCallsPerProducer / run.producerSeconds << endl;
+
+  node.shutdown();
+  pthread_cond_destroy(&run.startCondition);
+  pthread_mutex_destroy(&run.mutex);
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    Data data(Name("/producer/file").appendSegment(0));
+    const uint8_t content[100] = { 0 };
+    data.setContent(content, sizeof(content));
+    uint8_t signatureBits[128] = { 0 };
+    SignatureSha256WithRsa signature;
+    signature.setValue(dataBlock(Tlv::SignatureValue, signatureBits, sizeof(signatureBits)));
+    data.setSignature(signature);
+    data.wireEncode();
+
+    static const int N_PRODUCERS[] = { 1, 2, 4, 8 };
+    for (int workload = PUT; workload <= EXPRESS; ++workload) {
+      for (size_t i = 0; i < sizeof(N_PRODUCERS) / sizeof(N_PRODUCERS[0]); ++i)
+        benchmark(static_cast<Workload>(workload), N_PRODUCERS[i], data);
+    }
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
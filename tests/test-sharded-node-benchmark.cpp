@@ -0,0 +1,191 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2013 Regents of the University of California.
+ * See COPYING for copyright and distribution information.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <pthread.h>
+#include <sys/time.h>
+#include <ndn-cpp/sharded-node.hpp>
+#include <ndn-cpp/encoding/block-helpers.hpp>
+#include <ndn-cpp/security/signature-sha256-with-rsa.hpp>
+
+using namespace std;
+using namespace ndn;
+// In the std library, the placeholders are in a different namespace than boost.
+using namespace ndn::func_lib::placeholders;
+
+static double
+getNowSeconds()
+{
+  struct timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec + t.tv_usec / 1000000.0;
+}
+
+/**
+ * A Transport which stands in for the connection to a forwarder holding all the Data: it answers
+ * each Interest sent with the Data of its segment, received in the thread of the shard like a
+ * packet read from a socket.
+ */
+class ForwarderTransport : public Transport
+{
+public:
+  ForwarderTransport(const vector<Block> &dataWires)
+    : dataWires_(dataWires)
+  {
+  }
+
+  virtual void
+  connect(boost::asio::io_service &ioService, const ReceiveCallback &receiveCallback)
+  {
+    Transport::connect(ioService, receiveCallback);
+    isConnected_ = true;
+  }
+
+  virtual void
+  close()
+  {
+    isConnected_ = false;
+  }
+
+  virtual void
+  send(const Block &wire)
+  {
+    Interest interest;
+    interest.wireDecode(wire);
+    uint64_t segment = interest.getName().get(-1).toSegment();
+    ioService_->post(func_lib::bind(&ForwarderTransport::receive, this, dataWires_[segment]));
+  }
+
+private:
+  const vector<Block> &dataWires_;
+};
+
+/**
+ * The ShardedNode of one run and the state of the run, shared by the threads of the shards
+ */
+struct Run
+{
+  ShardedNode *node;
+  const vector<Interest> *interests;
+  Atomic<uint64_t> nextInterest;
+  Atomic<uint64_t> nSatisfied;
+};
+
+static void
+expressNextInterest(Run &run);
+
+/**
+ * Like a consumer keeping a window of Interests in flight, express the next Interest for each Data.
+ */
+static void
+onData(Run *run, const ptr_lib::shared_ptr<const Interest> &interest, const ptr_lib::shared_ptr<Data> &data)
+{
+  if (run->nSatisfied.fetchAdd(1) + 1 == run->interests->size())
+    run->node->shutdown();
+  else
+    expressNextInterest(*run);
+}
+
+static void
+expressNextInterest(Run &run)
+{
+  uint64_t i = run.nextInterest.fetchAdd(1);
+  if (i < run.interests->size())
+    run.node->expressInterest((*run.interests)[i], func_lib::bind(onData, &run, _1, _2), OnTimeout());
+}
+
+struct ShardThread
+{
+  ShardedNode *node;
+  size_t shard;
+};
+
+static void*
+runShard(void *argument)
+{
+  ShardThread &thread = *static_cast<ShardThread*>(argument);
+  thread.node->processEvents(thread.shard, 0, true);
+  return 0;
+}
+
+/**
+ * Fetch all the Data with nShards threads, each running one shard, and a window of nInFlight
+ * Interests, and measure the time until the last one is satisfied.
+ */
+static void
+benchmark(size_t nShards, size_t nInFlight, const vector<Interest> &interests, const vector<Block> &dataWires)
+{
+  vector<ptr_lib::shared_ptr<Transport> > transports;
+  for (size_t i = 0; i < nShards; ++i)
+    transports.push_back(ptr_lib::make_shared<ForwarderTransport>(dataWires));
+  ShardedNode node(transports);
+
+  Run run;
+  run.node = &node;
+  run.interests = &interests;
+
+  vector<ShardThread> shardThreads(nShards);
+  vector<pthread_t> threads(nShards);
+  double start = getNowSeconds();
+  for (size_t i = 0; i < nShards; ++i) {
+    shardThreads[i].node = &node;
+    shardThreads[i].shard = i;
+    pthread_create(&threads[i], 0, runShard, &shardThreads[i]);
+  }
+  for (size_t i = 0; i < nInFlight; ++i)
+    expressNextInterest(run);
+
+  for (size_t i = 0; i < nShards; ++i)
+    pthread_join(threads[i], 0);
+  double seconds = getNowSeconds() - start;
+
+  cout << nShards << " shards: Interests satisfied/s " << interests.size() / seconds << endl;
+  for (size_t i = 0; i < nShards; ++i) {
+    ShardedNode::ShardStatistics statistics = node.getShardStatistics(i);
+    cout << "  shard " << i << ": expressed " << statistics.nExpressedInterests
+         << ", satisfied " << statistics.nSatisfiedInterests
+         << ", timed out " << statistics.nTimedOutInterests << endl;
+  }
+  if (run.nSatisfied.load() != interests.size())
+    cout << "Error: " << run.nSatisfied.load() << " Interests satisfied of " << interests.size() << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    const size_t nInterests = 100000;
+    uint8_t signatureBits[128] = { 0 };
+    Block signatureValue = dataBlock(Tlv::SignatureValue, signatureBits, sizeof(signatureBits));
+    const uint8_t content[100] = { 0 };
+
+    vector<Interest> interests;
+    vector<Block> dataWires;
+    for (size_t i = 0; i < nInterests; ++i) {
+      ostringstream uri;
+      uri << "/site-" << i % 100 << "/app/file-" << i % 1000;
+      Name name = Name(uri.str()).appendSegment(i);
+      interests.push_back(Interest(name, 10000));
+
+      Data data(name);
+      data.setContent(content, sizeof(content));
+      SignatureSha256WithRsa signature;
+      signature.setValue(signatureValue);
+      data.setSignature(signature);
+      dataWires.push_back(data.wireEncode());
+    }
+
+    static const size_t N_SHARDS[] = { 1, 2, 4, 8 };
+    for (size_t i = 0; i < sizeof(N_SHARDS) / sizeof(N_SHARDS[0]); ++i)
+      benchmark(N_SHARDS[i], 1000, interests, dataWires);
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
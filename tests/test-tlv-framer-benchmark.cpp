@@ -0,0 +1,203 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2013 Regents of the University of California.
+ * See COPYING for copyright and distribution information.
+ */
+
+#include <iostream>
+#include <sys/time.h>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <ndn-cpp/encoding/block.hpp>
+#include <ndn-cpp/encoding/tlv-framer.hpp>
+
+using namespace std;
+using namespace ndn;
+
+/**
+ * Size of the fixed receive buffer in the transport before TlvFramer, and the largest packet it could frame.
+ */
+static const size_t OLD_MAX_LENGTH = 9000;
+
+static double
+getNowSeconds()
+{
+  struct timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec + t.tv_usec / 1000000.0;
+}
+
+/**
+ * A byte stream of concatenated TLV elements, and the sizes of the reads that deliver it.
+ */
+struct Stream
+{
+  vector<uint8_t> bytes;
+  size_t nElements;
+  vector<size_t> reads;
+};
+
+/**
+ * Create a stream of nElements Content elements with random value sizes and split it at random points.
+ * @param nElements The number of elements.
+ * @param maxValueSize The maximum size of element value.
+ * @param maxReadSize The maximum size of one read.
+ * @param stream The stream to fill.
+ */
+static void
+makeStream(size_t nElements, size_t maxValueSize, size_t maxReadSize, Stream &stream)
+{
+  vector<uint8_t> value(maxValueSize, 0xAB);
+
+  stream.bytes.clear();
+  for (size_t i = 0; i < nElements; ++i) {
+    Block element = dataBlock(Tlv::Content, &value[0], rand() % (maxValueSize + 1));
+    stream.bytes.insert(stream.bytes.end(), element.wire(), element.wire() + element.size());
+  }
+  stream.nElements = nElements;
+
+  stream.reads.clear();
+  size_t total = 0;
+  while (total < stream.bytes.size()) {
+    size_t size = std::min(1 + rand() % maxReadSize, stream.bytes.size() - total);
+    stream.reads.push_back(size);
+    total += size;
+  }
+}
+
+/**
+ * Feed the stream through TlvFramer nIterations times, imitating socket reads into its receive buffer.
+ * @param nIterations The number of iterations.
+ * @param stream The stream.
+ * @return The number of seconds for all iterations.
+ */
+static double
+benchmarkFramerSeconds(int nIterations, const Stream &stream)
+{
+  size_t nElements = 0;
+  double start = getNowSeconds();
+  for (int i = 0; i < nIterations; ++i) {
+    TlvFramer framer(OLD_MAX_LENGTH);
+    Block element;
+    const uint8_t *input = &stream.bytes[0];
+
+    for (size_t r = 0; r < stream.reads.size(); ++r) {
+      size_t size = stream.reads[r];
+      while (size > 0) {
+        // A read gets at most the free space of the receive buffer.
+        size_t readSize = std::min(size, framer.receiveBufferSize());
+        memcpy(framer.receiveBuffer(), input, readSize);
+        input += readSize;
+        size -= readSize;
+
+        framer.received(readSize);
+        while (framer.next(element))
+          ++nElements;
+      }
+    }
+  }
+  double finish = getNowSeconds();
+
+  if (nElements != stream.nElements * nIterations)
+    cout << "Error: framed " << nElements << " elements instead of " << stream.nElements * nIterations << endl;
+  return finish - start;
+}
+
+/**
+ * Feed the stream nIterations times through the framing that the transport used before TlvFramer: copy each
+ * read into a fixed buffer, construct Blocks (which copy) and treat the Tlv::Error thrown for the incomplete
+ * trailing element as the end of the read.  Elements must not be larger than OLD_MAX_LENGTH.
+ * @param nIterations The number of iterations.
+ * @param stream The stream.
+ * @param nExceptions Set to the number of exceptions thrown in all iterations.
+ * @return The number of seconds for all iterations.
+ */
+static double
+benchmarkExceptionFramingSeconds(int nIterations, const Stream &stream, size_t &nExceptions)
+{
+  size_t nElements = 0;
+  nExceptions = 0;
+  uint8_t partialData[OLD_MAX_LENGTH * 2];
+
+  double start = getNowSeconds();
+  for (int i = 0; i < nIterations; ++i) {
+    size_t partialDataSize = 0;
+    const uint8_t *input = &stream.bytes[0];
+
+    for (size_t r = 0; r < stream.reads.size(); ++r) {
+      size_t size = stream.reads[r];
+      while (size > 0) {
+        size_t readSize = std::min(size, OLD_MAX_LENGTH);
+        memcpy(partialData + partialDataSize, input, readSize);
+        input += readSize;
+        size -= readSize;
+        partialDataSize += readSize;
+
+        size_t offset = 0;
+        try {
+          while (offset < partialDataSize) {
+            Block element(partialData + offset, partialDataSize - offset);
+            offset += element.size();
+            ++nElements;
+          }
+        }
+        catch (Tlv::Error &) {
+          ++nExceptions;
+        }
+
+        partialDataSize -= offset;
+        memmove(partialData, partialData + offset, partialDataSize);
+      }
+    }
+  }
+  double finish = getNowSeconds();
+
+  if (nElements != stream.nElements * nIterations)
+    cout << "Error: framed " << nElements << " elements instead of " << stream.nElements * nIterations << endl;
+  return finish - start;
+}
+
+/**
+ * Call benchmarkFramerSeconds and (if the stream has only small elements) benchmarkExceptionFramingSeconds.
+ * Print the results to cout.
+ * @param description Description of the stream.
+ * @param maxValueSize See makeStream.
+ * @param maxReadSize See makeStream.
+ */
+static void
+benchmarkFraming(const string &description, size_t maxValueSize, size_t maxReadSize)
+{
+  Stream stream;
+  makeStream(2000, maxValueSize, maxReadSize, stream);
+  double megabytes = stream.bytes.size() / 1000000.0;
+  int nIterations = 200;
+
+  if (maxValueSize + 8 < OLD_MAX_LENGTH) {
+    size_t nExceptions;
+    double duration = benchmarkExceptionFramingSeconds(nIterations, stream, nExceptions);
+    cout << "Frame " << description << ": Block + exceptions, Duration sec, MB/s, packets/s: " << duration << ", "
+         << (nIterations * megabytes / duration) << ", " << (nIterations * stream.nElements / duration)
+         << ", exceptions per read: " << (double)nExceptions / (nIterations * stream.reads.size()) << endl;
+  }
+
+  double duration = benchmarkFramerSeconds(nIterations, stream);
+  cout << "Frame " << description << ": TlvFramer,          Duration sec, MB/s, packets/s: " << duration << ", "
+       << (nIterations * megabytes / duration) << ", " << (nIterations * stream.nElements / duration) << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    srand(1);
+    benchmarkFraming("small packets, small reads", 200, 512);
+    benchmarkFraming("small packets, large reads", 200, 8800);
+    benchmarkFraming("large packets, large reads", 8000, 8800);
+    benchmarkFraming("huge packets,  large reads", 60000, 8800);
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
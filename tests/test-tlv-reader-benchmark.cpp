@@ -0,0 +1,243 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2013 Regents of the University of California.
+ * See COPYING for copyright and distribution information.
+ */
+
+#include <iostream>
+#include <sys/time.h>
+#include <sstream>
+#include <stdexcept>
+#include <cstdlib>
+#include <vector>
+#include <ndn-cpp/data.hpp>
+#include <ndn-cpp/interest.hpp>
+#include <ndn-cpp/security/signature-sha256-with-rsa.hpp>
+#include <ndn-cpp/encoding/tlv-reader.hpp>
+
+using namespace std;
+using namespace ndn;
+
+static double
+getNowSeconds()
+{
+  struct timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec + t.tv_usec / 1000000.0;
+}
+
+/**
+ * A buffer of concatenated Interest and Data packets, as they arrive from the transport.
+ */
+struct Stream
+{
+  ConstBufferPtr bytes;
+  size_t nPackets;
+};
+
+/**
+ * Create a stream of nPackets packets: every other packet is a Data with random content size and the rest
+ * are Interests, all with names of 3 to 8 components.
+ * @param nPackets The number of packets.
+ * @param maxContentSize The maximum size of Data content.
+ * @param stream The stream to fill.
+ */
+static void
+makeStream(size_t nPackets, size_t maxContentSize, Stream &stream)
+{
+  vector<uint8_t> content(maxContentSize + 1, 0xAB);
+  string signatureValue(256, 'x');
+  SignatureSha256WithRsa signature;
+  signature.setKeyLocator(KeyLocator(Name("/ndn/ucla.edu/KEY/ksk-1234")));
+  signature.setValue(dataBlock(Tlv::SignatureValue, signatureValue.c_str(), signatureValue.size()));
+
+  BufferPtr bytes = ptr_lib::make_shared<Buffer>();
+  for (size_t i = 0; i < nPackets; ++i) {
+    ostringstream uri;
+    uri << "/ndn/ucla.edu/apps";
+    for (int j = rand() % 6; j > 0; --j)
+      uri << "/component" << rand();
+
+    Block packet;
+    if (i % 2 == 0) {
+      Data data(Name(uri.str()));
+      MetaInfo metaInfo;
+      metaInfo.setFreshnessPeriod(rand() % 10000);
+      data.setMetaInfo(metaInfo);
+      data.setContent(&content[0], rand() % (maxContentSize + 1));
+      data.setSignature(signature);
+      packet = data.wireEncode();
+    }
+    else {
+      Interest interest(Name(uri.str()));
+      interest.setNonce(rand());
+      interest.setScope(1);
+      interest.setInterestLifetime(4000);
+      packet = interest.wireEncode();
+    }
+    bytes->insert(bytes->end(), packet.begin(), packet.end());
+  }
+
+  stream.bytes = bytes;
+  stream.nPackets = nPackets;
+}
+
+/**
+ * Walk the stream nIterations times with Block: slice each packet, parse it and its Name, and read the
+ * components and FreshnessPeriod.
+ * @param nIterations The number of iterations.
+ * @param stream The stream.
+ * @return The number of seconds for all iterations.
+ */
+static double
+benchmarkBlockSeconds(int nIterations, const Stream &stream)
+{
+  size_t nPackets = 0;
+  size_t nComponentBytes = 0;
+  double start = getNowSeconds();
+  for (int i = 0; i < nIterations; ++i) {
+    Buffer::const_iterator begin = stream.bytes->begin();
+    Buffer::const_iterator end = stream.bytes->end();
+    while (begin != end) {
+      Buffer::const_iterator elementBegin = begin;
+      uint32_t type = Tlv::readType(begin, end);
+      uint64_t length = Tlv::readVarNumber(begin, end);
+      Buffer::const_iterator elementEnd = begin + length;
+
+      Block packet(stream.bytes, type, elementBegin, elementEnd, begin, elementEnd);
+      packet.parse();
+
+      Block name = packet.get(Tlv::Name);
+      name.parse();
+      for (Block::element_const_iterator j = name.elements_begin(); j != name.elements_end(); ++j)
+        nComponentBytes += j->value_size();
+
+      if (type == Tlv::Data) {
+        Block metaInfo = packet.get(Tlv::MetaInfo);
+        metaInfo.parse();
+        Block::element_const_iterator freshness = metaInfo.find(Tlv::FreshnessPeriod);
+        if (freshness != metaInfo.elements_end())
+          nComponentBytes += readNonNegativeInteger(*freshness) & 1;
+      }
+
+      begin = elementEnd;
+      ++nPackets;
+    }
+  }
+  double finish = getNowSeconds();
+
+  if (nPackets != stream.nPackets * nIterations || nComponentBytes == 0)
+    cout << "Error: walked " << nPackets << " packets instead of " << stream.nPackets * nIterations << endl;
+  return finish - start;
+}
+
+/**
+ * Walk the stream nIterations times with TlvReader, reading the same fields as benchmarkBlockSeconds.
+ * @param nIterations The number of iterations.
+ * @param stream The stream.
+ * @return The number of seconds for all iterations.
+ */
+static double
+benchmarkTlvReaderSeconds(int nIterations, const Stream &stream)
+{
+  size_t nPackets = 0;
+  size_t nComponentBytes = 0;
+  double start = getNowSeconds();
+  for (int i = 0; i < nIterations; ++i) {
+    TlvReader packets(stream.bytes->buf(), stream.bytes->buf() + stream.bytes->size());
+    while (packets.next()) {
+      TlvReader packet = packets.children();
+      while (packet.next()) {
+        if (packet.type() == Tlv::Name) {
+          TlvReader name = packet.children();
+          while (name.next())
+            nComponentBytes += name.value_size();
+        }
+        else if (packet.type() == Tlv::MetaInfo) {
+          TlvReader metaInfo = packet.children();
+          if (metaInfo.find(Tlv::FreshnessPeriod))
+            nComponentBytes += metaInfo.readNonNegativeInteger() & 1;
+        }
+      }
+      ++nPackets;
+    }
+  }
+  double finish = getNowSeconds();
+
+  if (nPackets != stream.nPackets * nIterations || nComponentBytes == 0)
+    cout << "Error: walked " << nPackets << " packets instead of " << stream.nPackets * nIterations << endl;
+  return finish - start;
+}
+
+/**
+ * Decode the Name of every packet in the stream nIterations times with Name::wireDecode.
+ * @param nIterations The number of iterations.
+ * @param stream The stream.
+ * @return The number of seconds for all iterations.
+ */
+static double
+benchmarkNameDecodeSeconds(int nIterations, const Stream &stream)
+{
+  // Slice the names once, so that only Name::wireDecode is measured.
+  vector<Block> names;
+  TlvReader packets(stream.bytes->buf(), stream.bytes->buf() + stream.bytes->size());
+  while (packets.next()) {
+    TlvReader packet = packets.children();
+    if (packet.find(Tlv::Name))
+      names.push_back(Block(packet.wire(), packet.size()));
+  }
+
+  size_t nComponents = 0;
+  Name name;
+  double start = getNowSeconds();
+  for (int i = 0; i < nIterations; ++i) {
+    for (size_t j = 0; j < names.size(); ++j) {
+      name.wireDecode(names[j]);
+      nComponents += name.size();
+    }
+  }
+  double finish = getNowSeconds();
+
+  if (nComponents == 0)
+    cout << "Error: no name components decoded" << endl;
+  return finish - start;
+}
+
+/**
+ * Call the benchmarks for a stream and print the results to cout.
+ * @param description Description of the stream.
+ * @param maxContentSize See makeStream.
+ */
+static void
+benchmarkStream(const string &description, size_t maxContentSize)
+{
+  Stream stream;
+  makeStream(2000, maxContentSize, stream);
+  double megabytes = stream.bytes->size() / 1000000.0;
+  int nIterations = 500;
+
+  double duration = benchmarkBlockSeconds(nIterations, stream);
+  cout << "Walk " << description << ": Block,     Duration sec, MB/s, packets/s: " << duration << ", "
+       << (nIterations * megabytes / duration) << ", " << (nIterations * stream.nPackets / duration) << endl;
+
+  duration = benchmarkTlvReaderSeconds(nIterations, stream);
+  cout << "Walk " << description << ": TlvReader, Duration sec, MB/s, packets/s: " << duration << ", "
+       << (nIterations * megabytes / duration) << ", " << (nIterations * stream.nPackets / duration) << endl;
+
+  duration = benchmarkNameDecodeSeconds(nIterations, stream);
+  cout << "Name::wireDecode " << description << ": Duration sec, names/s: " << duration << ", "
+       << (nIterations * stream.nPackets / duration) << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+  try {
+    srand(1);
+    benchmarkStream("small packets", 200);
+    benchmarkStream("large packets", 8000);
+  } catch (std::exception& e) {
+    cout << "exception: " << e.what() << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2013 Regents of the University of California.
+ * See COPYING for copyright and distribution information.
+ */
+
+#ifndef NDN_TESTS_LOOPBACK_TRANSPORT_HPP
+#define NDN_TESTS_LOOPBACK_TRANSPORT_HPP
+
+#include <ndn-cpp/data.hpp>
+#include <ndn-cpp/interest.hpp>
+#include <ndn-cpp/forwarding-entry.hpp>
+#include <ndn-cpp/transport/transport.hpp>
+#include <ndn-cpp/encoding/block-helpers.hpp>
+#include <ndn-cpp/security/signature-sha256-with-rsa.hpp>
+
+#include <vector>
+
+namespace ndn {
+
+/**
+ * A Transport which stays in the process: it keeps the packets sent, and receives the packets
+ * given to deliver(), so that a test plays the role of the hub.
+ */
+class LoopbackTransport : public Transport
+{
+public:
+  virtual void
+  connect(boost::asio::io_service &ioService, const ReceiveCallback &receiveCallback)
+  {
+    Transport::connect(ioService, receiveCallback);
+    isConnected_ = true;
+  }
+
+  virtual void
+  close()
+  {
+    isConnected_ = false;
+  }
+
+  virtual void
+  send(const Block &wire)
+  {
+    sentPackets.push_back(wire);
+  }
+
+  void
+  deliver(const Block &wire)
+  {
+    receive(wire);
+  }
+
+  /**
+   * Answer the Interests sent as an NDN hub does, with its key for the Interest fetching its ID
+   * and a ForwardingEntry for a prefix registration, until no more are sent.  sentPackets is
+   * cleared.
+   */
+  void
+  answerHubInterests()
+  {
+    static const uint8_t hubKey[128] = { 0 };
+    while (!sentPackets.empty())
+      {
+        std::vector<Block> packets;
+        packets.swap(sentPackets);
+        for (size_t i = 0; i < packets.size(); ++i)
+          {
+            if (packets[i].type() != Tlv::Interest)
+              continue;
+
+            Interest interest;
+            interest.wireDecode(packets[i]);
+            if (interest.getName().size() > 2 && interest.getName().get(2) == Name::Component("selfreg"))
+              deliver(makeDataWire(interest.getName(),
+                                   ForwardingEntry("selfreg", Name(), 1).wireEncode()));
+            else
+              deliver(makeDataWire(interest.getName(), dataBlock(Tlv::Content, hubKey, sizeof(hubKey))));
+          }
+      }
+  }
+
+  /**
+   * Encode a Data packet with the name and the content, empty by default, and a signature of zeros.
+   */
+  static Block
+  makeDataWire(const Name &name, const Block &content = Block())
+  {
+    static const uint8_t zeros[128] = { 0 };
+    Data data(name);
+    // the Content element is required, even when it is empty
+    if (content.hasWire())
+      data.setContent(content);
+    else
+      data.setContent(zeros, 0);
+    SignatureSha256WithRsa signature;
+    signature.setValue(dataBlock(Tlv::SignatureValue, zeros, sizeof(zeros)));
+    data.setSignature(signature);
+    return data.wireEncode();
+  }
+
+  std::vector<Block> sentPackets;
+};
+
+} // namespace ndn
+
+#endif // NDN_TESTS_LOOPBACK_TRANSPORT_HPP
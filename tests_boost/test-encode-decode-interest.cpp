@@ -6,11 +6,30 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <pthread.h>
 #include <ndn-cpp/interest.hpp>
+#include <ndn-cpp/util/instrumentation.hpp>
 
 using namespace std;
 using namespace ndn;
 
+/**
+ * The Interest whose nonce the threads get at once, and the nonce which each of them got
+ */
+struct NonceThread
+{
+  const ndn::Interest *interest;
+  uint32_t nonce;
+};
+
+static void*
+getNonce(void *argument)
+{
+  NonceThread &thread = *static_cast<NonceThread*>(argument);
+  thread.nonce = thread.interest->getNonce();
+  return 0;
+}
+
 BOOST_AUTO_TEST_SUITE(TestInterest)
 
 const uint8_t Interest1[] = {
@@ -78,4 +97,80 @@ BOOST_AUTO_TEST_CASE (Encode)
                                   wire.begin(), wire.end());
 }
 
+BOOST_AUTO_TEST_CASE (DecodeWithoutNonce)
+{
+  const uint8_t interestWithoutNonce[] = {
+    0x1,  0x8, // NDN Interest
+        0x3,  0x3, // Name
+            0x4,  0x1, // NameComponent
+                0x61,
+        0x7,  0x1, // Scope
+            0x1
+  };
+
+  ndn::Interest i;
+  BOOST_REQUIRE_NO_THROW(i.wireDecode(Block(interestWithoutNonce, sizeof(interestWithoutNonce))));
+  BOOST_CHECK_EQUAL(i.getName().toUri(), "/a");
+  BOOST_CHECK_EQUAL(i.getScope(), 1);
+
+  // the nonce is generated when it is used, and then encoded
+  uint32_t nonce = i.getNonce();
+  BOOST_CHECK_NE(nonce, 0);
+  ndn::Interest decoded;
+  decoded.wireDecode(ndn::Interest(i).wireEncode());
+  BOOST_CHECK_EQUAL(decoded.getNonce(), nonce);
+}
+
+BOOST_AUTO_TEST_CASE (NonceFromSeveralThreads)
+{
+  // the threads which assign the nonce at once all get the one assigned first
+  for (int run = 0; run < 20; ++run)
+    {
+      ndn::Interest interest(Name("/a"));
+      vector<NonceThread> threads(8);
+      vector<pthread_t> ids(threads.size());
+      for (size_t i = 0; i < threads.size(); ++i)
+        {
+          threads[i].interest = &interest;
+          pthread_create(&ids[i], 0, getNonce, &threads[i]);
+        }
+      for (size_t i = 0; i < threads.size(); ++i)
+        pthread_join(ids[i], 0);
+
+      uint32_t nonce = interest.getNonce();
+      BOOST_CHECK_NE(nonce, 0);
+      for (size_t i = 0; i < threads.size(); ++i)
+        BOOST_CHECK_EQUAL(threads[i].nonce, nonce);
+    }
+
+  // a copy has the nonce as it is when the copy is made
+  ndn::Interest interest(Name("/a"));
+  ndn::Interest before(interest);
+  uint32_t nonce = interest.getNonce();
+  ndn::Interest after(interest);
+  BOOST_CHECK_EQUAL(after.getNonce(), nonce);
+  BOOST_CHECK_NE(before.getNonce(), nonce);
+  before = interest;
+  BOOST_CHECK_EQUAL(before.getNonce(), nonce);
+}
+
+BOOST_AUTO_TEST_CASE (DecodeAllocations)
+{
+  if (!Instrumentation::isEnabled()) {
+    BOOST_TEST_MESSAGE("DecodeAllocations skipped: the library is not configured with --enable-instrumentation");
+    return;
+  }
+
+  Block interestBlock(Interest1, sizeof(Interest1));
+  ndn::Interest i;
+
+  Instrumentation::Snapshot snapshot;
+  i.wireDecode(interestBlock);
+
+  // the name and the exclude (which is decoded only when used) stay in the packet buffer
+  BOOST_CHECK_EQUAL(snapshot.get(Instrumentation::BUFFER_ALLOCATIONS), 0);
+  BOOST_CHECK_EQUAL(snapshot.get(Instrumentation::BUFFER_COPIES), 0);
+  BOOST_CHECK_LE(snapshot.get(Instrumentation::BLOCK_COPIES), 3);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
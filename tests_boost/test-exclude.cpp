@@ -0,0 +1,258 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2013 Regents of the University of California.
+ * See COPYING for copyright and distribution information.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <sstream>
+
+#include <ndn-cpp/interest.hpp>
+
+using namespace std;
+using namespace ndn;
+
+static const uint8_t Interest1[] = {
+  0x1,  0x41, // NDN Interest
+      0x3,  0x14, // Name
+          0x4,  0x5, // NameComponent
+              0x6c,  0x6f,  0x63,  0x61,  0x6c,
+          0x4,  0x3, // NameComponent
+              0x6e,  0x64,  0x6e,
+          0x4,  0x6, // NameComponent
+              0x70,  0x72,  0x65,  0x66,  0x69,  0x78,
+      0x5,  0x1f, // Selectors
+          0x09,  0x1,  0x1,  // MinSuffix
+          0x0a,  0x1,  0x1,  // MaxSuffix
+          0x0c,  0x14, // Exclude
+              0x4,  0x4, // NameComponent
+                  0x61,  0x6c,  0x65,  0x78,
+              0x4,  0x4, // NameComponent
+                  0x78,  0x78,  0x78,  0x78,
+              0xf,  0x0, // Any
+              0x4,  0x4, // NameComponent
+                  0x79,  0x79,  0x79,  0x79,
+          0x0d,  0x1, // ChildSelector
+              0x1,
+      0x6,  0x1, // Nonce
+          0x1,
+      0x7,  0x1, // Scope
+          0x1,
+      0x8,       // InterestLifetime
+          0x2,  0x3,  0xe8
+};
+
+BOOST_AUTO_TEST_SUITE(TestExclude)
+
+BOOST_AUTO_TEST_CASE (ExcludeRangeMerges)
+{
+  Exclude e;
+  e.excludeRange(Name::Component("b"), Name::Component("d"));
+  BOOST_CHECK_EQUAL(e.toUri(), "b,*,d");
+
+  // overlapping ranges join
+  e.excludeRange(Name::Component("c"), Name::Component("f"));
+  BOOST_CHECK_EQUAL(e.toUri(), "b,*,f");
+
+  // a range starting after the end of another one does not join it
+  e.excludeRange(Name::Component("g"), Name::Component("h"));
+  BOOST_CHECK_EQUAL(e.toUri(), "b,*,f,g,*,h");
+
+  // a range ending at the start of another one joins it, and a range covering others replaces them
+  e.excludeRange(Name::Component("a"), Name::Component("b"));
+  BOOST_CHECK_EQUAL(e.toUri(), "a,*,f,g,*,h");
+  e.excludeRange(Name::Component("a"), Name::Component("z"));
+  BOOST_CHECK_EQUAL(e.toUri(), "a,*,z");
+  BOOST_CHECK_EQUAL(e.size(), 2);
+
+  // components inside a range are already excluded
+  e.excludeOne(Name::Component("m"));
+  BOOST_CHECK_EQUAL(e.toUri(), "a,*,z");
+
+  // canonical order: shorter components come first
+  BOOST_CHECK(e.isExcluded(Name::Component("a")));
+  BOOST_CHECK(e.isExcluded(Name::Component("q")));
+  BOOST_CHECK(e.isExcluded(Name::Component("z")));
+  BOOST_CHECK(!e.isExcluded(Name::Component("aa")));
+  BOOST_CHECK(!e.isExcluded(Name::Component("%00")));
+
+  BOOST_CHECK_THROW(e.excludeRange(Name::Component("d"), Name::Component("b")), Exclude::Error);
+  BOOST_CHECK_THROW(e.excludeRange(Name::Component("d"), Name::Component("d")), Exclude::Error);
+}
+
+const uint8_t ExcludeBeforeC[] = {
+  0x0c,  0x05, // Exclude
+      0xf,  0x0, // Any
+      0x4,  0x1, // NameComponent
+          0x63
+};
+
+BOOST_AUTO_TEST_CASE (LeadingAny)
+{
+  Exclude e;
+  e.excludeBefore(Name::Component("c"));
+  BOOST_CHECK_EQUAL(e.toUri(), "*,c");
+  const Block &wire = e.wireEncode();
+  BOOST_CHECK_EQUAL_COLLECTIONS(ExcludeBeforeC, ExcludeBeforeC + sizeof(ExcludeBeforeC),
+                                wire.begin(), wire.end());
+
+  Exclude decoded;
+  decoded.wireDecode(Block(ExcludeBeforeC, sizeof(ExcludeBeforeC)));
+  BOOST_CHECK_EQUAL(decoded.toUri(), "*,c");
+
+  Exclude *excludes[] = { &e, &decoded };
+  for (size_t i = 0; i < 2; ++i) {
+    BOOST_CHECK(excludes[i]->isExcluded(0, 0));
+    BOOST_CHECK(excludes[i]->isExcluded(Name::Component("b")));
+    BOOST_CHECK(excludes[i]->isExcluded(Name::Component("c")));
+    BOOST_CHECK(!excludes[i]->isExcluded(Name::Component("d")));
+    BOOST_CHECK(!excludes[i]->isExcluded(Name::Component("bb")));
+  }
+
+  // the leading ANY stays when a range is added before it ends, and joins a range after
+  e.excludeRange(Name::Component("b"), Name::Component("e"));
+  BOOST_CHECK_EQUAL(e.toUri(), "*,e");
+  e.excludeAfter(Name::Component("x"));
+  BOOST_CHECK_EQUAL(e.toUri(), "*,e,x,*");
+  e.excludeBefore(Name::Component("y"));
+  BOOST_CHECK_EQUAL(e.toUri(), "*");
+  BOOST_CHECK(e.isExcluded(Name::Component("anything")));
+}
+
+const uint8_t ExcludeUnordered[] = {
+  0x0c,  0x0f, // Exclude
+      0x4,  0x2, // NameComponent
+          0x78,  0x78,
+      0x4,  0x1, // NameComponent
+          0x63,
+      0xf,  0x0, // Any
+      0x4,  0x1, // NameComponent
+          0x61,
+      0x4,  0x1, // NameComponent
+          0x61
+};
+
+BOOST_AUTO_TEST_CASE (DecodeNonCanonical)
+{
+  Exclude e;
+  e.wireDecode(Block(ExcludeUnordered, sizeof(ExcludeUnordered)));
+
+  // the terms are sorted and the equal ones merged, as by appendExclude
+  BOOST_CHECK_EQUAL(e.size(), 3);
+  BOOST_CHECK_EQUAL(e.toUri(), "a,c,*,xx");
+  BOOST_CHECK(e.isExcluded(Name::Component("a")));
+  BOOST_CHECK(!e.isExcluded(Name::Component("b")));
+  BOOST_CHECK(e.isExcluded(Name::Component("d")));
+  BOOST_CHECK(e.isExcluded(Name::Component("xx")));
+  BOOST_CHECK(!e.isExcluded(Name::Component("xxx")));
+
+  Exclude reference;
+  reference.excludeOne(Name::Component("a")).excludeRange(Name::Component("c"), Name::Component("xx"));
+  BOOST_CHECK_EQUAL(reference.toUri(), e.toUri());
+
+  // encoding it again gives the same filter
+  Exclude decodedAgain;
+  decodedAgain.wireDecode(e.wireEncode());
+  BOOST_CHECK_EQUAL(decodedAgain.toUri(), "a,c,*,xx");
+}
+
+const uint8_t ExcludeLongComponents[] = {
+  0x0c,  0x35, // Exclude
+      0x4,  0x1, // NameComponent
+          0x62,
+      0xf,  0x0, // Any
+      0x4,  0x12, // NameComponent
+          0x6c,  0x6f,  0x6e,  0x67,  0x2d,  0x63,  0x6f,  0x6d,  0x70,
+          0x6f,  0x6e,  0x65,  0x6e,  0x74,  0x2d,  0x30,  0x30,  0x31,
+      0x4,  0x12, // NameComponent
+          0x6c,  0x6f,  0x6e,  0x67,  0x2d,  0x63,  0x6f,  0x6d,  0x70,
+          0x6f,  0x6e,  0x65,  0x6e,  0x74,  0x2d,  0x30,  0x30,  0x33,
+      0xf,  0x0, // Any
+      0x4,  0x2, // NameComponent
+          0xff,  0xff,
+      0xf,  0x0 // Any
+};
+
+BOOST_AUTO_TEST_CASE (LazyDecodeMatchesDecoded)
+{
+  Block interestBlock(Interest1, sizeof(Interest1));
+  interestBlock.parse();
+  Block selectors = interestBlock.get(Tlv::Selectors);
+  selectors.parse();
+  Block interestExclude = selectors.get(Tlv::Exclude);
+
+  std::vector<Block> wires;
+  wires.push_back(interestExclude);
+  wires.push_back(Block(ExcludeBeforeC, sizeof(ExcludeBeforeC)));
+  wires.push_back(Block(ExcludeLongComponents, sizeof(ExcludeLongComponents)));
+
+  const char* probes[] = {
+    "a", "b", "c", "d", "z", "%00", "%FF", "aa", "bb", "ab",
+    "alex", "alew", "alexa", "xxxx", "xxxw", "xxxy", "yyyy", "yyyz", "zzzz", "aaaaa",
+    "long-component-000", "long-component-001", "long-component-002", "long-component-003",
+    "long-component-004", "long-component-0011", "%FF%FE", "%FF%FF", "%00%00%00"
+  };
+
+  for (size_t i = 0; i < wires.size(); ++i) {
+    Exclude lazy;
+    lazy.wireDecode(wires[i]);
+    Exclude decoded;
+    decoded.wireDecode(wires[i]);
+    decoded.reserve(0, 0); // decodes the terms
+
+    // the const methods read the wire in place
+    BOOST_REQUIRE_EQUAL(lazy.size(), decoded.size());
+    for (size_t j = 0; j < lazy.size(); ++j) {
+      BOOST_CHECK_EQUAL_COLLECTIONS(lazy.getComponentValue(j),
+                                    lazy.getComponentValue(j) + lazy.getComponentValueSize(j),
+                                    decoded.getComponentValue(j),
+                                    decoded.getComponentValue(j) + decoded.getComponentValueSize(j));
+      BOOST_CHECK_EQUAL(lazy.hasAnyAfter(j), decoded.hasAnyAfter(j));
+    }
+    BOOST_CHECK(std::equal(lazy.begin(), lazy.end(), decoded.begin()));
+
+    BOOST_CHECK_EQUAL(lazy.empty(), decoded.empty());
+    BOOST_CHECK_EQUAL(lazy.isExcluded(0, 0), decoded.isExcluded(0, 0));
+    for (size_t j = 0; j < sizeof(probes) / sizeof(probes[0]); ++j) {
+      Name::Component component(Name::fromEscapedString(probes[j]));
+      BOOST_CHECK_MESSAGE(lazy.isExcluded(component) == decoded.isExcluded(component),
+                          probes[j] << " in exclude " << i);
+    }
+    BOOST_CHECK_EQUAL(lazy.toUri(), decoded.toUri());
+  }
+
+  // matching a name against a decoded Interest gives the same result with the exclude read in place
+  ndn::Interest lazyInterest;
+  lazyInterest.wireDecode(interestBlock);
+  ndn::Interest decodedInterest;
+  decodedInterest.wireDecode(interestBlock);
+  decodedInterest.getExclude().reserve(0, 0);
+  for (size_t j = 0; j < sizeof(probes) / sizeof(probes[0]); ++j) {
+    Name name = Name("/local/ndn/prefix").append(Name::fromEscapedString(probes[j]));
+    BOOST_CHECK_EQUAL(lazyInterest.matchesName(name), decodedInterest.matchesName(name));
+  }
+}
+
+BOOST_AUTO_TEST_CASE (DecodeManyTerms)
+{
+  // a filter with more terms than are read in place is decoded by wireDecode
+  Exclude built;
+  for (int i = 0; i < 20; ++i) {
+    ostringstream component;
+    component << "component-" << (i + 10);
+    built.excludeOne(Name::Component(component.str().c_str()));
+  }
+  Exclude decoded;
+  decoded.wireDecode(built.wireEncode());
+
+  BOOST_CHECK_EQUAL(decoded.size(), 20);
+  BOOST_CHECK_EQUAL(decoded.toUri(), built.toUri());
+  BOOST_CHECK(decoded.isExcluded(Name::Component("component-15")));
+  BOOST_CHECK(!decoded.isExcluded(Name::Component("component-9")));
+  BOOST_CHECK_EQUAL_COLLECTIONS(decoded.wireEncode().begin(), decoded.wireEncode().end(),
+                                built.wireEncode().begin(), built.wireEncode().end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
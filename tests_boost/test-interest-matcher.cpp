@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2013 Regents of the University of California.
+ * See COPYING for copyright and distribution information.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <ndn-cpp/util/interest-matcher.hpp>
+
+using namespace std;
+using namespace ndn;
+
+static const char *COMPONENTS[] = { "a", "b", "c" };
+static const size_t N_COMPONENTS = sizeof(COMPONENTS) / sizeof(COMPONENTS[0]);
+
+/**
+ * A pseudo-random number generator with a fixed sequence, so that a failure can be repeated.
+ */
+class Random
+{
+public:
+  Random()
+    : state_(1)
+  {
+  }
+
+  size_t
+  next(size_t limit)
+  {
+    state_ = state_ * 1103515245 + 12345;
+    return (state_ >> 16) % limit;
+  }
+
+private:
+  uint32_t state_;
+};
+
+static Name
+makeName(Random &random, size_t maxSize)
+{
+  Name name;
+  for (size_t i = random.next(maxSize + 1); i > 0; --i)
+    name.append(COMPONENTS[random.next(N_COMPONENTS)]);
+  return name;
+}
+
+/**
+ * Make an Interest under a short name, with selectors chosen at random among those which matter
+ * for the names of makeName().
+ */
+static Interest
+makeInterest(Random &random)
+{
+  Interest interest(makeName(random, 3));
+  interest.setMinSuffixComponents(static_cast<int>(random.next(5)) - 1);
+  interest.setMaxSuffixComponents(static_cast<int>(random.next(5)) - 1);
+  switch (random.next(4))
+    {
+    case 0:
+      interest.getExclude().excludeOne(Name::Component(COMPONENTS[random.next(N_COMPONENTS)]));
+      break;
+    case 1:
+      interest.getExclude().excludeRange(Name::Component("a"), Name::Component("b"));
+      break;
+    case 2:
+      interest.getExclude().excludeAfter(Name::Component(COMPONENTS[random.next(N_COMPONENTS)]));
+      break;
+    default:
+      break;
+    }
+  return interest;
+}
+
+/**
+ * Check that findMatches finds exactly the Interests of the table whose matchesName is true.
+ */
+static void
+checkMatches(const InterestMatcher<size_t> &matcher, const vector<Interest> &interests,
+             const vector<bool> &isInTable, const Name &name)
+{
+  vector<size_t> expected;
+  for (size_t i = 0; i < interests.size(); ++i)
+    {
+      if (isInTable[i] && interests[i].matchesName(name))
+        expected.push_back(i);
+    }
+
+  vector<size_t> matches;
+  size_t nMatches = matcher.findMatches(name, matches);
+  BOOST_CHECK_EQUAL(nMatches, matches.size());
+  sort(matches.begin(), matches.end());
+  BOOST_CHECK_MESSAGE(matches == expected, "the matches of " << name.toUri());
+}
+
+BOOST_AUTO_TEST_SUITE(TestInterestMatcher)
+
+BOOST_AUTO_TEST_CASE (AgreesWithMatchesName)
+{
+  Random random;
+  vector<Interest> interests;
+  for (size_t i = 0; i < 300; ++i)
+    interests.push_back(makeInterest(random));
+
+  InterestMatcher<size_t> matcher;
+  vector<bool> isInTable(interests.size(), true);
+  for (size_t i = 0; i < interests.size(); ++i)
+    BOOST_REQUIRE(matcher.insert(i, interests[i], i));
+  BOOST_CHECK_EQUAL(matcher.size(), interests.size());
+
+  vector<Name> names;
+  for (size_t i = 0; i < 300; ++i)
+    names.push_back(makeName(random, 5));
+  for (size_t i = 0; i < names.size(); ++i)
+    checkMatches(matcher, interests, isInTable, names[i]);
+
+  // the same after removing some of the Interests
+  for (size_t i = 0; i < interests.size(); i += 3)
+    {
+      BOOST_CHECK(matcher.erase(i));
+      isInTable[i] = false;
+    }
+  BOOST_CHECK(!matcher.erase(0));
+  for (size_t i = 0; i < names.size(); ++i)
+    checkMatches(matcher, interests, isInTable, names[i]);
+}
+
+BOOST_AUTO_TEST_CASE (InsertAndErase)
+{
+  InterestMatcher<int> matcher;
+  BOOST_CHECK(matcher.empty());
+
+  Interest interest(Name("/a/b"));
+  BOOST_CHECK(matcher.insert(1, interest, 10));
+  // an ID is only used once, but Interests with the same name are kept apart
+  BOOST_CHECK(!matcher.insert(1, interest, 11));
+  BOOST_CHECK(matcher.insert(2, interest, 20));
+  BOOST_CHECK_EQUAL(matcher.size(), 2);
+  BOOST_CHECK(matcher.contains(1));
+
+  vector<int> values;
+  BOOST_CHECK_EQUAL(matcher.findMatches(Name("/a/b/c"), values), 2);
+  BOOST_CHECK_EQUAL(matcher.findMatches(Name("/a"), values), 0);
+
+  BOOST_CHECK(matcher.erase(1));
+  BOOST_CHECK(!matcher.contains(1));
+  values.clear();
+  BOOST_REQUIRE_EQUAL(matcher.findMatches(Name("/a/b"), values), 1);
+  BOOST_CHECK_EQUAL(values[0], 20);
+
+  matcher.clear();
+  BOOST_CHECK(matcher.empty());
+  values.clear();
+  BOOST_CHECK_EQUAL(matcher.findMatches(Name("/a/b"), values), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
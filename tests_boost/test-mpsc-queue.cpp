@@ -0,0 +1,104 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2013 Regents of the University of California.
+ * See COPYING for copyright and distribution information.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <pthread.h>
+#include <ndn-cpp/util/mpsc-queue.hpp>
+
+using namespace std;
+using namespace ndn;
+
+static const size_t N_PRODUCERS = 4;
+static const size_t N_VALUES_PER_PRODUCER = 100000;
+
+/**
+ * A value pushed by a producer thread: the producer and the number of the values it pushed before
+ */
+typedef pair<size_t, size_t> Value;
+
+struct Producer
+{
+  MpscQueue<Value> *queue;
+  size_t id;
+};
+
+static void*
+produce(void *argument)
+{
+  Producer &producer = *static_cast<Producer*>(argument);
+  for (size_t i = 0; i < N_VALUES_PER_PRODUCER; ++i)
+    producer.queue->push(Value(producer.id, i));
+  return 0;
+}
+
+BOOST_AUTO_TEST_SUITE(TestMpscQueue)
+
+BOOST_AUTO_TEST_CASE (PushAndPop)
+{
+  MpscQueue<int> queue;
+  int value = 0;
+  BOOST_CHECK(queue.empty());
+  BOOST_CHECK(!queue.pop(value));
+
+  queue.push(1);
+  queue.push(2);
+  BOOST_CHECK(!queue.empty());
+  BOOST_REQUIRE(queue.pop(value));
+  BOOST_CHECK_EQUAL(value, 1);
+
+  queue.push(3);
+  BOOST_REQUIRE(queue.pop(value));
+  BOOST_CHECK_EQUAL(value, 2);
+  BOOST_REQUIRE(queue.pop(value));
+  BOOST_CHECK_EQUAL(value, 3);
+  BOOST_CHECK(queue.empty());
+  BOOST_CHECK(!queue.pop(value));
+
+  // the values left in the queue are freed with it
+  queue.push(4);
+  queue.push(5);
+}
+
+BOOST_AUTO_TEST_CASE (FifoPerProducer)
+{
+  MpscQueue<Value> queue;
+  vector<Producer> producers(N_PRODUCERS);
+  vector<pthread_t> threads(N_PRODUCERS);
+  for (size_t i = 0; i < N_PRODUCERS; ++i)
+    {
+      producers[i].queue = &queue;
+      producers[i].id = i;
+      pthread_create(&threads[i], 0, produce, &producers[i]);
+    }
+
+  // Pop while the producers push.  The values of each producer come in the order it pushed them,
+  // whatever the order between the producers.
+  vector<size_t> nPopped(N_PRODUCERS, 0);
+  size_t nErrors = 0;
+  Value value;
+  for (size_t total = 0; total < N_PRODUCERS * N_VALUES_PER_PRODUCER; )
+    {
+      if (!queue.pop(value))
+        continue;
+      if (value.first >= N_PRODUCERS || value.second != nPopped[value.first])
+        ++nErrors;
+      else
+        ++nPopped[value.first];
+      ++total;
+    }
+  BOOST_CHECK_EQUAL(nErrors, 0);
+
+  for (size_t i = 0; i < N_PRODUCERS; ++i)
+    {
+      pthread_join(threads[i], 0);
+      BOOST_CHECK_EQUAL(nPopped[i], N_VALUES_PER_PRODUCER);
+    }
+  BOOST_CHECK(queue.empty());
+  BOOST_CHECK(!queue.pop(value));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
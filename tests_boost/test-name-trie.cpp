@@ -0,0 +1,276 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2013 Regents of the University of California.
+ * See COPYING for copyright and distribution information.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <ndn-cpp/util/name-trie.hpp>
+
+using namespace std;
+using namespace ndn;
+
+/**
+ * Insert /a, /a/b, /a/b/c, /a/d and /x with the values 1 to 5.
+ */
+static void
+fill(NameTrie<int> &trie)
+{
+  trie.insert("/a", 1);
+  trie.insert("/a/b", 2);
+  trie.insert("/a/b/c", 3);
+  trie.insert("/a/d", 4);
+  trie.insert("/x", 5);
+}
+
+/**
+ * Run the test with a tree read by other threads and with a tree changed in place.
+ */
+#define NAME_TRIE_TEST_CASE(name)                                       \
+  static void name##Test(bool isReadByOtherThreads);                    \
+  BOOST_AUTO_TEST_CASE (name)                                           \
+  {                                                                     \
+    name##Test(true);                                                   \
+    name##Test(false);                                                  \
+  }                                                                     \
+  static void name##Test(bool isReadByOtherThreads)
+
+BOOST_AUTO_TEST_SUITE(TestNameTrie)
+
+NAME_TRIE_TEST_CASE (Insert)
+{
+  NameTrie<int> trie(isReadByOtherThreads);
+  BOOST_CHECK(trie.empty());
+  BOOST_CHECK_EQUAL(trie.size(), 0);
+
+  BOOST_CHECK(trie.insert("/a/b", 1));
+  BOOST_CHECK(!trie.empty());
+  BOOST_CHECK_EQUAL(trie.size(), 1);
+
+  // a name with a value gets a new one, and is counted once
+  BOOST_CHECK(!trie.insert("/a/b", 2));
+  BOOST_CHECK_EQUAL(trie.size(), 1);
+  int value = 0;
+  BOOST_REQUIRE(trie.findExactMatch("/a/b", value));
+  BOOST_CHECK_EQUAL(value, 2);
+
+  // the empty name is the root
+  BOOST_CHECK(trie.insert(Name(), 3));
+  BOOST_CHECK_EQUAL(trie.size(), 2);
+  BOOST_REQUIRE(trie.findExactMatch(Name(), value));
+  BOOST_CHECK_EQUAL(value, 3);
+}
+
+NAME_TRIE_TEST_CASE (FindExactMatch)
+{
+  NameTrie<int> trie(isReadByOtherThreads);
+  int value = 0;
+  BOOST_CHECK(!trie.findExactMatch("/a", value));
+
+  fill(trie);
+  BOOST_REQUIRE(trie.findExactMatch("/a/b/c", value));
+  BOOST_CHECK_EQUAL(value, 3);
+  BOOST_REQUIRE(trie.findExactMatch("/a/d", value));
+  BOOST_CHECK_EQUAL(value, 4);
+
+  // neither a prefix without a value nor a longer name matches
+  BOOST_CHECK(!trie.findExactMatch(Name(), value));
+  BOOST_CHECK(!trie.findExactMatch("/a/b/c/d", value));
+  BOOST_CHECK(!trie.findExactMatch("/a/c", value));
+  BOOST_CHECK(!trie.findExactMatch("/b", value));
+
+  // the components are compared by value, including the empty component and length
+  trie.insert(Name("/a").append(Name::Component()), 6);
+  BOOST_REQUIRE(trie.findExactMatch(Name("/a").append(Name::Component()), value));
+  BOOST_CHECK_EQUAL(value, 6);
+  BOOST_CHECK(!trie.findExactMatch("/a/bb", value));
+}
+
+NAME_TRIE_TEST_CASE (FindLongestPrefixMatch)
+{
+  NameTrie<int> trie(isReadByOtherThreads);
+  int value = 0;
+  size_t nComponents = 99;
+  BOOST_CHECK(!trie.findLongestPrefixMatch("/a/b", value, &nComponents));
+
+  fill(trie);
+  BOOST_REQUIRE(trie.findLongestPrefixMatch("/a/b/c/d/e", value, &nComponents));
+  BOOST_CHECK_EQUAL(value, 3);
+  BOOST_CHECK_EQUAL(nComponents, 3);
+
+  BOOST_REQUIRE(trie.findLongestPrefixMatch("/a/b", value, &nComponents));
+  BOOST_CHECK_EQUAL(value, 2);
+  BOOST_CHECK_EQUAL(nComponents, 2);
+
+  BOOST_REQUIRE(trie.findLongestPrefixMatch("/a/c/b", value, &nComponents));
+  BOOST_CHECK_EQUAL(value, 1);
+  BOOST_CHECK_EQUAL(nComponents, 1);
+
+  BOOST_CHECK(!trie.findLongestPrefixMatch("/b/a", value));
+  BOOST_CHECK(!trie.findLongestPrefixMatch(Name(), value));
+
+  // a value at the root matches all names
+  trie.insert(Name(), 0);
+  BOOST_REQUIRE(trie.findLongestPrefixMatch("/b/a", value, &nComponents));
+  BOOST_CHECK_EQUAL(value, 0);
+  BOOST_CHECK_EQUAL(nComponents, 0);
+}
+
+NAME_TRIE_TEST_CASE (FindAllUnder)
+{
+  NameTrie<int> trie(isReadByOtherThreads);
+  fill(trie);
+
+  NameTrie<int>::EntryList entries;
+  trie.findAllUnder("/a", entries);
+  BOOST_REQUIRE_EQUAL(entries.size(), 4);
+  // in the NDN canonical order, with the prefix itself first
+  BOOST_CHECK_EQUAL(entries[0].first, Name("/a"));
+  BOOST_CHECK_EQUAL(entries[0].second, 1);
+  BOOST_CHECK_EQUAL(entries[1].first, Name("/a/b"));
+  BOOST_CHECK_EQUAL(entries[1].second, 2);
+  BOOST_CHECK_EQUAL(entries[2].first, Name("/a/b/c"));
+  BOOST_CHECK_EQUAL(entries[2].second, 3);
+  BOOST_CHECK_EQUAL(entries[3].first, Name("/a/d"));
+  BOOST_CHECK_EQUAL(entries[3].second, 4);
+
+  // the entries are appended
+  trie.findAllUnder("/x", entries);
+  BOOST_REQUIRE_EQUAL(entries.size(), 5);
+  BOOST_CHECK_EQUAL(entries[4].first, Name("/x"));
+
+  entries.clear();
+  trie.findAllUnder("/a/b/c/d", entries);
+  BOOST_CHECK(entries.empty());
+  trie.findAllUnder("/y", entries);
+  BOOST_CHECK(entries.empty());
+
+  trie.findAllUnder(Name(), entries);
+  BOOST_CHECK_EQUAL(entries.size(), 5);
+}
+
+NAME_TRIE_TEST_CASE (Erase)
+{
+  NameTrie<int> trie(isReadByOtherThreads);
+  fill(trie);
+  BOOST_CHECK_EQUAL(trie.size(), 5);
+
+  // names without a value are not erased
+  BOOST_CHECK(!trie.erase("/a/c"));
+  BOOST_CHECK(!trie.erase("/a/b/c/d"));
+  BOOST_CHECK(!trie.erase(Name()));
+  BOOST_CHECK_EQUAL(trie.size(), 5);
+
+  // erasing an inner name keeps the names under it
+  BOOST_CHECK(trie.erase("/a/b"));
+  BOOST_CHECK(!trie.erase("/a/b"));
+  BOOST_CHECK_EQUAL(trie.size(), 4);
+  int value = 0;
+  BOOST_CHECK(!trie.findExactMatch("/a/b", value));
+  BOOST_REQUIRE(trie.findExactMatch("/a/b/c", value));
+  BOOST_CHECK_EQUAL(value, 3);
+  size_t nComponents = 0;
+  BOOST_REQUIRE(trie.findLongestPrefixMatch("/a/b/z", value, &nComponents));
+  BOOST_CHECK_EQUAL(nComponents, 1);
+
+  // the number of entries under each node follows the erasures
+  NameTrie<int>::EntryList entries;
+  trie.findAllUnder("/a", entries);
+  BOOST_CHECK_EQUAL(entries.size(), 3);
+
+  BOOST_CHECK(trie.erase("/a/b/c"));
+  BOOST_CHECK(trie.erase("/a"));
+  BOOST_CHECK_EQUAL(trie.size(), 2);
+  entries.clear();
+  trie.findAllUnder("/a", entries);
+  BOOST_REQUIRE_EQUAL(entries.size(), 1);
+  BOOST_CHECK_EQUAL(entries[0].first, Name("/a/d"));
+
+  BOOST_CHECK(trie.erase("/a/d"));
+  BOOST_CHECK(trie.erase("/x"));
+  BOOST_CHECK_EQUAL(trie.size(), 0);
+  BOOST_CHECK(trie.empty());
+
+  // the tree can be filled again after it is emptied
+  trie.insert("/a/b", 7);
+  BOOST_CHECK_EQUAL(trie.size(), 1);
+  trie.clear();
+  BOOST_CHECK(trie.empty());
+}
+
+NAME_TRIE_TEST_CASE (SnapshotDoesNotChange)
+{
+  NameTrie<int> trie(isReadByOtherThreads);
+  fill(trie);
+
+  NameTrie<int>::Snapshot snapshot = trie.getSnapshot();
+  const int *value = snapshot.findExactMatch("/a/b/c");
+  BOOST_REQUIRE(value != 0);
+
+  trie.insert("/a/b/c", 30);
+  trie.insert("/a/b/e", 8);
+  trie.erase("/a/d");
+  trie.erase("/x");
+
+  // the snapshot still has the old version, and its values stay in place
+  BOOST_CHECK_EQUAL(*value, 3);
+  BOOST_CHECK_EQUAL(snapshot.size(), 5);
+  BOOST_CHECK(snapshot.findExactMatch("/a/b/e") == 0);
+  BOOST_REQUIRE(snapshot.findExactMatch("/a/d") != 0);
+  BOOST_CHECK_EQUAL(*snapshot.findExactMatch("/a/d"), 4);
+  BOOST_REQUIRE(snapshot.findExactMatch("/x") != 0);
+
+  NameTrie<int>::Snapshot current = trie.getSnapshot();
+  BOOST_CHECK_EQUAL(current.size(), 4);
+  BOOST_REQUIRE(current.findExactMatch("/a/b/c") != 0);
+  BOOST_CHECK_EQUAL(*current.findExactMatch("/a/b/c"), 30);
+  BOOST_CHECK(current.findExactMatch("/x") == 0);
+
+  // once the snapshots are released, changes are made in place again
+  snapshot = NameTrie<int>::Snapshot();
+  current = NameTrie<int>::Snapshot();
+  trie.erase("/a/b/c");
+  int found = 0;
+  BOOST_CHECK(!trie.findExactMatch("/a/b/c", found));
+  BOOST_CHECK_EQUAL(trie.size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE (ChangeInPlace)
+{
+  NameTrie<int> trie(false);
+  fill(trie);
+
+  // no snapshot holds the nodes, so a value keeps its address when the name gets a new value
+  const int *value = trie.getSnapshot().findExactMatch("/a/b/c");
+  trie.insert("/a/b/c", 30);
+  BOOST_CHECK(trie.getSnapshot().findExactMatch("/a/b/c") == value);
+  BOOST_CHECK_EQUAL(*value, 30);
+
+  // while a snapshot holds them, the path is copied
+  NameTrie<int>::Snapshot snapshot = trie.getSnapshot();
+  trie.insert("/a/b/c", 31);
+  BOOST_CHECK(trie.getSnapshot().findExactMatch("/a/b/c") != value);
+  BOOST_CHECK_EQUAL(*value, 30);
+}
+
+BOOST_AUTO_TEST_CASE (ManySiblings)
+{
+  // siblings are kept in the canonical order however they are inserted
+  NameTrie<int> trie(false);
+  for (int i = 0; i < 1000; ++i)
+    trie.insert(Name("/a").appendSegment((i * 7919) % 1000), i);
+  BOOST_CHECK_EQUAL(trie.size(), 1000);
+
+  NameTrie<int>::EntryList entries;
+  trie.findAllUnder("/a", entries);
+  BOOST_REQUIRE_EQUAL(entries.size(), 1000);
+  for (size_t i = 0; i < entries.size(); ++i)
+    BOOST_CHECK_EQUAL(entries[i].first.get(-1).toSegment(), i);
+
+  for (int i = 0; i < 1000; i += 2)
+    BOOST_CHECK(trie.erase(Name("/a").appendSegment(i)));
+  BOOST_CHECK_EQUAL(trie.size(), 500);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
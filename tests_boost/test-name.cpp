@@ -0,0 +1,281 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2013 Regents of the University of California.
+ * See COPYING for copyright and distribution information.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+
+#include <ndn-cpp/interest.hpp>
+
+using namespace std;
+using namespace ndn;
+
+static const uint8_t Interest1[] = {
+  0x1,  0x41, // NDN Interest
+      0x3,  0x14, // Name
+          0x4,  0x5, // NameComponent
+              0x6c,  0x6f,  0x63,  0x61,  0x6c,
+          0x4,  0x3, // NameComponent
+              0x6e,  0x64,  0x6e,
+          0x4,  0x6, // NameComponent
+              0x70,  0x72,  0x65,  0x66,  0x69,  0x78,
+      0x5,  0x1f, // Selectors
+          0x09,  0x1,  0x1,  // MinSuffix
+          0x0a,  0x1,  0x1,  // MaxSuffix
+          0x0c,  0x14, // Exclude
+              0x4,  0x4, // NameComponent
+                  0x61,  0x6c,  0x65,  0x78,
+              0x4,  0x4, // NameComponent
+                  0x78,  0x78,  0x78,  0x78,
+              0xf,  0x0, // Any
+              0x4,  0x4, // NameComponent
+                  0x79,  0x79,  0x79,  0x79,
+          0x0d,  0x1, // ChildSelector
+              0x1,
+      0x6,  0x1, // Nonce
+          0x1,
+      0x7,  0x1, // Scope
+          0x1,
+      0x8,       // InterestLifetime
+          0x2,  0x3,  0xe8
+};
+
+BOOST_AUTO_TEST_SUITE(TestName)
+
+BOOST_AUTO_TEST_CASE (UriRoundTrip)
+{
+  const char* uris[] = {
+    "/",
+    "/local/ndn/prefix",
+    "/a%20b/%00%01%FE%FF",
+    "/..../...../a.b",
+    "/%C1.M.S.localhost/%C1.M.SRV/ndnd/KEY"
+  };
+  for (size_t i = 0; i < sizeof(uris) / sizeof(uris[0]); ++i) {
+    Name name(uris[i]);
+    BOOST_CHECK_EQUAL(name.toUri(), uris[i]);
+    BOOST_CHECK_EQUAL(Name(name.toUri()), name);
+    BOOST_CHECK_EQUAL(Name(name.wireEncode()), name);
+  }
+
+  BOOST_CHECK_EQUAL(Name("ndn:/local//ndn/").toUri(), "/local/ndn");
+  BOOST_CHECK_EQUAL(Name("/a%2fb").get(0).getValue().size(), 3);
+  // an empty component is written as "...", which set() ignores like the other illegal components
+  Name emptyComponent;
+  emptyComponent.append(0, 0);
+  BOOST_CHECK_EQUAL(emptyComponent.toUri(), "/...");
+  BOOST_CHECK_EQUAL(Name(emptyComponent.wireEncode()), emptyComponent);
+  BOOST_CHECK_EQUAL(Name("/...").size(), 0);
+  BOOST_CHECK_EQUAL(Name("/....").get(0).getValue().size(), 1);
+  BOOST_CHECK_EQUAL(Name("/local/ndn/prefix").size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE (ComponentsOfDecodedName)
+{
+  Block interestBlock(Interest1, sizeof(Interest1));
+  ndn::Interest i;
+  i.wireDecode(interestBlock);
+  const Name &name = i.getName();
+
+  BOOST_REQUIRE_EQUAL(name.size(), 3);
+  BOOST_CHECK_EQUAL(name.getComponentValueSize(0), 5);
+  BOOST_CHECK_EQUAL(std::string(reinterpret_cast<const char*>(name.getComponentValue(2)), 6), "prefix");
+  BOOST_CHECK_EQUAL(name.get(1).toEscapedString(), "ndn");
+  BOOST_CHECK_EQUAL(name.get(-1).toEscapedString(), "prefix");
+  BOOST_CHECK_EQUAL(name.getPrefix(-1).toUri(), "/local/ndn");
+}
+
+BOOST_AUTO_TEST_CASE (Iterators)
+{
+  Name name("/local/ndn/prefix");
+
+  std::vector<std::string> forward;
+  for (Name::const_iterator i = name.begin(); i != name.end(); ++i)
+    forward.push_back(i->toEscapedString());
+  BOOST_REQUIRE_EQUAL(forward.size(), 3);
+  BOOST_CHECK_EQUAL(forward[0], "local");
+  BOOST_CHECK_EQUAL(forward[2], "prefix");
+
+  BOOST_CHECK_EQUAL(name.end() - name.begin(), 3);
+  BOOST_CHECK_EQUAL(name.begin()[1], Name::Component("ndn"));
+  BOOST_CHECK_EQUAL(*(name.end() - 1), name.get(-1));
+  BOOST_CHECK_EQUAL(name.rbegin()->toEscapedString(), "prefix");
+  BOOST_CHECK_EQUAL(std::distance(name.rbegin(), name.rend()), 3);
+  BOOST_CHECK(std::find(name.begin(), name.end(), Name::Component("ndn")) == name.begin() + 1);
+
+  // the components are copies, which stay valid after the name changes
+  Name::Component last = name.get(-1);
+  name.clear();
+  name.append("other");
+  BOOST_CHECK_EQUAL(last.toEscapedString(), "prefix");
+
+  Name empty;
+  BOOST_CHECK(empty.begin() == empty.end());
+}
+
+BOOST_AUTO_TEST_CASE (ComponentNumbers)
+{
+  // a component made from a number, with or without a marker
+  Name::Component segment = Name::Component::fromNumberWithMarker(258, 0x00);
+  BOOST_CHECK_EQUAL(segment.getValue().size(), 3);
+  BOOST_CHECK_EQUAL(segment.toSegment(), 258);
+  BOOST_CHECK_EQUAL(segment.toNumber(), 258);
+  BOOST_CHECK_THROW(segment.toVersion(), runtime_error);
+  BOOST_CHECK_EQUAL(Name::Component::fromNumber(258).toNumber(), 258);
+  BOOST_CHECK(Name::Component::fromNumber(0).empty());
+  BOOST_CHECK_EQUAL(Name::Component::fromNumber(0).toNumber(), 0);
+
+  // the same numbers decoded from components made from their bytes
+  Name::Component decoded(segment.getValue());
+  BOOST_CHECK_EQUAL(decoded.toSegment(), 258);
+  BOOST_CHECK_EQUAL(decoded.toSegment(), 258);
+  BOOST_CHECK_EQUAL(decoded.toNumber(), 258);
+  BOOST_CHECK_THROW(decoded.toVersion(), runtime_error);
+  BOOST_CHECK_EQUAL(Name::Component().toNumber(), 0);
+  BOOST_CHECK_THROW(Name::Component().toSegment(), runtime_error);
+
+  // and from the components of a name, which are made on each call
+  Name name("/a");
+  name.appendVersion(0x0102).appendSegment(7);
+  BOOST_CHECK_EQUAL(name.get(1).toVersion(), 0x0102);
+  BOOST_CHECK_EQUAL(name.get(-1).toSegment(), 7);
+  BOOST_CHECK_EQUAL(name.getComponentNumberWithMarker(2, 0x00), 7);
+}
+
+BOOST_AUTO_TEST_CASE (SharedPartsAreCopiedOnWrite)
+{
+  Name name("/a/b/c/d");
+
+  Name prefix = name.getPrefix(2);
+  Name subName = name.getSubName(1, 2);
+  Name copy = name;
+  BOOST_CHECK_EQUAL(prefix.toUri(), "/a/b");
+  BOOST_CHECK_EQUAL(subName.toUri(), "/b/c");
+
+  // changing the derived names does not change the name they share components with
+  prefix.append("x");
+  subName.appendSegment(5);
+  copy.clear();
+  BOOST_CHECK_EQUAL(name.toUri(), "/a/b/c/d");
+  BOOST_CHECK_EQUAL(prefix.toUri(), "/a/b/x");
+  BOOST_CHECK_EQUAL(subName, Name("/b/c").appendSegment(5));
+  BOOST_CHECK(copy.empty());
+
+  // nor the other way around
+  Name derived = Name(name).appendSegment(1);
+  Name tail = name.getSubName(2);
+  name.append("e");
+  name.set("/z");
+  BOOST_CHECK_EQUAL(name.toUri(), "/z");
+  BOOST_CHECK_EQUAL(derived, Name("/a/b/c/d").appendSegment(1));
+  BOOST_CHECK_EQUAL(derived.get(-1).toSegment(), 1);
+  BOOST_CHECK_EQUAL(tail.toUri(), "/c/d");
+  BOOST_CHECK_EQUAL(prefix.toUri(), "/a/b/x");
+
+  // a prefix of a derived name, then appended to, keeps the components of both
+  Name prefixOfDerived = derived.getPrefix(-1);
+  prefixOfDerived.append(tail);
+  BOOST_CHECK_EQUAL(prefixOfDerived.toUri(), "/a/b/c/d/c/d");
+  BOOST_CHECK_EQUAL(prefixOfDerived.getHash(), Name("/a/b/c/d/c/d").getHash());
+  std::vector<size_t> hashes;
+  prefixOfDerived.getPrefixHashes(prefixOfDerived.size(), hashes);
+  BOOST_REQUIRE_EQUAL(hashes.size(), prefixOfDerived.size() + 1);
+  for (size_t i = 0; i < hashes.size(); ++i)
+    BOOST_CHECK_EQUAL(hashes[i], prefixOfDerived.getPrefix(i).getHash());
+  BOOST_CHECK_EQUAL(prefixOfDerived.getPrefixHash(2), Name("/a/b").getHash());
+  BOOST_CHECK_EQUAL(derived, Name("/a/b/c/d").appendSegment(1));
+}
+
+static int
+sign(int value)
+{
+  return value < 0 ? -1 : (value > 0 ? 1 : 0);
+}
+
+/**
+ * The canonical order of names defined from the order of their components, as -1, 0 or 1
+ */
+static int
+compareByComponents(const Name &name1, const Name &name2)
+{
+  for (size_t i = 0; i < name1.size() && i < name2.size(); ++i) {
+    int result = name1.get(i).compare(name2.get(i));
+    if (result != 0)
+      return sign(result);
+  }
+  if (name1.size() == name2.size())
+    return 0;
+  return name1.size() < name2.size() ? -1 : 1;
+}
+
+BOOST_AUTO_TEST_CASE (CompareInCanonicalOrder)
+{
+  BOOST_CHECK_LT(Name::Component("b").compare(Name::Component("aa")), 0);
+  BOOST_CHECK_LT(Name::Component("a").compare(Name::Component("b")), 0);
+  BOOST_CHECK_LT(Name::Component("%7F").compare(Name::Component("%80")), 0);
+  BOOST_CHECK_EQUAL(Name::Component("abc").compare(Name::Component("abc")), 0);
+
+  std::vector<Name> names;
+  names.push_back(Name());
+  names.push_back(Name("/a"));
+  names.push_back(Name("/b"));
+  names.push_back(Name("/aa"));
+  names.push_back(Name("/a/b"));
+  names.push_back(Name("/a/b/c"));
+  names.push_back(Name("/a/bb"));
+  names.push_back(Name("/a/c"));
+  names.push_back(Name("/%00"));
+  names.push_back(Name("/%7F"));
+  names.push_back(Name("/%80"));
+  names.push_back(Name("/%FF/a"));
+  names.push_back(Name("/%FF%00"));
+  names.push_back(Name("/long-component-which-differs-late-x/a"));
+  names.push_back(Name("/long-component-which-differs-late-y"));
+  names.push_back(Name("/a").appendSegment(0));
+  names.push_back(Name("/a").appendSegment(255));
+  names.push_back(Name("/a").appendSegment(256));
+  Name withEmptyComponent("/a");
+  withEmptyComponent.append(0, 0);
+  names.push_back(withEmptyComponent);
+  Block interestBlock(Interest1, sizeof(Interest1));
+  ndn::Interest decoded;
+  decoded.wireDecode(interestBlock);
+  names.push_back(decoded.getName());
+  names.push_back(Name("/local/ndn/prefix"));
+  names.push_back(decoded.getName().getPrefix(2));
+
+  for (size_t i = 0; i < names.size(); ++i) {
+    for (size_t j = 0; j < names.size(); ++j) {
+      int expected = compareByComponents(names[i], names[j]);
+      BOOST_CHECK_MESSAGE(sign(names[i].compare(names[j])) == expected,
+                          names[i].toUri() << " compared with " << names[j].toUri());
+      BOOST_CHECK_EQUAL(names[i] < names[j], expected < 0);
+      BOOST_CHECK_EQUAL(names[i] == names[j], expected == 0);
+      BOOST_CHECK_EQUAL(Name::breadthFirstLess(names[i], names[j]), expected < 0);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE (CompareSubNames)
+{
+  Name name1("/x/a/b/c");
+  Name name2("/a/b/d/e");
+
+  for (size_t start1 = 0; start1 <= name1.size(); ++start1)
+    for (size_t n1 = 0; n1 <= name1.size() + 1; ++n1)
+      for (size_t start2 = 0; start2 <= name2.size(); ++start2)
+        for (size_t n2 = 0; n2 <= name2.size() + 1; ++n2) {
+          Name subName1 = name1.getSubName(start1, n1);
+          Name subName2 = name2.getSubName(start2, n2);
+          BOOST_CHECK_EQUAL(sign(name1.compare(start1, n1, name2, start2, n2)),
+                            compareByComponents(subName1, subName2));
+        }
+
+  BOOST_CHECK_EQUAL(name1.compare(1, 2, name2, 0, 2), 0);
+  BOOST_CHECK_LT(name1.compare(1, Name::npos, name2), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,533 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2013 Regents of the University of California.
+ * See COPYING for copyright and distribution information.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <pthread.h>
+#include <ndn-cpp/node.hpp>
+#include "loopback-transport.hpp"
+
+using namespace std;
+using namespace ndn;
+
+// In the std library, the placeholders are in a different namespace than boost.
+using namespace ndn::func_lib::placeholders;
+
+/**
+ * Records the callbacks of the Interests expressed with its OnData and OnTimeout, and of the
+ * prefixes registered with its OnInterest, each Interest or prefix being identified by a tag.
+ */
+class Recorder
+{
+public:
+  Recorder()
+    : node(0)
+    , removingTag(0)
+    , nRegisterFailed(0)
+  {
+  }
+
+  OnData
+  makeOnData(int tag)
+  {
+    return func_lib::bind(&Recorder::onData, this, tag, _1, _2);
+  }
+
+  OnTimeout
+  makeOnTimeout(int tag)
+  {
+    return func_lib::bind(&Recorder::onTimeout, this, tag, _1);
+  }
+
+  OnInterest
+  makeOnInterest(int tag)
+  {
+    return func_lib::bind(&Recorder::onInterest, this, tag, _1, _2, _3, _4);
+  }
+
+  OnRegisterFailed
+  makeOnRegisterFailed()
+  {
+    return func_lib::bind(&Recorder::onRegisterFailed, this, _1);
+  }
+
+  void
+  onData(int tag, const ptr_lib::shared_ptr<const Interest> &interest, const ptr_lib::shared_ptr<Data> &data)
+  {
+    dataTags.push_back(tag);
+    if (node != 0 && tag == removingTag)
+      for (size_t i = 0; i < idsToRemove.size(); ++i)
+        node->removePendingInterest(idsToRemove[i]);
+  }
+
+  void
+  onTimeout(int tag, const ptr_lib::shared_ptr<const Interest> &interest)
+  {
+    timeoutTags.push_back(tag);
+  }
+
+  void
+  onInterest(int tag, const ptr_lib::shared_ptr<const Name> &prefix,
+             const ptr_lib::shared_ptr<const Interest> &interest, Transport &transport, uint64_t registeredPrefixId)
+  {
+    interestTags.push_back(tag);
+    registeredPrefixIds.push_back(registeredPrefixId);
+  }
+
+  void
+  onRegisterFailed(const ptr_lib::shared_ptr<const Name> &prefix)
+  {
+    ++nRegisterFailed;
+  }
+
+  /// @brief The tags in the order of the callbacks
+  vector<int> dataTags;
+  vector<int> timeoutTags;
+  vector<int> interestTags;
+  /// @brief The registeredPrefixId given to each OnInterest call
+  vector<uint64_t> registeredPrefixIds;
+  int nRegisterFailed;
+
+  /// @brief The node in which the OnData of removingTag removes the pending interests of idsToRemove
+  Node *node;
+  int removingTag;
+  vector<uint64_t> idsToRemove;
+};
+
+static vector<int>
+sorted(vector<int> tags)
+{
+  sort(tags.begin(), tags.end());
+  return tags;
+}
+
+static Interest
+makeInterest(const Name &name, Milliseconds lifetime)
+{
+  Interest interest(name);
+  interest.setInterestLifetime(lifetime);
+  return interest;
+}
+
+/**
+ * Record the timeout of the Interest with the tag, and express it again with the next tag.
+ */
+static void
+reexpressOnTimeout(Node *node, Recorder *recorder, int tag, const ptr_lib::shared_ptr<const Interest> &interest)
+{
+  recorder->onTimeout(tag, interest);
+  node->expressInterest(*interest, recorder->makeOnData(tag + 1), recorder->makeOnTimeout(tag + 1));
+}
+
+static Data
+makeData(const Name &name)
+{
+  Data data;
+  data.wireDecode(LoopbackTransport::makeDataWire(name));
+  return data;
+}
+
+static const size_t N_PUTS_PER_PRODUCER = 2000;
+
+/**
+ * A thread calling put on a thread-safe Node, with the Data names /p/<id>/<i> for i from 0
+ */
+struct PutThread
+{
+  Node *node;
+  int id;
+};
+
+static void*
+runPuts(void *argument)
+{
+  PutThread &thread = *static_cast<PutThread*>(argument);
+  for (size_t i = 0; i < N_PUTS_PER_PRODUCER; ++i)
+    thread.node->put(makeData(Name("/p").appendNumber(thread.id).appendSegment(i)));
+  return 0;
+}
+
+static void*
+runProcessEvents(void *argument)
+{
+  static_cast<Node*>(argument)->processEvents(0, true);
+  return 0;
+}
+
+static void
+onDataHoldingToken(const ptr_lib::shared_ptr<int> &token, const ptr_lib::shared_ptr<const Interest> &interest,
+                   const ptr_lib::shared_ptr<Data> &data)
+{
+}
+
+BOOST_AUTO_TEST_SUITE(TestNode)
+
+BOOST_AUTO_TEST_CASE (DataSatisfiesSeveralInterests)
+{
+  ptr_lib::shared_ptr<LoopbackTransport> transport(new LoopbackTransport());
+  Node node(transport);
+  Recorder recorder;
+
+  node.expressInterest(Interest(Name("/a")), recorder.makeOnData(1), recorder.makeOnTimeout(1));
+  node.expressInterest(Interest(Name("/a/b")), recorder.makeOnData(2), recorder.makeOnTimeout(2));
+  node.expressInterest(Interest(Name("/a/b/c")), recorder.makeOnData(3), recorder.makeOnTimeout(3));
+  node.expressInterest(Interest(Name("/a/b")), recorder.makeOnData(4), recorder.makeOnTimeout(4));
+  node.expressInterest(Interest(Name("/a/x")), recorder.makeOnData(5), recorder.makeOnTimeout(5));
+  node.expressInterest(Interest(Name("/a/b/c/d/e")), recorder.makeOnData(6), recorder.makeOnTimeout(6));
+  BOOST_CHECK_EQUAL(transport->sentPackets.size(), 6);
+
+  transport->deliver(LoopbackTransport::makeDataWire(Name("/a/b/c/d")));
+  int expected[] = { 1, 2, 3, 4 };
+  BOOST_CHECK(sorted(recorder.dataTags) == vector<int>(expected, expected + 4));
+
+  // the satisfied Interests are no longer pending
+  transport->deliver(LoopbackTransport::makeDataWire(Name("/a/b/c/d")));
+  BOOST_CHECK_EQUAL(recorder.dataTags.size(), 4);
+
+  transport->deliver(LoopbackTransport::makeDataWire(Name("/a/x")));
+  BOOST_REQUIRE_EQUAL(recorder.dataTags.size(), 5);
+  BOOST_CHECK_EQUAL(recorder.dataTags.back(), 5);
+  BOOST_CHECK(recorder.timeoutTags.empty());
+
+  node.shutdown();
+}
+
+BOOST_AUTO_TEST_CASE (SelectorsRejectData)
+{
+  ptr_lib::shared_ptr<LoopbackTransport> transport(new LoopbackTransport());
+  Node node(transport);
+  Recorder recorder;
+  Name dataName("/a/b/c");
+
+  // The Data name has 3 suffix components under /a, counting the implicit digest.
+  vector<Interest> interests;
+  interests.push_back(Interest(Name("/a")));
+  interests.back().setMinSuffixComponents(3);  // 1: satisfied
+  interests.push_back(Interest(Name("/a")));
+  interests.back().setMinSuffixComponents(4);  // 2: too few components
+  interests.push_back(Interest(Name("/a")));
+  interests.back().setMaxSuffixComponents(2);  // 3: too many components
+  interests.push_back(Interest(Name("/a/b")));
+  interests.back().setMaxSuffixComponents(2);  // 4: satisfied
+  interests.push_back(Interest(Name("/a")));
+  interests.back().getExclude().excludeOne(Name::Component("b"));  // 5: excluded
+  interests.push_back(Interest(Name("/a")));
+  interests.back().getExclude().excludeAfter(Name::Component("c"));  // 6: satisfied
+  interests.push_back(Interest(Name("/a")));
+  interests.back().getExclude().excludeBefore(Name::Component("b"));  // 7: excluded
+  interests.push_back(Interest(Name("/a/b/c")));
+  interests.back().getExclude().excludeOne(Name::Component("c"));  // 8: nothing after the name to exclude
+
+  vector<int> expected;
+  for (size_t i = 0; i < interests.size(); ++i)
+    {
+      int tag = static_cast<int>(i + 1);
+      node.expressInterest(interests[i], recorder.makeOnData(tag), recorder.makeOnTimeout(tag));
+      if (interests[i].matchesName(dataName))
+        expected.push_back(tag);
+    }
+  int satisfied[] = { 1, 4, 6, 8 };
+  BOOST_CHECK(expected == vector<int>(satisfied, satisfied + 4));
+
+  transport->deliver(LoopbackTransport::makeDataWire(dataName));
+  BOOST_CHECK(sorted(recorder.dataTags) == expected);
+
+  // the rejected Interests are still pending, and all but 3 accept this name
+  transport->deliver(LoopbackTransport::makeDataWire(Name("/a/x/y/z")));
+  int expectedAfter[] = { 1, 2, 4, 5, 6, 7, 8 };
+  BOOST_CHECK(sorted(recorder.dataTags) == vector<int>(expectedAfter, expectedAfter + 7));
+
+  node.shutdown();
+}
+
+BOOST_AUTO_TEST_CASE (RemovePendingInterestInOnData)
+{
+  ptr_lib::shared_ptr<LoopbackTransport> transport(new LoopbackTransport());
+  Node node(transport);
+  Recorder recorder;
+
+  node.expressInterest(Interest(Name("/a")), recorder.makeOnData(1), recorder.makeOnTimeout(1));
+  uint64_t id2 = node.expressInterest(Interest(Name("/a/b")), recorder.makeOnData(2), recorder.makeOnTimeout(2));
+  uint64_t id3 = node.expressInterest(Interest(Name("/a/c")), recorder.makeOnData(3), recorder.makeOnTimeout(3));
+
+  // The OnData of 1 removes 2, which the same Data satisfies, and 3, which it does not.
+  recorder.node = &node;
+  recorder.removingTag = 1;
+  recorder.idsToRemove.push_back(id2);
+  recorder.idsToRemove.push_back(id3);
+  transport->deliver(LoopbackTransport::makeDataWire(Name("/a/b")));
+
+  // 2 was already taken out of the table with 1, so it still gets the Data
+  int expected[] = { 1, 2 };
+  BOOST_CHECK(sorted(recorder.dataTags) == vector<int>(expected, expected + 2));
+
+  // 3 was removed before its Data came
+  recorder.node = 0;
+  transport->deliver(LoopbackTransport::makeDataWire(Name("/a/c")));
+  BOOST_CHECK_EQUAL(recorder.dataTags.size(), 2);
+
+  // removing an ID again, or one never used, does nothing
+  node.removePendingInterest(id3);
+  node.removePendingInterest(0);
+  BOOST_CHECK(recorder.timeoutTags.empty());
+
+  node.shutdown();
+}
+
+BOOST_AUTO_TEST_CASE (TimeoutsInDeadlineOrder)
+{
+  ptr_lib::shared_ptr<LoopbackTransport> transport(new LoopbackTransport());
+  Node node(transport);
+  Recorder recorder;
+
+  // Expressed out of the order of their deadlines.  5 is satisfied and 6 removed before they time
+  // out, which leaves their entries in the timeout queue.
+  Milliseconds lifetimes[] = { 120, 40, 80, 20, 60, 100 };
+  vector<uint64_t> ids;
+  for (int tag = 1; tag <= 6; ++tag)
+    ids.push_back(node.expressInterest(makeInterest(Name("/t").appendSegment(tag), lifetimes[tag - 1]),
+                                       recorder.makeOnData(tag), recorder.makeOnTimeout(tag)));
+  transport->deliver(LoopbackTransport::makeDataWire(Name("/t").appendSegment(5)));
+  node.removePendingInterest(ids[5]);
+
+  // processEvents returns once the table is empty, well before its own timeout
+  node.processEvents(5000);
+  int expected[] = { 4, 2, 3, 1 };
+  BOOST_CHECK(recorder.timeoutTags == vector<int>(expected, expected + 4));
+  BOOST_REQUIRE_EQUAL(recorder.dataTags.size(), 1);
+  BOOST_CHECK_EQUAL(recorder.dataTags[0], 5);
+
+  node.shutdown();
+}
+
+BOOST_AUTO_TEST_CASE (TimeoutReexpresses)
+{
+  ptr_lib::shared_ptr<LoopbackTransport> transport(new LoopbackTransport());
+  Node node(transport);
+  Recorder recorder;
+
+  node.expressInterest(makeInterest(Name("/t/1"), 20), recorder.makeOnData(1),
+                       func_lib::bind(&reexpressOnTimeout, &node, &recorder, 1, _1));
+  node.expressInterest(makeInterest(Name("/t/2"), 30), recorder.makeOnData(3), recorder.makeOnTimeout(3));
+
+  // the Interest expressed again by the callback of 1, at 20 ms, times out after 3 at 30 ms
+  node.processEvents(5000);
+  int expected[] = { 1, 3, 2 };
+  BOOST_CHECK(recorder.timeoutTags == vector<int>(expected, expected + 3));
+  BOOST_CHECK_EQUAL(transport->sentPackets.size(), 3);
+  BOOST_CHECK(recorder.dataTags.empty());
+
+  node.shutdown();
+}
+
+BOOST_AUTO_TEST_CASE (StaleTimeoutsAreCompacted)
+{
+  ptr_lib::shared_ptr<LoopbackTransport> transport(new LoopbackTransport());
+  Node node(transport);
+
+  // Each PendingInterest holds a copy of the token in its OnData, and is held by the timeout queue
+  // until its entry is dropped, so the use count of the token is 1 + the size of the queue.
+  ptr_lib::shared_ptr<int> token(new int(0));
+  vector<uint64_t> ids;
+  for (int i = 0; i < 200; ++i)
+    ids.push_back(node.expressInterest(Interest(Name("/t").appendSegment(i)),
+                                       func_lib::bind(&onDataHoldingToken, token, _1, _2), OnTimeout()));
+  BOOST_CHECK_EQUAL(token.use_count(), 1 + 200);
+
+  // Removed and satisfied Interests leave their entries, until there are more than
+  // 2 * 67 + 64 = 198 entries for 67 pending Interests.
+  for (int i = 0; i < 100; ++i)
+    node.removePendingInterest(ids[i]);
+  for (int i = 100; i < 132; ++i)
+    transport->deliver(LoopbackTransport::makeDataWire(Name("/t").appendSegment(i)));
+  BOOST_CHECK_EQUAL(token.use_count(), 1 + 200);
+
+  transport->deliver(LoopbackTransport::makeDataWire(Name("/t").appendSegment(132)));
+  BOOST_CHECK_EQUAL(token.use_count(), 1 + 67);
+
+  // when the last Interest is gone, the queue is cleared
+  for (int i = 133; i < 200; ++i)
+    node.removePendingInterest(ids[i]);
+  BOOST_CHECK_EQUAL(token.use_count(), 1);
+
+  node.shutdown();
+}
+
+BOOST_AUTO_TEST_CASE (InterestsGoToLongestRegisteredPrefix)
+{
+  ptr_lib::shared_ptr<LoopbackTransport> transport(new LoopbackTransport());
+  Node node(transport);
+  Recorder recorder;
+
+  Name prefixes[] = { Name("/a"), Name("/a/b"), Name("/a/b"), Name("/a/b/c"), Name("/a") };
+  vector<uint64_t> ids;
+  for (int tag = 1; tag <= 5; ++tag)
+    ids.push_back(node.registerPrefix(prefixes[tag - 1], recorder.makeOnInterest(tag),
+                                      recorder.makeOnRegisterFailed(), ForwardingFlags()));
+  transport->answerHubInterests();
+  BOOST_CHECK_EQUAL(recorder.nRegisterFailed, 0);
+
+  // only the handlers of the longest prefix are called, in the order of registration
+  transport->deliver(Interest(Name("/a/b/d")).wireEncode());
+  int expectedB[] = { 2, 3 };
+  BOOST_CHECK(recorder.interestTags == vector<int>(expectedB, expectedB + 2));
+  BOOST_REQUIRE_EQUAL(recorder.registeredPrefixIds.size(), 2);
+  BOOST_CHECK_EQUAL(recorder.registeredPrefixIds[0], ids[1]);
+  BOOST_CHECK_EQUAL(recorder.registeredPrefixIds[1], ids[2]);
+
+  recorder.interestTags.clear();
+  transport->deliver(Interest(Name("/a/b/c/d")).wireEncode());
+  transport->deliver(Interest(Name("/a")).wireEncode());
+  transport->deliver(Interest(Name("/b/a")).wireEncode());
+  int expectedCA[] = { 4, 1, 5 };
+  BOOST_CHECK(recorder.interestTags == vector<int>(expectedCA, expectedCA + 3));
+
+  // the prefix is unregistered from the hub only when its last handler is removed
+  transport->sentPackets.clear();
+  node.removeRegisteredPrefix(ids[1]);
+  BOOST_CHECK(transport->sentPackets.empty());
+  recorder.interestTags.clear();
+  transport->deliver(Interest(Name("/a/b/d")).wireEncode());
+  BOOST_CHECK(recorder.interestTags == vector<int>(1, 3));
+
+  node.removeRegisteredPrefix(ids[2]);
+  BOOST_REQUIRE_EQUAL(transport->sentPackets.size(), 1);
+  Interest unregister;
+  unregister.wireDecode(transport->sentPackets[0]);
+  BOOST_CHECK(unregister.getName().get(2) == Name::Component("unreg"));
+  recorder.interestTags.clear();
+  transport->deliver(Interest(Name("/a/b/d")).wireEncode());
+  int expectedA[] = { 1, 5 };
+  BOOST_CHECK(recorder.interestTags == vector<int>(expectedA, expectedA + 2));
+
+  // removing an ID again does nothing
+  node.removeRegisteredPrefix(ids[2]);
+  BOOST_CHECK_EQUAL(transport->sentPackets.size(), 1);
+
+  node.shutdown();
+}
+
+BOOST_AUTO_TEST_CASE (MalformedPacketsAreDropped)
+{
+  ptr_lib::shared_ptr<LoopbackTransport> transport(new LoopbackTransport());
+  Node node(transport);
+  Recorder recorder;
+
+  node.registerPrefix(Name("/a"), recorder.makeOnInterest(1), recorder.makeOnRegisterFailed(), ForwardingFlags());
+  transport->answerHubInterests();
+  node.expressInterest(Interest(Name("/a")), recorder.makeOnData(2), recorder.makeOnTimeout(2));
+
+  // An Interest and a Data whose first element is not a Name, an Interest for /a/b whose Nonce is
+  // cut short, and a Data for /a/b without the required Content.
+  static const uint8_t noName[] = { Tlv::Interest, 3, Tlv::Nonce, 1, 0 };
+  static const uint8_t noNameData[] = { Tlv::Data, 3, Tlv::Content, 1, 0 };
+  static const uint8_t shortNonce[] = {
+    Tlv::Interest, 11,
+      Tlv::Name, 6, Tlv::NameComponent, 1, 'a', Tlv::NameComponent, 1, 'b',
+      Tlv::Nonce, 2, 0
+  };
+  static const uint8_t noContent[] = {
+    Tlv::Data, 8,
+      Tlv::Name, 6, Tlv::NameComponent, 1, 'a', Tlv::NameComponent, 1, 'b'
+  };
+  // a packet of another type is ignored
+  static const uint8_t content[] = { Tlv::Content, 1, 0 };
+
+  BOOST_CHECK_NO_THROW(transport->deliver(Block(noName, sizeof(noName))));
+  BOOST_CHECK_NO_THROW(transport->deliver(Block(noNameData, sizeof(noNameData))));
+  BOOST_CHECK_NO_THROW(transport->deliver(Block(shortNonce, sizeof(shortNonce))));
+  BOOST_CHECK_NO_THROW(transport->deliver(Block(noContent, sizeof(noContent))));
+  BOOST_CHECK_NO_THROW(transport->deliver(Block(content, sizeof(content))));
+  BOOST_CHECK(recorder.interestTags.empty());
+  BOOST_CHECK(recorder.dataTags.empty());
+
+  // the Node still works, and the Interest is still pending
+  transport->deliver(Interest(Name("/a/b")).wireEncode());
+  BOOST_CHECK(recorder.interestTags == vector<int>(1, 1));
+  transport->deliver(LoopbackTransport::makeDataWire(Name("/a/b")));
+  BOOST_CHECK(recorder.dataTags == vector<int>(1, 2));
+
+  node.shutdown();
+}
+
+BOOST_AUTO_TEST_CASE (CommandsQueuedTogether)
+{
+  ptr_lib::shared_ptr<LoopbackTransport> transport(new LoopbackTransport());
+  ptr_lib::shared_ptr<boost::asio::io_service> ioService(new boost::asio::io_service());
+  Node node(transport, ioService);
+  node.enableThreadSafety();
+
+  // the calls are queued for the thread running processEvents
+  for (int i = 0; i < 3; ++i)
+    node.put(makeData(Name("/p").appendSegment(i)));
+  BOOST_CHECK(transport->sentPackets.empty());
+
+  // the one processCommands posted runs all the commands queued before it
+  BOOST_CHECK_EQUAL(ioService->poll_one(), 1);
+  BOOST_REQUIRE_EQUAL(transport->sentPackets.size(), 3);
+  for (int i = 0; i < 3; ++i)
+    {
+      Data data;
+      data.wireDecode(transport->sentPackets[i]);
+      BOOST_CHECK_EQUAL(data.getName(), Name("/p").appendSegment(i));
+    }
+  ioService->reset();
+  BOOST_CHECK_EQUAL(ioService->poll(), 0);
+
+  // once it has returned, the next call posts it again
+  ioService->reset();
+  node.put(makeData(Name("/p").appendSegment(3)));
+  BOOST_CHECK_EQUAL(ioService->poll_one(), 1);
+  BOOST_CHECK_EQUAL(transport->sentPackets.size(), 4);
+
+  node.shutdown();
+}
+
+BOOST_AUTO_TEST_CASE (CommandsFromSeveralThreads)
+{
+  ptr_lib::shared_ptr<LoopbackTransport> transport(new LoopbackTransport());
+  ptr_lib::shared_ptr<boost::asio::io_service> ioService(new boost::asio::io_service());
+  Node node(transport, ioService);
+  node.enableThreadSafety();
+
+  pthread_t io;
+  pthread_create(&io, 0, runProcessEvents, &node);
+  vector<PutThread> producers(4);
+  vector<pthread_t> threads(producers.size());
+  for (size_t i = 0; i < producers.size(); ++i)
+    {
+      producers[i].node = &node;
+      producers[i].id = static_cast<int>(i);
+      pthread_create(&threads[i], 0, runPuts, &producers[i]);
+    }
+  for (size_t i = 0; i < producers.size(); ++i)
+    pthread_join(threads[i], 0);
+  // The calls are carried out before this handler, which is posted after them, unless a call queued
+  // while processCommands was returning is left in the queue.
+  ioService->post(func_lib::bind(&boost::asio::io_service::stop, ioService.get()));
+  pthread_join(io, 0);
+
+  // none of the calls is lost, and those of each thread are carried out in order
+  BOOST_REQUIRE_EQUAL(transport->sentPackets.size(), producers.size() * N_PUTS_PER_PRODUCER);
+  vector<size_t> nSent(producers.size(), 0);
+  size_t nErrors = 0;
+  for (size_t i = 0; i < transport->sentPackets.size(); ++i)
+    {
+      Data data;
+      data.wireDecode(transport->sentPackets[i]);
+      size_t id = static_cast<size_t>(data.getName().get(1).toNumber());
+      if (id >= nSent.size() || data.getName().get(2).toSegment() != nSent[id])
+        ++nErrors;
+      else
+        ++nSent[id];
+    }
+  BOOST_CHECK_EQUAL(nErrors, 0);
+
+  node.shutdown();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
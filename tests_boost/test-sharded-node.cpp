@@ -0,0 +1,243 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2013 Regents of the University of California.
+ * See COPYING for copyright and distribution information.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <set>
+#include <ndn-cpp/sharded-node.hpp>
+#include "loopback-transport.hpp"
+
+using namespace std;
+using namespace ndn;
+
+// In the std library, the placeholders are in a different namespace than boost.
+using namespace ndn::func_lib::placeholders;
+
+static const size_t N_SHARDS = 3;
+static const size_t N_NAMES_PER_SHARD = 4;
+
+/**
+ * The ShardedNode over loopback transports, one for each shard, which stand in for the hub
+ */
+class ShardedNodeFixture
+{
+public:
+  ShardedNodeFixture()
+  {
+    vector<ptr_lib::shared_ptr<Transport> > shardTransports;
+    for (size_t i = 0; i < N_SHARDS; ++i)
+      {
+        transports.push_back(ptr_lib::make_shared<LoopbackTransport>());
+        shardTransports.push_back(transports.back());
+      }
+    node.reset(new ShardedNode(shardTransports));
+  }
+
+  ~ShardedNodeFixture()
+  {
+    node->shutdown();
+    processCommands();
+  }
+
+  /**
+   * Run the calls queued for each shard, as the thread of the shard would.
+   */
+  void
+  processCommands()
+  {
+    for (size_t i = 0; i < N_SHARDS; ++i)
+      node->processEvents(i, -1);
+  }
+
+  /**
+   * Get names under the prefix, N_NAMES_PER_SHARD for each shard, in the order of the shards.
+   * The hash of a name is not the same in each process, so the names are chosen in this one.
+   */
+  vector<Name>
+  makeNamesOfEachShard(const Name &prefix) const
+  {
+    vector<vector<Name> > namesOfShards(N_SHARDS);
+    for (uint64_t i = 0; ; ++i)
+      {
+        Name name = Name(prefix).appendNumber(i);
+        vector<Name> &namesOfShard = namesOfShards[node->getShardForName(name)];
+        if (namesOfShard.size() < N_NAMES_PER_SHARD)
+          namesOfShard.push_back(name);
+
+        bool isComplete = true;
+        for (size_t shard = 0; shard < N_SHARDS; ++shard)
+          isComplete = isComplete && namesOfShards[shard].size() == N_NAMES_PER_SHARD;
+        if (isComplete)
+          break;
+      }
+
+    vector<Name> names;
+    for (size_t shard = 0; shard < N_SHARDS; ++shard)
+      names.insert(names.end(), namesOfShards[shard].begin(), namesOfShards[shard].end());
+    return names;
+  }
+
+  vector<ptr_lib::shared_ptr<LoopbackTransport> > transports;
+  ptr_lib::shared_ptr<ShardedNode> node;
+};
+
+/**
+ * Records the Data received for the pending interests and the Interests received for the
+ * prefixes, and answers each Interest by putting a Data through the ShardedNode.
+ */
+class ShardedRecorder
+{
+public:
+  ShardedRecorder()
+    : node(0)
+  {
+  }
+
+  void
+  onData(size_t index, const ptr_lib::shared_ptr<const Interest> &interest, const ptr_lib::shared_ptr<Data> &data)
+  {
+    dataIndexes.push_back(index);
+  }
+
+  void
+  onInterest(const ptr_lib::shared_ptr<const Name> &prefix, const ptr_lib::shared_ptr<const Interest> &interest,
+             Transport &transport, uint64_t registeredPrefixId)
+  {
+    registeredPrefixIds.push_back(registeredPrefixId);
+    interestTransports.push_back(&transport);
+    if (node != 0)
+      {
+        Data data;
+        data.wireDecode(LoopbackTransport::makeDataWire(interest->getName()));
+        node->put(data, registeredPrefixId);
+      }
+  }
+
+  vector<size_t> dataIndexes;
+  /// @brief The registeredPrefixId given to each OnInterest call, and the transport
+  vector<uint64_t> registeredPrefixIds;
+  vector<Transport*> interestTransports;
+
+  /// @brief If not 0, the ShardedNode through which each Interest is answered
+  ShardedNode *node;
+};
+
+static void
+onRegisterFailed(const ptr_lib::shared_ptr<const Name> &prefix)
+{
+  BOOST_ERROR("registerPrefix failed for " << prefix->toUri());
+}
+
+BOOST_FIXTURE_TEST_SUITE(TestShardedNode, ShardedNodeFixture)
+
+BOOST_AUTO_TEST_CASE (PendingInterestIds)
+{
+  ShardedRecorder recorder;
+  vector<Name> names = makeNamesOfEachShard("/s");
+  vector<uint64_t> ids;
+  for (size_t i = 0; i < names.size(); ++i)
+    ids.push_back(node->expressInterest(Interest(names[i]),
+                                        func_lib::bind(&ShardedRecorder::onData, &recorder, i, _1, _2),
+                                        OnTimeout()));
+  BOOST_CHECK_EQUAL(set<uint64_t>(ids.begin(), ids.end()).size(), ids.size());
+  processCommands();
+
+  // each Interest is sent over the connection of the shard of its name
+  for (size_t shard = 0; shard < N_SHARDS; ++shard)
+    {
+      BOOST_REQUIRE_EQUAL(transports[shard]->sentPackets.size(), N_NAMES_PER_SHARD);
+      for (size_t i = 0; i < N_NAMES_PER_SHARD; ++i)
+        {
+          Interest interest;
+          interest.wireDecode(transports[shard]->sentPackets[i]);
+          BOOST_CHECK_EQUAL(interest.getName(), names[shard * N_NAMES_PER_SHARD + i]);
+        }
+      BOOST_CHECK_EQUAL(node->getShardStatistics(shard).nExpressedInterests, N_NAMES_PER_SHARD);
+    }
+
+  // an ID given back to removePendingInterest removes the Interest it was returned for
+  for (size_t i = 0; i < names.size(); i += 2)
+    node->removePendingInterest(ids[i]);
+  processCommands();
+
+  for (size_t i = 0; i < names.size(); ++i)
+    transports[node->getShardForName(names[i])]->deliver(LoopbackTransport::makeDataWire(names[i]));
+  vector<size_t> expected;
+  for (size_t i = 1; i < names.size(); i += 2)
+    expected.push_back(i);
+  sort(recorder.dataIndexes.begin(), recorder.dataIndexes.end());
+  BOOST_CHECK(recorder.dataIndexes == expected);
+  for (size_t shard = 0; shard < N_SHARDS; ++shard)
+    BOOST_CHECK_EQUAL(node->getShardStatistics(shard).nSatisfiedInterests, N_NAMES_PER_SHARD / 2);
+}
+
+BOOST_AUTO_TEST_CASE (RegisteredPrefixIds)
+{
+  ShardedRecorder recorder;
+  recorder.node = node.get();
+  vector<Name> prefixes = makeNamesOfEachShard("/r");
+  vector<uint64_t> ids;
+  for (size_t i = 0; i < prefixes.size(); ++i)
+    ids.push_back(node->registerPrefix(prefixes[i],
+                                       func_lib::bind(&ShardedRecorder::onInterest, &recorder, _1, _2, _3, _4),
+                                       onRegisterFailed, ForwardingFlags()));
+  BOOST_CHECK_EQUAL(set<uint64_t>(ids.begin(), ids.end()).size(), ids.size());
+  processCommands();
+  for (size_t shard = 0; shard < N_SHARDS; ++shard)
+    transports[shard]->answerHubInterests();
+
+  for (size_t i = 0; i < prefixes.size(); ++i)
+    {
+      size_t shard = node->getShardForName(prefixes[i]);
+      Name interestName = Name(prefixes[i]).append("x");
+      transports[shard]->deliver(Interest(interestName).wireEncode());
+
+      // OnInterest gets the ID that registerPrefix returned, and the transport of the shard
+      BOOST_REQUIRE_EQUAL(recorder.registeredPrefixIds.size(), i + 1);
+      BOOST_CHECK_EQUAL(recorder.registeredPrefixIds.back(), ids[i]);
+      BOOST_CHECK(recorder.interestTransports.back() == transports[shard].get());
+
+      // and the Data put with the ID goes back through the shard that received the Interest
+      processCommands();
+      for (size_t other = 0; other < N_SHARDS; ++other)
+        {
+          if (other != shard)
+            BOOST_CHECK(transports[other]->sentPackets.empty());
+        }
+      BOOST_REQUIRE_EQUAL(transports[shard]->sentPackets.size(), 1);
+      Data data;
+      data.wireDecode(transports[shard]->sentPackets[0]);
+      BOOST_CHECK_EQUAL(data.getName(), interestName);
+      transports[shard]->sentPackets.clear();
+    }
+
+  for (size_t shard = 0; shard < N_SHARDS; ++shard)
+    {
+      ShardedNode::ShardStatistics statistics = node->getShardStatistics(shard);
+      BOOST_CHECK_EQUAL(statistics.nReceivedInterests, N_NAMES_PER_SHARD);
+      BOOST_CHECK_EQUAL(statistics.nPutData, N_NAMES_PER_SHARD);
+    }
+
+  // an ID given back to removeRegisteredPrefix unregisters the prefix it was returned for
+  recorder.node = 0;
+  node->removeRegisteredPrefix(ids[0]);
+  processCommands();
+  size_t shard = node->getShardForName(prefixes[0]);
+  BOOST_REQUIRE_EQUAL(transports[shard]->sentPackets.size(), 1);
+  Interest unregister;
+  unregister.wireDecode(transports[shard]->sentPackets[0]);
+  BOOST_CHECK(unregister.getName().get(2) == Name::Component("unreg"));
+
+  // the other prefixes of the shard are still registered
+  size_t nInterests = recorder.registeredPrefixIds.size();
+  transports[shard]->deliver(Interest(Name(prefixes[0]).append("x")).wireEncode());
+  BOOST_CHECK_EQUAL(recorder.registeredPrefixIds.size(), nInterests);
+  transports[shard]->deliver(Interest(Name(prefixes[1]).append("x")).wireEncode());
+  BOOST_CHECK_EQUAL(recorder.registeredPrefixIds.size(), nInterests + 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
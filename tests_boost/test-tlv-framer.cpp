@@ -0,0 +1,233 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/**
+ * Copyright (C) 2013 Regents of the University of California.
+ * See COPYING for copyright and distribution information.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+#include <ndn-cpp/encoding/tlv-framer.hpp>
+
+using namespace std;
+using namespace ndn;
+
+// A Content element with 3 bytes of value, and the header of one with 200 bytes of value, whose
+// length takes 3 bytes.
+static const uint8_t SHORT_ELEMENT[] = { 0x11, 0x03, 0x01, 0x02, 0x03 };
+static const uint8_t LONG_HEADER[] = { 0x11, 0xFD, 0x00, 0xC8 };
+static const size_t LONG_VALUE_SIZE = 200;
+
+/**
+ * Copy the bytes into the receive buffer of the framer, like a socket read.
+ */
+static void
+receive(TlvFramer &framer, const uint8_t *bytes, size_t size)
+{
+  BOOST_REQUIRE(size <= framer.receiveBufferSize());
+  memcpy(framer.receiveBuffer(), bytes, size);
+  framer.received(size);
+}
+
+static vector<uint8_t>
+makeLongElement()
+{
+  vector<uint8_t> element(LONG_HEADER, LONG_HEADER + sizeof(LONG_HEADER));
+  for (size_t i = 0; i < LONG_VALUE_SIZE; ++i)
+    element.push_back(static_cast<uint8_t>(i));
+  return element;
+}
+
+BOOST_AUTO_TEST_SUITE(TestTlvFramer)
+
+BOOST_AUTO_TEST_CASE (ElementsOfOneRead)
+{
+  TlvFramer framer;
+  vector<uint8_t> stream(SHORT_ELEMENT, SHORT_ELEMENT + sizeof(SHORT_ELEMENT));
+  stream.insert(stream.end(), SHORT_ELEMENT, SHORT_ELEMENT + sizeof(SHORT_ELEMENT));
+  receive(framer, &stream[0], stream.size());
+
+  Block element;
+  for (int i = 0; i < 2; ++i)
+    {
+      BOOST_REQUIRE(framer.next(element));
+      BOOST_CHECK_EQUAL(element.type(), Tlv::Content);
+      BOOST_CHECK_EQUAL_COLLECTIONS(element.begin(), element.end(),
+                                    SHORT_ELEMENT, SHORT_ELEMENT + sizeof(SHORT_ELEMENT));
+    }
+  BOOST_CHECK(!framer.next(element));
+  BOOST_CHECK(!element.hasWire());
+  BOOST_CHECK_EQUAL(framer.needed(), 1);
+}
+
+BOOST_AUTO_TEST_CASE (ElementSplitAcrossReads)
+{
+  TlvFramer framer;
+  vector<uint8_t> long_ = makeLongElement();
+  receive(framer, &long_[0], 10);
+
+  Block element;
+  BOOST_CHECK(!framer.next(element));
+  BOOST_CHECK_EQUAL(framer.needed(), long_.size() - 10);
+
+  // a read which is still short only lowers the number of needed bytes
+  receive(framer, &long_[10], 90);
+  BOOST_CHECK(!framer.next(element));
+  BOOST_CHECK_EQUAL(framer.needed(), long_.size() - 100);
+
+  // the rest of the element and the start of the next one
+  vector<uint8_t> rest(long_.begin() + 100, long_.end());
+  rest.insert(rest.end(), SHORT_ELEMENT, SHORT_ELEMENT + 2);
+  receive(framer, &rest[0], rest.size());
+  BOOST_REQUIRE(framer.next(element));
+  BOOST_CHECK_EQUAL(element.value_size(), LONG_VALUE_SIZE);
+  BOOST_CHECK_EQUAL_COLLECTIONS(element.begin(), element.end(), long_.begin(), long_.end());
+
+  BOOST_CHECK(!framer.next(element));
+  receive(framer, SHORT_ELEMENT + 2, sizeof(SHORT_ELEMENT) - 2);
+  BOOST_REQUIRE(framer.next(element));
+  BOOST_CHECK_EQUAL(element.value_size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE (HeaderSplitAcrossReads)
+{
+  TlvFramer framer;
+  vector<uint8_t> long_ = makeLongElement();
+
+  // the type and the first byte of the 3-byte length: the size is not known yet
+  receive(framer, &long_[0], 2);
+  Block element;
+  BOOST_CHECK(!framer.next(element));
+  BOOST_CHECK_EQUAL(framer.needed(), 1);
+
+  receive(framer, &long_[2], 1);
+  BOOST_CHECK(!framer.next(element));
+  BOOST_CHECK_EQUAL(framer.needed(), 1);
+
+  // the length is complete, so the framer knows the rest that it needs
+  receive(framer, &long_[3], 1);
+  BOOST_CHECK(!framer.next(element));
+  BOOST_CHECK_EQUAL(framer.needed(), LONG_VALUE_SIZE);
+
+  receive(framer, &long_[4], LONG_VALUE_SIZE);
+  BOOST_REQUIRE(framer.next(element));
+  BOOST_CHECK_EQUAL(element.size(), long_.size());
+}
+
+BOOST_AUTO_TEST_CASE (ElementLargerThanBuffer)
+{
+  // the element does not fit in the receive buffer, so it gets a buffer of its own
+  TlvFramer framer(16);
+  vector<uint8_t> long_ = makeLongElement();
+
+  size_t offset = 0;
+  Block element;
+  while (offset < long_.size())
+    {
+      BOOST_CHECK(!framer.next(element));
+      size_t size = min(framer.receiveBufferSize(), long_.size() - offset);
+      BOOST_REQUIRE(size > 0);
+      receive(framer, &long_[offset], size);
+      offset += size;
+    }
+  BOOST_REQUIRE(framer.next(element));
+  BOOST_CHECK_EQUAL_COLLECTIONS(element.begin(), element.end(), long_.begin(), long_.end());
+
+  // the next element is received in the same way
+  BOOST_CHECK(!framer.next(element));
+  receive(framer, SHORT_ELEMENT, sizeof(SHORT_ELEMENT));
+  BOOST_REQUIRE(framer.next(element));
+  BOOST_CHECK_EQUAL(element.size(), sizeof(SHORT_ELEMENT));
+}
+
+BOOST_AUTO_TEST_CASE (ElementLargerThanMaximum)
+{
+  TlvFramer framer;
+  // a length of 1 MB + 1 in the 5-byte form
+  static const uint8_t header[] = { 0x11, 0xFE, 0x00, 0x10, 0x00, 0x01 };
+  receive(framer, header, sizeof(header));
+
+  Block element;
+  BOOST_CHECK_THROW(framer.next(element), TlvFramer::Error);
+
+  // an element of exactly the maximum size with a smaller maximum
+  TlvFramer smallFramer(8800, 5);
+  receive(smallFramer, SHORT_ELEMENT, sizeof(SHORT_ELEMENT));
+  BOOST_CHECK(smallFramer.next(element));
+  receive(smallFramer, LONG_HEADER, sizeof(LONG_HEADER));
+  BOOST_CHECK_THROW(smallFramer.next(element), TlvFramer::Error);
+}
+
+BOOST_AUTO_TEST_CASE (MalformedVarNumber)
+{
+  // a length which overflows when the size of the header is added
+  TlvFramer framer;
+  static const uint8_t overflowingLength[] = { 0x11, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+  receive(framer, overflowingLength, sizeof(overflowingLength));
+  Block element;
+  BOOST_CHECK_THROW(framer.next(element), TlvFramer::Error);
+
+  // a type larger than 32 bits in a complete element
+  TlvFramer typeFramer;
+  static const uint8_t longType[] = { 0xFF, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00 };
+  receive(typeFramer, longType, sizeof(longType));
+  BOOST_CHECK_THROW(typeFramer.next(element), TlvFramer::Error);
+}
+
+BOOST_AUTO_TEST_CASE (Compaction)
+{
+  TlvFramer framer(16);
+  vector<uint8_t> stream(SHORT_ELEMENT, SHORT_ELEMENT + sizeof(SHORT_ELEMENT));
+  stream.insert(stream.end(), SHORT_ELEMENT, SHORT_ELEMENT + 4);
+
+  // while a delivered element shares the buffer, the partial element is moved to a new buffer
+  receive(framer, &stream[0], stream.size());
+  Block delivered;
+  BOOST_REQUIRE(framer.next(delivered));
+  Block element;
+  BOOST_CHECK(!framer.next(element));
+  BOOST_CHECK_EQUAL(framer.receiveBufferSize(), 16 - 4);
+
+  // and the delivered element is not overwritten by the next read
+  static const uint8_t filler[] = { 0x11, 0x05, 0xEE, 0xEE, 0xEE, 0xEE, 0xEE };
+  receive(framer, SHORT_ELEMENT + 4, 1);
+  receive(framer, filler, sizeof(filler));
+  BOOST_CHECK_EQUAL_COLLECTIONS(delivered.begin(), delivered.end(),
+                                SHORT_ELEMENT, SHORT_ELEMENT + sizeof(SHORT_ELEMENT));
+  BOOST_REQUIRE(framer.next(element));
+  BOOST_CHECK_EQUAL_COLLECTIONS(element.begin(), element.end(),
+                                SHORT_ELEMENT, SHORT_ELEMENT + sizeof(SHORT_ELEMENT));
+  BOOST_REQUIRE(framer.next(element));
+  BOOST_CHECK_EQUAL(element.value_size(), 5);
+  BOOST_CHECK(!framer.next(element));
+
+  // once nothing shares the buffer, a partial element is moved to its front in place
+  delivered = Block();
+  const uint8_t *front = framer.receiveBuffer();
+  stream.assign(SHORT_ELEMENT, SHORT_ELEMENT + sizeof(SHORT_ELEMENT));
+  stream.insert(stream.end(), SHORT_ELEMENT, SHORT_ELEMENT + 3);
+  receive(framer, &stream[0], stream.size());
+  BOOST_REQUIRE(framer.next(element));
+  BOOST_CHECK(!framer.next(element));
+  BOOST_CHECK(framer.receiveBuffer() == front + 3);
+  receive(framer, SHORT_ELEMENT + 3, sizeof(SHORT_ELEMENT) - 3);
+  BOOST_REQUIRE(framer.next(element));
+  BOOST_CHECK_EQUAL_COLLECTIONS(element.begin(), element.end(),
+                                SHORT_ELEMENT, SHORT_ELEMENT + sizeof(SHORT_ELEMENT));
+}
+
+BOOST_AUTO_TEST_CASE (Reset)
+{
+  TlvFramer framer;
+  receive(framer, SHORT_ELEMENT, 3);
+  Block element;
+  BOOST_CHECK(!framer.next(element));
+
+  framer.reset();
+  BOOST_CHECK_EQUAL(framer.needed(), 1);
+  receive(framer, SHORT_ELEMENT, sizeof(SHORT_ELEMENT));
+  BOOST_REQUIRE(framer.next(element));
+  BOOST_CHECK_EQUAL(element.size(), sizeof(SHORT_ELEMENT));
+}
+
+BOOST_AUTO_TEST_SUITE_END()